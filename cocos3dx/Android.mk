@@ -44,7 +44,6 @@ C3DMesh.cpp \
 C3DMeshSkin.cpp \
 C3DModel.cpp \
 C3DModelNode.cpp \
-C3Dneon_matrix_impl.c \
 C3DNode.cpp \
 C3DNoise.cpp \
 C3DOBB.cpp \
@@ -105,6 +104,19 @@ C3DSkinMorphModel.cpp \
 C3DSkinlessMorphModel.cpp \
 Rectangle.cpp \
 StringTool.cpp \
+C3DOctree.cpp \
+C3DLightGrid.cpp \
+C3DMathSIMD.cpp \
+C3DMathSIMD_sse.cpp \
+C3DMathSIMD_neon.cpp \
+physics/RigidBody.cpp \
+physics/PhysicsWorld.cpp \
+physics/PhysicsCollision.cpp \
+C3DStateCache.cpp \
+C3DGLShim.cpp \
+C3DAsyncLoader.cpp \
+C3DOcclusionBuffer.cpp \
+C3DLODNode.cpp \
 C3DDeviceAdapter_android.cpp \
 
 
@@ -184,15 +184,27 @@ extern void printError(const char* format, ...);
     extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArrays;
     extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays;
     extern PFNGLISVERTEXARRAYOESPROC glIsVertexArray;
+    typedef void (GL_APIENTRYP PFNC3DDRAWELEMENTSINSTANCEDPROC) (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei primcount);
+    typedef void (GL_APIENTRYP PFNC3DVERTEXATTRIBDIVISORPROC) (GLuint index, GLuint divisor);
+    extern PFNC3DDRAWELEMENTSINSTANCEDPROC glDrawElementsInstanced;
+    extern PFNC3DVERTEXATTRIBDIVISORPROC glVertexAttribDivisor;
+    extern PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinary;
+    extern PFNGLPROGRAMBINARYOESPROC glProgramBinary;
+    #define GL_PROGRAM_BINARY_LENGTH GL_PROGRAM_BINARY_LENGTH_OES
+    #define GL_NUM_PROGRAM_BINARY_FORMATS GL_NUM_PROGRAM_BINARY_FORMATS_OES
     #define glClearDepth glClearDepthf
     #define OPENGL_ES
     #define USE_PVRTC
+    #define USE_PROGRAM_BINARY
     // todo reedhong:
    // #define USE_VAO
 #elif WIN32
     #define WIN32_LEAN_AND_MEAN
     #include <GL/glew.h>
     //#define USE_VAO
+    #define USE_PROGRAM_BINARY
+#elif defined(LINUX)
+    #include <GL/glew.h>
 #elif __APPLE__
     #include "TargetConditionals.h"
     #if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
@@ -202,6 +214,8 @@ extern void printError(const char* format, ...);
         #define glDeleteVertexArrays glDeleteVertexArraysOES
         #define glGenVertexArrays glGenVertexArraysOES
         #define glIsVertexArray glIsVertexArrayOES
+        #define glDrawElementsInstanced glDrawElementsInstancedEXT
+        #define glVertexAttribDivisor glVertexAttribDivisorEXT
         #define glClearDepth glClearDepthf
         #define OPENGL_ES
         #define USE_PVRTC
@@ -213,6 +227,8 @@ extern void printError(const char* format, ...);
         #define glDeleteVertexArrays glDeleteVertexArraysAPPLE
         #define glGenVertexArrays glGenVertexArraysAPPLE
         #define glIsVertexArray glIsVertexArrayAPPLE
+        #define glDrawElementsInstanced glDrawElementsInstancedARB
+        #define glVertexAttribDivisor glVertexAttribDivisorARB
     //    #define USE_VAO
     #else
         #error "Unsupported Apple Device"
@@ -230,6 +246,10 @@ typedef GLuint FrameBufferHandle;
 typedef GLuint RenderBufferHandle;
 }
 
+#if defined(C3D_GL_RECORD) || defined(C3D_GL_NULL)
+#include "C3DGLShim.h"
+#endif
+
 /**
  * GL assertion that can be used for any OpenGL function call.
  *
@@ -313,8 +333,11 @@ extern GLenum __gl_error_code;
 #endif
 #endif
 
+// ENABLE_C3D_PROFILE may also be defined by the build, the profiler is cheap enough for release builds
 #ifdef COCOS3DX_DEBUG
+#ifndef ENABLE_C3D_PROFILE
 #define ENABLE_C3D_PROFILE
+#endif
 #define ENABLE_C3D_DRAWDEBUG
 #endif
 
@@ -24,17 +24,19 @@ THE SOFTWARE.
 #include "BonePart.h"
 
 #include "C3DMeshSkin.h"
+#include "C3DVector4.h"
 
 namespace cocos3d
 {
 BonePart::BonePart():
-          _meshSkin(NULL),_batchID(0),_offsetVertexIndex(0),_numVertexIndex(0)
+          _meshSkin(NULL),_batchID(0),_offsetVertexIndex(0),_numVertexIndex(0),_matrixPalette(NULL),_paletteFrameIndex(0)
 {
 	_meshSkin = NULL;
 }
 
 BonePart::~BonePart()
 {
+	SAFE_DELETE_ARRAY(_matrixPalette);
 }
 
 BonePart* BonePart::create(C3DMeshSkin* meshSkin, unsigned int batchID,unsigned int offsetVertexIndex,unsigned int numVertexIndex)
@@ -53,5 +55,11 @@ void BonePart::setIndexData(void* indexData, unsigned int indexCount)
 {
 	_indices.resize(indexCount);
 	memcpy(&_indices[0],indexData,indexCount * sizeof(unsigned int));
+
+	// 3 rows per bone, filled by C3DMeshSkin::getMatrixPalette
+	SAFE_DELETE_ARRAY(_matrixPalette);
+	if (indexCount > 0)
+		_matrixPalette = new C3DVector4[indexCount * 3];
+	_paletteFrameIndex = 0;
 }
 }
\ No newline at end of file
@@ -27,6 +27,7 @@ namespace cocos3d
 {
 class C3DNode;
 class C3DMeshSkin;
+class C3DVector4;
 
 /**
  * Defines a structure of skin-mesh's bone.
@@ -65,6 +66,10 @@ public:
 	unsigned int _offsetVertexIndex;
 	unsigned int _numVertexIndex;
 	std::vector<unsigned int> _indices;
+
+	// Palette of the bones in _indices, gathered from the skin's palette once a frame.
+	C3DVector4* _matrixPalette;
+	unsigned int _paletteFrameIndex;
 };
 }
 
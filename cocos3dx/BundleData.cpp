@@ -27,7 +27,7 @@ THE SOFTWARE.
 namespace cocos3d
 {
 MeshData::MeshData(C3DVertexElement* elements, unsigned int elementCount)
-	: vertexFormat(NULL), vertexCount(0), vertexData(NULL), boundingBox(NULL)
+	: vertexFormat(NULL), vertexCount(0), vertexData(NULL), ownVertexData(true), boundingBox(NULL)
 {
 	vertexFormat = new C3DVertexFormat(elements,elementCount);
 	boundingBox = new C3DAABB();
@@ -36,7 +36,8 @@ MeshData::MeshData(C3DVertexElement* elements, unsigned int elementCount)
 MeshData::~MeshData()
 {
 	SAFE_DELETE(vertexFormat);
-    SAFE_DELETE_ARRAY(vertexData);
+    if (ownVertexData)
+        SAFE_DELETE_ARRAY(vertexData);
 
     for (unsigned int i = 0; i < parts.size(); ++i)
     {
@@ -66,12 +67,13 @@ BonePartData::~BonePartData()
 }
 
 SubMeshData::SubMeshData() :
-    indexCount(0), indexData(NULL)
+    indexCount(0), indexData(NULL), ownIndexData(true)
 {
 }
 
 SubMeshData::~SubMeshData()
 {
-    SAFE_DELETE_ARRAY(indexData);
+    if (ownIndexData)
+        SAFE_DELETE_ARRAY(indexData);
 }
 }
\ No newline at end of file
@@ -50,6 +50,7 @@ public:
     C3DVertexFormat* vertexFormat;
     unsigned int vertexCount;
     unsigned char* vertexData;
+    bool ownVertexData;         // false when vertexData points into the stream of the loader
 	C3DAABB* boundingBox;
 
     PrimitiveType primitiveType;
@@ -129,6 +130,7 @@ public:
     IndexFormat indexFormat;
     unsigned int indexCount;
     unsigned char* indexData;
+    bool ownIndexData;          // false when indexData points into the stream of the loader
 };
 }
 
@@ -261,12 +261,11 @@ void C3DAABB::transform(const C3DMatrix& matrix)
     corners[7].set(_min.x, _max.y, _min.z);
 
     // C3DTransform the corners, recalculating the min and max points along the way.
-    matrix.transformPoint(&corners[0]);
+    matrix.transformPoints(corners, corners, 8);
     C3DVector3 newMin = corners[0];
     C3DVector3 newMax = corners[0];
     for (int i = 1; i < 8; i++)
     {
-        matrix.transformPoint(&corners[i]);
         updateMinMax(&corners[i], &newMin, &newMax);
     }
     _min = newMin;
@@ -485,7 +485,7 @@ void C3DAnimation::removeRunClip(C3DAnimationClip* clip)
 
 void C3DAnimation::update(long elapsedTime, bool updatePose)
 {
-    BEGIN_PROFILE("3danimation");
+    PROFILE_SCOPE("3danimation");
     if (_state != RUNNING)
         return;
 
@@ -520,7 +520,5 @@ void C3DAnimation::update(long elapsedTime, bool updatePose)
 
     if (_runningClips.empty())
         _state = IDLE;
-
-    END_PROFILE("3danimation");
 }
 }
\ No newline at end of file
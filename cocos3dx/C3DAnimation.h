@@ -170,6 +170,11 @@ public:
      */
     C3DAnimationClip* getCurAnimationClip() { return _currentClip; }
 
+	/**
+     * Determines if any clip of the animation is running
+     */
+    bool isPlaying() const { return !_runningClips.empty(); }
+
 	/**
      * clone
      */
@@ -30,7 +30,7 @@ THE SOFTWARE.
 namespace cocos3d
 {
 C3DAnimationChannel::C3DAnimationChannel(C3DAnimation* animation, C3DBone* bone, C3DAnimationCurve* curve, unsigned long duration)
-    : _animation(animation), _bone(bone),  _curve(curve), _duration(duration)
+    : _animation(animation), _bone(bone),  _curve(curve), _duration(duration), _keyCursor(0)
 {
 	_curve->retain();
     _bone->addChannel(this);
@@ -58,6 +58,8 @@ private:
 
     C3DAnimationCurve* _curve;
     unsigned long _duration;
+
+    unsigned int _keyCursor; // last key used on the shared curve, speeds up the next evaluate
 };
 }
 
@@ -406,7 +406,7 @@ unsigned short C3DAnimationClip::update_loop(unsigned long elapsedTime, bool upd
 
            // Evaluate the point on Curve
            C3DAnimationCurve::InterpolationMode mode = _animation->getQuality() == C3DAnimation::High ? C3DAnimationCurve::Linear : C3DAnimationCurve::Near;
-           channel->getCurve()->evaluate(percentComplete, value, mode);
+           channel->getCurve()->evaluate(percentComplete, value, mode, &channel->_keyCursor);
            // Set the animation value on the target property.
            bone->setAnimationValue(value, _blendWeight);
        }
@@ -589,7 +589,7 @@ unsigned short C3DAnimationClip::update_once(unsigned long elapsedTime, bool upd
 
            // Evaluate the point on Curve
            C3DAnimationCurve::InterpolationMode mode = _animation->getQuality() == C3DAnimation::High ? C3DAnimationCurve::Linear : C3DAnimationCurve::Near;
-           channel->getCurve()->evaluate(percentComplete, value, mode);
+           channel->getCurve()->evaluate(percentComplete, value, mode, &channel->_keyCursor);
            // Set the animation value on the target property.
            bone->setAnimationValue(value, _blendWeight);
        }
@@ -22,6 +22,7 @@ THE SOFTWARE.
 
 #include "C3DAnimationCurve.h"
 #include "C3DQuaternion.h"
+#include "C3DMathSIMD.h"
 #include "Base.h"
 
 namespace cocos3d
@@ -32,33 +33,24 @@ C3DAnimationCurve* C3DAnimationCurve::create(unsigned int pointCount)
 }
 
 C3DAnimationCurve::C3DAnimationCurve(unsigned int pointCount)
-    : _pointCount(pointCount), _componentSize(sizeof(float)*10),  _points(NULL), _dur(0)
+    : _pointCount(pointCount), _times(NULL), _scales(NULL), _rotations(NULL), _positions(NULL), _dur(0)
 {
-    _points = new Point[_pointCount];
-    for (unsigned int i = 0; i < _pointCount; i++)
-    {
-        _points[i].time = 0.0f;
-        _points[i].value = new float[10];
-    }
-    _points[_pointCount - 1].time = 1.0f;
+    // one block for all the tracks: times, scales, rotations, positions
+    _times = new float[_pointCount * 11];
+    _scales = _times + _pointCount;
+    _rotations = _scales + _pointCount * 3;
+    _positions = _rotations + _pointCount * 4;
+
+    memset(_times, 0, sizeof(float) * _pointCount * 11);
+    _times[_pointCount - 1] = 1.0f;
 }
 
 C3DAnimationCurve::~C3DAnimationCurve()
 {
-    for (unsigned int i = 0; i < _pointCount; i++) {
-        SAFE_DELETE_ARRAY(_points[i].value);
-    }
-    SAFE_DELETE_ARRAY(_points);
-}
-
-C3DAnimationCurve::Point::Point()
-    : time(0.0f), value(NULL)
-{
-}
-
-C3DAnimationCurve::Point::~Point()
-{
-    SAFE_DELETE_ARRAY(value);
+    SAFE_DELETE_ARRAY(_times);
+    _scales = NULL;
+    _rotations = NULL;
+    _positions = NULL;
 }
 
 unsigned int C3DAnimationCurve::getPointCount() const
@@ -68,55 +60,63 @@ unsigned int C3DAnimationCurve::getPointCount() const
 
 float C3DAnimationCurve::getStartTime() const
 {
-    return _points[0].time;
+    return _times[0];
 }
 
 float C3DAnimationCurve::getEndTime() const
 {
-    return _points[_pointCount-1].time;
+    return _times[_pointCount-1];
 }
 
 void C3DAnimationCurve::setPoint(unsigned int index, float time, float* value)
 {
     //assert(index < _pointCount && time >= 0.0f && time <= 1.0f && !(index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
 
-    _points[index].time = time;
+    _times[index] = time;
 
     if (value)
-        memcpy(_points[index].value, value, _componentSize);
+    {
+        memcpy(_scales + index * 3, value, sizeof(float) * 3);
+        memcpy(_rotations + index * 4, value + 3, sizeof(float) * 4);
+        memcpy(_positions + index * 3, value + 7, sizeof(float) * 3);
+    }
 }
 
-void C3DAnimationCurve::evaluate(float time, float* dst, C3DAnimationCurve::InterpolationMode mode) const
+void C3DAnimationCurve::getValue(unsigned int index, float* dst) const
+{
+    memcpy(dst, _scales + index * 3, sizeof(float) * 3);
+    memcpy(dst + 3, _rotations + index * 4, sizeof(float) * 4);
+    memcpy(dst + 7, _positions + index * 3, sizeof(float) * 3);
+}
+
+void C3DAnimationCurve::evaluate(float time, float* dst, C3DAnimationCurve::InterpolationMode mode, unsigned int* cursor) const
 {
     assert(dst && time >= 0 && time <= 1.0f);
 
-    if (_pointCount == 1 || time <= _points[0].time)
+    if (_pointCount == 1 || time <= _times[0])
     {
-        memcpy(dst, _points[0].value, _componentSize);
+        getValue(0, dst);
         return;
     }
-    else if (time >= _points[_pointCount - 1].time)
+    else if (time >= _times[_pointCount - 1])
     {
-        memcpy(dst, _points[_pointCount - 1].value, _componentSize);
+        getValue(_pointCount - 1, dst);
         return;
     }
 
-    unsigned int index = determineIndex(time);
-
-    Point* from = _points + index;
-    Point* to = _points + (index + 1);
+    unsigned int index = determineIndex(time, cursor);
 
-    float scale = (to->time - from->time);
-    float t = (time - from->time) / scale;
+    float scale = (_times[index + 1] - _times[index]);
+    float t = (time - _times[index]) / scale;
 
     if (mode == C3DAnimationCurve::Linear)
-        interpolateLinear(t, from, to, dst);
+        interpolateLinear(t, index, index + 1, dst);
     else if (mode == C3DAnimationCurve::Near)
     {
         if (t  < 0.5f)
-            memcpy(dst, from->value, _componentSize);
+            getValue(index, dst);
         else
-            memcpy(dst, to->value, _componentSize);
+            getValue(index + 1, dst);
     }
 }
 
@@ -125,10 +125,10 @@ float C3DAnimationCurve::lerp(float t, float from, float to)
     return from + (to-from) * t;
 }
 
-void C3DAnimationCurve::interpolateLinear(float t, Point* from, Point* to, float* dst) const
+void C3DAnimationCurve::interpolateLinear(float t, unsigned int from, unsigned int to, float* dst) const
 {
-    float* fromValue = from->value;
-    float* toValue = to->value;
+    const float* fromValue = _scales + from * 3;
+    const float* toValue = _scales + to * 3;
 
     unsigned int i = 0;
     for (i = 0; i < 3; i++)
@@ -139,14 +139,16 @@ void C3DAnimationCurve::interpolateLinear(float t, Point* from, Point* to, float
             dst[i] = fromValue[i] + (toValue[i] - fromValue[i]) * t;
     }
 
-    interpolateQuaternion(t, (fromValue + i), (toValue + i), (dst + i));
+    interpolateQuaternion(t, _rotations + from * 4, _rotations + to * 4, dst + 3);
 
-    for (i += 4; i < 10; i++)
+    fromValue = _positions + from * 3;
+    toValue = _positions + to * 3;
+    for (i = 0; i < 3; i++)
     {
         if (fromValue[i] == toValue[i])
-            dst[i] = fromValue[i];
+            dst[i + 7] = fromValue[i];
         else
-            dst[i] = fromValue[i] + (toValue[i] - fromValue[i]) * t;
+            dst[i + 7] = fromValue[i] + (toValue[i] - fromValue[i]) * t;
     }
 }
 
@@ -155,34 +157,50 @@ void C3DAnimationCurve::interpolateQuaternion(float t, float* from, float* to, f
     // Evaluate.
     if (t >= 0)
     {
-        C3DQuaternion::slerp(from[0], from[1], from[2], from[3], to[0], to[1], to[2], to[3], t, dst, dst + 1, dst + 2, dst + 3);
+        C3DMathSIMD::getInstance().slerpQuaternion(from, to, t, dst);
     }
     else
-        C3DQuaternion::slerp(to[0], to[1], to[2], to[3], from[0], from[1], from[2], from[3], t, dst, dst + 1, dst + 2, dst + 3);
+        C3DMathSIMD::getInstance().slerpQuaternion(to, from, t, dst);
 
     //((C3DQuaternion*) dst)->normalize();
 }
 
-int C3DAnimationCurve::determineIndex(float time) const
+unsigned int C3DAnimationCurve::determineIndex(float time, unsigned int* cursor) const
 {
+    // time is inside ]_times[0], _times[_pointCount - 1][ here
+    if (cursor)
+    {
+        // forward playback stays on the same key or steps to the next one
+        unsigned int index = *cursor;
+        if (index < _pointCount - 1 && time >= _times[index])
+        {
+            if (time <= _times[index + 1])
+                return index;
+
+            if (index + 2 < _pointCount && time <= _times[index + 2])
+            {
+                *cursor = index + 1;
+                return index + 1;
+            }
+        }
+    }
+
+    // last key whose time is not greater than time
     unsigned int min = 0;
     unsigned int max = _pointCount - 1;
-    unsigned int mid = 0;
-
-    do
+    while (max - min > 1)
     {
-        mid = (min + max) >> 1;
-
-        if (time >= _points[mid].time && time <= _points[mid + 1].time)
-            return mid;
-        else if (time < _points[mid].time)
-            max = mid - 1;
+        unsigned int mid = (min + max) >> 1;
+        if (time < _times[mid])
+            max = mid;
         else
-            min = mid + 1;
-    } while (min <= max);
+            min = mid;
+    }
+
+    if (cursor)
+        *cursor = min;
 
-    // We should never hit this!
-    return -1;
+    return min;
 }
 
     ///////////////////implementation of animation manager////////////
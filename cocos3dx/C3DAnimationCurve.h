@@ -30,7 +30,11 @@ THE SOFTWARE.
 namespace cocos3d
 {
 /**
- * Represents an n-dimensional curve.
+ * Represents the transform curve of a bone.
+ *
+ * The keys are stored as separate scale, rotation and position tracks sharing
+ * one time array, all in a single allocation. A key value passed in or out of
+ * the curve is 10 floats: scale (3), rotation quaternion (4) and position (3).
  */
 class C3DAnimationCurve : public cocos2d::Ref
 {
@@ -79,8 +83,11 @@ public:
 
 	/**
     * interpolate evaluate by time.
+    *
+    * @param cursor Key index found by the previous evaluate of the caller, updated here.
+    * Curves are shared, so the cursor belongs to the caller. May be NULL.
     */
-    void evaluate(float time, float* dst, InterpolationMode mode = Linear) const;
+    void evaluate(float time, float* dst, InterpolationMode mode = Linear, unsigned int* cursor = NULL) const;
 
 	/**
     * lerp.
@@ -89,22 +96,6 @@ public:
 
 private:
 
-    /**
-     * Defines a single point within a curve.
-     */
-    class Point
-    {
-    public:
-
-        float time;
-
-        float* value;
-
-        Point();
-
-        ~Point();
-    };
-
 	/**
      * Constructor.
      */
@@ -123,7 +114,12 @@ private:
 	/**
      * Interpolate by Linear.
      */
-    void interpolateLinear(float t, Point* from, Point* to, float* dst) const;
+    void interpolateLinear(float t, unsigned int from, unsigned int to, float* dst) const;
+
+	/**
+     * Copy the value of a key.
+     */
+    void getValue(unsigned int index, float* dst) const;
 
 	/**
      * Interpolate by C3DQuaternion.
@@ -131,15 +127,19 @@ private:
     void interpolateQuaternion(float s, float* from, float* to, float* dst) const;
 
 	/**
-     * Determine index by time.
+     * Determine index by time, the cursor is tried before searching.
      */
-    int determineIndex(float time) const;
+    unsigned int determineIndex(float time, unsigned int* cursor) const;
 
     unsigned int _pointCount;           // Number of points on the curve.
 
-    unsigned int _componentSize;        // The component size (in bytes).
+    float* _times;                      // key times, shared by the tracks.
+
+    float* _scales;                     // scale track, 3 floats per key.
+
+    float* _rotations;                  // rotation track, 4 floats per key.
 
-    Point* _points;                     // The points on the curve.
+    float* _positions;                  // position track, 3 floats per key.
 
     unsigned long _dur;                          //  duration of the animation curve, ms
 };
@@ -0,0 +1,580 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "Base.h"
+#include "C3DAsyncLoader.h"
+#include "C3DElementNode.h"
+#include "C3DTexture.h"
+#include "C3DMaterialManager.h"
+#include "C3DRenderNodeManager.h"
+#include "C3DResourceLoader.h"
+#include "C3DProfile.h"
+
+#include <algorithm>
+
+namespace cocos3d
+{
+static C3DAsyncLoader* __asyncLoaderInstance = NULL;
+
+struct C3DAsyncLoader::Request
+{
+	enum Type
+	{
+		Type_Texture,
+		Type_Material,
+		Type_RenderNode
+	};
+
+	enum State
+	{
+		State_Queued,	// waits for a worker
+		State_Loading,	// taken by a worker, or loaded and not seen by update() yet
+		State_Waiting,	// material waiting for its textures
+		State_Ready		// waits for the main thread
+	};
+
+	unsigned int id;
+	std::string name;
+	std::string fullPath;
+	std::string binaryPath;	// the ".bin" of a material, empty when there is none
+	Type type;
+	int priority;
+	State state;
+	bool cancelled;
+	Callback callback;
+
+	// the material a texture is decoded for, and the textures a material waits for
+	Request* parent;
+	unsigned int pendingTextures;
+
+	// results of the worker
+	cocos2d::CCImage* image;
+	C3DElementNode* nodes;
+	C3DResourceLoader* loader;
+	unsigned int size;
+
+	Request() : id(0), type(Type_Texture), priority(0), state(State_Queued), cancelled(false),
+		parent(NULL), pendingTextures(0), image(NULL), nodes(NULL), loader(NULL), size(0)
+	{
+	}
+
+	~Request()
+	{
+		SAFE_RELEASE(image);
+		SAFE_DELETE(nodes);
+		SAFE_RELEASE(loader);
+	}
+};
+
+static bool hasExtension(const std::string& name, const char* extension)
+{
+	size_t length = strlen(extension);
+	if (name.size() < length)
+		return false;
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		if (tolower(name[name.size() - length + i]) != extension[i])
+			return false;
+	}
+	return true;
+}
+
+C3DAsyncLoader::C3DAsyncLoader()
+{
+	_nextId = 1;
+	_quit = false;
+	_threadCount = 2;
+	_budgetBytes = 4 * 1024 * 1024;
+	_budgetTime = 4.0f;
+}
+
+C3DAsyncLoader::~C3DAsyncLoader()
+{
+	stopThreads();
+
+	for (size_t i = 0; i < _requests.size(); ++i)
+	{
+		delete _requests[i];
+	}
+	_requests.clear();
+
+	__asyncLoaderInstance = NULL;
+}
+
+C3DAsyncLoader* C3DAsyncLoader::getInstance()
+{
+	if (!__asyncLoaderInstance)
+	{
+		__asyncLoaderInstance = new C3DAsyncLoader();
+		__asyncLoaderInstance->autorelease();
+	}
+	return __asyncLoaderInstance;
+}
+
+unsigned int C3DAsyncLoader::load(const std::string& name, int priority, const Callback& callback)
+{
+	std::string fullPath = cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(name.c_str());
+	if (fullPath.empty())
+	{
+		WARN_VARG("Failed to find file: '%s'.", name.c_str());
+		return 0;
+	}
+
+	Request* request = new Request();
+	request->id = _nextId++;
+	request->name = name;
+	request->fullPath = fullPath;
+	request->priority = priority;
+	request->callback = callback;
+
+	if (hasExtension(name, ".ckb"))
+		request->type = Request::Type_RenderNode;
+	else if (hasExtension(name, ".material"))
+	{
+		request->type = Request::Type_Material;
+		request->binaryPath = C3DElementNode::getBinaryFullPath(name);
+	}
+	else
+		request->type = Request::Type_Texture;
+
+	_requests.push_back(request);
+	queueRequest(request);
+
+	return request->id;
+}
+
+bool C3DAsyncLoader::cancel(unsigned int requestId)
+{
+	Request* request = findRequest(requestId);
+	if (request == NULL || request->parent != NULL)
+		return false;
+
+	// the textures of a material first, they point to it
+	std::vector<Request*> textures;
+	for (size_t i = 0; i < _requests.size(); ++i)
+	{
+		if (_requests[i]->parent == request)
+			textures.push_back(_requests[i]);
+	}
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		cancelRequest(textures[i]);
+	}
+
+	cancelRequest(request);
+	return true;
+}
+
+void C3DAsyncLoader::cancelAll()
+{
+	std::vector<unsigned int> ids;
+	for (size_t i = 0; i < _requests.size(); ++i)
+	{
+		if (_requests[i]->parent == NULL && !_requests[i]->cancelled)
+			ids.push_back(_requests[i]->id);
+	}
+
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		cancel(ids[i]);
+	}
+}
+
+bool C3DAsyncLoader::setPriority(unsigned int requestId, int priority)
+{
+	Request* request = findRequest(requestId);
+	if (request == NULL || request->parent != NULL)
+		return false;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (size_t i = 0; i < _requests.size(); ++i)
+	{
+		if (_requests[i] == request || _requests[i]->parent == request)
+			_requests[i]->priority = priority;
+	}
+	return true;
+}
+
+bool C3DAsyncLoader::isPending(unsigned int requestId) const
+{
+	Request* request = findRequest(requestId);
+	return request != NULL && request->parent == NULL;
+}
+
+unsigned int C3DAsyncLoader::getPendingCount() const
+{
+	unsigned int count = 0;
+	for (size_t i = 0; i < _requests.size(); ++i)
+	{
+		if (_requests[i]->parent == NULL && !_requests[i]->cancelled)
+			++count;
+	}
+	return count;
+}
+
+void C3DAsyncLoader::setUploadBudget(unsigned int bytes, float milliseconds)
+{
+	_budgetBytes = bytes;
+	_budgetTime = milliseconds;
+}
+
+void C3DAsyncLoader::setThreadCount(unsigned int count)
+{
+	if (count == 0)
+		count = 1;
+
+	if (count == _threadCount)
+		return;
+
+	bool running = !_threads.empty();
+	stopThreads();
+
+	_threadCount = count;
+	if (running)
+		startThreads();
+}
+
+void C3DAsyncLoader::update()
+{
+	if (_requests.empty())
+		return;
+
+	PROFILE_SCOPE("async load");
+
+	std::vector<Request*> loaded;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		loaded.swap(_loaded);
+	}
+
+	for (size_t i = 0; i < loaded.size(); ++i)
+	{
+		onLoaded(loaded[i]);
+	}
+
+	unsigned long long start = C3DProfile::getTime();
+	unsigned int bytes = 0;
+
+	while (!_ready.empty())
+	{
+		Request* request = popNext(_ready);
+		bytes += request->size;
+
+		// out of the list before the callback, which may queue or cancel requests
+		_requests.erase(std::find(_requests.begin(), _requests.end(), request));
+		complete(request);
+		delete request;
+
+		if (_budgetBytes > 0 && bytes >= _budgetBytes)
+			break;
+
+		if (_budgetTime > 0.0f && (C3DProfile::getTime() - start) >= (unsigned long long)(_budgetTime * 1000000.0f))
+			break;
+	}
+}
+
+void C3DAsyncLoader::startThreads()
+{
+	_quit = false;
+	for (unsigned int i = 0; i < _threadCount; ++i)
+	{
+		_threads.push_back(std::thread(&C3DAsyncLoader::workerLoop, this));
+	}
+}
+
+void C3DAsyncLoader::stopThreads()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+	}
+	_condition.notify_all();
+
+	for (size_t i = 0; i < _threads.size(); ++i)
+	{
+		_threads[i].join();
+	}
+	_threads.clear();
+}
+
+void C3DAsyncLoader::workerLoop()
+{
+	while (true)
+	{
+		Request* request = NULL;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this] { return _quit || !_queue.empty(); });
+			if (_quit)
+				return;
+
+			request = popNext(_queue);
+			request->state = Request::State_Loading;
+		}
+
+		// name and paths never change once queued, the results are only read by the main thread.
+		// the paths are resolved at queue time, CCFileUtils caches are not touched from here
+		switch (request->type)
+		{
+		case Request::Type_Texture:
+			request->image = new cocos2d::CCImage();
+			if (request->image->initWithImageFileThreadSafe(request->fullPath))
+			{
+				request->size = (unsigned int)request->image->getDataLen();
+			}
+			else
+			{
+				SAFE_RELEASE(request->image);
+			}
+			break;
+
+		case Request::Type_Material:
+			request->nodes = C3DElementNode::createFromFullPath(request->fullPath, request->binaryPath);
+			break;
+
+		case Request::Type_RenderNode:
+			request->loader = C3DResourceLoader::createFromFullPath(request->fullPath, false);
+			if (request->loader)
+				request->size = request->loader->getDataSize();
+			break;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_loaded.push_back(request);
+	}
+}
+
+C3DAsyncLoader::Request* C3DAsyncLoader::popNext(std::vector<Request*>& requests)
+{
+	// highest priority, the oldest request first among equals
+	size_t best = 0;
+	for (size_t i = 1; i < requests.size(); ++i)
+	{
+		if (requests[i]->priority > requests[best]->priority ||
+			(requests[i]->priority == requests[best]->priority && requests[i]->id < requests[best]->id))
+		{
+			best = i;
+		}
+	}
+
+	Request* request = requests[best];
+	requests.erase(requests.begin() + best);
+	return request;
+}
+
+C3DAsyncLoader::Request* C3DAsyncLoader::findRequest(unsigned int requestId) const
+{
+	for (size_t i = 0; i < _requests.size(); ++i)
+	{
+		if (_requests[i]->id == requestId && !_requests[i]->cancelled)
+			return _requests[i];
+	}
+	return NULL;
+}
+
+bool C3DAsyncLoader::isLoaded(Request* request) const
+{
+	switch (request->type)
+	{
+	case Request::Type_Texture:
+		return cocos2d::CCTextureCache::sharedTextureCache()->getTextureForKey(request->fullPath) != NULL;
+	case Request::Type_Material:
+		return C3DMaterialManager::getInstance()->hasResource(request->name);
+	case Request::Type_RenderNode:
+		return C3DRenderNodeManager::getInstance()->hasResource(request->name);
+	}
+	return false;
+}
+
+void C3DAsyncLoader::queueRequest(Request* request)
+{
+	// already in memory, only the main thread part is left
+	if (isLoaded(request))
+	{
+		request->state = Request::State_Ready;
+		_ready.push_back(request);
+		return;
+	}
+
+	if (_threads.empty())
+		startThreads();
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		request->state = Request::State_Queued;
+		_queue.push_back(request);
+	}
+	_condition.notify_one();
+}
+
+void C3DAsyncLoader::queueTextures(Request* material, C3DElementNode* node)
+{
+	for (int i = 0; i < node->getChildCount(); ++i)
+	{
+		C3DElementNode* child = node->getChild(i);
+		if (child->getNodeType() != "sampler")
+		{
+			queueTextures(material, child);
+			continue;
+		}
+
+		const std::string path = child->getElement("path");
+		if (path.empty())
+			continue;
+
+		Request* texture = new Request();
+		texture->id = _nextId++;
+		texture->name = path;
+		texture->fullPath = cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(path.c_str());
+		texture->type = Request::Type_Texture;
+		texture->priority = material->priority;
+		texture->parent = material;
+
+		if (texture->fullPath.empty() || isLoaded(texture))
+		{
+			// left to the material, which reports the missing files
+			delete texture;
+			continue;
+		}
+
+		material->pendingTextures++;
+		_requests.push_back(texture);
+		queueRequest(texture);
+	}
+}
+
+void C3DAsyncLoader::onLoaded(Request* request)
+{
+	if (request->cancelled)
+	{
+		destroyRequest(request);
+		return;
+	}
+
+	if (request->nodes != NULL)
+		queueTextures(request, request->nodes);
+
+	if (request->pendingTextures > 0)
+	{
+		request->state = Request::State_Waiting;
+	}
+	else
+	{
+		request->state = Request::State_Ready;
+		_ready.push_back(request);
+	}
+}
+
+void C3DAsyncLoader::complete(Request* request)
+{
+	cocos2d::CCObject* resource = NULL;
+
+	switch (request->type)
+	{
+	case Request::Type_Texture:
+		{
+			cocos2d::CCTextureCache* cache = cocos2d::CCTextureCache::sharedTextureCache();
+			if (request->image != NULL)
+				cache->addImage(request->image, request->fullPath);
+
+			// the textures of a material are only put in the cache
+			if (request->parent == NULL && cache->getTextureForKey(request->fullPath) != NULL)
+				resource = C3DTexture::create(request->name);
+		}
+		break;
+
+	case Request::Type_Material:
+		{
+			C3DMaterialManager* manager = C3DMaterialManager::getInstance();
+			if (manager->hasResource(request->name))
+				resource = manager->getResource(request->name);
+			else if (request->nodes != NULL)
+				resource = manager->createResource(request->name, request->nodes);
+		}
+		break;
+
+	case Request::Type_RenderNode:
+		{
+			C3DRenderNodeManager* manager = C3DRenderNodeManager::getInstance();
+			if (manager->hasResource(request->name))
+			{
+				resource = manager->getResource(request->name);
+			}
+			else if (request->loader != NULL)
+			{
+				resource = manager->createResource(request->name, request->loader);
+			}
+		}
+		break;
+	}
+
+	if (request->parent != NULL)
+	{
+		Request* material = request->parent;
+		if (--material->pendingTextures == 0 && material->state == Request::State_Waiting)
+		{
+			material->state = Request::State_Ready;
+			_ready.push_back(material);
+		}
+	}
+
+	if (request->callback)
+		request->callback(request->name, resource);
+}
+
+void C3DAsyncLoader::cancelRequest(Request* request)
+{
+	request->cancelled = true;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		// dropped by update() once the worker is done with it
+		if (request->state == Request::State_Loading)
+			return;
+
+		if (request->state == Request::State_Queued)
+			_queue.erase(std::find(_queue.begin(), _queue.end(), request));
+	}
+
+	if (request->state == Request::State_Ready)
+	{
+		std::vector<Request*>::iterator it = std::find(_ready.begin(), _ready.end(), request);
+		if (it != _ready.end())
+			_ready.erase(it);
+	}
+
+	destroyRequest(request);
+}
+
+void C3DAsyncLoader::destroyRequest(Request* request)
+{
+	std::vector<Request*>::iterator it = std::find(_requests.begin(), _requests.end(), request);
+	if (it != _requests.end())
+		_requests.erase(it);
+
+	delete request;
+}
+
+}
@@ -0,0 +1,147 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef C3DASYNCLOADER_H_
+#define C3DASYNCLOADER_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "cocos2d.h"
+
+namespace cocos3d
+{
+class C3DElementNode;
+
+/**
+ * Loads textures, materials and render nodes (.ckb) in the background.
+ *
+ * Worker threads read and parse the files. The GL objects are created on the main
+ * thread by update(), which stops once the upload budget of the frame is spent, so a
+ * new character streams in over a few frames instead of stalling one. Requests with a
+ * higher priority are served first at both stages. The textures of a material are
+ * decoded by the workers as well before the material itself is created.
+ */
+class C3DAsyncLoader : public cocos2d::CCObject
+{
+public:
+
+	/**
+	 * Called on the main thread when a request completes, resource is NULL if the load failed.
+	 * The resource is autoreleased, as the ones returned by the resource managers: a
+	 * C3DTexture, a C3DMaterial or a C3DRenderNode.
+	 */
+	typedef std::function<void(const std::string& name, cocos2d::CCObject* resource)> Callback;
+
+	static C3DAsyncLoader* getInstance();
+
+	/**
+	 * Queues the load of name, the type comes from the extension: .ckb files are
+	 * render nodes, .material files materials and anything else an image.
+	 *
+	 * @return The request id, 0 if the file does not exist.
+	 */
+	unsigned int load(const std::string& name, int priority = 0, const Callback& callback = Callback());
+
+	/**
+	 * Drops a request, its callback is never called.
+	 *
+	 * @return false if the request already completed.
+	 */
+	bool cancel(unsigned int requestId);
+	void cancelAll();
+
+	/**
+	 * Changes the priority of a request which is not completed yet.
+	 */
+	bool setPriority(unsigned int requestId, int priority);
+
+	bool isPending(unsigned int requestId) const;
+	unsigned int getPendingCount() const;
+
+	/**
+	 * Sets the main thread work of a frame, update() stops once the uploaded bytes or the
+	 * elapsed milliseconds reach the budget. 0 disables the limit. At least one request
+	 * completes each frame whatever the budget.
+	 */
+	void setUploadBudget(unsigned int bytes, float milliseconds);
+	unsigned int getUploadBudgetBytes() const { return _budgetBytes; }
+	float getUploadBudgetTime() const { return _budgetTime; }
+
+	/**
+	 * Sets the number of worker threads, they are started by the first request.
+	 */
+	void setThreadCount(unsigned int count);
+	unsigned int getThreadCount() const { return _threadCount; }
+
+	/**
+	 * Completes the loaded requests, called once a frame by C3DRenderSystem.
+	 */
+	void update();
+
+private:
+
+	struct Request;
+
+	C3DAsyncLoader();
+	virtual ~C3DAsyncLoader();
+
+	void startThreads();
+	void stopThreads();
+	void workerLoop();
+
+	static Request* popNext(std::vector<Request*>& requests);
+
+	Request* findRequest(unsigned int requestId) const;
+	bool isLoaded(Request* request) const;
+	void queueRequest(Request* request);
+	void queueTextures(Request* material, C3DElementNode* node);
+	void onLoaded(Request* request);
+	void complete(Request* request);
+	void cancelRequest(Request* request);
+	void destroyRequest(Request* request);
+
+	// main thread only
+	std::vector<Request*> _requests;
+	std::vector<Request*> _ready;
+	unsigned int _nextId;
+
+	// shared with the workers
+	std::vector<Request*> _queue;
+	std::vector<Request*> _loaded;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::vector<std::thread> _threads;
+	bool _quit;
+
+	unsigned int _threadCount;
+	unsigned int _budgetBytes;
+	float _budgetTime;
+};
+
+}
+
+#endif
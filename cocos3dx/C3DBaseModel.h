@@ -42,6 +42,17 @@ public:
 
 	virtual void draw() = 0;
 
+	/**
+	 * whether the model can be drawn together with another model in one instanced draw,
+	 * see C3DRenderChannel::draw
+	 */
+	virtual bool canInstanceWith(C3DBaseModel* other) { return false; }
+
+	/**
+	 * draw a group of models accepted by canInstanceWith, models[0] is this model
+	 */
+	virtual void drawInstances(C3DBaseModel** models, unsigned int count) {}
+
 	//virtual void setNode(C3DNode* node) = 0;
 
 	//virtual void setMesh(C3DBatchMesh* mesh) = 0;
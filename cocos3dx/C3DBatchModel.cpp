@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include "C3DRenderSystem.h"
 #include "C3DRenderChannel.h"
 #include "C3DMaterialManager.h"
+#include "C3DStateCache.h"
 
 namespace cocos3d
 {
@@ -269,7 +270,7 @@ void C3DBatchModel::draw(void)
 		C3DPass* pass = technique->getPass(i);
 		pass->bind();
 
-		GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+		C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 		if (_mesh->_bUseIndex)
 		{
 			GL_ASSERT( glDrawElements(_mesh->_primitiveType, _mesh->_indexCount, GL_UNSIGNED_SHORT, _mesh->_indices));
@@ -42,9 +42,12 @@ THE SOFTWARE.
 
 namespace cocos3d
 {
+static unsigned int __nextCameraId = 1;
+
 C3DCamera::C3DCamera(const std::string& id)
     :C3DNode(id),  _type(PERSPECTIVE), _fieldOfView(45.0f), _aspectRatio(0.75), _nearPlane(10.0f), _farPlane(1000.0f),
-      _dirtyBits(CAMERA_DIRTY_ALL), _bEnableFrustum(true), _target(C3DVector3(0, 0, 0)), _bDrawCamera(false)
+      _dirtyBits(CAMERA_DIRTY_ALL), _bEnableFrustum(true), _target(C3DVector3(0, 0, 0)), _bDrawCamera(false),
+      _cameraId(__nextCameraId++)
 {
     this->addListener(this);
 
@@ -53,7 +56,8 @@ C3DCamera::C3DCamera(const std::string& id)
 }
 C3DCamera::C3DCamera(float fieldOfView, float aspectRatio, float nearPlane, float farPlane, const std::string& strId)
     :C3DNode(strId),  _type(PERSPECTIVE), _fieldOfView(fieldOfView), _aspectRatio(aspectRatio), _nearPlane(nearPlane), _farPlane(farPlane),
-      _dirtyBits(CAMERA_DIRTY_ALL), _bEnableFrustum(true), _target(C3DVector3(0, 0, 0)), _bDrawCamera(false)
+      _dirtyBits(CAMERA_DIRTY_ALL), _bEnableFrustum(true), _target(C3DVector3(0, 0, 0)), _bDrawCamera(false),
+      _cameraId(__nextCameraId++)
 {
     this->addListener(this);
 
@@ -63,7 +67,8 @@ C3DCamera::C3DCamera(float fieldOfView, float aspectRatio, float nearPlane, floa
 
 C3DCamera::C3DCamera(float zoomX, float zoomY, float aspectRatio, float nearPlane, float farPlane, const std::string& strId)
     :C3DNode(strId),  _type(ORTHOGRAPHIC), _aspectRatio(aspectRatio), _nearPlane(nearPlane), _farPlane(farPlane),
-      _dirtyBits(CAMERA_DIRTY_ALL), _bEnableFrustum(true), _target(C3DVector3(0, 0, 0)), _bDrawCamera(false)
+      _dirtyBits(CAMERA_DIRTY_ALL), _bEnableFrustum(true), _target(C3DVector3(0, 0, 0)), _bDrawCamera(false),
+      _cameraId(__nextCameraId++)
 {
     // Orthographic camera.
     _zoom[0] = zoomX;
@@ -430,23 +435,23 @@ void C3DCamera::drawDebug()
 
 		// top-left
 		getAxes(viewport, 0, 0, &ray);
-		C3DVector3 point_tl_0 = ray.intersects(&_frustum._plane[4]);
-		C3DVector3 point_tl_1 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_tl_0 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_tl_1 = ray.intersects(&_frustum._plane[4]);
 
 		// top-right
 		getAxes(viewport, viewport->width, 0, &ray);
-		C3DVector3 point_tr_0 = ray.intersects(&_frustum._plane[4]);
-		C3DVector3 point_tr_1 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_tr_0 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_tr_1 = ray.intersects(&_frustum._plane[4]);
 
 		// bottom-left
 		getAxes(viewport, 0, viewport->height, &ray);
-		C3DVector3 point_bl_0 = ray.intersects(&_frustum._plane[4]);
-		C3DVector3 point_bl_1 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_bl_0 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_bl_1 = ray.intersects(&_frustum._plane[4]);
 
 		// bottom-right
 		getAxes(viewport, viewport->width, viewport->height, &ray);
-		C3DVector3 point_br_0 = ray.intersects(&_frustum._plane[4]);
-		C3DVector3 point_br_1 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_br_0 = ray.intersects(&_frustum._plane[5]);
+		C3DVector3 point_br_1 = ray.intersects(&_frustum._plane[4]);
 
 		// draw line
 		C3DVector4 color(0.7f, 0.7f, 0.7f, 1);
@@ -283,6 +283,11 @@ public:
      */
     bool isFrustumCullEnalbed() const { return _bEnableFrustum; }
 
+	/**
+     * get camera frustum
+     */
+    const C3DFrustum& getFrustum() const { return _frustum; }
+
 	/**
      * draw camera debug info
      */
@@ -290,6 +295,11 @@ public:
 
 	void drawCamera(bool show){_bDrawCamera = show;}
 	bool drawCamera(){return _bDrawCamera;}
+
+	/**
+     * Gets the id given to the camera at its creation, never given to another camera.
+     */
+	unsigned int getCameraId() const { return _cameraId; }
 private:
 	/**
      * Constructor & Destructor
@@ -325,6 +335,8 @@ private:
 	C3DVector3 _target;	// camera look focus
 
 	bool _bDrawCamera;
+
+	unsigned int _cameraId;
 };
 }
 
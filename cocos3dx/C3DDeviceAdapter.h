@@ -52,11 +52,17 @@ public:
          _platformName = "unknown";
 		 _deviceLevel = DeviceLevel::Low;
 		 _supportVAO = false;
+		 _supportInstancing = false;
+		 _supportParallelShaderCompile = false;
+		 _supportProgramBinary = false;
 
 		 checkCpuInfo();
 		 checkNeon();
 		 checkDevice();
 		 checkVAO();
+		 checkInstancing();
+		 checkParallelShaderCompile();
+		 checkProgramBinary();
 		 checkPostProcess();
 		 checkShadow();
 	 }
@@ -73,6 +79,12 @@ public:
     void checkCpuInfo();
 
 	void checkVAO();
+
+	void checkInstancing();
+
+	void checkParallelShaderCompile();
+
+	void checkProgramBinary();
 	
 	void checkNeon();
 
@@ -112,6 +124,21 @@ public:
 		return _supportVAO;
 	}
 
+	bool isSupportInstancing()
+	{
+		return _supportInstancing;
+	}
+
+	bool isSupportParallelShaderCompile()
+	{
+		return _supportParallelShaderCompile;
+	}
+
+	bool isSupportProgramBinary()
+	{
+		return _supportProgramBinary;
+	}
+
 	void setSupportShadow(bool support)
 	{
 		_supportShadow = support;
@@ -140,6 +167,9 @@ private:
     std::string _platformName;
 	DeviceLevel _deviceLevel;
 	bool _supportVAO;
+	bool _supportInstancing;
+	bool _supportParallelShaderCompile;
+	bool _supportProgramBinary;
 	bool _supportPostProcess;
 	bool _supportShadow;
 	bool _supportNeon;
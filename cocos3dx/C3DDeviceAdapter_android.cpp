@@ -82,6 +82,46 @@ void C3DDeviceAdapter::checkVAO()
 	WARN_VARG("the gpu support VAO : %d",_supportVAO);
 }
 
+void C3DDeviceAdapter::checkInstancing()
+{
+	if(cocos2d::Configuration::getInstance()->checkForGLExtension("instanced_arrays"))
+	{
+		glDrawElementsInstanced = (PFNC3DDRAWELEMENTSINSTANCEDPROC)eglGetProcAddress("glDrawElementsInstancedEXT");
+		glVertexAttribDivisor = (PFNC3DVERTEXATTRIBDIVISORPROC)eglGetProcAddress("glVertexAttribDivisorEXT");
+	}
+
+	_supportInstancing = glDrawElementsInstanced != NULL && glVertexAttribDivisor != NULL;
+
+	WARN_VARG("the gpu support instancing : %d",_supportInstancing);
+}
+
+void C3DDeviceAdapter::checkParallelShaderCompile()
+{
+	// KHR_parallel_shader_compile or ARB_parallel_shader_compile, glCompileShader & glLinkProgram
+	// return at once and the driver compiles on its own threads
+	_supportParallelShaderCompile = cocos2d::Configuration::getInstance()->checkForGLExtension("parallel_shader_compile");
+
+	WARN_VARG("the gpu support parallel shader compile : %d",_supportParallelShaderCompile);
+}
+
+void C3DDeviceAdapter::checkProgramBinary()
+{
+	// GL_OES_get_program_binary, some drivers expose it without any binary format
+	GLint formats = 0;
+	if(cocos2d::Configuration::getInstance()->checkForGLExtension("GL_OES_get_program_binary"))
+	{
+		glGetProgramBinary = (PFNGLGETPROGRAMBINARYOESPROC)eglGetProcAddress("glGetProgramBinaryOES");
+		glProgramBinary = (PFNGLPROGRAMBINARYOESPROC)eglGetProcAddress("glProgramBinaryOES");
+
+		if (glGetProgramBinary != NULL && glProgramBinary != NULL)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	}
+
+	_supportProgramBinary = formats > 0;
+
+	WARN_VARG("the gpu support program binary : %d",_supportProgramBinary);
+}
+
 void C3DDeviceAdapter::checkDevice()
 {
 	if(_cpuCount == 1)
@@ -47,6 +47,24 @@ namespace cocos3d
     {
         _supportVAO = true;
     }
+
+    void C3DDeviceAdapter::checkInstancing()
+    {
+        // GL_EXT_instanced_arrays, A7 and later
+        _supportInstancing = cocos2d::Configuration::getInstance()->checkForGLExtension("GL_EXT_instanced_arrays");
+    }
+
+    void C3DDeviceAdapter::checkParallelShaderCompile()
+    {
+        // not exposed by the iOS drivers
+        _supportParallelShaderCompile = false;
+    }
+
+    void C3DDeviceAdapter::checkProgramBinary()
+    {
+        // GL_OES_get_program_binary is not available on iOS
+        _supportProgramBinary = false;
+    }
 	
     void C3DDeviceAdapter::checkNeon()
     {
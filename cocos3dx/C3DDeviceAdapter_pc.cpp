@@ -22,7 +22,7 @@ THE SOFTWARE.
 
 #include "CCPlatformConfig.h"
 
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
 #include "Base.h"
 #include "C3DDeviceAdapter.h"
 
@@ -69,6 +69,42 @@ void C3DDeviceAdapter::checkVAO()
 	WARN_VARG("the gpu support VAO : %d",_supportVAO);
 }
 
+void C3DDeviceAdapter::checkInstancing()
+{
+	// glew resolves the entry points, NULL when the driver has neither GL 3.3 nor ARB_instanced_arrays
+	_supportInstancing = cocos2d::Configuration::getInstance()->checkForGLExtension("instanced_arrays")
+		&& glDrawElementsInstanced != NULL && glVertexAttribDivisor != NULL;
+
+	WARN_VARG("the gpu support instancing : %d",_supportInstancing);
+}
+
+void C3DDeviceAdapter::checkParallelShaderCompile()
+{
+	// KHR_parallel_shader_compile or ARB_parallel_shader_compile, glCompileShader & glLinkProgram
+	// return at once and the driver compiles on its own threads
+	_supportParallelShaderCompile = cocos2d::Configuration::getInstance()->checkForGLExtension("parallel_shader_compile");
+
+	WARN_VARG("the gpu support parallel shader compile : %d",_supportParallelShaderCompile);
+}
+
+void C3DDeviceAdapter::checkProgramBinary()
+{
+#ifdef USE_PROGRAM_BINARY
+	// GL 4.1 or ARB_get_program_binary, and at least one binary format the driver can save
+	GLint formats = 0;
+	if (cocos2d::Configuration::getInstance()->checkForGLExtension("get_program_binary")
+		&& glGetProgramBinary != NULL && glProgramBinary != NULL)
+	{
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	}
+	_supportProgramBinary = formats > 0;
+#else
+	_supportProgramBinary = false;
+#endif
+
+	WARN_VARG("the gpu support program binary : %d",_supportProgramBinary);
+}
+
 void C3DDeviceAdapter::checkDevice()
 {
 	if(_cpuCount == 1)
@@ -28,15 +28,57 @@ THE SOFTWARE.
 #include "C3DRenderState.h"
 #include "C3DElementNode.h"
 #include "C3DSamplerCube.h"
+#include "C3DStat.h"
+#include "C3DStateCache.h"
+#include "C3DDeviceAdapter.h"
+#include "C3DEffectManager.h"
 #include "Base.h"
 
 #define OPENGL_ES_DEFINE  "#define OPENGL_ES"
 
+// KHR_parallel_shader_compile & ARB_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 namespace cocos3d
 {
 static C3DEffect* __currentEffect = NULL;
 
-C3DEffect::C3DEffect(const std::string& name) : C3DResource(name),_program(0)
+// size in bytes of one element of an uniform of the given type
+static unsigned int getUniformTypeSize(GLenum type)
+{
+    switch (type)
+    {
+    case GL_FLOAT:
+        return sizeof(GLfloat);
+    case GL_FLOAT_VEC2:
+        return sizeof(GLfloat) * 2;
+    case GL_FLOAT_VEC3:
+        return sizeof(GLfloat) * 3;
+    case GL_FLOAT_VEC4:
+    case GL_FLOAT_MAT2:
+        return sizeof(GLfloat) * 4;
+    case GL_FLOAT_MAT3:
+        return sizeof(GLfloat) * 9;
+    case GL_FLOAT_MAT4:
+        return sizeof(GLfloat) * 16;
+    case GL_INT_VEC2:
+    case GL_BOOL_VEC2:
+        return sizeof(GLint) * 2;
+    case GL_INT_VEC3:
+    case GL_BOOL_VEC3:
+        return sizeof(GLint) * 3;
+    case GL_INT_VEC4:
+    case GL_BOOL_VEC4:
+        return sizeof(GLint) * 4;
+    default:
+        // int, bool and samplers
+        return sizeof(GLint);
+    }
+}
+
+C3DEffect::C3DEffect(const std::string& name) : C3DResource(name),_program(0),_pendingProgram(0),_vertexShader(0),_fragmentShader(0),_sourceHash(0)
 {
 	//LOG_TRACE_VARG("+Effect: %s", name.c_str());
 }
@@ -51,16 +93,18 @@ C3DEffect::~C3DEffect()
         SAFE_DELETE(itr->second);
     }
 
+    deletePending();
+
     if (_program)
     {
         // If our program object is currently bound, unbind it before we're destroyed.
         if (__currentEffect == this)
         {
-            GL_ASSERT( glUseProgram(0) );
+            C3DStateCache::useProgram(0);
             __currentEffect = NULL;
         }
 
-        GL_ASSERT( glDeleteProgram(_program) );
+        C3DStateCache::deleteProgram(_program);
         _program = 0;
     }
 }
@@ -155,6 +199,9 @@ void C3DEffect::reload()
 	_vertexAttributes.clear();
 
 	_program = 0;
+	_pendingProgram = 0;
+	_vertexShader = 0;
+	_fragmentShader = 0;
 
 	C3DElementNode* elementNode = C3DElementNode::createEmptyNode("test", "effect");
 	if(elementNode != NULL)
@@ -171,6 +218,18 @@ void C3DEffect::reload()
 }
 
 bool C3DEffect::load(C3DElementNode* node)
+{
+	if (!compile(node))
+		return false;
+
+	if (!link())
+	{
+		LOG_ERROR_VARG("Failed to create effect from shaders: %s, %s", _vshPath.c_str(), _fshPath.c_str());
+	}
+    return true;
+}
+
+bool C3DEffect::compile(C3DElementNode* node)
 {
 	C3DResource::load(node);
 
@@ -195,27 +254,27 @@ bool C3DEffect::load(C3DElementNode* node)
 		return false;
     }
 
-    if(this->load(vshSource, fshSource, defines) == false)
-	{
-		LOG_ERROR_VARG("Failed to create effect from shaders: %s, %s", _vshPath.c_str(), _fshPath.c_str());
-	}
+    bool result = this->compile(vshSource, fshSource, defines);
     SAFE_DELETE_ARRAY(vshSource);
     SAFE_DELETE_ARRAY(fshSource);
-    return true;
+    return result;
 }
 
 bool C3DEffect::load(const std::string& vshSource, const std::string& fshSource, const std::string& defines)
+{
+    return compile(vshSource, fshSource, defines) && link();
+}
+
+bool C3DEffect::compile(const std::string& vshSource, const std::string& fshSource, const std::string& defines)
 {
     const unsigned int SHADER_SOURCE_LENGTH = 3;
     const GLchar* shaderSource[SHADER_SOURCE_LENGTH];
-    char* infoLog = NULL;
     GLuint vertexShader;
     GLuint fragmentShader;
     GLuint program;
-    GLint length;
-    GLint success;
 
-    // Compile vertex shader.
+    deletePending();
+
     std::string definesStr = defines.empty()? "" : defines;
 #ifdef OPENGL_ES
     if (defines.length() != 0)
@@ -233,11 +292,111 @@ bool C3DEffect::load(const std::string& vshSource, const std::string& fshSource,
             vshSourceStr += "\n";
     }
 
+	std::string fshSourceStr = "";
+    {
+        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
+        replaceIncludes(fshSource, fshSourceStr);
+        if (!fshSource.empty())
+            fshSourceStr += "\n";
+    }
+
+    // Use the binary linked by a previous run from the same sources when there is one.
+    _sourceHash = 0;
+    C3DEffectManager* manager = C3DEffectManager::getInstance();
+    if (manager->isProgramBinaryEnabled())
+    {
+        _sourceHash = C3DEffectManager::hashString(definesStr);
+        _sourceHash = C3DEffectManager::hashString(vshSourceStr, _sourceHash);
+        _sourceHash = C3DEffectManager::hashString(fshSourceStr, _sourceHash);
+
+        GL_ASSERT( program = glCreateProgram() );
+        if (manager->loadProgramBinary(getID(), _sourceHash, program))
+        {
+            _pendingProgram = program;
+            return true;
+        }
+        GL_ASSERT( glDeleteProgram(program) );
+    }
+
+    // Compile vertex shader.
 	shaderSource[2] = vshSourceStr.c_str();
     GL_ASSERT( vertexShader = glCreateShader(GL_VERTEX_SHADER) );
     GL_ASSERT( glShaderSource(vertexShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
     GL_ASSERT( glCompileShader(vertexShader) );
-    GL_ASSERT( glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success) );
+
+    // Compile the fragment shader.
+	shaderSource[2] = fshSourceStr.c_str();
+    GL_ASSERT( fragmentShader = glCreateShader(GL_FRAGMENT_SHADER) );
+    GL_ASSERT( glShaderSource(fragmentShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
+    GL_ASSERT( glCompileShader(fragmentShader) );
+
+    // Link program, the statuses are checked by link() so that drivers compiling
+    // in the background are not waited for here.
+    GL_ASSERT( program = glCreateProgram() );
+    GL_ASSERT( glAttachShader(program, vertexShader) );
+    GL_ASSERT( glAttachShader(program, fragmentShader) );
+#if defined(USE_PROGRAM_BINARY) && defined(GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+    if (_sourceHash != 0)
+        GL_ASSERT( glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE) );
+#endif
+    GL_ASSERT( glLinkProgram(program) );
+
+    _vertexShader = vertexShader;
+    _fragmentShader = fragmentShader;
+    _pendingProgram = program;
+    return true;
+}
+
+bool C3DEffect::isCompiling() const
+{
+    if (_pendingProgram == 0 || !C3DDeviceAdapter::getInstance()->isSupportParallelShaderCompile())
+        return false;
+
+    GLint completed = GL_TRUE;
+    GL_ASSERT( glGetProgramiv(_pendingProgram, GL_COMPLETION_STATUS_KHR, &completed) );
+    return completed != GL_TRUE;
+}
+
+void C3DEffect::deletePending()
+{
+    if (_pendingProgram == 0)
+        return;
+
+    // no shaders when the program was loaded from a binary
+    if (_vertexShader != 0)
+    {
+        GL_ASSERT( glDeleteShader(_vertexShader) );
+        GL_ASSERT( glDeleteShader(_fragmentShader) );
+    }
+    GL_ASSERT( glDeleteProgram(_pendingProgram) );
+
+    _vertexShader = 0;
+    _fragmentShader = 0;
+    _pendingProgram = 0;
+}
+
+bool C3DEffect::link()
+{
+    if (_pendingProgram == 0)
+        return _program != 0;
+
+    char* infoLog = NULL;
+    GLuint vertexShader = _vertexShader;
+    GLuint fragmentShader = _fragmentShader;
+    GLuint program = _pendingProgram;
+    GLint length;
+    GLint success;
+
+    _vertexShader = 0;
+    _fragmentShader = 0;
+    _pendingProgram = 0;
+
+    // a program loaded from a binary has no shaders and is already linked
+    bool fromBinary = vertexShader == 0;
+
+    success = GL_TRUE;
+    if (!fromBinary)
+        GL_ASSERT( glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success) );
     if (success != GL_TRUE)
     {
         GL_ASSERT( glGetShaderiv(vertexShader, GL_INFO_LOG_LENGTH, &length) );
@@ -252,24 +411,14 @@ bool C3DEffect::load(const std::string& vshSource, const std::string& fshSource,
 
         // Clean up.
         GL_ASSERT( glDeleteShader(vertexShader) );
+        GL_ASSERT( glDeleteShader(fragmentShader) );
+        GL_ASSERT( glDeleteProgram(program) );
 
         return false;
     }
 
-    // Compile the fragment shader.
-	std::string fshSourceStr = "";
-    {
-        // Replace the #include "xxxxx.xxx" with the sources that come from file paths
-        replaceIncludes(fshSource, fshSourceStr);
-        if (!fshSource.empty())
-            fshSourceStr += "\n";
-    }
-	shaderSource[2] = fshSourceStr.c_str();
-
-    GL_ASSERT( fragmentShader = glCreateShader(GL_FRAGMENT_SHADER) );
-    GL_ASSERT( glShaderSource(fragmentShader, SHADER_SOURCE_LENGTH, shaderSource, NULL) );
-    GL_ASSERT( glCompileShader(fragmentShader) );
-    GL_ASSERT( glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success) );
+    if (!fromBinary)
+        GL_ASSERT( glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success) );
     if (success != GL_TRUE)
     {
         GL_ASSERT( glGetShaderiv(fragmentShader, GL_INFO_LOG_LENGTH, &length) );
@@ -285,20 +434,19 @@ bool C3DEffect::load(const std::string& vshSource, const std::string& fshSource,
         // Clean up.
         GL_ASSERT( glDeleteShader(vertexShader) );
         GL_ASSERT( glDeleteShader(fragmentShader) );
+        GL_ASSERT( glDeleteProgram(program) );
 
         return false;
     }
 
-    // Link program.
-    GL_ASSERT( program = glCreateProgram() );
-    GL_ASSERT( glAttachShader(program, vertexShader) );
-    GL_ASSERT( glAttachShader(program, fragmentShader) );
-    GL_ASSERT( glLinkProgram(program) );
     GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
 
     // Delete shaders after linking.
-    GL_ASSERT( glDeleteShader(vertexShader) );
-    GL_ASSERT( glDeleteShader(fragmentShader) );
+    if (!fromBinary)
+    {
+        GL_ASSERT( glDeleteShader(vertexShader) );
+        GL_ASSERT( glDeleteShader(fragmentShader) );
+    }
 
     // Check link status.
     if (success != GL_TRUE)
@@ -319,6 +467,10 @@ bool C3DEffect::load(const std::string& vshSource, const std::string& fshSource,
         return false;
     }
 
+    // keep the binary for the next runs
+    if (!fromBinary && _sourceHash != 0)
+        C3DEffectManager::getInstance()->saveProgramBinary(getID(), _sourceHash, program);
+
     this->_program = program;
 
     // Query and store vertex attribute meta-data from the program.
@@ -399,6 +551,10 @@ bool C3DEffect::load(const std::string& vshSource, const std::string& fshSource,
 				else
 					uniform->_index = /*uniformType == GL_SAMPLER_2D ? (samplerIndex++) : */0;
 
+                uniform->_valueSize = getUniformTypeSize(uniformType) * (uniformSize > 0 ? uniformSize : 1);
+                uniform->_value = new unsigned char[uniform->_valueSize];
+                memset(uniform->_value, 0, uniform->_valueSize);
+
                 this->_uniforms[uniformName] = uniform;
             }
             SAFE_DELETE_ARRAY(uniformName);
@@ -444,62 +600,74 @@ unsigned int C3DEffect::getUniformCount() const
 
 void C3DEffect::bindValue(Uniform* uniform, float value)
 {
-    GL_ASSERT( glUniform1f(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(float)))
+        GL_ASSERT( glUniform1f(uniform->_location, value) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const float* values, unsigned int count)
 {
-    GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(float) * count))
+        GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, int value)
 {
-    GL_ASSERT( glUniform1i(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(int)))
+        GL_ASSERT( glUniform1i(uniform->_location, value) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const int* values, unsigned int count)
 {
-    GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(int) * count))
+        GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DMatrix& value)
 {
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    if (uniform->updateValue(value.m, sizeof(float) * 16))
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DMatrix* values, unsigned int count)
 {
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(C3DMatrix) * count))
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DVector2& value)
 {
-    GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    if (uniform->updateValue(&value, sizeof(C3DVector2)))
+        GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DVector2* values, unsigned int count)
 {
-    GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(C3DVector2) * count))
+        GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DVector3& value)
 {
-    GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    if (uniform->updateValue(&value, sizeof(C3DVector3)))
+        GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DVector3* values, unsigned int count)
 {
-    GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(C3DVector3) * count))
+        GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DVector4& value)
 {
-    GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    if (uniform->updateValue(&value, sizeof(C3DVector4)))
+        GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DVector4* values, unsigned int count)
 {
-    GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(C3DVector4) * count))
+        GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DSampler* sampler)
@@ -513,7 +681,9 @@ void C3DEffect::bindValue(Uniform* uniform, const C3DSampler* sampler)
     // Bind the sampler - this binds the texture and applies sampler state
     const_cast<C3DSampler*>(sampler)->bind();
 
-    GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    int index = uniform->_index;
+    if (uniform->updateValue(&index, sizeof(int)))
+        GL_ASSERT( glUniform1i(uniform->_location, index) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DTexture* texture)
@@ -525,9 +695,11 @@ void C3DEffect::bindValue(Uniform* uniform, const C3DTexture* texture)
     C3DRenderState::activeTexture(GL_TEXTURE0 + uniform->_index);
 
     //binds the texture
-	GL_ASSERT( glBindTexture(GL_TEXTURE_2D, texture->getHandle()) );
+	C3DStateCache::bindTexture(GL_TEXTURE_2D, texture->getHandle());
 
-    GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    int index = uniform->_index;
+    if (uniform->updateValue(&index, sizeof(int)))
+        GL_ASSERT( glUniform1i(uniform->_location, index) );
 }
 
 void C3DEffect::bindValue(Uniform* uniform, const C3DSamplerCube* sampler)
@@ -538,7 +710,9 @@ void C3DEffect::bindValue(Uniform* uniform, const C3DSamplerCube* sampler)
 	//binds the texture
 	const_cast<C3DSamplerCube*>(sampler)->bind();
 
-	GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+	int index = uniform->_index;
+	if (uniform->updateValue(&index, sizeof(int)))
+		GL_ASSERT( glUniform1i(uniform->_location, index) );
 }
 
 void C3DEffect::bind()
@@ -551,14 +725,16 @@ void C3DEffect::bind()
 
 void C3DEffect::setCurrentEffect(C3DEffect* effect)
 {
-    if (effect && __currentEffect != effect)
+    // the state cache skips the call when the program is already in use
+    if (effect)
     {
-        GL_ASSERT( glUseProgram(effect->_program) );
-
-        __currentEffect = effect;
+        // an effect still compiling in the background is finished before its first use
+        if (effect->isPending())
+            effect->link();
+        C3DStateCache::useProgram(effect->_program);
     }
-    else if(effect == NULL)
-        __currentEffect = NULL;
+
+    __currentEffect = effect;
 }
 
 C3DEffect* C3DEffect::getCurrentEffect()
@@ -567,7 +743,7 @@ C3DEffect* C3DEffect::getCurrentEffect()
 }
 
 Uniform::Uniform() :
-    _location(-1), _type(0), _index(0)
+    _location(-1), _type(0), _index(0), _effect(NULL), _value(NULL), _valueSize(0), _valueSet(false)
 {
 }
 
@@ -578,7 +754,30 @@ Uniform::Uniform(const Uniform& copy)
 
 Uniform::~Uniform()
 {
-    // hidden
+    SAFE_DELETE_ARRAY(_value);
+}
+
+bool Uniform::updateValue(const void* value, unsigned int size)
+{
+    // values larger than the uniform are not tracked, let GL deal with them
+    if (size > _valueSize)
+    {
+        _valueSet = false;
+        STAT_INC_UNIFORM_ISSUED(1);
+        return true;
+    }
+
+    // a partial array upload only compares and refreshes the head of the copy, as GL does
+    if (_valueSet && memcmp(_value, value, size) == 0)
+    {
+        STAT_INC_UNIFORM_SKIPPED(1);
+        return false;
+    }
+
+    memcpy(_value, value, size);
+    _valueSet = true;
+    STAT_INC_UNIFORM_ISSUED(1);
+    return true;
 }
 
 C3DEffect* Uniform::getEffect() const
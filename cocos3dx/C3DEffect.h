@@ -87,6 +87,17 @@ public:
      */
     unsigned int getUniformCount() const;
 
+    /**
+     * Returns the OpenGL program object of this effect.
+     */
+    GLuint getProgram() const { return _program; }
+
+    /**
+     * Returns true while the program is compiled by the driver in the background,
+     * only drivers supporting parallel shader compilation do so.
+     */
+    bool isCompiling() const;
+
     /**
      * Sets a float uniform value.
      *
@@ -227,8 +238,32 @@ private:
 
 	bool load(const std::string& vshSource, const std::string& fshSource, const std::string& defines);
 
+	/**
+     * submits the compilation of the shaders & the link of the program. The status is not
+     * queried, drivers compiling in the background are not waited for until link().
+     */
+	bool compile(C3DElementNode* node);
+	bool compile(const std::string& vshSource, const std::string& fshSource, const std::string& defines);
+
+	/**
+     * checks the result of compile() and queries the attributes & uniforms of the program.
+     */
+	bool link();
+
+	bool isPending() const { return _pendingProgram != 0; }
+
+	void deletePending();
+
     GLuint _program;
 
+    // submitted by compile(), not checked yet
+    GLuint _pendingProgram;
+    GLuint _vertexShader;
+    GLuint _fragmentShader;
+
+    // hash of the sources, keys the program binary cache. 0 when the cache is disabled
+    unsigned long long _sourceHash;
+
     std::map<std::string, VertexAttribute> _vertexAttributes;
     std::map<std::string, Uniform*> _uniforms;
     static Uniform _emptyUniform;
@@ -270,6 +305,16 @@ public:
 
 private:
 
+    /**
+     * Compares value with the shadow copy of the uniform and updates the copy.
+     *
+     * @param value The value about to be uploaded.
+     * @param size Size of the value in bytes.
+     *
+     * @return true if the value must be uploaded, false if the program already holds it.
+     */
+    bool updateValue(const void* value, unsigned int size);
+
     /**
      * Constructor.
      */
@@ -290,6 +335,10 @@ private:
     GLenum _type;
     unsigned int _index;
     C3DEffect* _effect;
+
+    unsigned char* _value;      // shadow copy of the value last uploaded to the program
+    unsigned int _valueSize;    // size of the whole uniform (all array elements) in bytes
+    bool _valueSet;
 };
 }
 
@@ -26,19 +26,35 @@ THE SOFTWARE.
 #include "C3DEffectManager.h"
 #include "C3DElementNode.h"
 #include "StringTool.h"
+#include "C3DStream.h"
+#include "C3DProfile.h"
+#include "C3DDeviceAdapter.h"
 #include "Base.h"
 
 #include "C3DResourcePool.h"
+
+// header of the cached program binaries
+#define PROGRAM_BINARY_MAGIC    "C3PB"
+#define PROGRAM_BINARY_VERSION  1
+
 namespace cocos3d
 {
 static C3DEffectManager* __effectManagerInstance = NULL;
 
 C3DEffectManager::C3DEffectManager()
+	: _lazyCompile(true), _warmupRecording(false), _warmupBudget(4.0f), _driverHash(0)
 {
+	_programBinaryPath = cocos2d::CCFileUtils::sharedFileUtils()->getWritablePath();
 }
 
 C3DEffectManager::~C3DEffectManager()
 {
+	for (std::vector<C3DEffect*>::iterator iter = _compiling.begin(); iter != _compiling.end(); ++iter)
+	{
+		(*iter)->release();
+	}
+	_compiling.clear();
+
 	__effectManagerInstance = NULL;
 }
 
@@ -54,6 +70,10 @@ C3DEffectManager* C3DEffectManager::getInstance()
 
 void C3DEffectManager::preload(const std::string& name)
 {
+	// the effects are compiled on demand, see setLazyCompile
+	if (_lazyCompile)
+		return;
+
 	if(!name.empty())
 	{
 		C3DElementNode* doc = C3DElementNode::create(name);
@@ -142,6 +162,20 @@ void C3DEffectManager::loadAllEffect(C3DElementNode* effectNodes)
 }
 
 C3DResource* C3DEffectManager::createResource(const std::string& name)
+{
+	C3DEffect* effect = createEffect(name, true);
+	if (effect == NULL)
+		return NULL;
+
+	effect->retain();
+
+	if (_warmupRecording)
+		record(name);
+
+	return effect;
+}
+
+C3DEffect* C3DEffectManager::createEffect(const std::string& name, bool link)
 {
 	std::vector<std::string> a = StringTool::StringSplitByChar(name,';');
 	if(a.size() < 2)
@@ -162,14 +196,14 @@ C3DResource* C3DEffectManager::createResource(const std::string& name)
 			elementNode->setElement("defines", define);
 	}
 
-	C3DResource* effect = new C3DEffect(name);
+	C3DEffect* effect = new C3DEffect(name);
 	effect->autorelease();
 
-	if(effect->load(elementNode) == true)
+	bool loaded = link ? effect->load(elementNode) : effect->compile(elementNode);
+	if(loaded == true)
 	{
 		this->setResourceState(effect,C3DResource::State_Used);
 	}
-	effect->retain();
 
 	SAFE_DELETE(elementNode);
 
@@ -212,6 +246,14 @@ C3DResource* C3DEffectManager::cloneResource(C3DResource* resource)
 {
 	if(resource != NULL)
     {
+		// queued by the warm-up and not finished yet, the driver is waited for
+		C3DEffect* effect = static_cast<C3DEffect*>(resource);
+		if (effect->isPending())
+			effect->link();
+
+		if (_warmupRecording)
+			record(resource->getID());
+
 		resource->retain();
 		this->setResourceState(resource,C3DResource::State_Used);
 		return resource;
@@ -252,4 +294,298 @@ void C3DEffectManager::preload(C3DElementNode* node)
 		}
 	}
 }
-}
\ No newline at end of file
+
+void C3DEffectManager::record(const std::string& name)
+{
+	if (_recordedSet.insert(name).second)
+		_recorded.push_back(name);
+}
+
+void C3DEffectManager::setWarmupRecording(bool recording)
+{
+	_warmupRecording = recording;
+
+	if (recording)
+	{
+		// the effects already in use belong to the list as well
+		for (C3DResourcePool::ItemList::const_iterator iter = _usedPool->_order.begin(); iter != _usedPool->_order.end(); ++iter)
+		{
+			record((*iter)->getID());
+		}
+	}
+}
+
+bool C3DEffectManager::saveWarmupList(const std::string& fileName) const
+{
+	FILE* file = fopen(fileName.c_str(), "w");
+	if (file == NULL)
+	{
+		LOG_ERROR_VARG("Failed to open file: %s", fileName.c_str());
+		return false;
+	}
+
+	for (std::vector<std::string>::const_iterator iter = _recorded.begin(); iter != _recorded.end(); ++iter)
+	{
+		// the defines of an id are new-line delimited, keep one id per line
+		std::string line = *iter;
+		size_t pos = 0;
+		while ((pos = line.find('\n', pos)) != std::string::npos)
+		{
+			line.replace(pos, 1, "\\n");
+			pos += 2;
+		}
+		fprintf(file, "%s\n", line.c_str());
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool C3DEffectManager::warmup(const std::string& fileName)
+{
+	char* text = C3DStreamManager::readAll(fileName);
+	if (text == NULL)
+	{
+		WARN_VARG("Error loading effect warm-up list: Could not load file: %s", fileName.c_str());
+		return false;
+	}
+
+	std::string line;
+	for (const char* c = text; ; ++c)
+	{
+		if (*c != '\n' && *c != '\r' && *c != '\0')
+		{
+			line += *c;
+			continue;
+		}
+
+		if (!line.empty())
+		{
+			size_t pos = 0;
+			while ((pos = line.find("\\n", pos)) != std::string::npos)
+			{
+				line.replace(pos, 2, "\n");
+				++pos;
+			}
+
+			if (findResource(line) == NULL)
+				_warmupQueue.push_back(line);
+			line.clear();
+		}
+
+		if (*c == '\0')
+			break;
+	}
+
+	SAFE_DELETE_ARRAY(text);
+	return true;
+}
+
+void C3DEffectManager::update(long elapsedTime)
+{
+	C3DResourceManager::update(elapsedTime);
+
+	if (_warmupQueue.empty() && _compiling.empty())
+		return;
+
+	PROFILE_SCOPE("effect warmup");
+
+	unsigned long long start = C3DProfile::getTime();
+	unsigned long long budget = (unsigned long long)(_warmupBudget * 1000000.0f);
+
+	// finish the effects the driver is done with, or which were asked for meanwhile
+	for (std::vector<C3DEffect*>::iterator iter = _compiling.begin(); iter != _compiling.end(); )
+	{
+		C3DEffect* effect = *iter;
+		if (effect->isCompiling())
+		{
+			++iter;
+			continue;
+		}
+
+		if (!effect->link())
+		{
+			LOG_ERROR_VARG("Failed to create effect from shaders: %s, %s", effect->_vshPath.c_str(), effect->_fshPath.c_str());
+		}
+		effect->release();
+		iter = _compiling.erase(iter);
+	}
+
+	// the driver compiles on its own threads when it supports it, the whole queue is
+	// submitted then. Otherwise each effect is compiled & linked here, in the budget.
+	bool parallel = C3DDeviceAdapter::getInstance()->isSupportParallelShaderCompile();
+	while (!_warmupQueue.empty())
+	{
+		if (!parallel && budget > 0 && C3DProfile::getTime() - start >= budget)
+			break;
+
+		std::string name = _warmupQueue.front();
+		_warmupQueue.pop_front();
+
+		if (findResource(name) != NULL)
+			continue;
+
+		C3DEffect* effect = createEffect(name, !parallel);
+		if (effect != NULL && effect->isPending())
+		{
+			effect->retain();
+			_compiling.push_back(effect);
+		}
+	}
+}
+
+unsigned long long C3DEffectManager::hashString(const std::string& str, unsigned long long seed)
+{
+	unsigned long long hash = seed;
+	for (size_t i = 0; i < str.size(); ++i)
+	{
+		hash ^= (unsigned char)str[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool C3DEffectManager::isProgramBinaryEnabled() const
+{
+	return !_programBinaryPath.empty() && C3DDeviceAdapter::getInstance()->isSupportProgramBinary();
+}
+
+std::string C3DEffectManager::getProgramBinaryFile(const std::string& name) const
+{
+	char fileName[32];
+	sprintf(fileName, "program_%016llx.bin", hashString(name));
+	return _programBinaryPath + fileName;
+}
+
+unsigned long long C3DEffectManager::getDriverHash()
+{
+	if (_driverHash == 0)
+	{
+		// a driver update invalidates the binaries
+		const GLubyte* strings[3] = { glGetString(GL_VENDOR), glGetString(GL_RENDERER), glGetString(GL_VERSION) };
+		_driverHash = hashString("");
+		for (int i = 0; i < 3; ++i)
+		{
+			if (strings[i] != NULL)
+				_driverHash = hashString((const char*)strings[i], _driverHash);
+		}
+	}
+	return _driverHash;
+}
+
+bool C3DEffectManager::loadProgramBinary(const std::string& name, unsigned long long sourceHash, GLuint program)
+{
+#ifdef USE_PROGRAM_BINARY
+	if (!isProgramBinaryEnabled())
+		return false;
+
+	// no binary yet, not an error
+	std::string fileName = getProgramBinaryFile(name);
+	FILE* file = fopen(fileName.c_str(), "rb");
+	if (file == NULL)
+		return false;
+
+	char magic[4];
+	unsigned int version = 0;
+	unsigned long long driverHash = 0;
+	unsigned long long fileSourceHash = 0;
+	unsigned int nameLength = 0;
+	GLenum format = 0;
+	unsigned int length = 0;
+
+	bool valid = fread(magic, 1, 4, file) == 4 && memcmp(magic, PROGRAM_BINARY_MAGIC, 4) == 0
+		&& fread(&version, sizeof(version), 1, file) == 1 && version == PROGRAM_BINARY_VERSION
+		&& fread(&driverHash, sizeof(driverHash), 1, file) == 1 && driverHash == getDriverHash()
+		&& fread(&fileSourceHash, sizeof(fileSourceHash), 1, file) == 1 && fileSourceHash == sourceHash
+		&& fread(&nameLength, sizeof(nameLength), 1, file) == 1 && nameLength == name.size()
+		&& fread(&format, sizeof(format), 1, file) == 1
+		&& fread(&length, sizeof(length), 1, file) == 1 && length > 0;
+
+	// the file name is a hash of the id, the id itself tells the collisions apart
+	std::string fileId(nameLength, '\0');
+	valid = valid && (nameLength == 0 || fread(&fileId[0], 1, nameLength, file) == nameLength) && fileId == name;
+
+	char* binary = NULL;
+	if (valid)
+	{
+		binary = new char[length];
+		valid = fread(binary, 1, length, file) == length;
+	}
+	fclose(file);
+
+	GLint success = GL_FALSE;
+	if (valid)
+	{
+		GL_ASSERT( glProgramBinary(program, format, binary, length) );
+		GL_ASSERT( glGetProgramiv(program, GL_LINK_STATUS, &success) );
+	}
+	SAFE_DELETE_ARRAY(binary);
+
+	if (success != GL_TRUE)
+	{
+		WARN_VARG("Program binary out of date, compiling from the sources: %s", fileName.c_str());
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void C3DEffectManager::saveProgramBinary(const std::string& name, unsigned long long sourceHash, GLuint program)
+{
+#ifdef USE_PROGRAM_BINARY
+	if (!isProgramBinaryEnabled())
+		return;
+
+	GLint length = 0;
+	GL_ASSERT( glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length) );
+	if (length <= 0)
+		return;
+
+	char* binary = new char[length];
+	GLenum format = 0;
+	GLsizei written = 0;
+	GL_ASSERT( glGetProgramBinary(program, length, &written, &format, binary) );
+
+	// written next to the cache file and renamed, a crash mid-write never leaves a truncated binary
+	std::string fileName = getProgramBinaryFile(name);
+	std::string tempName = fileName + ".tmp";
+	FILE* file = written > 0 ? fopen(tempName.c_str(), "wb") : NULL;
+	bool saved = false;
+	if (file != NULL)
+	{
+		unsigned int version = PROGRAM_BINARY_VERSION;
+		unsigned int nameLength = (unsigned int)name.size();
+		unsigned int binaryLength = (unsigned int)written;
+		unsigned long long driverHash = getDriverHash();
+
+		saved = fwrite(PROGRAM_BINARY_MAGIC, 1, 4, file) == 4
+			&& fwrite(&version, sizeof(version), 1, file) == 1
+			&& fwrite(&driverHash, sizeof(driverHash), 1, file) == 1
+			&& fwrite(&sourceHash, sizeof(sourceHash), 1, file) == 1
+			&& fwrite(&nameLength, sizeof(nameLength), 1, file) == 1
+			&& fwrite(&format, sizeof(format), 1, file) == 1
+			&& fwrite(&binaryLength, sizeof(binaryLength), 1, file) == 1
+			&& fwrite(name.c_str(), 1, nameLength, file) == nameLength
+			&& fwrite(binary, 1, binaryLength, file) == binaryLength;
+		saved = fclose(file) == 0 && saved;
+
+#ifdef WIN32
+		// rename doesn't replace an existing file there
+		if (saved)
+			remove(fileName.c_str());
+#endif
+		saved = saved && rename(tempName.c_str(), fileName.c_str()) == 0;
+		if (!saved)
+			remove(tempName.c_str());
+	}
+
+	// the cache is optional, the program is compiled from source next time
+	if (!saved)
+		WARN_VARG("Failed to save program binary: %s", fileName.c_str());
+
+	SAFE_DELETE_ARRAY(binary);
+#endif
+}
+}
@@ -31,6 +31,9 @@ THE SOFTWARE.
 
 #include <string>
 #include <map>
+#include <set>
+#include <list>
+#include <vector>
 #include "cocos2d.h"
 #include "C3DResourceManager.h"
 
@@ -69,6 +72,82 @@ public:
 	void preload(C3DElementNode* node);
 
 	static std::string generateID( std::string& vshPath, std::string& fshPath, std::string& defines);
+
+	/**
+     * Effects are compiled the first time a material asks for them, the 'Effects' config
+     * files are then skipped by preload. Set it to false to compile every permutation of
+     * the config files at preload. true by default.
+     */
+	void setLazyCompile(bool lazy) { _lazyCompile = lazy; }
+	bool isLazyCompile() const { return _lazyCompile; }
+
+	/**
+     * Starts or stops recording the effects asked for by the materials, see saveWarmupList.
+     */
+	void setWarmupRecording(bool recording);
+	bool isWarmupRecording() const { return _warmupRecording; }
+
+	/**
+     * Writes the recorded effects, one per line, for warmup on the next run.
+     *
+     * @param fileName The full path of the file, under the writable path for instance.
+     */
+	bool saveWarmupList(const std::string& fileName) const;
+
+	/**
+     * Queues the effects of a list written by saveWarmupList, update() compiles them over
+     * the next frames within the warm-up budget. When the driver compiles in the background
+     * the queue is submitted at once and each effect is finished as soon as it is ready.
+     * An effect asked for before its turn is compiled right away.
+     * Returns false, with a warning, when there is no list: the effects are compiled on use.
+     */
+	bool warmup(const std::string& fileName);
+
+	/**
+     * Sets the time update() may spend on the warm-up each frame, 0 means no limit.
+     */
+	void setWarmupBudget(float milliseconds) { _warmupBudget = milliseconds; }
+
+	/** Gets the number of effects queued or compiling for the warm-up. */
+	unsigned int getWarmupCount() const { return (unsigned int)(_warmupQueue.size() + _compiling.size()); }
+
+	virtual void update(long elapsedTime);
+
+	/**
+     * Sets the directory where the linked programs are kept between runs, empty disables
+     * the cache. A cached program is used when its effect id, the driver and the shader
+     * sources are the ones it was saved with, the effect is compiled from the sources
+     * and saved again otherwise.
+     *
+     * @param path The directory, ending with a separator. The writable path by default.
+     */
+	void setProgramBinaryPath(const std::string& path) { _programBinaryPath = path; }
+	const std::string& getProgramBinaryPath() const { return _programBinaryPath; }
+
+	/**
+     * Returns true when the driver can save program binaries and a cache path is set.
+     */
+	bool isProgramBinaryEnabled() const;
+
+	/**
+     * Loads the cached binary of an effect into the program, false when there is none or
+     * it does not match.
+     *
+     * @param name The effect id.
+     * @param sourceHash The hash of the sources the effect would be compiled from.
+     * @param program A program object created for the binary.
+     */
+	bool loadProgramBinary(const std::string& name, unsigned long long sourceHash, GLuint program);
+
+	/**
+     * Saves the binary of a linked program.
+     */
+	void saveProgramBinary(const std::string& name, unsigned long long sourceHash, GLuint program);
+
+	/**
+     * 64 bits FNV-1a hash of str, hashes can be chained through the seed.
+     */
+	static unsigned long long hashString(const std::string& str, unsigned long long seed = 14695981039346656037ULL);
 private:
 
     C3DEffectManager();
@@ -77,6 +156,30 @@ private:
 
 	void loadAllEffect(C3DElementNode* effectNodes);
 
+	/**
+     * Creates the effect from its id and submits its compilation, the effect is linked
+     * at once unless link is false.
+     */
+	C3DEffect* createEffect(const std::string& name, bool link);
+
+	void record(const std::string& name);
+
+	bool _lazyCompile;
+
+	bool _warmupRecording;
+	std::vector<std::string> _recorded;
+	std::set<std::string> _recordedSet;
+
+	float _warmupBudget;
+	std::list<std::string> _warmupQueue;
+	std::vector<C3DEffect*> _compiling;
+
+	std::string getProgramBinaryFile(const std::string& name) const;
+	unsigned long long getDriverHash();
+
+	std::string _programBinaryPath;
+	unsigned long long _driverHash;
+
 };
 }
 
@@ -23,13 +23,20 @@ THE SOFTWARE.
 #include "Base.h"
 #include "C3DElementNode.h"
 #include "C3DStream.h"
+#include "cocos2d.h"
 #include "C3DQuaternion.h"
 #include "C3DMatrix.h"
 #include "C3DVector2.h"
 #include "C3DStream.h"
 
+#define ELEMENT_BINARY_VERSION_MAJOR 2
+#define ELEMENT_BINARY_VERSION_MINOR 0
+
 namespace cocos3d
 {
+static const char __binaryIdentifier[] = { 'C', '3', 'E', 'N' };
+static const std::string __emptyString;
+
 void skipWhiteSpace(C3DStream* stream);
 char* trimWhiteSpace(char* str);
 
@@ -269,19 +276,209 @@ C3DElementNode* C3DElementNode::create(const std::string& fileName)
         return NULL;
     }
 
-	C3DStream* stream = C3DStreamManager::openStream(fileName, "rb");
+	std::string fullPath = cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(fileName.c_str());
+	if (fullPath.empty())
+	{
+		WARN("Failed to open file");
+		return NULL;
+	}
+
+	return createFromFullPath(fullPath, getBinaryFullPath(fileName));
+}
+
+std::string C3DElementNode::getBinaryFullPath(const std::string& fileName)
+{
+	std::string binaryName = fileName + ".bin";
+	if (!cocos2d::CCFileUtils::sharedFileUtils()->isFileExist(binaryName))
+		return "";
+
+	return cocos2d::CCFileUtils::sharedFileUtils()->fullPathForFilename(binaryName.c_str());
+}
+
+C3DElementNode* C3DElementNode::createFromFullPath(const std::string& fullPath, const std::string& binaryFullPath)
+{
+	C3DStream* stream = C3DStreamManager::openFullPathStream(fullPath, "rb");
     if (!stream)
     {
 		WARN("Failed to open file");
         return NULL;
     }
 
-    C3DElementNode* properties = new C3DElementNode(stream);
+	C3DElementNode* properties = NULL;
+
+	// the ".bin" is only used when it was converted from the current text file
+	C3DStream* binaryStream = binaryFullPath.empty() ? NULL : C3DStreamManager::openFullPathStream(binaryFullPath, "rb");
+	if (binaryStream)
+	{
+		unsigned int sourceLength = 0;
+		unsigned int sourceHash = hashSource(stream, sourceLength);
+
+		char sig[4];
+		if (binaryStream->read(sig, 1, 4) == 4 && memcmp(sig, __binaryIdentifier, 4) == 0)
+			properties = createFromBinary(binaryStream, binaryFullPath, sourceLength, sourceHash);
+
+		SAFE_DELETE(binaryStream);
+	}
+
+	if (!properties)
+		properties = new C3DElementNode(stream);
 
     SAFE_DELETE(stream);
     return properties;
 }
 
+unsigned int C3DElementNode::hashSource(C3DStream* stream, unsigned int& length)
+{
+	std::string data(stream->length(), '\0');
+	length = data.empty() ? 0 : (unsigned int)stream->read(&data[0], 1, data.size());
+	data.resize(length);
+	stream->rewind();
+
+	return hashKey(data);
+}
+
+// bytes left in the stream, the counts read from a damaged file are checked against it before allocating
+static size_t remainingBytes(C3DStream* stream)
+{
+	long int position = stream->tell();
+	size_t length = stream->length();
+	return position >= 0 && (size_t)position < length ? length - (size_t)position : 0;
+}
+
+C3DElementNode* C3DElementNode::createFromBinary(C3DStream* stream, const std::string& fileName, unsigned int sourceLength, unsigned int sourceHash)
+{
+	unsigned char ver[2];
+	if (stream->read(ver, 1, 2) != 2 || ver[0] != ELEMENT_BINARY_VERSION_MAJOR)
+	{
+		WARN_VARG("Unsupported version (%d.%d) for element file: %s (expected %d.%d), using the text file", (int)ver[0], (int)ver[1], fileName.c_str(), ELEMENT_BINARY_VERSION_MAJOR, ELEMENT_BINARY_VERSION_MINOR);
+		return NULL;
+	}
+
+	// length and FNV-1a hash of the text file it was converted from
+	unsigned int source[2];
+	if (stream->read(source, 4, 2) != 2 || source[0] != sourceLength || source[1] != sourceHash)
+	{
+		WARN_VARG("Element file was not converted from the current text file: %s, using the text file", fileName.c_str());
+		return NULL;
+	}
+
+	// string table, every key, value, type and name once
+	// a string takes 6 bytes at least: hash and length
+	unsigned int stringCount;
+	if (stream->read(&stringCount, 4, 1) != 1 || stringCount > remainingBytes(stream) / 6)
+	{
+		WARN_VARG("Failed to read the string table of element file: %s, using the text file", fileName.c_str());
+		return NULL;
+	}
+
+	std::vector<std::string> strings(stringCount);
+	std::vector<unsigned int> hashes(stringCount);
+	for (unsigned int i = 0; i < stringCount; ++i)
+	{
+		unsigned short length;
+		if (stream->read(&hashes[i], 4, 1) != 1 || stream->read(&length, 2, 1) != 1)
+		{
+			WARN_VARG("Failed to read the string table of element file: %s, using the text file", fileName.c_str());
+			return NULL;
+		}
+
+		if (length > 0)
+		{
+			strings[i].resize(length);
+			if (stream->read(&strings[i][0], 1, length) != length)
+			{
+				WARN_VARG("Failed to read the string table of element file: %s, using the text file", fileName.c_str());
+				return NULL;
+			}
+		}
+	}
+
+	C3DElementNode* root = new C3DElementNode();
+	if (!root->readBinary(stream, strings, hashes))
+	{
+		WARN_VARG("Invalid element file: %s, using the text file", fileName.c_str());
+		SAFE_DELETE(root);
+	}
+
+	return root;
+}
+
+bool C3DElementNode::readBinary(C3DStream* stream, const std::vector<std::string>& strings, const std::vector<unsigned int>& hashes)
+{
+	unsigned int header[3];	// type, name, flag count
+	if (stream->read(header, 4, 3) != 3 || header[0] >= strings.size() || header[1] >= strings.size())
+		return false;
+
+	_nodeType = strings[header[0]];
+	_nodeName = strings[header[1]];
+
+	std::vector<unsigned int> records;
+
+	// flags: key, value
+	unsigned int flagCount = header[2];
+	if (flagCount > remainingBytes(stream) / 8)
+		return false;
+
+	if (flagCount > 0)
+	{
+		records.resize(flagCount * 2);
+		if (stream->read(&records[0], 4, records.size()) != records.size())
+			return false;
+
+		_flags.reserve(flagCount);
+		for (unsigned int i = 0; i < flagCount; ++i)
+		{
+			unsigned int key = records[i * 2];
+			unsigned int value = records[i * 2 + 1];
+			if (key >= strings.size() || value >= strings.size())
+				return false;
+
+			_flags.push_back(KeyValue(strings[key], strings[value], hashes[key], -1));
+		}
+	}
+
+	// elements: key, value, ElementType
+	unsigned int elementCount;
+	if (stream->read(&elementCount, 4, 1) != 1 || elementCount > remainingBytes(stream) / 12)
+		return false;
+
+	if (elementCount > 0)
+	{
+		records.resize(elementCount * 3);
+		if (stream->read(&records[0], 4, records.size()) != records.size())
+			return false;
+
+		_elements.reserve(elementCount);
+		for (unsigned int i = 0; i < elementCount; ++i)
+		{
+			unsigned int key = records[i * 3];
+			unsigned int value = records[i * 3 + 1];
+			if (key >= strings.size() || value >= strings.size() || records[i * 3 + 2] > MATRIX)
+				return false;
+
+			_elements.push_back(KeyValue(strings[key], strings[value], hashes[key], (int)records[i * 3 + 2]));
+		}
+	}
+
+	unsigned int childCount;
+	// a child takes 20 bytes at least: header, element and child counts
+	if (stream->read(&childCount, 4, 1) != 1 || childCount > remainingBytes(stream) / 20)
+		return false;
+
+	_childs.reserve(childCount);
+	for (unsigned int i = 0; i < childCount; ++i)
+	{
+		C3DElementNode* child = new C3DElementNode();
+		_childs.push_back(child);
+
+		if (!child->readBinary(stream, strings, hashes))
+			return false;
+	}
+
+	rewind();
+	return true;
+}
+
 void C3DElementNode::readFlag(C3DStream* stream)
 {
 	char line[2048];
@@ -693,9 +890,19 @@ const bool isStringNumeric(const char* str)
     return true;
 }
 
-C3DElementNode::ElementType C3DElementNode::getElementType(const std::string& elementName /*= ""*/) const
+unsigned int C3DElementNode::hashKey(const std::string& key)
+{
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < key.size(); ++i)
+	{
+		hash ^= (unsigned char)key[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static C3DElementNode::ElementType parseElementType(const std::string& val)
 {
-    const std::string& val = getElement(elementName);
     if (val.empty())
     {
         return C3DElementNode::NONE;
@@ -728,15 +935,32 @@ C3DElementNode::ElementType C3DElementNode::getElementType(const std::string& el
     }
 }
 
-const std::string C3DElementNode::getElement(const std::string name) const
+C3DElementNode::ElementType C3DElementNode::getElementType(const std::string& elementName /*= ""*/) const
+{
+    const KeyValue* element = findElement(elementName);
+    if (element == NULL)
+    {
+        return C3DElementNode::NONE;
+    }
+
+    // precompiled files come with the type
+    if (element->type < 0)
+    {
+        element->type = parseElementType(element->value);
+    }
+    return (C3DElementNode::ElementType)element->type;
+}
+
+const C3DElementNode::KeyValue* C3DElementNode::findElement(const std::string& name) const
 {
     if (!name.empty())
     {
+        unsigned int hash = hashKey(name);
         for (size_t i = 0; i < _elements.size(); ++i)
         {
-            if (_elements[i].key == name)
+            if (_elements[i].hash == hash && _elements[i].key == name)
             {
-                return _elements[i].value;
+                return &_elements[i];
             }
         }
     }
@@ -744,20 +968,27 @@ const std::string C3DElementNode::getElement(const std::string name) const
     {
         if (_elementsItr != _elements.end())
         {
-            return _elementsItr->value;
+            return &(*_elementsItr);
         }
     }
 
-    return "";
+    return NULL;
+}
+
+const std::string& C3DElementNode::getElement(const std::string& name) const
+{
+    const KeyValue* element = findElement(name);
+    return element ? element->value : __emptyString;
 }
 
 std::string C3DElementNode::getElementFlag(const std::string& flagName)
 {
 	if (!flagName.empty())
     {
+        unsigned int hash = hashKey(flagName);
         for (size_t i = 0; i < _flags.size(); ++i)
         {
-            if (_flags[i].key == flagName)
+            if (_flags[i].hash == hash && _flags[i].key == flagName)
                 return _flags[i].value;
         }
     }
@@ -1075,9 +1306,10 @@ void C3DElementNode::write(C3DStream* stream, const std::string& indent)
 
 void C3DElementNode::setElementFlag(const std::string& flagName, const std::string& flag)
 {
+    unsigned int hash = hashKey(flagName);
     for (size_t i = 0; i < _flags.size(); i++)
     {
-        if (_flags[i].key == flagName)
+        if (_flags[i].hash == hash && _flags[i].key == flagName)
         {
             _flags[i].value = flag;
             return;
@@ -36,6 +36,11 @@ class C3DStream;
 
 /**
  * C3DElementNode is an interface for reading and writing element.
+ *
+ * Files may be precompiled by tools/pytools/element_convert.py, which writes
+ * "<file>.bin" next to the text file: a string table with the hashed keys and
+ * the nodes with pre-typed elements, read without any text parsing. create()
+ * uses the binary file when it is present.
  */
 class  C3DElementNode
 {
@@ -53,10 +58,21 @@ public:
     };
 
 	/**
-     * Creates ElementNode.
+     * Creates ElementNode, from fileName + ".bin" when it exists.
      */
     static C3DElementNode* create(const std::string& fileName);
 
+	/**
+     * Creates ElementNode from paths resolved by CCFileUtils, binaryFullPath is empty when there
+     * is no ".bin" file. The search paths are not looked up, so the loader threads can call it.
+     */
+    static C3DElementNode* createFromFullPath(const std::string& fullPath, const std::string& binaryFullPath);
+
+	/**
+     * Full path of the ".bin" version of fileName, empty when there is none.
+     */
+	static std::string getBinaryFullPath(const std::string& fileName);
+
 	/**
      * Creates empty ElementNode.
      */
@@ -135,7 +151,7 @@ public:
 	/**
 	 * Gets the element value by specified name.
 	 */
-    const std::string getElement(const std::string name = "") const;
+    const std::string& getElement(const std::string& name = "") const;
 
     /**
 	 * template function to get element value by specified name.
@@ -160,17 +176,7 @@ public:
 	template<typename T>
 	void setElement(const std::string& name, T* value)
 	{
-		size_t i;
-		for (i = 0; i < _elements.size(); i++)
-		{
-			if (_elements[i].key == name)
-			{
-				_elements[i].value = StringTool::toString(*value);
-				break;
-			}
-		}
-		if (i >= _elements.size())
-			_elements.push_back(KeyValue(name, StringTool::toString(*value)));
+		setElement(name, StringTool::toString(*value));
 	}
 
 	/**
@@ -178,16 +184,13 @@ public:
 	 */
     void setElement(const std::string& name, const std::string& value)
     {
-        size_t i;
-        for (i = 0; i < _elements.size(); i++)
+        KeyValue* element = const_cast<KeyValue*>(findElement(name));
+        if (element)
         {
-            if (_elements[i].key == name)
-            {
-                _elements[i].value =value;
-                break;
-            }
+            element->value = value;
+            element->type = -1;
         }
-        if (i >= _elements.size())
+        else
             _elements.push_back(KeyValue(name, value));
     }
 
@@ -210,6 +213,11 @@ public:
 	* Gets element count.
 	*/
     int getElementCount() const;
+
+	/**
+	* Hash of the element keys, FNV-1a as written by the converter.
+	*/
+	static unsigned int hashKey(const std::string& key);
 private:
 	/**
      * Constructor.
@@ -246,6 +254,18 @@ private:
      */
     void readFlag(C3DStream* stream);
 
+	/**
+     * read the nodes of a precompiled file, the signature is already read.
+     * returns NULL when it was not converted from the text file of the given length and hash.
+     */
+	static C3DElementNode* createFromBinary(C3DStream* stream, const std::string& fileName, unsigned int sourceLength, unsigned int sourceHash);
+
+	/**
+     * FNV-1a hash and length of the whole stream, which is rewound.
+     */
+	static unsigned int hashSource(C3DStream* stream, unsigned int& length);
+	bool readBinary(C3DStream* stream, const std::vector<std::string>& strings, const std::vector<unsigned int>& hashes);
+
 	/**
      * Defines structure to describe the element value.
      */
@@ -253,10 +273,18 @@ private:
     {
         std::string key;
         std::string value;
+        unsigned int hash;
+        mutable int type; // ElementType, -1 until asked
 
-        KeyValue(const std::string& k, const std::string& v) : key(k), value(v){}
+        KeyValue(const std::string& k, const std::string& v) : key(k), value(v), hash(hashKey(k)), type(-1){}
+        KeyValue(const std::string& k, const std::string& v, unsigned int h, int t) : key(k), value(v), hash(h), type(t){}
     };
 
+	/**
+     * Finds an element, the current one of the iterator when name is empty.
+     */
+	const KeyValue* findElement(const std::string& name) const;
+
     std::string _nodeType;
     std::string _nodeName;
 
@@ -52,20 +52,20 @@ void C3DForcePSA::save(C3DElementNode* properties)
 	properties->setElement("force", &_force);
 }
 
-void C3DForcePSA::action(long elapsedTime)
+void C3DForcePSA::action(long elapsedTime, int begin, int end)
 {
 	// Calculate the time passed since last update.
     float elapsedSecs = (float)elapsedTime * 0.001f;
-	C3DParticle**& _particles = _system->_particles;
-	int& _validParticleCount = _system->_validParticleCount;
+	C3DParticleArrays& p = _system->_particles;
 
-	for (int i = 0; i < _validParticleCount; ++i)
+	float dx = _force.x * elapsedSecs;
+	float dy = _force.y * elapsedSecs;
+	float dz = _force.z * elapsedSecs;
+	for (int i = begin; i < end; ++i)
     {
-		C3DParticle*& p = _particles[i];
-
-        p->_velocity.x += _force.x * elapsedSecs;
-        p->_velocity.y += _force.y * elapsedSecs;
-        p->_velocity.z += _force.z * elapsedSecs;
+        p._velocityX[i] += dx;
+        p._velocityY[i] += dy;
+        p._velocityZ[i] += dz;
     }
 }
 
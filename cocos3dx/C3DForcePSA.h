@@ -59,7 +59,7 @@ public:
 	/**
 	change particle state, called by C3DParticleSystem
 	*/
-	virtual void action(long elapsedTime);
+	virtual void action(long elapsedTime, int begin, int end);
 
 	/**
 	set & get force affect the particles
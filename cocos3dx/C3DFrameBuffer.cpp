@@ -32,7 +32,7 @@ namespace cocos3d
 
 C3DFrameBuffer::C3DFrameBuffer(const std::string& id) :
     _id(id), _handle(0), _renderTarget(NULL), _depthStencilTarget(NULL), _width(1), _height(1),
-    _isBind(false), _oldFBO(0), _oldViewport(0, 0, 1, 1)
+    _isBind(false), _oldFBO(0), _oldViewport(0, 0, 1, 1), _reloadCount(0)
 {
 	C3DFrameBufferMgr::getInstance()->add(this);
 }
@@ -129,6 +129,7 @@ void C3DFrameBuffer::reload()
 	GL_ASSERT( glGenFramebuffers(1, &handle) );
 
 	_handle = handle;
+	++_reloadCount;
 
 	setRenderTarget(_renderTarget);
 	setDepthStencilTarget(_depthStencilTarget);
@@ -107,6 +107,14 @@ public:
 
 	void reload();
 
+	/**
+     * get the number of reloads, the content of the targets is lost on each of them.
+     */
+	unsigned int getReloadCount() const
+	{
+		return _reloadCount;
+	}
+
 private:
 
 	/**
@@ -126,6 +134,7 @@ private:
     bool _isBind;
     C3DViewport _oldViewport;
     GLint _oldFBO;
+    unsigned int _reloadCount;
 };
 
 class C3DFrameBufferMgr : public cocos2d::Ref
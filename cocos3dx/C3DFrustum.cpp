@@ -23,9 +23,47 @@ THE SOFTWARE.
 #include "Base.h"
 #include "C3DFrustum.h"
 #include "C3DCamera.h"
+#include "C3DMathSIMD.h"
 
 namespace cocos3d
 {
+    void C3DBoxArray::add(const C3DAABB& aabb)
+    {
+        for (int k = 0; k < 6; k++)
+            _components[k].push_back(0.0f);
+        _lastPlane.push_back(C3DMathSIMD::CULL_NO_PLANE);
+
+        set(size() - 1, aabb);
+    }
+
+    void C3DBoxArray::set(unsigned int index, const C3DAABB& aabb)
+    {
+        _components[0][index] = (aabb._min.x + aabb._max.x) * 0.5f;
+        _components[1][index] = (aabb._min.y + aabb._max.y) * 0.5f;
+        _components[2][index] = (aabb._min.z + aabb._max.z) * 0.5f;
+        _components[3][index] = (aabb._max.x - aabb._min.x) * 0.5f;
+        _components[4][index] = (aabb._max.y - aabb._min.y) * 0.5f;
+        _components[5][index] = (aabb._max.z - aabb._min.z) * 0.5f;
+    }
+
+    void C3DBoxArray::swapRemove(unsigned int index)
+    {
+        unsigned int last = size() - 1;
+        for (int k = 0; k < 6; k++)
+        {
+            _components[k][index] = _components[k][last];
+            _components[k].pop_back();
+        }
+        _lastPlane[index] = _lastPlane[last];
+        _lastPlane.pop_back();
+    }
+
+    void C3DBoxArray::clear()
+    {
+        for (int k = 0; k < 6; k++)
+            _components[k].clear();
+        _lastPlane.clear();
+    }
 
     bool C3DFrustum::initFrustum(C3DCamera* pCamera)
     {
@@ -33,13 +71,20 @@ namespace cocos3d
         createPlane(pCamera);
         return true;
     }
+
+    bool C3DFrustum::initFrustum(const C3DMatrix& viewProjection)
+    {
+        _bInit = true;
+        createPlane(viewProjection);
+        return true;
+    }
     bool C3DFrustum::isOutFrustum(const C3DAABB& aabb) const
     {
         if (_bInit)
         {
             C3DVector3 point;
 
-            int nplane = _bClipZ ? 6 : 4;
+            int nplane = getPlaneCount();
             for (int i = 0; i < nplane; i++) {
                 const C3DVector3& normal = _plane[i].getNormal();
                 point.x = normal.x < 0 ? aabb._max.x : aabb._min.x;
@@ -58,7 +103,7 @@ namespace cocos3d
         {
             C3DVector3 point;
 
-            int nplane = _bClipZ ? 6 : 4;
+            int nplane = getPlaneCount();
 
             for (int i = 0; i < nplane; i++) {
                 const C3DVector3& normal = _plane[i].getNormal();
@@ -75,16 +120,68 @@ namespace cocos3d
         return  false;
     }
 
+    bool C3DFrustum::isInFrustum(const C3DAABB& aabb) const
+    {
+        if (_bInit)
+        {
+            C3DVector3 point;
+
+            int nplane = getPlaneCount();
+            for (int i = 0; i < nplane; i++) {
+                const C3DVector3& normal = _plane[i].getNormal();
+                point.x = normal.x < 0 ? aabb._min.x : aabb._max.x;
+                point.y = normal.y < 0 ? aabb._min.y : aabb._max.y;
+                point.z = normal.z < 0 ? aabb._min.z : aabb._max.z;
+                if (_plane[i].pointClassify(point) == C3DPlane::FRONT_PLANE )
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void C3DFrustum::cullBoxes(const C3DBoxArray& boxes, std::vector<unsigned int>& visibility) const
+    {
+        unsigned int count = boxes.size();
+        visibility.resize((count + 31) / 32);
+        if (count == 0)
+            return;
+
+        if (!_bInit)
+        {
+            std::fill(visibility.begin(), visibility.end(), 0xffffffff);
+            return;
+        }
+
+        const float* bounds[6];
+        for (int k = 0; k < 6; k++)
+            bounds[k] = boxes.getComponent(k);
+
+        C3DMathSIMD::getInstance().cullBoxes(_planeData, getPlaneCount(), bounds, &boxes._lastPlane[0], count, &visibility[0]);
+    }
+
     void C3DFrustum::createPlane(C3DCamera* pcamera)
     {
-		const C3DMatrix& mat = pcamera->getViewProjectionMatrix();
+		createPlane(pcamera->getViewProjectionMatrix());
+    }
+
+    void C3DFrustum::createPlane(const C3DMatrix& mat)
+    {
 		//ref http://www.lighthouse3d.com/tutorials/view-frustum-culling/clip-space-approach-extracting-the-planes/
 		//extract frustum plane
 		_plane[0].initPlane(-C3DVector3(mat.m[3] + mat.m[0], mat.m[7] + mat.m[4], mat.m[11] + mat.m[8]), (mat.m[15] + mat.m[12]));//left
 		_plane[1].initPlane(-C3DVector3(mat.m[3] - mat.m[0], mat.m[7] - mat.m[4], mat.m[11] - mat.m[8]), (mat.m[15] - mat.m[12]));//right
 		_plane[2].initPlane(-C3DVector3(mat.m[3] + mat.m[1], mat.m[7] + mat.m[5], mat.m[11] + mat.m[9]), (mat.m[15] + mat.m[13]));//bottom
 		_plane[3].initPlane(-C3DVector3(mat.m[3] - mat.m[1], mat.m[7] - mat.m[5], mat.m[11] - mat.m[9]), (mat.m[15] - mat.m[13]));//top
-		_plane[4].initPlane(-C3DVector3(mat.m[3] + mat.m[2], mat.m[7] + mat.m[6], mat.m[11] + mat.m[10]), (mat.m[15] + mat.m[14]));//near
-		_plane[5].initPlane(-C3DVector3(mat.m[3] - mat.m[2], mat.m[7] - mat.m[6], mat.m[11] - mat.m[10]), (mat.m[15] - mat.m[14]));//far
+		_plane[4].initPlane(-C3DVector3(mat.m[3] - mat.m[2], mat.m[7] - mat.m[6], mat.m[11] - mat.m[10]), (mat.m[15] - mat.m[14]));//far
+		_plane[5].initPlane(-C3DVector3(mat.m[3] + mat.m[2], mat.m[7] + mat.m[6], mat.m[11] + mat.m[10]), (mat.m[15] + mat.m[14]));//near
+
+		for (int i = 0; i < 6; i++)
+		{
+			const C3DVector3& normal = _plane[i].getNormal();
+			_planeData[i * 4] = normal.x;
+			_planeData[i * 4 + 1] = normal.y;
+			_planeData[i * 4 + 2] = normal.z;
+			_planeData[i * 4 + 3] = _plane[i].getDist();
+		}
     }
 }
\ No newline at end of file
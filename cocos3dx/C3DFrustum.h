@@ -23,6 +23,7 @@ THE SOFTWARE.
 #ifndef C3DFRUSTUM_H_
 #define C3DFRUSTUM_H_
 
+#include <vector>
 #include "C3DAABB.h"
 #include "C3DOBB.h"
 #include "C3DPlane.h"
@@ -30,6 +31,39 @@ THE SOFTWARE.
 namespace cocos3d
 {
     class C3DCamera;
+    class C3DMatrix;
+
+    /**
+     * Bounding boxes of many nodes stored component by component (centers and extents),
+     * the layout culled by C3DFrustum::cullBoxes. Each box also keeps the frustum plane
+     * which culled it last, tested first on the next cull.
+     */
+    class C3DBoxArray
+    {
+    public:
+        unsigned int size() const { return (unsigned int)_lastPlane.size(); }
+
+        void add(const C3DAABB& aabb);
+        void set(unsigned int index, const C3DAABB& aabb);
+
+        /**
+         * Removes a box by moving the last one in its place.
+         */
+        void swapRemove(unsigned int index);
+        void clear();
+
+        /**
+         * Gets the array of the center x, y, z (0 to 2) or of the extents x, y, z (3 to 5).
+         */
+        const float* getComponent(int component) const { return &_components[component][0]; }
+
+    private:
+        friend class C3DFrustum;
+
+        std::vector<float> _components[6];
+        mutable std::vector<unsigned char> _lastPlane;
+    };
+
     /**
 	* Defines a 3-dimensional frustum.
 	*/
@@ -44,7 +78,11 @@ namespace cocos3d
         /**
 		 * Constructor & Destructor.
 		 */
-        C3DFrustum(): _bInit(true), _bClipZ(true){}
+        C3DFrustum(): _bInit(true), _bClipZ(true), _bClipNear(true)
+        {
+            for (int i = 0; i < 24; i++)
+                _planeData[i] = 0.0f;
+        }
 		~C3DFrustum(){}
 
 		/**
@@ -52,6 +90,11 @@ namespace cocos3d
 		 */
         bool initFrustum(C3DCamera* pCamera);
 
+		/**
+		 * init frustum from a view projection matrix, a light for instance.
+		 */
+        bool initFrustum(const C3DMatrix& viewProjection);
+
 		/**
 		 * is aabb out of frustum.
 		 */
@@ -61,20 +104,48 @@ namespace cocos3d
 		 */
         bool isOutFrustum(const C3DOBB& obb) const;
 
+		/**
+		 * is aabb totally inside frustum.
+		 */
+        bool isInFrustum(const C3DAABB& aabb) const;
+
+        /**
+         * Culls all the boxes of the array at once, 4 or 8 boxes per instruction depending
+         * on the cpu. The bit i % 32 of visibility[i / 32] is set when the box i is visible.
+         *
+         * @param visibility Resized to (boxes.size() + 31) / 32 words.
+         */
+        void cullBoxes(const C3DBoxArray& boxes, std::vector<unsigned int>& visibility) const;
+
 		/**
 		 * get & set z clip. if bclipZ == true use near and far plane
 		 */
         void setClipZ(bool bclipZ) { _bClipZ = bclipZ; }
         bool isClipZ() { return _bClipZ; }
 
+		/**
+		 * get & set near clip. if bclipNear == false the frustum is open toward its origin,
+		 * only the far plane clips z
+		 */
+        void setClipNear(bool bclipNear) { _bClipNear = bclipNear; }
+        bool isClipNear() { return _bClipNear; }
+
     protected:
 		/**
 		 * create clip plane
 		 */
         void createPlane(C3DCamera* pcamera);
+        void createPlane(const C3DMatrix& mat);
+
+		/**
+		 * number of planes to test, the near plane is the last one so it can be left out
+		 */
+        int getPlaneCount() const { return _bClipZ ? (_bClipNear ? 6 : 5) : 4; }
 
-        C3DPlane _plane[6];// clip plane, left, right, top, bottom, near, far
+        C3DPlane _plane[6];// clip plane, left, right, bottom, top, far, near
+        float _planeData[24];// the planes packed for cullBoxes, normal & distance
         bool _bClipZ;//use near and far clip plane
+        bool _bClipNear;//use near clip plane, only when _bClipZ
         bool _bInit;
     };
 }
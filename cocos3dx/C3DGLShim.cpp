@@ -0,0 +1,1310 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+// this file calls the real GL functions, keep the shim macros out of it
+#define C3D_GL_SHIM_IMPL
+#include "Base.h"
+
+#if defined(C3D_GL_RECORD) || defined(C3D_GL_NULL)
+#include "C3DGLShim.h"
+
+namespace cocos3d
+{
+// Argument formats of the logged calls:
+//   e enum, i int, f float, b boolean, p pointer or offset,
+//   names of GL objects: B buffer, T texture, F framebuffer, R renderbuffer, V vertex array, S shader, P program
+struct C3DGLOpInfo
+{
+    const char* name;
+    const char* format;
+    C3DGLShim::Counter counter;
+};
+
+static const C3DGLOpInfo __opInfos[C3DGLShim::OP_NUM] =
+{
+    { "glActiveTexture",            "e",        C3DGLShim::COUNT_STATE },
+    { "glAttachShader",             "PS",       C3DGLShim::COUNT_OBJECT },
+    { "glBindBuffer",               "eB",       C3DGLShim::COUNT_STATE },
+    { "glBindFramebuffer",          "eF",       C3DGLShim::COUNT_STATE },
+    { "glBindRenderbuffer",         "eR",       C3DGLShim::COUNT_STATE },
+    { "glBindTexture",              "eT",       C3DGLShim::COUNT_STATE },
+    { "glBindVertexArray",          "V",        C3DGLShim::COUNT_STATE },
+    { "glBlendFunc",                "ee",       C3DGLShim::COUNT_STATE },
+    { "glBufferData",               "eie",      C3DGLShim::COUNT_BUFFER_UPLOAD },
+    { "glBufferSubData",            "eii",      C3DGLShim::COUNT_BUFFER_UPLOAD },
+    { "glClear",                    "e",        C3DGLShim::COUNT_CLEAR },
+    { "glClearColor",               "ffff",     C3DGLShim::COUNT_STATE },
+    { "glClearDepth",               "f",        C3DGLShim::COUNT_STATE },
+    { "glClearStencil",             "i",        C3DGLShim::COUNT_STATE },
+    { "glCompileShader",            "S",        C3DGLShim::COUNT_OBJECT },
+    { "glCreateProgram",            "P",        C3DGLShim::COUNT_OBJECT },
+    { "glCreateShader",             "eS",       C3DGLShim::COUNT_OBJECT },
+    { "glDeleteBuffers",            "i",        C3DGLShim::COUNT_OBJECT },
+    { "glDeleteFramebuffers",       "i",        C3DGLShim::COUNT_OBJECT },
+    { "glDeleteProgram",            "P",        C3DGLShim::COUNT_OBJECT },
+    { "glDeleteShader",             "S",        C3DGLShim::COUNT_OBJECT },
+    { "glDeleteTextures",           "i",        C3DGLShim::COUNT_OBJECT },
+    { "glDeleteVertexArrays",       "i",        C3DGLShim::COUNT_OBJECT },
+    { "glDepthMask",                "b",        C3DGLShim::COUNT_STATE },
+    { "glDisable",                  "e",        C3DGLShim::COUNT_STATE },
+    { "glDisableVertexAttribArray", "i",        C3DGLShim::COUNT_STATE },
+    { "glDrawArrays",               "eii",      C3DGLShim::COUNT_DRAW },
+    { "glDrawElements",             "eiep",     C3DGLShim::COUNT_DRAW },
+    { "glDrawElementsInstanced",    "eiepi",    C3DGLShim::COUNT_DRAW },
+    { "glEnable",                   "e",        C3DGLShim::COUNT_STATE },
+    { "glEnableVertexAttribArray",  "i",        C3DGLShim::COUNT_STATE },
+    { "glFramebufferRenderbuffer",  "eeeR",     C3DGLShim::COUNT_STATE },
+    { "glFramebufferTexture2D",     "eeeTi",    C3DGLShim::COUNT_STATE },
+    { "glGenBuffers",               "i",        C3DGLShim::COUNT_OBJECT },
+    { "glGenFramebuffers",          "i",        C3DGLShim::COUNT_OBJECT },
+    { "glGenRenderbuffers",         "i",        C3DGLShim::COUNT_OBJECT },
+    { "glGenTextures",              "i",        C3DGLShim::COUNT_OBJECT },
+    { "glGenVertexArrays",          "i",        C3DGLShim::COUNT_OBJECT },
+    { "glGenerateMipmap",           "e",        C3DGLShim::COUNT_TEXTURE_UPLOAD },
+    { "glLinkProgram",              "P",        C3DGLShim::COUNT_OBJECT },
+    { "glProgramBinary",            "Pei",      C3DGLShim::COUNT_OBJECT },
+    { "glProgramParameteri",        "Pei",      C3DGLShim::COUNT_STATE },
+    { "glRenderbufferStorage",      "eeii",     C3DGLShim::COUNT_OBJECT },
+    { "glScissor",                  "iiii",     C3DGLShim::COUNT_STATE },
+    { "glShaderSource",             "Si",       C3DGLShim::COUNT_OBJECT },
+    { "glTexImage2D",               "eieiiiee", C3DGLShim::COUNT_TEXTURE_UPLOAD },
+    { "glTexParameteri",            "eee",      C3DGLShim::COUNT_STATE },
+    { "glUniform1f",                "if",       C3DGLShim::COUNT_UNIFORM },
+    { "glUniform1fv",               "ii",       C3DGLShim::COUNT_UNIFORM },
+    { "glUniform1i",                "ii",       C3DGLShim::COUNT_UNIFORM },
+    { "glUniform1iv",               "ii",       C3DGLShim::COUNT_UNIFORM },
+    { "glUniform2f",                "iff",      C3DGLShim::COUNT_UNIFORM },
+    { "glUniform2fv",               "ii",       C3DGLShim::COUNT_UNIFORM },
+    { "glUniform3f",                "ifff",     C3DGLShim::COUNT_UNIFORM },
+    { "glUniform3fv",               "ii",       C3DGLShim::COUNT_UNIFORM },
+    { "glUniform4f",                "iffff",    C3DGLShim::COUNT_UNIFORM },
+    { "glUniform4fv",               "ii",       C3DGLShim::COUNT_UNIFORM },
+    { "glUniformMatrix4fv",         "iib",      C3DGLShim::COUNT_UNIFORM },
+    { "glUseProgram",               "P",        C3DGLShim::COUNT_STATE },
+    { "glVertexAttribDivisor",      "ii",       C3DGLShim::COUNT_STATE },
+    { "glVertexAttribPointer",      "iiebip",   C3DGLShim::COUNT_STATE },
+    { "glViewport",                 "iiii",     C3DGLShim::COUNT_STATE },
+};
+
+static unsigned int __counters[C3DGLShim::COUNTER_NUM] = { 0 };
+static unsigned int __bufferUploadBytes = 0;
+
+static bool __recording = false;
+static std::vector<C3DGLCommand> __commands;
+static std::vector<unsigned char> __commandData;
+
+// names of the objects created by the log, recorded name -> name created by the replay
+enum
+{
+    NAME_BUFFER = 0,
+    NAME_TEXTURE,
+    NAME_FRAMEBUFFER,
+    NAME_RENDERBUFFER,
+    NAME_VERTEX_ARRAY,
+    NAME_SHADER,
+    NAME_PROGRAM,
+    NAME_KIND_NUM
+};
+static std::map<GLuint, GLuint> __replayNames[NAME_KIND_NUM];
+static bool __replaying = false;
+
+#ifdef C3D_GL_NULL
+// the little state the engine reads back from GL
+static struct
+{
+    GLuint nextName;
+    GLint activeTexture;
+    GLint textureBinding2D;
+    GLint framebufferBinding;
+    GLint renderbufferBinding;
+    GLint viewport[4];
+    GLint blendSrc;
+    GLint blendDst;
+    GLint depthWriteMask;
+    std::set<GLenum> enabledCaps;
+} __nullState = { 1, GL_TEXTURE0, 0, 0, 0, { 0, 0, 0, 0 }, GL_ONE, GL_ZERO, GL_TRUE };
+#endif
+
+static int getNameKind(char format)
+{
+    switch (format)
+    {
+    case 'B': return NAME_BUFFER;
+    case 'T': return NAME_TEXTURE;
+    case 'F': return NAME_FRAMEBUFFER;
+    case 'R': return NAME_RENDERBUFFER;
+    case 'V': return NAME_VERTEX_ARRAY;
+    case 'S': return NAME_SHADER;
+    case 'P': return NAME_PROGRAM;
+    default: return -1;
+    }
+}
+
+static int getGenNameKind(unsigned short op)
+{
+    switch (op)
+    {
+    case C3DGLShim::OP_GEN_BUFFERS:
+    case C3DGLShim::OP_DELETE_BUFFERS:
+        return NAME_BUFFER;
+    case C3DGLShim::OP_GEN_TEXTURES:
+    case C3DGLShim::OP_DELETE_TEXTURES:
+        return NAME_TEXTURE;
+    case C3DGLShim::OP_GEN_FRAMEBUFFERS:
+    case C3DGLShim::OP_DELETE_FRAMEBUFFERS:
+        return NAME_FRAMEBUFFER;
+    case C3DGLShim::OP_GEN_RENDERBUFFERS:
+        return NAME_RENDERBUFFER;
+    case C3DGLShim::OP_GEN_VERTEX_ARRAYS:
+    case C3DGLShim::OP_DELETE_VERTEX_ARRAYS:
+        return NAME_VERTEX_ARRAY;
+    default:
+        return -1;
+    }
+}
+
+static GLuint getReplayName(int kind, GLuint name)
+{
+    std::map<GLuint, GLuint>::const_iterator itr = __replayNames[kind].find(name);
+    return itr == __replayNames[kind].end() ? name : itr->second;
+}
+
+static unsigned int getPixelSize(GLenum format, GLenum type)
+{
+    switch (type)
+    {
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+    case GL_UNSIGNED_SHORT_5_6_5:
+        return 2;
+    default:
+        break;
+    }
+
+    unsigned int components;
+    switch (format)
+    {
+    case GL_RGBA:
+        components = 4;
+        break;
+    case GL_RGB:
+        components = 3;
+        break;
+    case GL_LUMINANCE_ALPHA:
+        components = 2;
+        break;
+    default:
+        components = 1;
+        break;
+    }
+
+    switch (type)
+    {
+    case GL_UNSIGNED_SHORT:
+        return components * 2;
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        return components * 4;
+    default:
+        return components;
+    }
+}
+
+static C3DGLCommand makeCommand(C3DGLShim::Op op)
+{
+    C3DGLCommand command;
+    memset(&command, 0, sizeof(command));
+    command.op = op;
+    return command;
+}
+
+// executes the command on GL, names are already translated
+static void execute(const C3DGLCommand& cmd, const unsigned char* data)
+{
+#ifndef C3D_GL_NULL
+    const C3DGLCommand::Arg* a = cmd.args;
+    switch (cmd.op)
+    {
+    case C3DGLShim::OP_ACTIVE_TEXTURE: glActiveTexture(a[0].u); break;
+    case C3DGLShim::OP_ATTACH_SHADER: glAttachShader(a[0].u, a[1].u); break;
+    case C3DGLShim::OP_BIND_BUFFER: glBindBuffer(a[0].u, a[1].u); break;
+    case C3DGLShim::OP_BIND_FRAMEBUFFER: glBindFramebuffer(a[0].u, a[1].u); break;
+    case C3DGLShim::OP_BIND_RENDERBUFFER: glBindRenderbuffer(a[0].u, a[1].u); break;
+    case C3DGLShim::OP_BIND_TEXTURE: glBindTexture(a[0].u, a[1].u); break;
+    case C3DGLShim::OP_BIND_VERTEX_ARRAY: glBindVertexArray(a[0].u); break;
+    case C3DGLShim::OP_BLEND_FUNC: glBlendFunc(a[0].u, a[1].u); break;
+    case C3DGLShim::OP_BUFFER_DATA: glBufferData(a[0].u, a[1].p, cmd.dataSize ? data : NULL, a[2].u); break;
+    case C3DGLShim::OP_BUFFER_SUB_DATA: glBufferSubData(a[0].u, a[1].p, a[2].p, data); break;
+    case C3DGLShim::OP_CLEAR: glClear(a[0].u); break;
+    case C3DGLShim::OP_CLEAR_COLOR: glClearColor(a[0].f, a[1].f, a[2].f, a[3].f); break;
+    case C3DGLShim::OP_CLEAR_DEPTH: glClearDepth(a[0].f); break;
+    case C3DGLShim::OP_CLEAR_STENCIL: glClearStencil(a[0].i); break;
+    case C3DGLShim::OP_COMPILE_SHADER: glCompileShader(a[0].u); break;
+    case C3DGLShim::OP_DELETE_PROGRAM: glDeleteProgram(a[0].u); break;
+    case C3DGLShim::OP_DELETE_SHADER: glDeleteShader(a[0].u); break;
+    case C3DGLShim::OP_DELETE_BUFFERS: glDeleteBuffers(a[0].i, (const GLuint*)data); break;
+    case C3DGLShim::OP_DELETE_FRAMEBUFFERS: glDeleteFramebuffers(a[0].i, (const GLuint*)data); break;
+    case C3DGLShim::OP_DELETE_TEXTURES: glDeleteTextures(a[0].i, (const GLuint*)data); break;
+    case C3DGLShim::OP_DELETE_VERTEX_ARRAYS: glDeleteVertexArrays(a[0].i, (const GLuint*)data); break;
+    case C3DGLShim::OP_DEPTH_MASK: glDepthMask((GLboolean)a[0].u); break;
+    case C3DGLShim::OP_DISABLE: glDisable(a[0].u); break;
+    case C3DGLShim::OP_DISABLE_VERTEX_ATTRIB_ARRAY: glDisableVertexAttribArray(a[0].u); break;
+    case C3DGLShim::OP_DRAW_ARRAYS: glDrawArrays(a[0].u, a[1].i, a[2].i); break;
+    case C3DGLShim::OP_DRAW_ELEMENTS: glDrawElements(a[0].u, a[1].i, a[2].u, (const GLvoid*)a[3].p); break;
+    case C3DGLShim::OP_DRAW_ELEMENTS_INSTANCED: glDrawElementsInstanced(a[0].u, a[1].i, a[2].u, (const GLvoid*)a[3].p, a[4].i); break;
+    case C3DGLShim::OP_ENABLE: glEnable(a[0].u); break;
+    case C3DGLShim::OP_ENABLE_VERTEX_ATTRIB_ARRAY: glEnableVertexAttribArray(a[0].u); break;
+    case C3DGLShim::OP_FRAMEBUFFER_RENDERBUFFER: glFramebufferRenderbuffer(a[0].u, a[1].u, a[2].u, a[3].u); break;
+    case C3DGLShim::OP_FRAMEBUFFER_TEXTURE_2D: glFramebufferTexture2D(a[0].u, a[1].u, a[2].u, a[3].u, a[4].i); break;
+    case C3DGLShim::OP_GENERATE_MIPMAP: glGenerateMipmap(a[0].u); break;
+    case C3DGLShim::OP_LINK_PROGRAM: glLinkProgram(a[0].u); break;
+#ifdef USE_PROGRAM_BINARY
+    case C3DGLShim::OP_PROGRAM_BINARY: glProgramBinary(a[0].u, a[1].u, data, a[2].i); break;
+#endif
+#if defined(USE_PROGRAM_BINARY) && defined(GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+    case C3DGLShim::OP_PROGRAM_PARAMETER_I: glProgramParameteri(a[0].u, a[1].u, a[2].i); break;
+#endif
+    case C3DGLShim::OP_RENDERBUFFER_STORAGE: glRenderbufferStorage(a[0].u, a[1].u, a[2].i, a[3].i); break;
+    case C3DGLShim::OP_SCISSOR: glScissor(a[0].i, a[1].i, a[2].i, a[3].i); break;
+    case C3DGLShim::OP_SHADER_SOURCE:
+        {
+            // data holds the strings one after the other, each one null terminated
+            std::vector<const GLchar*> strings;
+            const GLchar* str = (const GLchar*)data;
+            for (int i = 0; i < a[1].i; i++)
+            {
+                strings.push_back(str);
+                str += strlen(str) + 1;
+            }
+            glShaderSource(a[0].u, a[1].i, strings.empty() ? NULL : &strings[0], NULL);
+        }
+        break;
+    case C3DGLShim::OP_TEX_IMAGE_2D:
+        // the pixels were copied tightly packed
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(a[0].u, a[1].i, a[2].i, a[3].i, a[4].i, a[5].i, a[6].u, a[7].u, cmd.dataSize ? data : NULL);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        break;
+    case C3DGLShim::OP_TEX_PARAMETER_I: glTexParameteri(a[0].u, a[1].u, a[2].i); break;
+    case C3DGLShim::OP_UNIFORM_1F: glUniform1f(a[0].i, a[1].f); break;
+    case C3DGLShim::OP_UNIFORM_1FV: glUniform1fv(a[0].i, a[1].i, (const GLfloat*)data); break;
+    case C3DGLShim::OP_UNIFORM_1I: glUniform1i(a[0].i, a[1].i); break;
+    case C3DGLShim::OP_UNIFORM_1IV: glUniform1iv(a[0].i, a[1].i, (const GLint*)data); break;
+    case C3DGLShim::OP_UNIFORM_2F: glUniform2f(a[0].i, a[1].f, a[2].f); break;
+    case C3DGLShim::OP_UNIFORM_2FV: glUniform2fv(a[0].i, a[1].i, (const GLfloat*)data); break;
+    case C3DGLShim::OP_UNIFORM_3F: glUniform3f(a[0].i, a[1].f, a[2].f, a[3].f); break;
+    case C3DGLShim::OP_UNIFORM_3FV: glUniform3fv(a[0].i, a[1].i, (const GLfloat*)data); break;
+    case C3DGLShim::OP_UNIFORM_4F: glUniform4f(a[0].i, a[1].f, a[2].f, a[3].f, a[4].f); break;
+    case C3DGLShim::OP_UNIFORM_4FV: glUniform4fv(a[0].i, a[1].i, (const GLfloat*)data); break;
+    case C3DGLShim::OP_UNIFORM_MATRIX_4FV: glUniformMatrix4fv(a[0].i, a[1].i, (GLboolean)a[2].u, (const GLfloat*)data); break;
+    case C3DGLShim::OP_USE_PROGRAM: glUseProgram(a[0].u); break;
+    case C3DGLShim::OP_VERTEX_ATTRIB_DIVISOR: glVertexAttribDivisor(a[0].u, a[1].u); break;
+    case C3DGLShim::OP_VERTEX_ATTRIB_POINTER: glVertexAttribPointer(a[0].u, a[1].i, a[2].u, (GLboolean)a[3].u, a[4].i, (const GLvoid*)a[5].p); break;
+    case C3DGLShim::OP_VIEWPORT: glViewport(a[0].i, a[1].i, a[2].i, a[3].i); break;
+    default:
+        // creation is handled by the callers
+        break;
+    }
+#else
+    const C3DGLCommand::Arg* a = cmd.args;
+    switch (cmd.op)
+    {
+    case C3DGLShim::OP_ACTIVE_TEXTURE: __nullState.activeTexture = a[0].i; break;
+    case C3DGLShim::OP_BIND_FRAMEBUFFER: __nullState.framebufferBinding = a[1].i; break;
+    case C3DGLShim::OP_BIND_RENDERBUFFER: __nullState.renderbufferBinding = a[1].i; break;
+    case C3DGLShim::OP_BIND_TEXTURE:
+        if (a[0].u == GL_TEXTURE_2D)
+            __nullState.textureBinding2D = a[1].i;
+        break;
+    case C3DGLShim::OP_BLEND_FUNC: __nullState.blendSrc = a[0].i; __nullState.blendDst = a[1].i; break;
+    case C3DGLShim::OP_DEPTH_MASK: __nullState.depthWriteMask = a[0].i; break;
+    case C3DGLShim::OP_DISABLE: __nullState.enabledCaps.erase(a[0].u); break;
+    case C3DGLShim::OP_ENABLE: __nullState.enabledCaps.insert(a[0].u); break;
+    case C3DGLShim::OP_VIEWPORT:
+        for (int i = 0; i < 4; i++)
+            __nullState.viewport[i] = a[i].i;
+        break;
+    default:
+        break;
+    }
+#endif
+}
+
+// counts, logs and executes a call
+static void submit(C3DGLCommand& command, const void* data, unsigned int size)
+{
+    __counters[__opInfos[command.op].counter]++;
+    if (command.op == C3DGLShim::OP_BUFFER_DATA || command.op == C3DGLShim::OP_BUFFER_SUB_DATA)
+        __bufferUploadBytes += size;
+
+    if (__recording && !__replaying)
+    {
+        command.dataOffset = (unsigned int)__commandData.size();
+        command.dataSize = data ? size : 0;
+        if (command.dataSize)
+        {
+            const unsigned char* bytes = (const unsigned char*)data;
+            __commandData.insert(__commandData.end(), bytes, bytes + size);
+        }
+        __commands.push_back(command);
+    }
+
+    execute(command, (const unsigned char*)data);
+}
+
+static void genNames(C3DGLShim::Op op, GLsizei n, GLuint* names)
+{
+#ifndef C3D_GL_NULL
+    switch (op)
+    {
+    case C3DGLShim::OP_GEN_BUFFERS: glGenBuffers(n, names); break;
+    case C3DGLShim::OP_GEN_FRAMEBUFFERS: glGenFramebuffers(n, names); break;
+    case C3DGLShim::OP_GEN_RENDERBUFFERS: glGenRenderbuffers(n, names); break;
+    case C3DGLShim::OP_GEN_TEXTURES: glGenTextures(n, names); break;
+    case C3DGLShim::OP_GEN_VERTEX_ARRAYS: glGenVertexArrays(n, names); break;
+    default: break;
+    }
+#else
+    for (GLsizei i = 0; i < n; i++)
+        names[i] = __nullState.nextName++;
+#endif
+}
+
+static GLuint createObject(C3DGLShim::Op op, GLenum type)
+{
+#ifndef C3D_GL_NULL
+    return op == C3DGLShim::OP_CREATE_PROGRAM ? glCreateProgram() : glCreateShader(type);
+#else
+    return __nullState.nextName++;
+#endif
+}
+
+static void submitGen(C3DGLShim::Op op, GLsizei n, GLuint* names)
+{
+    genNames(op, n, names);
+
+    C3DGLCommand command = makeCommand(op);
+    command.args[0].i = n;
+    submit(command, names, sizeof(GLuint) * n);
+}
+
+static void submitDelete(C3DGLShim::Op op, GLsizei n, const GLuint* names)
+{
+    C3DGLCommand command = makeCommand(op);
+    command.args[0].i = n;
+    submit(command, names, sizeof(GLuint) * n);
+}
+
+static void countQuery()
+{
+    __counters[C3DGLShim::COUNT_QUERY]++;
+}
+
+unsigned int C3DGLShim::getCount(Counter counter)
+{
+    return __counters[counter];
+}
+
+unsigned int C3DGLShim::getBufferUploadBytes()
+{
+    return __bufferUploadBytes;
+}
+
+void C3DGLShim::resetCounters()
+{
+    memset(__counters, 0, sizeof(__counters));
+    __bufferUploadBytes = 0;
+}
+
+void C3DGLShim::setRecording(bool recording)
+{
+    __recording = recording;
+}
+
+bool C3DGLShim::isRecording()
+{
+    return __recording;
+}
+
+const std::vector<C3DGLCommand>& C3DGLShim::getCommands()
+{
+    return __commands;
+}
+
+const unsigned char* C3DGLShim::getCommandData(const C3DGLCommand& command)
+{
+    return command.dataSize ? &__commandData[command.dataOffset] : NULL;
+}
+
+void C3DGLShim::clearCommands()
+{
+    __commands.clear();
+    __commandData.clear();
+}
+
+const char* C3DGLShim::getOpName(Op op)
+{
+    return op < OP_NUM ? __opInfos[op].name : "";
+}
+
+void C3DGLShim::dump(FILE* file)
+{
+    for (size_t i = 0; i < __commands.size(); i++)
+    {
+        const C3DGLCommand& command = __commands[i];
+        const C3DGLOpInfo& info = __opInfos[command.op];
+
+        fprintf(file, "%s(", info.name);
+        for (int j = 0; info.format[j]; j++)
+        {
+            const C3DGLCommand::Arg& arg = command.args[j];
+            if (j > 0)
+                fprintf(file, ", ");
+
+            switch (info.format[j])
+            {
+            case 'e': fprintf(file, "0x%x", arg.u); break;
+            case 'f': fprintf(file, "%g", arg.f); break;
+            case 'b': fprintf(file, "%s", arg.u ? "GL_TRUE" : "GL_FALSE"); break;
+            case 'p': fprintf(file, "%p", (void*)arg.p); break;
+            case 'i': fprintf(file, "%d", arg.i); break;
+            default: fprintf(file, "%u", arg.u); break;
+            }
+        }
+        fprintf(file, ")");
+
+        if (command.dataSize)
+            fprintf(file, " [%u bytes]", command.dataSize);
+        fprintf(file, "\n");
+    }
+}
+
+void C3DGLShim::replay()
+{
+    for (int i = 0; i < NAME_KIND_NUM; i++)
+    {
+        __replayNames[i].clear();
+    }
+
+    __replaying = true;
+    for (size_t i = 0; i < __commands.size(); i++)
+    {
+        C3DGLCommand command = __commands[i];
+        const unsigned char* data = getCommandData(command);
+
+        int genKind = getGenNameKind(command.op);
+        switch (command.op)
+        {
+        case OP_GEN_BUFFERS:
+        case OP_GEN_FRAMEBUFFERS:
+        case OP_GEN_RENDERBUFFERS:
+        case OP_GEN_TEXTURES:
+        case OP_GEN_VERTEX_ARRAYS:
+            {
+                std::vector<GLuint> names(command.args[0].i);
+                genNames((Op)command.op, command.args[0].i, &names[0]);
+                for (int j = 0; j < command.args[0].i; j++)
+                {
+                    __replayNames[genKind][((const GLuint*)data)[j]] = names[j];
+                }
+                __counters[COUNT_OBJECT]++;
+            }
+            continue;
+
+        case OP_CREATE_PROGRAM:
+            __replayNames[NAME_PROGRAM][command.args[0].u] = createObject(OP_CREATE_PROGRAM, 0);
+            __counters[COUNT_OBJECT]++;
+            continue;
+
+        case OP_CREATE_SHADER:
+            __replayNames[NAME_SHADER][command.args[1].u] = createObject(OP_CREATE_SHADER, command.args[0].u);
+            __counters[COUNT_OBJECT]++;
+            continue;
+
+        default:
+            break;
+        }
+
+        // translate the names of the objects created by the replay
+        const char* format = __opInfos[command.op].format;
+        for (int j = 0; format[j]; j++)
+        {
+            int kind = getNameKind(format[j]);
+            if (kind >= 0)
+                command.args[j].u = getReplayName(kind, command.args[j].u);
+        }
+
+        std::vector<GLuint> names;
+        if (genKind >= 0)
+        {
+            // deletions carry their names in the data
+            for (int j = 0; j < command.args[0].i; j++)
+            {
+                names.push_back(getReplayName(genKind, ((const GLuint*)data)[j]));
+            }
+            data = names.empty() ? NULL : (const unsigned char*)&names[0];
+        }
+
+        submit(command, data, command.dataSize);
+    }
+    __replaying = false;
+}
+}
+
+using namespace cocos3d;
+
+void c3dglActiveTexture(GLenum texture)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_ACTIVE_TEXTURE);
+    command.args[0].u = texture;
+    submit(command, NULL, 0);
+}
+
+void c3dglAttachShader(GLuint program, GLuint shader)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_ATTACH_SHADER);
+    command.args[0].u = program;
+    command.args[1].u = shader;
+    submit(command, NULL, 0);
+}
+
+void c3dglBindBuffer(GLenum target, GLuint buffer)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BIND_BUFFER);
+    command.args[0].u = target;
+    command.args[1].u = buffer;
+    submit(command, NULL, 0);
+}
+
+void c3dglBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BIND_FRAMEBUFFER);
+    command.args[0].u = target;
+    command.args[1].u = framebuffer;
+    submit(command, NULL, 0);
+}
+
+void c3dglBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BIND_RENDERBUFFER);
+    command.args[0].u = target;
+    command.args[1].u = renderbuffer;
+    submit(command, NULL, 0);
+}
+
+void c3dglBindTexture(GLenum target, GLuint texture)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BIND_TEXTURE);
+    command.args[0].u = target;
+    command.args[1].u = texture;
+    submit(command, NULL, 0);
+}
+
+void c3dglBindVertexArray(GLuint array)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BIND_VERTEX_ARRAY);
+    command.args[0].u = array;
+    submit(command, NULL, 0);
+}
+
+void c3dglBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BLEND_FUNC);
+    command.args[0].u = sfactor;
+    command.args[1].u = dfactor;
+    submit(command, NULL, 0);
+}
+
+void c3dglBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BUFFER_DATA);
+    command.args[0].u = target;
+    command.args[1].p = size;
+    command.args[2].u = usage;
+    submit(command, data, (unsigned int)size);
+}
+
+void c3dglBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_BUFFER_SUB_DATA);
+    command.args[0].u = target;
+    command.args[1].p = offset;
+    command.args[2].p = size;
+    submit(command, data, (unsigned int)size);
+}
+
+GLenum c3dglCheckFramebufferStatus(GLenum target)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    return glCheckFramebufferStatus(target);
+#else
+    return GL_FRAMEBUFFER_COMPLETE;
+#endif
+}
+
+void c3dglClear(GLbitfield mask)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_CLEAR);
+    command.args[0].u = mask;
+    submit(command, NULL, 0);
+}
+
+void c3dglClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_CLEAR_COLOR);
+    command.args[0].f = red;
+    command.args[1].f = green;
+    command.args[2].f = blue;
+    command.args[3].f = alpha;
+    submit(command, NULL, 0);
+}
+
+void c3dglClearDepth(GLfloat depth)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_CLEAR_DEPTH);
+    command.args[0].f = depth;
+    submit(command, NULL, 0);
+}
+
+void c3dglClearStencil(GLint s)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_CLEAR_STENCIL);
+    command.args[0].i = s;
+    submit(command, NULL, 0);
+}
+
+void c3dglCompileShader(GLuint shader)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_COMPILE_SHADER);
+    command.args[0].u = shader;
+    submit(command, NULL, 0);
+}
+
+GLuint c3dglCreateProgram()
+{
+    GLuint program = createObject(C3DGLShim::OP_CREATE_PROGRAM, 0);
+
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_CREATE_PROGRAM);
+    command.args[0].u = program;
+    submit(command, NULL, 0);
+    return program;
+}
+
+GLuint c3dglCreateShader(GLenum type)
+{
+    GLuint shader = createObject(C3DGLShim::OP_CREATE_SHADER, type);
+
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_CREATE_SHADER);
+    command.args[0].u = type;
+    command.args[1].u = shader;
+    submit(command, NULL, 0);
+    return shader;
+}
+
+void c3dglDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    submitDelete(C3DGLShim::OP_DELETE_BUFFERS, n, buffers);
+}
+
+void c3dglDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    submitDelete(C3DGLShim::OP_DELETE_FRAMEBUFFERS, n, framebuffers);
+}
+
+void c3dglDeleteProgram(GLuint program)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DELETE_PROGRAM);
+    command.args[0].u = program;
+    submit(command, NULL, 0);
+}
+
+void c3dglDeleteShader(GLuint shader)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DELETE_SHADER);
+    command.args[0].u = shader;
+    submit(command, NULL, 0);
+}
+
+void c3dglDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    submitDelete(C3DGLShim::OP_DELETE_TEXTURES, n, textures);
+}
+
+void c3dglDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    submitDelete(C3DGLShim::OP_DELETE_VERTEX_ARRAYS, n, arrays);
+}
+
+void c3dglDepthMask(GLboolean flag)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DEPTH_MASK);
+    command.args[0].u = flag;
+    submit(command, NULL, 0);
+}
+
+void c3dglDisable(GLenum cap)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DISABLE);
+    command.args[0].u = cap;
+    submit(command, NULL, 0);
+}
+
+void c3dglDisableVertexAttribArray(GLuint index)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DISABLE_VERTEX_ATTRIB_ARRAY);
+    command.args[0].u = index;
+    submit(command, NULL, 0);
+}
+
+void c3dglDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DRAW_ARRAYS);
+    command.args[0].u = mode;
+    command.args[1].i = first;
+    command.args[2].i = count;
+    submit(command, NULL, 0);
+}
+
+void c3dglDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DRAW_ELEMENTS);
+    command.args[0].u = mode;
+    command.args[1].i = count;
+    command.args[2].u = type;
+    command.args[3].p = (intptr_t)indices;
+    submit(command, NULL, 0);
+}
+
+void c3dglDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei primcount)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_DRAW_ELEMENTS_INSTANCED);
+    command.args[0].u = mode;
+    command.args[1].i = count;
+    command.args[2].u = type;
+    command.args[3].p = (intptr_t)indices;
+    command.args[4].i = primcount;
+    submit(command, NULL, 0);
+}
+
+void c3dglEnable(GLenum cap)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_ENABLE);
+    command.args[0].u = cap;
+    submit(command, NULL, 0);
+}
+
+void c3dglEnableVertexAttribArray(GLuint index)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_ENABLE_VERTEX_ATTRIB_ARRAY);
+    command.args[0].u = index;
+    submit(command, NULL, 0);
+}
+
+void c3dglFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_FRAMEBUFFER_RENDERBUFFER);
+    command.args[0].u = target;
+    command.args[1].u = attachment;
+    command.args[2].u = renderbuffertarget;
+    command.args[3].u = renderbuffer;
+    submit(command, NULL, 0);
+}
+
+void c3dglFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_FRAMEBUFFER_TEXTURE_2D);
+    command.args[0].u = target;
+    command.args[1].u = attachment;
+    command.args[2].u = textarget;
+    command.args[3].u = texture;
+    command.args[4].i = level;
+    submit(command, NULL, 0);
+}
+
+void c3dglGenBuffers(GLsizei n, GLuint* buffers)
+{
+    submitGen(C3DGLShim::OP_GEN_BUFFERS, n, buffers);
+}
+
+void c3dglGenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    submitGen(C3DGLShim::OP_GEN_FRAMEBUFFERS, n, framebuffers);
+}
+
+void c3dglGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+    submitGen(C3DGLShim::OP_GEN_RENDERBUFFERS, n, renderbuffers);
+}
+
+void c3dglGenTextures(GLsizei n, GLuint* textures)
+{
+    submitGen(C3DGLShim::OP_GEN_TEXTURES, n, textures);
+}
+
+void c3dglGenVertexArrays(GLsizei n, GLuint* arrays)
+{
+    submitGen(C3DGLShim::OP_GEN_VERTEX_ARRAYS, n, arrays);
+}
+
+void c3dglGenerateMipmap(GLenum target)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_GENERATE_MIPMAP);
+    command.args[0].u = target;
+    submit(command, NULL, 0);
+}
+
+void c3dglGetActiveAttrib(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetActiveAttrib(program, index, bufsize, length, size, type, name);
+#else
+    if (length) *length = 0;
+    if (size) *size = 0;
+    if (type) *type = GL_FLOAT;
+    if (name && bufsize > 0) name[0] = '\0';
+#endif
+}
+
+void c3dglGetActiveUniform(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetActiveUniform(program, index, bufsize, length, size, type, name);
+#else
+    if (length) *length = 0;
+    if (size) *size = 0;
+    if (type) *type = GL_FLOAT;
+    if (name && bufsize > 0) name[0] = '\0';
+#endif
+}
+
+GLint c3dglGetAttribLocation(GLuint program, const GLchar* name)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    return glGetAttribLocation(program, name);
+#else
+    return -1;
+#endif
+}
+
+GLenum c3dglGetError()
+{
+#ifndef C3D_GL_NULL
+    return glGetError();
+#else
+    return GL_NO_ERROR;
+#endif
+}
+
+void c3dglGetFloatv(GLenum pname, GLfloat* params)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetFloatv(pname, params);
+#else
+    params[0] = 0.0f;
+#endif
+}
+
+void c3dglGetIntegerv(GLenum pname, GLint* params)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetIntegerv(pname, params);
+#else
+    switch (pname)
+    {
+    case GL_ACTIVE_TEXTURE: params[0] = __nullState.activeTexture; break;
+    case GL_TEXTURE_BINDING_2D: params[0] = __nullState.textureBinding2D; break;
+    case GL_FRAMEBUFFER_BINDING: params[0] = __nullState.framebufferBinding; break;
+    case GL_RENDERBUFFER_BINDING: params[0] = __nullState.renderbufferBinding; break;
+    case GL_BLEND_SRC_ALPHA: params[0] = __nullState.blendSrc; break;
+    case GL_BLEND_DST_ALPHA: params[0] = __nullState.blendDst; break;
+    case GL_DEPTH_WRITEMASK: params[0] = __nullState.depthWriteMask; break;
+    case GL_MAX_VERTEX_ATTRIBS: params[0] = 16; break;
+    case GL_MAX_TEXTURE_IMAGE_UNITS: params[0] = 16; break;
+    case GL_MAX_TEXTURE_SIZE: params[0] = 4096; break;
+#ifdef GL_NUM_PROGRAM_BINARY_FORMATS
+    // no binary can be saved, the program binary cache stays off
+    case GL_NUM_PROGRAM_BINARY_FORMATS: params[0] = 0; break;
+#endif
+    case GL_VIEWPORT:
+        for (int i = 0; i < 4; i++)
+            params[i] = __nullState.viewport[i];
+        break;
+    default:
+        params[0] = 0;
+        break;
+    }
+#endif
+}
+
+void c3dglGetProgramBinary(GLuint program, GLsizei bufsize, GLsizei* length, GLenum* binaryFormat, GLvoid* binary)
+{
+    countQuery();
+#if !defined(C3D_GL_NULL) && defined(USE_PROGRAM_BINARY)
+    glGetProgramBinary(program, bufsize, length, binaryFormat, binary);
+#else
+    if (length) *length = 0;
+    *binaryFormat = 0;
+#endif
+}
+
+void c3dglGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetProgramInfoLog(program, bufsize, length, infolog);
+#else
+    if (length) *length = 0;
+    if (infolog && bufsize > 0) infolog[0] = '\0';
+#endif
+}
+
+void c3dglGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetProgramiv(program, pname, params);
+#else
+    params[0] = pname == GL_LINK_STATUS ? GL_TRUE : 0;
+#endif
+}
+
+void c3dglGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetShaderInfoLog(shader, bufsize, length, infolog);
+#else
+    if (length) *length = 0;
+    if (infolog && bufsize > 0) infolog[0] = '\0';
+#endif
+}
+
+void c3dglGetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetShaderiv(shader, pname, params);
+#else
+    params[0] = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+#endif
+}
+
+const GLubyte* c3dglGetString(GLenum name)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    return glGetString(name);
+#else
+    switch (name)
+    {
+    case GL_VENDOR: return (const GLubyte*)"cocos3d";
+    case GL_RENDERER: return (const GLubyte*)"null";
+    case GL_VERSION: return (const GLubyte*)"2.0";
+    default: return (const GLubyte*)"";
+    }
+#endif
+}
+
+GLint c3dglGetUniformLocation(GLuint program, const GLchar* name)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    return glGetUniformLocation(program, name);
+#else
+    return -1;
+#endif
+}
+
+void c3dglGetVertexAttribiv(GLuint index, GLenum pname, GLint* params)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    glGetVertexAttribiv(index, pname, params);
+#else
+    params[0] = 0;
+#endif
+}
+
+GLboolean c3dglIsEnabled(GLenum cap)
+{
+    countQuery();
+#ifndef C3D_GL_NULL
+    return glIsEnabled(cap);
+#else
+    return __nullState.enabledCaps.count(cap) ? GL_TRUE : GL_FALSE;
+#endif
+}
+
+void c3dglLinkProgram(GLuint program)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_LINK_PROGRAM);
+    command.args[0].u = program;
+    submit(command, NULL, 0);
+}
+
+void c3dglProgramBinary(GLuint program, GLenum binaryFormat, const GLvoid* binary, GLint length)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_PROGRAM_BINARY);
+    command.args[0].u = program;
+    command.args[1].u = binaryFormat;
+    command.args[2].i = length;
+    submit(command, binary, length);
+}
+
+void c3dglProgramParameteri(GLuint program, GLenum pname, GLint value)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_PROGRAM_PARAMETER_I);
+    command.args[0].u = program;
+    command.args[1].u = pname;
+    command.args[2].i = value;
+    submit(command, NULL, 0);
+}
+
+void c3dglRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_RENDERBUFFER_STORAGE);
+    command.args[0].u = target;
+    command.args[1].u = internalformat;
+    command.args[2].i = width;
+    command.args[3].i = height;
+    submit(command, NULL, 0);
+}
+
+void c3dglScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_SCISSOR);
+    command.args[0].i = x;
+    command.args[1].i = y;
+    command.args[2].i = width;
+    command.args[3].i = height;
+    submit(command, NULL, 0);
+}
+
+void c3dglShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    // keep the strings null terminated one after the other
+    std::string source;
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (length && length[i] >= 0)
+            source.append(string[i], length[i]);
+        else
+            source.append(string[i]);
+        source.push_back('\0');
+    }
+
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_SHADER_SOURCE);
+    command.args[0].u = shader;
+    command.args[1].i = count;
+
+    // executed with the original strings, the copy is only for the log
+    __counters[C3DGLShim::COUNT_OBJECT]++;
+    if (__recording)
+    {
+        command.dataOffset = (unsigned int)__commandData.size();
+        command.dataSize = (unsigned int)source.size();
+        __commandData.insert(__commandData.end(), source.begin(), source.end());
+        __commands.push_back(command);
+    }
+#ifndef C3D_GL_NULL
+    glShaderSource(shader, count, (const GLchar**)string, length);
+#endif
+}
+
+void c3dglTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_TEX_IMAGE_2D);
+    command.args[0].u = target;
+    command.args[1].i = level;
+    command.args[2].i = internalformat;
+    command.args[3].i = width;
+    command.args[4].i = height;
+    command.args[5].i = border;
+    command.args[6].u = format;
+    command.args[7].u = type;
+
+    // executed with the caller's pixels and unpack alignment, the log keeps a tightly packed copy
+    __counters[C3DGLShim::COUNT_TEXTURE_UPLOAD]++;
+    if (__recording && pixels)
+    {
+        unsigned int size = width * height * getPixelSize(format, type);
+        const unsigned char* bytes = (const unsigned char*)pixels;
+        command.dataOffset = (unsigned int)__commandData.size();
+        command.dataSize = size;
+        __commandData.insert(__commandData.end(), bytes, bytes + size);
+    }
+    if (__recording)
+        __commands.push_back(command);
+#ifndef C3D_GL_NULL
+    glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+#endif
+}
+
+void c3dglTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_TEX_PARAMETER_I);
+    command.args[0].u = target;
+    command.args[1].u = pname;
+    command.args[2].i = param;
+    submit(command, NULL, 0);
+}
+
+void c3dglUniform1f(GLint location, GLfloat x)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_1F);
+    command.args[0].i = location;
+    command.args[1].f = x;
+    submit(command, NULL, 0);
+}
+
+void c3dglUniform1fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_1FV);
+    command.args[0].i = location;
+    command.args[1].i = count;
+    submit(command, v, sizeof(GLfloat) * count);
+}
+
+void c3dglUniform1i(GLint location, GLint x)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_1I);
+    command.args[0].i = location;
+    command.args[1].i = x;
+    submit(command, NULL, 0);
+}
+
+void c3dglUniform1iv(GLint location, GLsizei count, const GLint* v)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_1IV);
+    command.args[0].i = location;
+    command.args[1].i = count;
+    submit(command, v, sizeof(GLint) * count);
+}
+
+void c3dglUniform2f(GLint location, GLfloat x, GLfloat y)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_2F);
+    command.args[0].i = location;
+    command.args[1].f = x;
+    command.args[2].f = y;
+    submit(command, NULL, 0);
+}
+
+void c3dglUniform2fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_2FV);
+    command.args[0].i = location;
+    command.args[1].i = count;
+    submit(command, v, sizeof(GLfloat) * 2 * count);
+}
+
+void c3dglUniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_3F);
+    command.args[0].i = location;
+    command.args[1].f = x;
+    command.args[2].f = y;
+    command.args[3].f = z;
+    submit(command, NULL, 0);
+}
+
+void c3dglUniform3fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_3FV);
+    command.args[0].i = location;
+    command.args[1].i = count;
+    submit(command, v, sizeof(GLfloat) * 3 * count);
+}
+
+void c3dglUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_4F);
+    command.args[0].i = location;
+    command.args[1].f = x;
+    command.args[2].f = y;
+    command.args[3].f = z;
+    command.args[4].f = w;
+    submit(command, NULL, 0);
+}
+
+void c3dglUniform4fv(GLint location, GLsizei count, const GLfloat* v)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_4FV);
+    command.args[0].i = location;
+    command.args[1].i = count;
+    submit(command, v, sizeof(GLfloat) * 4 * count);
+}
+
+void c3dglUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_UNIFORM_MATRIX_4FV);
+    command.args[0].i = location;
+    command.args[1].i = count;
+    command.args[2].u = transpose;
+    submit(command, value, sizeof(GLfloat) * 16 * count);
+}
+
+void c3dglUseProgram(GLuint program)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_USE_PROGRAM);
+    command.args[0].u = program;
+    submit(command, NULL, 0);
+}
+
+void c3dglVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_VERTEX_ATTRIB_DIVISOR);
+    command.args[0].u = index;
+    command.args[1].u = divisor;
+    submit(command, NULL, 0);
+}
+
+void c3dglVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_VERTEX_ATTRIB_POINTER);
+    command.args[0].u = indx;
+    command.args[1].i = size;
+    command.args[2].u = type;
+    command.args[3].u = normalized;
+    command.args[4].i = stride;
+    command.args[5].p = (intptr_t)ptr;
+    submit(command, NULL, 0);
+}
+
+void c3dglViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    C3DGLCommand command = makeCommand(C3DGLShim::OP_VIEWPORT);
+    command.args[0].i = x;
+    command.args[1].i = y;
+    command.args[2].i = width;
+    command.args[3].i = height;
+    submit(command, NULL, 0);
+}
+
+#endif
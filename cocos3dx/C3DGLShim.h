@@ -0,0 +1,357 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef C3DGLSHIM_H_
+#define C3DGLSHIM_H_
+
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * GL call shim, compiled in when C3D_GL_RECORD or C3D_GL_NULL is defined.
+ *
+ * Base.h includes this header after the GL headers, and the macros at the end of
+ * this file route every GL call made by cocos3dx through the shim. cocos2d is not
+ * affected. With C3D_GL_RECORD the calls are counted, logged and forwarded to GL.
+ * With C3D_GL_NULL they are counted and logged but never reach GL, queries return
+ * plausible values, and the engine runs without a GL context.
+ */
+namespace cocos3d
+{
+/**
+ * A recorded GL call. Arrays passed by pointer (buffer, texture and uniform data,
+ * shader sources, generated names) are copied in the data block of the log.
+ * Client side vertex and index pointers are recorded by address.
+ */
+struct C3DGLCommand
+{
+    union Arg
+    {
+        GLint i;
+        GLuint u;
+        GLfloat f;
+        intptr_t p;
+    };
+
+    unsigned short op;              // C3DGLShim::Op
+    Arg args[8];
+    unsigned int dataOffset;
+    unsigned int dataSize;
+};
+
+class C3DGLShim
+{
+public:
+
+    enum Op
+    {
+        OP_ACTIVE_TEXTURE = 0,
+        OP_ATTACH_SHADER,
+        OP_BIND_BUFFER,
+        OP_BIND_FRAMEBUFFER,
+        OP_BIND_RENDERBUFFER,
+        OP_BIND_TEXTURE,
+        OP_BIND_VERTEX_ARRAY,
+        OP_BLEND_FUNC,
+        OP_BUFFER_DATA,
+        OP_BUFFER_SUB_DATA,
+        OP_CLEAR,
+        OP_CLEAR_COLOR,
+        OP_CLEAR_DEPTH,
+        OP_CLEAR_STENCIL,
+        OP_COMPILE_SHADER,
+        OP_CREATE_PROGRAM,
+        OP_CREATE_SHADER,
+        OP_DELETE_BUFFERS,
+        OP_DELETE_FRAMEBUFFERS,
+        OP_DELETE_PROGRAM,
+        OP_DELETE_SHADER,
+        OP_DELETE_TEXTURES,
+        OP_DELETE_VERTEX_ARRAYS,
+        OP_DEPTH_MASK,
+        OP_DISABLE,
+        OP_DISABLE_VERTEX_ATTRIB_ARRAY,
+        OP_DRAW_ARRAYS,
+        OP_DRAW_ELEMENTS,
+        OP_DRAW_ELEMENTS_INSTANCED,
+        OP_ENABLE,
+        OP_ENABLE_VERTEX_ATTRIB_ARRAY,
+        OP_FRAMEBUFFER_RENDERBUFFER,
+        OP_FRAMEBUFFER_TEXTURE_2D,
+        OP_GEN_BUFFERS,
+        OP_GEN_FRAMEBUFFERS,
+        OP_GEN_RENDERBUFFERS,
+        OP_GEN_TEXTURES,
+        OP_GEN_VERTEX_ARRAYS,
+        OP_GENERATE_MIPMAP,
+        OP_LINK_PROGRAM,
+        OP_PROGRAM_BINARY,
+        OP_PROGRAM_PARAMETER_I,
+        OP_RENDERBUFFER_STORAGE,
+        OP_SCISSOR,
+        OP_SHADER_SOURCE,
+        OP_TEX_IMAGE_2D,
+        OP_TEX_PARAMETER_I,
+        OP_UNIFORM_1F,
+        OP_UNIFORM_1FV,
+        OP_UNIFORM_1I,
+        OP_UNIFORM_1IV,
+        OP_UNIFORM_2F,
+        OP_UNIFORM_2FV,
+        OP_UNIFORM_3F,
+        OP_UNIFORM_3FV,
+        OP_UNIFORM_4F,
+        OP_UNIFORM_4FV,
+        OP_UNIFORM_MATRIX_4FV,
+        OP_USE_PROGRAM,
+        OP_VERTEX_ATTRIB_DIVISOR,
+        OP_VERTEX_ATTRIB_POINTER,
+        OP_VIEWPORT,
+
+        OP_NUM
+    };
+
+    enum Counter
+    {
+        COUNT_DRAW = 0,         // draw calls
+        COUNT_STATE,            // state changes, binds included
+        COUNT_UNIFORM,          // uniform uploads
+        COUNT_BUFFER_UPLOAD,    // glBufferData & glBufferSubData
+        COUNT_TEXTURE_UPLOAD,   // glTexImage2D
+        COUNT_OBJECT,           // creation & deletion of GL objects, shader compilation
+        COUNT_CLEAR,
+        COUNT_QUERY,            // glGet*, never logged
+
+        COUNTER_NUM
+    };
+
+    /**
+     * get & reset the call counters.
+     */
+    static unsigned int getCount(Counter counter);
+    static unsigned int getBufferUploadBytes();
+    static void resetCounters();
+
+    /**
+     * Starts or stops logging the calls, counters are always updated.
+     */
+    static void setRecording(bool recording);
+    static bool isRecording();
+
+    static const std::vector<C3DGLCommand>& getCommands();
+    static const unsigned char* getCommandData(const C3DGLCommand& command);
+    static void clearCommands();
+
+    static const char* getOpName(Op op);
+
+    /**
+     * Writes the log as text, one call per line.
+     */
+    static void dump(FILE* file);
+
+    /**
+     * Issues the logged calls again. Objects created in the log are created again and
+     * their new names are used in the calls that follow, other names are kept.
+     * Replayed calls are counted but not logged.
+     */
+    static void replay();
+};
+}
+
+#ifndef C3D_GL_SHIM_IMPL
+
+void c3dglActiveTexture(GLenum texture);
+void c3dglAttachShader(GLuint program, GLuint shader);
+void c3dglBindBuffer(GLenum target, GLuint buffer);
+void c3dglBindFramebuffer(GLenum target, GLuint framebuffer);
+void c3dglBindRenderbuffer(GLenum target, GLuint renderbuffer);
+void c3dglBindTexture(GLenum target, GLuint texture);
+void c3dglBindVertexArray(GLuint array);
+void c3dglBlendFunc(GLenum sfactor, GLenum dfactor);
+void c3dglBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+void c3dglBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+GLenum c3dglCheckFramebufferStatus(GLenum target);
+void c3dglClear(GLbitfield mask);
+void c3dglClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void c3dglClearDepth(GLfloat depth);
+void c3dglClearStencil(GLint s);
+void c3dglCompileShader(GLuint shader);
+GLuint c3dglCreateProgram();
+GLuint c3dglCreateShader(GLenum type);
+void c3dglDeleteBuffers(GLsizei n, const GLuint* buffers);
+void c3dglDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void c3dglDeleteProgram(GLuint program);
+void c3dglDeleteShader(GLuint shader);
+void c3dglDeleteTextures(GLsizei n, const GLuint* textures);
+void c3dglDeleteVertexArrays(GLsizei n, const GLuint* arrays);
+void c3dglDepthMask(GLboolean flag);
+void c3dglDisable(GLenum cap);
+void c3dglDisableVertexAttribArray(GLuint index);
+void c3dglDrawArrays(GLenum mode, GLint first, GLsizei count);
+void c3dglDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+void c3dglDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei primcount);
+void c3dglEnable(GLenum cap);
+void c3dglEnableVertexAttribArray(GLuint index);
+void c3dglFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+void c3dglFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void c3dglGenBuffers(GLsizei n, GLuint* buffers);
+void c3dglGenFramebuffers(GLsizei n, GLuint* framebuffers);
+void c3dglGenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+void c3dglGenTextures(GLsizei n, GLuint* textures);
+void c3dglGenVertexArrays(GLsizei n, GLuint* arrays);
+void c3dglGenerateMipmap(GLenum target);
+void c3dglGetActiveAttrib(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+void c3dglGetActiveUniform(GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+GLint c3dglGetAttribLocation(GLuint program, const GLchar* name);
+GLenum c3dglGetError();
+void c3dglGetFloatv(GLenum pname, GLfloat* params);
+void c3dglGetIntegerv(GLenum pname, GLint* params);
+void c3dglGetProgramBinary(GLuint program, GLsizei bufsize, GLsizei* length, GLenum* binaryFormat, GLvoid* binary);
+void c3dglGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog);
+void c3dglGetProgramiv(GLuint program, GLenum pname, GLint* params);
+void c3dglGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog);
+void c3dglGetShaderiv(GLuint shader, GLenum pname, GLint* params);
+const GLubyte* c3dglGetString(GLenum name);
+GLint c3dglGetUniformLocation(GLuint program, const GLchar* name);
+void c3dglGetVertexAttribiv(GLuint index, GLenum pname, GLint* params);
+GLboolean c3dglIsEnabled(GLenum cap);
+void c3dglLinkProgram(GLuint program);
+void c3dglProgramBinary(GLuint program, GLenum binaryFormat, const GLvoid* binary, GLint length);
+void c3dglProgramParameteri(GLuint program, GLenum pname, GLint value);
+void c3dglRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+void c3dglScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void c3dglShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void c3dglTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels);
+void c3dglTexParameteri(GLenum target, GLenum pname, GLint param);
+void c3dglUniform1f(GLint location, GLfloat x);
+void c3dglUniform1fv(GLint location, GLsizei count, const GLfloat* v);
+void c3dglUniform1i(GLint location, GLint x);
+void c3dglUniform1iv(GLint location, GLsizei count, const GLint* v);
+void c3dglUniform2f(GLint location, GLfloat x, GLfloat y);
+void c3dglUniform2fv(GLint location, GLsizei count, const GLfloat* v);
+void c3dglUniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z);
+void c3dglUniform3fv(GLint location, GLsizei count, const GLfloat* v);
+void c3dglUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+void c3dglUniform4fv(GLint location, GLsizei count, const GLfloat* v);
+void c3dglUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void c3dglUseProgram(GLuint program);
+void c3dglVertexAttribDivisor(GLuint index, GLuint divisor);
+void c3dglVertexAttribPointer(GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr);
+void c3dglViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+#define glActiveTexture c3dglActiveTexture
+#define glAttachShader c3dglAttachShader
+#define glBindBuffer c3dglBindBuffer
+#define glBindFramebuffer c3dglBindFramebuffer
+#define glBindRenderbuffer c3dglBindRenderbuffer
+#define glBindTexture c3dglBindTexture
+#define glBlendFunc c3dglBlendFunc
+#define glBufferData c3dglBufferData
+#define glBufferSubData c3dglBufferSubData
+#define glCheckFramebufferStatus c3dglCheckFramebufferStatus
+#define glClear c3dglClear
+#define glClearColor c3dglClearColor
+#undef glClearDepth
+#define glClearDepth c3dglClearDepth
+#define glClearStencil c3dglClearStencil
+#define glCompileShader c3dglCompileShader
+#define glCreateProgram c3dglCreateProgram
+#define glCreateShader c3dglCreateShader
+#define glDeleteBuffers c3dglDeleteBuffers
+#define glDeleteFramebuffers c3dglDeleteFramebuffers
+#define glDeleteProgram c3dglDeleteProgram
+#define glDeleteShader c3dglDeleteShader
+#define glDeleteTextures c3dglDeleteTextures
+#define glDepthMask c3dglDepthMask
+#define glDisable c3dglDisable
+#define glDisableVertexAttribArray c3dglDisableVertexAttribArray
+#define glDrawArrays c3dglDrawArrays
+#define glDrawElements c3dglDrawElements
+#define glEnable c3dglEnable
+#define glEnableVertexAttribArray c3dglEnableVertexAttribArray
+#define glFramebufferRenderbuffer c3dglFramebufferRenderbuffer
+#define glFramebufferTexture2D c3dglFramebufferTexture2D
+#define glGenBuffers c3dglGenBuffers
+#define glGenFramebuffers c3dglGenFramebuffers
+#define glGenRenderbuffers c3dglGenRenderbuffers
+#define glGenTextures c3dglGenTextures
+#define glGenerateMipmap c3dglGenerateMipmap
+#define glGetActiveAttrib c3dglGetActiveAttrib
+#define glGetActiveUniform c3dglGetActiveUniform
+#define glGetAttribLocation c3dglGetAttribLocation
+#define glGetError c3dglGetError
+#define glGetFloatv c3dglGetFloatv
+#define glGetIntegerv c3dglGetIntegerv
+#define glGetProgramInfoLog c3dglGetProgramInfoLog
+#define glGetProgramiv c3dglGetProgramiv
+#define glGetShaderInfoLog c3dglGetShaderInfoLog
+#define glGetShaderiv c3dglGetShaderiv
+#define glGetString c3dglGetString
+#define glGetUniformLocation c3dglGetUniformLocation
+#define glGetVertexAttribiv c3dglGetVertexAttribiv
+#define glIsEnabled c3dglIsEnabled
+#define glLinkProgram c3dglLinkProgram
+#undef glProgramParameteri
+#define glProgramParameteri c3dglProgramParameteri
+#define glRenderbufferStorage c3dglRenderbufferStorage
+#define glScissor c3dglScissor
+#define glShaderSource c3dglShaderSource
+#define glTexImage2D c3dglTexImage2D
+#define glTexParameteri c3dglTexParameteri
+#define glUniform1f c3dglUniform1f
+#define glUniform1fv c3dglUniform1fv
+#define glUniform1i c3dglUniform1i
+#define glUniform1iv c3dglUniform1iv
+#define glUniform2f c3dglUniform2f
+#define glUniform2fv c3dglUniform2fv
+#define glUniform3f c3dglUniform3f
+#define glUniform3fv c3dglUniform3fv
+#define glUniform4f c3dglUniform4f
+#define glUniform4fv c3dglUniform4fv
+#define glUniformMatrix4fv c3dglUniformMatrix4fv
+#define glUseProgram c3dglUseProgram
+#define glVertexAttribPointer c3dglVertexAttribPointer
+#define glViewport c3dglViewport
+
+// on android the vertex array, instancing and program binary entry points are variables defined by C3DStream.cpp
+#if !defined(__ANDROID__)
+#undef glBindVertexArray
+#undef glDeleteVertexArrays
+#undef glGenVertexArrays
+#undef glDrawElementsInstanced
+#undef glVertexAttribDivisor
+#undef glGetProgramBinary
+#undef glProgramBinary
+#define glBindVertexArray c3dglBindVertexArray
+#define glDeleteVertexArrays c3dglDeleteVertexArrays
+#define glGenVertexArrays c3dglGenVertexArrays
+#define glDrawElementsInstanced c3dglDrawElementsInstanced
+#define glVertexAttribDivisor c3dglVertexAttribDivisor
+#define glGetProgramBinary c3dglGetProgramBinary
+#define glProgramBinary c3dglProgramBinary
+#endif
+
+#endif // C3D_GL_SHIM_IMPL
+
+#endif
@@ -0,0 +1,281 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "Base.h"
+#include "C3DLODNode.h"
+#include "C3DModel.h"
+#include "C3DMesh.h"
+#include "C3DAABB.h"
+#include "C3DCamera.h"
+#include "C3DScene.h"
+#include <float.h>
+
+namespace cocos3d
+{
+float C3DLODNode::s_lodBias = 1.0f;
+
+C3DLODNode::C3DLODNode(const std::string& id)
+    : C3DModelNode(id), _cullScreenSize(0.0f), _hysteresis(0.1f), _fadeTime(0.0f)
+{
+}
+
+C3DLODNode::~C3DLODNode()
+{
+	for (size_t i = 0; i < _levels.size(); i++)
+	{
+		_levels[i].model->setNode(NULL);
+		SAFE_RELEASE(_levels[i].model);
+	}
+}
+
+C3DLODNode* C3DLODNode::create(const std::string& id)
+{
+	C3DLODNode* node = new C3DLODNode(id);
+	node->autorelease();
+
+	return node;
+}
+
+void C3DLODNode::addLevel(C3DModel* model, float screenSize)
+{
+	assert(model);
+	CCAssert(_levels.empty() || screenSize < _levels.back().screenSize, "the levels must get coarser");
+
+	Level level;
+	level.model = model;
+	level.screenSize = screenSize;
+	_levels.push_back(level);
+
+	model->retain();
+	model->setNode(this);
+}
+
+void C3DLODNode::setLevelScreenSize(unsigned int level, float screenSize)
+{
+	assert(level > 0 && level <= _levels.size());
+
+	_levels[level - 1].screenSize = screenSize;
+}
+
+float C3DLODNode::getLevelScreenSize(unsigned int level) const
+{
+	assert(level > 0 && level <= _levels.size());
+
+	return _levels[level - 1].screenSize;
+}
+
+float C3DLODNode::getDefaultScreenSize(unsigned int level)
+{
+	return 0.5f / (float)(1 << std::min(level, 24u));
+}
+
+void C3DLODNode::setCullScreenSize(float screenSize)
+{
+	_cullScreenSize = screenSize;
+}
+
+void C3DLODNode::setHysteresis(float hysteresis)
+{
+	_hysteresis = hysteresis;
+}
+
+void C3DLODNode::setFadeTime(float fadeTime)
+{
+	_fadeTime = fadeTime;
+}
+
+unsigned int C3DLODNode::getModelCount() const
+{
+	return _model ? 1 + _levels.size() : 0;
+}
+
+C3DModel* C3DLODNode::getModel(unsigned int index)
+{
+	assert(index < getModelCount());
+
+	return index == 0 ? _model : _levels[index - 1].model;
+}
+
+float C3DLODNode::getSwitchSize(unsigned int level) const
+{
+	if (level == 0)
+		return FLT_MAX;
+
+	return level <= _levels.size() ? _levels[level - 1].screenSize : _cullScreenSize;
+}
+
+unsigned int C3DLODNode::selectLevel(float screenSize, unsigned int level) const
+{
+	unsigned int count = getModelCount();
+
+	while (level < count && screenSize < getSwitchSize(level + 1) * (1.0f - _hysteresis))
+		level++;
+	while (level > 0 && screenSize > getSwitchSize(level) * (1.0f + _hysteresis))
+		level--;
+
+	return level;
+}
+
+float C3DLODNode::getScreenSize(C3DCamera* camera)
+{
+	if (_model == NULL || _model->getMesh() == NULL)
+		return FLT_MAX;
+
+	C3DAABB worldSpaceBox(*_model->getMesh()->getBoundingBox());
+	worldSpaceBox.transform(getWorldMatrix());
+
+	C3DVector3 center = worldSpaceBox.getCenter();
+	float radius = (worldSpaceBox._max - worldSpaceBox._min).length() * 0.5f;
+
+	// clip w of the center, the distance along the view for a perspective camera and 1 otherwise
+	const float* m = camera->getViewProjectionMatrix().m;
+	float w = m[3] * center.x + m[7] * center.y + m[11] * center.z + m[15];
+	if (w <= 0.0f)
+		return FLT_MAX;
+
+	return radius * camera->getProjectionMatrix().m[5] / w * s_lodBias;
+}
+
+const C3DLODNode::CameraLevel* C3DLODNode::findCameraLevel(C3DCamera* camera) const
+{
+	for (size_t i = 0; i < _cameraLevels.size(); i++)
+	{
+		if (_cameraLevels[i].cameraId == camera->getCameraId())
+			return &_cameraLevels[i];
+	}
+	return NULL;
+}
+
+unsigned int C3DLODNode::getCurrentLevel(C3DCamera* camera) const
+{
+	const CameraLevel* cameraLevel = findCameraLevel(camera);
+
+	return cameraLevel ? cameraLevel->level : 0;
+}
+
+unsigned int C3DLODNode::getShadowLevel(C3DCamera* camera)
+{
+	const CameraLevel* cameraLevel = findCameraLevel(camera);
+
+	return cameraLevel ? cameraLevel->level : selectLevel(getScreenSize(camera), 0);
+}
+
+void C3DLODNode::draw()
+{
+	if (_model == NULL)
+		return;
+
+	C3DCamera* camera = _scene->getActiveCamera();
+	if (camera == NULL)
+	{
+		drawModel(_model);
+		return;
+	}
+
+	unsigned int count = getModelCount();
+
+	// the shadow pass draws the level picked for the view, without transition
+	if (_scene->isInShadowPass())
+	{
+		unsigned int level = getShadowLevel(camera);
+		if (level < count)
+			drawModel(getModel(level));
+		return;
+	}
+
+	CameraLevel* cameraLevel = const_cast<CameraLevel*>(findCameraLevel(camera));
+	if (cameraLevel == NULL)
+	{
+		if (_cameraLevels.size() >= MAX_CAMERAS)
+			_cameraLevels.erase(_cameraLevels.begin());
+
+		CameraLevel newLevel;
+		newLevel.cameraId = camera->getCameraId();
+		newLevel.level = 0;
+		newLevel.fadeLevel = 0;
+		newLevel.fadeStart = 0.0f;
+		_cameraLevels.push_back(newLevel);
+		cameraLevel = &_cameraLevels.back();
+
+		cameraLevel->level = cameraLevel->fadeLevel = selectLevel(getScreenSize(camera), 0);
+	}
+
+	float time = _scene->getTimeParam().x;
+
+	unsigned int level = selectLevel(getScreenSize(camera), cameraLevel->level);
+	if (level != cameraLevel->level)
+	{
+		cameraLevel->fadeLevel = _fadeTime > 0.0f ? cameraLevel->level : level;
+		cameraLevel->fadeStart = time;
+		cameraLevel->level = level;
+	}
+
+	float fade = 0.0f;
+	if (cameraLevel->fadeLevel != cameraLevel->level)
+	{
+		fade = (time - cameraLevel->fadeStart) / _fadeTime;
+		if (fade >= 1.0f || fade < 0.0f)
+		{
+			cameraLevel->fadeLevel = cameraLevel->level;
+			fade = 0.0f;
+		}
+		else
+		{
+			// 0 would draw every pixel of both levels
+			fade = std::max(fade, 1.0f / 32.0f);
+		}
+	}
+
+	C3DModel* model;
+	if (fade > 0.0f && cameraLevel->fadeLevel < count)
+	{
+		model = getModel(cameraLevel->fadeLevel);
+		model->setLODFade(-fade);
+		drawModel(model);
+	}
+
+	if (cameraLevel->level < count)
+	{
+		model = getModel(cameraLevel->level);
+		model->setLODFade(fade);
+		drawModel(model);
+	}
+}
+
+C3DNode* C3DLODNode::clone(CloneContext& context) const
+{
+	C3DLODNode* other = new C3DLODNode(_id);
+	other->copyFrom(this, context);
+	other->_id = _id;
+	C3DModel* newModel = _model ? _model->clone(context) : NULL;
+	other->setModel(newModel);
+	for (size_t i = 0; i < _levels.size(); i++)
+	{
+		other->addLevel(_levels[i].model->clone(context), _levels[i].screenSize);
+	}
+	other->_cullScreenSize = _cullScreenSize;
+	other->_hysteresis = _hysteresis;
+	other->_fadeTime = _fadeTime;
+	other->autorelease();
+	return other;
+}
+}
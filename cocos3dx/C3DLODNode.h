@@ -0,0 +1,158 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef C3DLODNODE_H_
+#define C3DLODNODE_H_
+
+#include "C3DModelNode.h"
+
+namespace cocos3d
+{
+class C3DCamera;
+
+/**
+ * Defines a model node which draws coarser models as it gets smaller on the screen.
+ *
+ * Level 0 is the model of the node, the coarser levels are added with addLevel, each with the
+ * screen size below which it replaces the previous one. The screen size is the projected diameter
+ * of the bounding sphere of level 0 over the height of the viewport, scaled by the LOD bias.
+ * The level is picked for each camera, all of them are drawn with the world matrix of the node.
+ *
+ * In a .ckb file, the model nodes <id>_LOD1, <id>_LOD2, ... next to the model node <id> are
+ * loaded as its levels with the default screen sizes, and share its transform.
+ */
+class C3DLODNode : public C3DModelNode
+{
+public:
+	enum { MAX_CAMERAS = 4 };
+
+	static C3DLODNode* create(const std::string& id);
+
+	/**
+	 * Adds a coarser level, its screen size must be below the one of the previous level.
+	 */
+	void addLevel(C3DModel* model, float screenSize);
+
+	/**
+	 * Sets the screen size below which the level replaces the previous one, level 0 has none.
+	 */
+	void setLevelScreenSize(unsigned int level, float screenSize);
+	float getLevelScreenSize(unsigned int level) const;
+
+	/**
+	 * Gets the screen size used for the level when it is not given, halved at each level from 0.25.
+	 */
+	static float getDefaultScreenSize(unsigned int level);
+
+	/**
+	 * Sets the screen size below which nothing is drawn, 0 by default.
+	 */
+	void setCullScreenSize(float screenSize);
+	float getCullScreenSize() const { return _cullScreenSize; }
+
+	/**
+	 * Sets how far, as a fraction of the screen size of a level, the node must go past it
+	 * before switching, so that it does not flicker between two levels. 0.1 by default.
+	 */
+	void setHysteresis(float hysteresis);
+	float getHysteresis() const { return _hysteresis; }
+
+	/**
+	 * Sets the duration in seconds of the dithered transition between two levels, both are drawn
+	 * meanwhile. The materials of the levels need the LODFADE define. 0, the default, switches at once.
+	 */
+	void setFadeTime(float fadeTime);
+	float getFadeTime() const { return _fadeTime; }
+
+	/**
+	 * Gets the level drawn last for the camera, getModelCount() when the node is smaller than
+	 * the cull screen size.
+	 */
+	unsigned int getCurrentLevel(C3DCamera* camera) const;
+
+	/**
+	 * Gets the level drawn in the shadow pass for the camera, the one of the view without transition.
+	 */
+	unsigned int getShadowLevel(C3DCamera* camera);
+
+	/**
+	 * Gets the screen size of the node seen by the camera, the LOD bias applied.
+	 */
+	float getScreenSize(C3DCamera* camera);
+
+	/**
+	 * Scales the screen size of every LOD node, above 1 keeps the finer levels farther.
+	 */
+	static void setLODBias(float bias) { s_lodBias = bias; }
+	static float getLODBias() { return s_lodBias; }
+
+	using C3DModelNode::getModel;
+	virtual unsigned int getModelCount() const;
+	virtual C3DModel* getModel(unsigned int index);
+
+	virtual void draw();
+
+	virtual C3DNode* clone(CloneContext& context) const;
+
+protected:
+
+	C3DLODNode(const std::string& id);
+
+	virtual ~C3DLODNode();
+
+private:
+
+	struct Level
+	{
+		C3DModel* model;
+		float screenSize;
+	};
+
+	struct CameraLevel
+	{
+		unsigned int cameraId; // not the camera, another one may be created at its address
+		unsigned int level;
+		unsigned int fadeLevel; // level fading out, level when there is no transition
+		float fadeStart;
+	};
+
+	/**
+	 * screen size below which level replaces level - 1, the cull size for getModelCount()
+	 */
+	float getSwitchSize(unsigned int level) const;
+
+	unsigned int selectLevel(float screenSize, unsigned int level) const;
+
+	const CameraLevel* findCameraLevel(C3DCamera* camera) const;
+
+	std::vector<Level> _levels; // levels from 1
+	std::vector<CameraLevel> _cameraLevels;
+
+	float _cullScreenSize;
+	float _hysteresis;
+	float _fadeTime;
+
+	static float s_lodBias;
+};
+}
+
+#endif
@@ -46,6 +46,7 @@ THE SOFTWARE.
 #include "C3DRenderNodeManager.h"
 #include "C3DVertexDeclaration.h"
 #include "C3DProfile.h"
+#include "C3DStateCache.h"
 
 #include "CCStdC.h"
 using namespace cocos2d;
@@ -259,7 +260,7 @@ void C3DLayer::update(long elapsedTime)
         PROFILE_DISPLAY_UPDATE();
     }
 
-    BEGIN_PROFILE("3dlayer update");
+    PROFILE_SCOPE("3dlayer update");
 	_delatTimeSceond = elapsedTime*0.001f;
 	_totalTimeSceond += _delatTimeSceond;
 	_timeMinuteRound += _delatTimeSceond;
@@ -283,7 +284,6 @@ void C3DLayer::update(long elapsedTime)
     }
 
 	//_statRender->update(elapsedTime);
-    END_PROFILE("3dlayer update");
 }
 
 void C3DLayer::update(float delta)
@@ -294,10 +294,13 @@ void C3DLayer::update(float delta)
 
 void C3DLayer::beginRender()
 {
-    BEGIN_PROFILE("3dlayer beginRender");
+    PROFILE_SCOPE("3dlayer beginRender");
     //backup cocos2d opengl state, sync 3d cached opengl state
+    C3DStateCache::invalidate();
     _2DState->backUpGLState();
 
+    _renderSystem->_frameIndex++;
+
     glGetVertexAttribiv(cocos2d::kCCVertexAttrib_Position, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &_enablePos);
     glGetVertexAttribiv(cocos2d::kCCVertexAttrib_Color, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &_enableColor);
     glGetVertexAttribiv(cocos2d::kCCVertexAttrib_TexCoords, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &_enableTex);
@@ -315,12 +318,11 @@ void C3DLayer::beginRender()
     _renderSystem->setViewport(/*point1.x, point1.y, point2.x - point1.x, point2.y - point1.y*/);
 
     cocos2d::ccGLBindVAO(0);
-    END_PROFILE("3dlayer beginRender");
 }
 
 void C3DLayer::endRender()
 {
-    BEGIN_PROFILE("3dlayer endRender");
+    PROFILE_SCOPE("3dlayer endRender");
     // restore cocos2d opengl state
     cocos2d::ccGLUseProgram(0);
 
@@ -335,12 +337,11 @@ void C3DLayer::endRender()
         glEnableVertexAttribArray(cocos2d::kCCVertexAttrib_TexCoords);
 
 //	glClearColor(_oldClearColor[0], _oldClearColor[1], _oldClearColor[2], _oldClearColor[3]);
-	END_PROFILE("3dlayer endRender");
 }
 
 void C3DLayer::render(long elapsedTime)
 {
-    BEGIN_PROFILE("3dlayer render");
+    PROFILE_SCOPE("3dlayer render");
     /*if(_renderSystem == NULL)
         return;
 
@@ -356,7 +357,6 @@ void C3DLayer::render(long elapsedTime)
 	_scene->drawDebug();
     _scene->postDraw();
 
-    END_PROFILE("3dlayer render");
 }
 
 unsigned int C3DLayer::getWidth() const
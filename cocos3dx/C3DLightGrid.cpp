@@ -0,0 +1,220 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "Base.h"
+#include "C3DLightGrid.h"
+#include "C3DLight.h"
+
+namespace cocos3d
+{
+C3DLightGrid::C3DLightGrid(int resolution)
+    : _resolution(resolution), _cellSizeInverse(0.0f), _queryStamp(0)
+{
+    _dims[0] = _dims[1] = _dims[2] = 0;
+}
+
+C3DLightGrid::~C3DLightGrid()
+{
+}
+
+void C3DLightGrid::build(const std::vector<C3DLight*>& lights)
+{
+    _globalLights.clear();
+    _localLights.clear();
+    _bounds.reset();
+
+    for (size_t i = 0; i < lights.size(); i++)
+    {
+        C3DLight* light = lights[i];
+        if (!light->isActive())
+            continue;
+        C3DLightComponent* lightComp = light->getComponent();
+        if (!lightComp)
+            continue;
+
+        float range = 0.0f;
+        switch (light->getLightType())
+        {
+        case C3DLight::POINT:
+            range = static_cast<C3DPointLight*>(lightComp)->getRange();
+            break;
+        case C3DLight::SPOT:
+            range = static_cast<C3DSpotLight*>(lightComp)->getRange();
+            break;
+        default:
+            break;
+        }
+
+        // lights without a range reach every model
+        if (range <= 0.0f)
+        {
+            _globalLights.push_back(light);
+            continue;
+        }
+
+        LocalLight local;
+        local.light = light;
+        local.position = light->getTranslationWorld();
+        local.range = range;
+        local.rangeInverse = 1.0f / range;
+        _localLights.push_back(local);
+
+        C3DVector3 extent(range, range, range);
+        _bounds.merge(C3DAABB(local.position - extent, local.position + extent));
+    }
+
+    if (_localLights.empty())
+        return;
+
+    // cubic cells, the longest axis gets the full resolution
+    C3DVector3 size = _bounds._max - _bounds._min;
+    float maxSize = C3D_Max(size.x, C3D_Max(size.y, size.z));
+    float cellSize = maxSize / _resolution;
+    _cellSizeInverse = 1.0f / cellSize;
+
+    for (int a = 0; a < 3; a++)
+    {
+        int n = (int)ceilf(size[a] * _cellSizeInverse);
+        _dims[a] = C3D_Max(1, C3D_Min(n, _resolution));
+    }
+
+    // counting sort of the lights into the cells
+    unsigned int cellCount = _dims[0] * _dims[1] * _dims[2];
+    _cellStart.assign(cellCount + 1, 0);
+
+    int cellMin[3], cellMax[3];
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (size_t i = 0; i < _localLights.size(); i++)
+        {
+            const LocalLight& local = _localLights[i];
+            C3DVector3 extent(local.range, local.range, local.range);
+            getCellRange(local.position - extent, local.position + extent, cellMin, cellMax);
+
+            for (int z = cellMin[2]; z <= cellMax[2]; z++)
+            for (int y = cellMin[1]; y <= cellMax[1]; y++)
+            for (int x = cellMin[0]; x <= cellMax[0]; x++)
+            {
+                unsigned int cell = (z * _dims[1] + y) * _dims[0] + x;
+                if (pass == 0)
+                    _cellStart[cell + 1]++;
+                else
+                    _cellLights[_cellStart[cell]++] = (unsigned int)i;
+            }
+        }
+
+        if (pass == 0)
+        {
+            for (unsigned int c = 0; c < cellCount; c++)
+            {
+                _cellStart[c + 1] += _cellStart[c];
+            }
+            _cellLights.resize(_cellStart[cellCount]);
+        }
+        else
+        {
+            // filling moved every start to the start of the next cell, shift them back
+            for (unsigned int c = cellCount; c > 0; c--)
+            {
+                _cellStart[c] = _cellStart[c - 1];
+            }
+            _cellStart[0] = 0;
+        }
+    }
+
+    _queryStamps.assign(_localLights.size(), 0);
+    _queryStamp = 0;
+}
+
+bool C3DLightGrid::getCellRange(const C3DVector3& min, const C3DVector3& max, int* cellMin, int* cellMax) const
+{
+    for (int a = 0; a < 3; a++)
+    {
+        if (max[a] < _bounds._min[a] || min[a] > _bounds._max[a])
+            return false;
+
+        cellMin[a] = C3D_Max(0, (int)((min[a] - _bounds._min[a]) * _cellSizeInverse));
+        cellMax[a] = C3D_Min(_dims[a] - 1, (int)((max[a] - _bounds._min[a]) * _cellSizeInverse));
+    }
+    return true;
+}
+
+void C3DLightGrid::query(const C3DAABB& box, std::vector<C3DLight*>& result)
+{
+    result.insert(result.end(), _globalLights.begin(), _globalLights.end());
+
+    if (_localLights.empty())
+        return;
+
+    int cellMin[3], cellMax[3];
+    if (!getCellRange(box._min, box._max, cellMin, cellMax))
+        return;
+
+    if (++_queryStamp == 0)
+    {
+        std::fill(_queryStamps.begin(), _queryStamps.end(), 0);
+        _queryStamp = 1;
+    }
+
+    C3DAABB testBox(box);
+    _candidates.clear();
+
+    for (int z = cellMin[2]; z <= cellMax[2]; z++)
+    for (int y = cellMin[1]; y <= cellMax[1]; y++)
+    for (int x = cellMin[0]; x <= cellMax[0]; x++)
+    {
+        unsigned int cell = (z * _dims[1] + y) * _dims[0] + x;
+        for (unsigned int i = _cellStart[cell]; i < _cellStart[cell + 1]; i++)
+        {
+            unsigned int index = _cellLights[i];
+            if (_queryStamps[index] == _queryStamp)
+                continue;
+            _queryStamps[index] = _queryStamp;
+
+            const LocalLight& local = _localLights[index];
+            float distance = testBox.distance(local.position);
+            if (distance > local.range)
+                continue;
+
+            // insertion sort, only a few lights touch a box
+            Candidate candidate;
+            candidate.score = distance * local.rangeInverse;
+            candidate.light = local.light;
+
+            size_t pos = _candidates.size();
+            _candidates.push_back(candidate);
+            while (pos > 0 && _candidates[pos - 1].score > candidate.score)
+            {
+                _candidates[pos] = _candidates[pos - 1];
+                pos--;
+            }
+            _candidates[pos] = candidate;
+        }
+    }
+
+    for (size_t i = 0; i < _candidates.size(); i++)
+    {
+        result.push_back(_candidates[i].light);
+    }
+}
+}
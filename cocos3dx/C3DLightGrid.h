@@ -0,0 +1,110 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef C3DLIGHTGRID_H_
+#define C3DLIGHTGRID_H_
+
+#include <vector>
+#include "C3DAABB.h"
+#include "C3DVector3.h"
+
+namespace cocos3d
+{
+class C3DLight;
+
+/**
+ * Defines a uniform grid of the point and spot lights of a scene, rebuilt every frame.
+ *
+ * Each local light is registered in the cells its range overlaps, so the lights
+ * touching a box are found by visiting the cells of the box only. Directional and
+ * animated lights affect everything and are kept aside.
+ */
+class C3DLightGrid
+{
+public:
+    /**
+     * Constructor & Destructor.
+     *
+     * @param resolution Max number of cells along each axis.
+     */
+    C3DLightGrid(int resolution = 16);
+    ~C3DLightGrid();
+
+    /**
+     * Rebuilds the grid from the active lights.
+     */
+    void build(const std::vector<C3DLight*>& lights);
+
+    /**
+     * Collects the lights affecting the box. Directional and animated lights come first
+     * in scene order, then the point and spot lights whose range touches the box, nearest
+     * (relative to its range) first.
+     */
+    void query(const C3DAABB& box, std::vector<C3DLight*>& result);
+
+    /**
+     * get number of lights in the grid
+     */
+    unsigned int getLightCount() const { return (unsigned int)(_globalLights.size() + _localLights.size()); }
+
+private:
+
+    struct LocalLight
+    {
+        C3DLight* light;
+        C3DVector3 position;
+        float range;
+        float rangeInverse;
+    };
+
+    struct Candidate
+    {
+        float score;
+        C3DLight* light;
+    };
+
+    // cell range covered by the box, false if the box is outside of the grid
+    bool getCellRange(const C3DVector3& min, const C3DVector3& max, int* cellMin, int* cellMax) const;
+
+    int _resolution;
+
+    std::vector<C3DLight*> _globalLights;
+    std::vector<LocalLight> _localLights;
+
+    C3DAABB _bounds;
+    int _dims[3];
+    float _cellSizeInverse;
+
+    // lights of cell i are _cellLights[_cellStart[i]] .. _cellLights[_cellStart[i + 1] - 1]
+    std::vector<unsigned int> _cellStart;
+    std::vector<unsigned int> _cellLights;
+
+    // avoids testing a light twice when it spans several cells
+    std::vector<unsigned int> _queryStamps;
+    unsigned int _queryStamp;
+
+    std::vector<Candidate> _candidates;
+};
+}
+
+#endif
@@ -338,7 +338,8 @@ void C3DLineRender::draw()
 			C3DVector3 pos( C3DVector3::zero() );
 	        this->getWorldViewMatrix().getPosition( &pos );
 
-			channel->addItem( _model, pos.z, "LineRender" );
+			// view space looks down -z, pass the distance in front of the camera
+			channel->addItem( _model, -pos.z );
 		}
 		else
 		{
@@ -36,7 +36,7 @@ THE SOFTWARE.
 
 namespace cocos3d
 {
-C3DMaterial::C3DMaterial(const std::string& name) : C3DResource(name)
+C3DMaterial::C3DMaterial(const std::string& name) : C3DResource(name), _sortId(0)
 {
     memset(_techniqueChannel, 0, sizeof(_techniqueChannel));
 }
@@ -69,6 +69,37 @@ void C3DMaterial::reload()
 	for_each(_techniques.begin(), _techniques.end(), techniqueReload);
 }
 
+static void collectTextures(const C3DRenderState* state, std::set<const C3DTexture*>& textures)
+{
+	const std::list<MaterialParameter*>& parameters = state->getParameterList();
+	for (std::list<MaterialParameter*>::const_iterator iter = parameters.begin(); iter != parameters.end(); ++iter)
+	{
+		if ((*iter)->getType() != MaterialParameter::SAMPLER)
+			continue;
+
+		const C3DSampler* sampler = (*iter)->getSamplerValue();
+		if (sampler && sampler->getTexture())
+			textures.insert(sampler->getTexture());
+	}
+}
+
+size_t C3DMaterial::calculateGPUSize(void) const
+{
+	std::set<const C3DTexture*> textures;
+	collectTextures(this, textures);
+
+	for (size_t i = 0; i < _techniques.size(); i++)
+	{
+		for (unsigned int j = 0; j < _techniques[i]->getPassCount(); j++)
+		{
+			collectTextures(_techniques[i]->getPass(j), textures);
+		}
+	}
+
+	std::vector<const C3DTexture*> textureList(textures.begin(), textures.end());
+	return C3DTextureMgr::getInstance()->getExclusiveMemorySize(textureList);
+}
+
 //C3DMaterial* C3DMaterial::create(const std::string& fileName)
 //{
 //	assert(!fileName.empty());
@@ -171,6 +202,24 @@ void C3DMaterial::reload()
 //	return material;
 //}
 
+unsigned int C3DMaterial::getSortId() const
+{
+    if (_sortId == 0)
+    {
+        // clones keep the name of their source, so they get the same id
+        static std::map<std::string, unsigned int> s_sortIds;
+
+        std::map<std::string, unsigned int>::iterator it = s_sortIds.find(getResourceName());
+        if (it == s_sortIds.end())
+        {
+            it = s_sortIds.insert(std::make_pair(getResourceName(), (unsigned int)s_sortIds.size() + 1)).first;
+        }
+        _sortId = it->second;
+    }
+
+    return _sortId;
+}
+
 unsigned int C3DMaterial::getTechniqueCount() const
 {
     return _techniques.size();
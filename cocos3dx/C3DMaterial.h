@@ -146,11 +146,24 @@ public:
 
 	virtual void reload();
 
+	/**
+	 * the textures of the samplers that no other material or node uses, the ones evicting the
+	 * material frees. A shared texture is counted by the last material holding it.
+	 */
+	virtual size_t calculateGPUSize(void) const;
+
+	/**
+	 * get the sort id of the material, materials with the same name share the same id.
+	 */
+	unsigned int getSortId() const;
+
 private:
 
     std::vector<C3DTechnique*> _techniques;
 
     C3DTechnique* _techniqueChannel[TECH_USAGE_NUM];
+
+    mutable unsigned int _sortId;
 };
 }
 
@@ -61,6 +61,15 @@ C3DResource* C3DMaterialManager::createResource(const std::string& name)
         return NULL;
     }
 
+	C3DResource* material = createResource(name, nodes);
+
+    SAFE_DELETE(nodes);
+
+	return material;
+}
+
+C3DResource* C3DMaterialManager::createResource(const std::string& name, C3DElementNode* nodes)
+{
     C3DElementNode* materialNodes = nodes->getNodeType().empty() ? nodes->getNextChild() : nodes;
 	assert(materialNodes);
     if (!materialNodes || materialNodes->getNodeType()!="material")
@@ -79,12 +88,9 @@ C3DResource* C3DMaterialManager::createResource(const std::string& name)
 	else
 	{
 		SAFE_RELEASE(material);
-		SAFE_DELETE(nodes);
 		return NULL;
 	}
 
-    SAFE_DELETE(nodes);
-
 	return material;
 }
 
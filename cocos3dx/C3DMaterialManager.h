@@ -41,6 +41,11 @@ public:
 
 	virtual C3DResource* createResource(const std::string& name);
 
+	/**
+	 * Creates the material name from its already parsed file, nodes is not deleted.
+	 */
+	C3DResource* createResource(const std::string& name, C3DElementNode* nodes);
+
 	virtual C3DResource* cloneResource(C3DResource* resource);
 
 private:
@@ -0,0 +1,554 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include <float.h>
+#include "Base.h"
+#include "C3DMathSIMD.h"
+#include "C3DQuaternion.h"
+
+#if defined(C3D_MATH_SSE)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(C3D_MATH_NEON) && defined(ANDROID) && !defined(__aarch64__)
+#include <cpu-features.h>
+#endif
+
+namespace cocos3d
+{
+static void multiplyMatrixScalar(const float* m1, const float* m2, float* dst)
+{
+    // Support the case where m1 or m2 is the same array as dst.
+    float product[16];
+
+    product[0]  = m1[0] * m2[0]  + m1[4] * m2[1] + m1[8]   * m2[2]  + m1[12] * m2[3];
+    product[1]  = m1[1] * m2[0]  + m1[5] * m2[1] + m1[9]   * m2[2]  + m1[13] * m2[3];
+    product[2]  = m1[2] * m2[0]  + m1[6] * m2[1] + m1[10]  * m2[2]  + m1[14] * m2[3];
+    product[3]  = m1[3] * m2[0]  + m1[7] * m2[1] + m1[11]  * m2[2]  + m1[15] * m2[3];
+
+    product[4]  = m1[0] * m2[4]  + m1[4] * m2[5] + m1[8]   * m2[6]  + m1[12] * m2[7];
+    product[5]  = m1[1] * m2[4]  + m1[5] * m2[5] + m1[9]   * m2[6]  + m1[13] * m2[7];
+    product[6]  = m1[2] * m2[4]  + m1[6] * m2[5] + m1[10]  * m2[6]  + m1[14] * m2[7];
+    product[7]  = m1[3] * m2[4]  + m1[7] * m2[5] + m1[11]  * m2[6]  + m1[15] * m2[7];
+
+    product[8]  = m1[0] * m2[8]  + m1[4] * m2[9] + m1[8]   * m2[10] + m1[12] * m2[11];
+    product[9]  = m1[1] * m2[8]  + m1[5] * m2[9] + m1[9]   * m2[10] + m1[13] * m2[11];
+    product[10] = m1[2] * m2[8]  + m1[6] * m2[9] + m1[10]  * m2[10] + m1[14] * m2[11];
+    product[11] = m1[3] * m2[8]  + m1[7] * m2[9] + m1[11]  * m2[10] + m1[15] * m2[11];
+
+    product[12] = m1[0] * m2[12] + m1[4] * m2[13] + m1[8]  * m2[14] + m1[12] * m2[15];
+    product[13] = m1[1] * m2[12] + m1[5] * m2[13] + m1[9]  * m2[14] + m1[13] * m2[15];
+    product[14] = m1[2] * m2[12] + m1[6] * m2[13] + m1[10] * m2[14] + m1[14] * m2[15];
+    product[15] = m1[3] * m2[12] + m1[7] * m2[13] + m1[11] * m2[14] + m1[15] * m2[15];
+
+    memcpy(dst, product, sizeof(product));
+}
+
+static bool invertMatrixScalar(const float* m, float* dst)
+{
+    float a0 = m[0] * m[5] - m[1] * m[4];
+    float a1 = m[0] * m[6] - m[2] * m[4];
+    float a2 = m[0] * m[7] - m[3] * m[4];
+    float a3 = m[1] * m[6] - m[2] * m[5];
+    float a4 = m[1] * m[7] - m[3] * m[5];
+    float a5 = m[2] * m[7] - m[3] * m[6];
+    float b0 = m[8] * m[13] - m[9] * m[12];
+    float b1 = m[8] * m[14] - m[10] * m[12];
+    float b2 = m[8] * m[15] - m[11] * m[12];
+    float b3 = m[9] * m[14] - m[10] * m[13];
+    float b4 = m[9] * m[15] - m[11] * m[13];
+    float b5 = m[10] * m[15] - m[11] * m[14];
+
+    // Calculate the determinant.
+    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+
+    // Close to zero, can't invert.
+    if (fabs(det) <= MATH_TOLERANCE)
+        return false;
+
+    // Support the case where m == dst.
+    float inverse[16];
+    inverse[0]  = m[5] * b5 - m[6] * b4 + m[7] * b3;
+    inverse[1]  = -m[1] * b5 + m[2] * b4 - m[3] * b3;
+    inverse[2]  = m[13] * a5 - m[14] * a4 + m[15] * a3;
+    inverse[3]  = -m[9] * a5 + m[10] * a4 - m[11] * a3;
+
+    inverse[4]  = -m[4] * b5 + m[6] * b2 - m[7] * b1;
+    inverse[5]  = m[0] * b5 - m[2] * b2 + m[3] * b1;
+    inverse[6]  = -m[12] * a5 + m[14] * a2 - m[15] * a1;
+    inverse[7]  = m[8] * a5 - m[10] * a2 + m[11] * a1;
+
+    inverse[8]  = m[4] * b4 - m[5] * b2 + m[7] * b0;
+    inverse[9]  = -m[0] * b4 + m[1] * b2 - m[3] * b0;
+    inverse[10] = m[12] * a4 - m[13] * a2 + m[15] * a0;
+    inverse[11] = -m[8] * a4 + m[9] * a2 - m[11] * a0;
+
+    inverse[12] = -m[4] * b3 + m[5] * b1 - m[6] * b0;
+    inverse[13] = m[0] * b3 - m[1] * b1 + m[2] * b0;
+    inverse[14] = -m[12] * a3 + m[13] * a1 - m[14] * a0;
+    inverse[15] = m[8] * a3 - m[9] * a1 + m[10] * a0;
+
+    float scale = 1.0f / det;
+    for (int i = 0; i < 16; i++)
+    {
+        dst[i] = inverse[i] * scale;
+    }
+
+    return true;
+}
+
+static void transformPointsScalar(const float* m, const float* src, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++, src += 3, dst += 3)
+    {
+        float x = src[0], y = src[1], z = src[2];
+        dst[0] = x * m[0] + y * m[4] + z * m[8] + m[12];
+        dst[1] = x * m[1] + y * m[5] + z * m[9] + m[13];
+        dst[2] = x * m[2] + y * m[6] + z * m[10] + m[14];
+    }
+}
+
+static void transformVectorsScalar(const float* m, const float* src, float* dst, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++, src += 3, dst += 3)
+    {
+        float x = src[0], y = src[1], z = src[2];
+        dst[0] = x * m[0] + y * m[4] + z * m[8];
+        dst[1] = x * m[1] + y * m[5] + z * m[9];
+        dst[2] = x * m[2] + y * m[6] + z * m[10];
+    }
+}
+
+void C3DMathSIMD::slerpQuaternionScalar(const float* q1, const float* q2, float t, float* dst)
+{
+    C3DQuaternion::slerp(q1[0], q1[1], q1[2], q1[3], q2[0], q2[1], q2[2], q2[3], t, dst, dst + 1, dst + 2, dst + 3);
+}
+
+// distance of the box corner nearest to the back of the plane, the box is culled when it is positive
+static inline float boxPlaneDistance(const float* plane, float cx, float cy, float cz, float ex, float ey, float ez)
+{
+    return plane[0] * cx + plane[1] * cy + plane[2] * cz - plane[3]
+        - (fabsf(plane[0]) * ex + fabsf(plane[1]) * ey + fabsf(plane[2]) * ez);
+}
+
+void C3DMathSIMD::cullBoxRange(const float* planes, unsigned int planeCount, const float* const* bounds,
+                               unsigned char* lastPlane, unsigned int begin, unsigned int end, unsigned int* visibility)
+{
+    for (unsigned int i = begin; i < end; i++)
+    {
+        float cx = bounds[0][i], cy = bounds[1][i], cz = bounds[2][i];
+        float ex = bounds[3][i], ey = bounds[4][i], ez = bounds[5][i];
+
+        // the plane which culled the box last frame most likely still does
+        unsigned int cached = lastPlane[i];
+        if (cached < planeCount && boxPlaneDistance(planes + cached * 4, cx, cy, cz, ex, ey, ez) > 0)
+            continue;
+
+        unsigned int p = 0;
+        for (; p < planeCount; p++)
+        {
+            if (boxPlaneDistance(planes + p * 4, cx, cy, cz, ex, ey, ez) > 0)
+                break;
+        }
+
+        if (p < planeCount)
+        {
+            lastPlane[i] = (unsigned char)p;
+        }
+        else
+        {
+            lastPlane[i] = CULL_NO_PLANE;
+            visibility[i >> 5] |= 1u << (i & 31);
+        }
+    }
+}
+
+static void cullBoxesScalar(const float* planes, unsigned int planeCount, const float* const* bounds,
+                            unsigned char* lastPlane, unsigned int count, unsigned int* visibility)
+{
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+    C3DMathSIMD::cullBoxRange(planes, planeCount, bounds, lastPlane, 0, count, visibility);
+}
+
+static inline float dot3(const float* a, const float* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// radius of the box projected on the unit axis
+static inline float projectBox(const float* box, const float* axis)
+{
+    return fabsf(dot3(box + 3, axis)) * box[12] + fabsf(dot3(box + 6, axis)) * box[13] + fabsf(dot3(box + 9, axis)) * box[14];
+}
+
+void C3DMathSIMD::collideBoxRange(const float* pairs, unsigned int begin, unsigned int end, float* depth, float* normal)
+{
+    for (unsigned int i = begin; i < end; i++)
+    {
+        const float* a = pairs + i * BOX_PAIR_FLOATS;
+        const float* b = a + BOX_FLOATS;
+        float offset[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        float* n = normal + i * 3;
+
+        float minDepth = FLT_MAX;
+        for (int k = 0; k < 15; k++)
+        {
+            float axis[3];
+            if (k < 6)
+            {
+                const float* face = (k < 3 ? a + 3 + k * 3 : b + 3 + (k - 3) * 3);
+                axis[0] = face[0];
+                axis[1] = face[1];
+                axis[2] = face[2];
+            }
+            else
+            {
+                const float* u = a + 3 + ((k - 6) / 3) * 3;
+                const float* v = b + 3 + ((k - 6) % 3) * 3;
+                axis[0] = u[1] * v[2] - u[2] * v[1];
+                axis[1] = u[2] * v[0] - u[0] * v[2];
+                axis[2] = u[0] * v[1] - u[1] * v[0];
+            }
+
+            // edges nearly parallel, covered by the face axes
+            float len2 = dot3(axis, axis);
+            if (len2 < 1e-3f)
+                continue;
+
+            float invLength = 1.0f / sqrtf(len2);
+            axis[0] *= invLength;
+            axis[1] *= invLength;
+            axis[2] *= invLength;
+
+            float dist = dot3(offset, axis);
+            float overlap = projectBox(a, axis) + projectBox(b, axis) - fabsf(dist);
+            if (overlap < 0.0f)
+            {
+                minDepth = -1.0f;
+                break;
+            }
+
+            if (k >= 6)
+                overlap *= C3D_MATH_SAT_EDGE_WEIGHT;
+            if (overlap < minDepth)
+            {
+                minDepth = overlap;
+                float sign = dist < 0.0f ? -1.0f : 1.0f;
+                n[0] = axis[0] * sign;
+                n[1] = axis[1] * sign;
+                n[2] = axis[2] * sign;
+            }
+        }
+        depth[i] = minDepth;
+    }
+}
+
+static void collideBoxesScalar(const float* pairs, unsigned int count, float* depth, float* normal)
+{
+    C3DMathSIMD::collideBoxRange(pairs, 0, count, depth, normal);
+}
+
+static inline int clampPixel(float v, int size)
+{
+    // clamped as float first, the vertices may be far out of the buffer
+    if (v < 0.0f)
+        return 0;
+    if (v > (float)(size - 1))
+        return size - 1;
+    return (int)v;
+}
+
+bool C3DMathSIMD::setupDepthTriangle(const float* vertices, unsigned int width, unsigned int height, DepthTriangle* triangle)
+{
+    const float* v0 = vertices;
+    const float* v1 = vertices + 3;
+    const float* v2 = vertices + 6;
+
+    // twice the signed area, positive when counter clockwise. false for NaN too
+    float area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]);
+    if (!(area > 0.0f))
+        return false;
+
+    float minX = std::min(v0[0], std::min(v1[0], v2[0]));
+    float maxX = std::max(v0[0], std::max(v1[0], v2[0]));
+    float minY = std::min(v0[1], std::min(v1[1], v2[1]));
+    float maxY = std::max(v0[1], std::max(v1[1], v2[1]));
+    if (maxX < 0.0f || maxY < 0.0f || minX >= (float)width || minY >= (float)height)
+        return false;
+
+    triangle->minX = clampPixel(floorf(minX), width);
+    triangle->maxX = clampPixel(floorf(maxX), width);
+    triangle->minY = clampPixel(floorf(minY), height);
+    triangle->maxY = clampPixel(floorf(maxY), height);
+
+    // edge i goes from vertex i to the next one, positive on its left
+    for (int i = 0; i < 3; i++)
+    {
+        const float* a = vertices + i * 3;
+        const float* b = vertices + ((i + 1) % 3) * 3;
+        triangle->edge[i][0] = a[1] - b[1];
+        triangle->edge[i][1] = b[0] - a[0];
+        triangle->edge[i][2] = -(triangle->edge[i][0] * a[0] + triangle->edge[i][1] * a[1]);
+    }
+
+    // window depth is linear in screen space
+    float invArea = 1.0f / area;
+    triangle->depth[0] = ((v1[2] - v0[2]) * (v2[1] - v0[1]) - (v2[2] - v0[2]) * (v1[1] - v0[1])) * invArea;
+    triangle->depth[1] = ((v2[2] - v0[2]) * (v1[0] - v0[0]) - (v1[2] - v0[2]) * (v2[0] - v0[0])) * invArea;
+    triangle->depth[2] = v0[2] - triangle->depth[0] * v0[0] - triangle->depth[1] * v0[1];
+    return true;
+}
+
+static void rasterizeDepthScalar(const float* triangles, unsigned int count, float* depth, unsigned int width, unsigned int height)
+{
+    C3DMathSIMD::DepthTriangle t;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (!C3DMathSIMD::setupDepthTriangle(triangles + i * 9, width, height, &t))
+            continue;
+
+        for (int y = t.minY; y <= t.maxY; y++)
+        {
+            float py = y + 0.5f;
+            float rowEdge0 = t.edge[0][1] * py + t.edge[0][2];
+            float rowEdge1 = t.edge[1][1] * py + t.edge[1][2];
+            float rowEdge2 = t.edge[2][1] * py + t.edge[2][2];
+            float rowDepth = t.depth[1] * py + t.depth[2];
+            float* row = depth + y * width;
+
+            for (int x = t.minX; x <= t.maxX; x++)
+            {
+                float px = x + 0.5f;
+                if (t.edge[0][0] * px + rowEdge0 >= 0.0f && t.edge[1][0] * px + rowEdge1 >= 0.0f && t.edge[2][0] * px + rowEdge2 >= 0.0f)
+                {
+                    float z = t.depth[0] * px + rowDepth;
+                    if (z < row[x])
+                        row[x] = z;
+                }
+            }
+        }
+    }
+}
+
+void C3DMathSIMD::setupScalar(C3DMathSIMD* table)
+{
+    table->multiplyMatrix = multiplyMatrixScalar;
+    table->invertMatrix = invertMatrixScalar;
+    table->transformPoints = transformPointsScalar;
+    table->transformVectors = transformVectorsScalar;
+    table->slerpQuaternion = slerpQuaternionScalar;
+    table->cullBoxes = cullBoxesScalar;
+    table->rasterizeDepth = rasterizeDepthScalar;
+    table->collideBoxes = collideBoxesScalar;
+}
+
+C3DMathSIMD::C3DMathSIMD()
+{
+    _backend = Backend_Scalar;
+    setupScalar(this);
+
+    // prefer the widest backend the cpu supports
+    static const Backend preferred[] = { Backend_AVX, Backend_SSE, Backend_NEON };
+    for (size_t i = 0; i < sizeof(preferred) / sizeof(preferred[0]); i++)
+    {
+        if (setBackend(preferred[i]))
+            break;
+    }
+}
+
+C3DMathSIMD& C3DMathSIMD::getInstance()
+{
+    static C3DMathSIMD instance;
+    return instance;
+}
+
+#if defined(C3D_MATH_SSE)
+static void cpuid(int leaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    __cpuid((int*)regs, leaf);
+#else
+    __cpuid(leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+#endif
+
+bool C3DMathSIMD::isSupported(Backend backend)
+{
+    switch (backend)
+    {
+    case Backend_Scalar:
+        return true;
+
+#if defined(C3D_MATH_SSE)
+    case Backend_SSE:
+        {
+            // sse2 is compiled in, check it anyway for 32 bits builds
+            unsigned int regs[4];
+            cpuid(1, regs);
+            return (regs[3] & (1 << 26)) != 0;
+        }
+
+#if defined(C3D_MATH_AVX)
+    case Backend_AVX:
+        {
+            unsigned int regs[4];
+            cpuid(1, regs);
+            bool osxsave = (regs[2] & (1 << 27)) != 0;
+            bool avx = (regs[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx)
+                return false;
+
+            // the os must save the ymm registers on context switches
+#if defined(_MSC_VER)
+            unsigned long long xcr0 = _xgetbv(0);
+#else
+            unsigned int eax, edx;
+            __asm__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            unsigned long long xcr0 = ((unsigned long long)edx << 32) | eax;
+#endif
+            return (xcr0 & 6) == 6;
+        }
+#endif
+#endif
+
+#if defined(C3D_MATH_NEON)
+    case Backend_NEON:
+#if defined(ANDROID) && !defined(__aarch64__)
+        return android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+               (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) != 0;
+#else
+        // aarch64 always has neon, other armv7 targets are only built with neon when the device has it
+        return true;
+#endif
+#endif
+
+    default:
+        return false;
+    }
+}
+
+const char* C3DMathSIMD::getBackendName(Backend backend)
+{
+    static const char* names[Backend_Count] = { "scalar", "sse", "avx", "neon" };
+    return backend < Backend_Count ? names[backend] : "unknown";
+}
+
+bool C3DMathSIMD::setBackend(Backend backend)
+{
+    if (!isSupported(backend))
+        return false;
+
+    // backends only override the routines they vectorize
+    setupScalar(this);
+    switch (backend)
+    {
+    case Backend_SSE:
+        setupSSE(this);
+        break;
+    case Backend_AVX:
+        setupSSE(this);
+        setupAVX(this);
+        break;
+    case Backend_NEON:
+        setupNEON(this);
+        break;
+    default:
+        break;
+    }
+    _backend = backend;
+    return true;
+}
+
+void C3DMathSIMD::computeSlerpWeights(float cosTheta, float t, float* alpha, float* beta)
+{
+    // kwhatmough's fast slerp, see C3DQuaternion::slerp
+    float halfY, u, f1, f2a, f2b;
+    float ratio1, ratio2;
+    float halfSecHalfTheta, versHalfTheta;
+    float sqNotU, sqU;
+
+    // As usual in all slerp implementations, we fold theta.
+    *alpha = cosTheta >= 0 ? 1.0f : -1.0f;
+    halfY = 1.0f + *alpha * cosTheta;
+
+    // Here we bisect the interval, so we need to fold t as well.
+    f2b = t - 0.5f;
+    u = f2b >= 0 ? f2b : -f2b;
+    f2a = u - f2b;
+    f2b += u;
+    u += u;
+    f1 = 1.0f - u;
+
+    // One iteration of Newton to get 1-cos(theta / 2) to good accuracy.
+    halfSecHalfTheta = 1.09f - (0.476537f - 0.0903321f * halfY) * halfY;
+    halfSecHalfTheta *= 1.5f - halfY * halfSecHalfTheta * halfSecHalfTheta;
+    versHalfTheta = 1.0f - halfY * halfSecHalfTheta;
+
+    // Evaluate series expansions of the coefficients.
+    sqNotU = f1 * f1;
+    ratio2 = 0.0000440917108f * versHalfTheta;
+    ratio1 = -0.00158730159f + (sqNotU - 16.0f) * ratio2;
+    ratio1 = 0.0333333333f + ratio1 * (sqNotU - 9.0f) * versHalfTheta;
+    ratio1 = -0.333333333f + ratio1 * (sqNotU - 4.0f) * versHalfTheta;
+    ratio1 = 1.0f + ratio1 * (sqNotU - 1.0f) * versHalfTheta;
+
+    sqU = u * u;
+    ratio2 = -0.00158730159f + (sqU - 16.0f) * ratio2;
+    ratio2 = 0.0333333333f + ratio2 * (sqU - 9.0f) * versHalfTheta;
+    ratio2 = -0.333333333f + ratio2 * (sqU - 4.0f) * versHalfTheta;
+    ratio2 = 1.0f + ratio2 * (sqU - 1.0f) * versHalfTheta;
+
+    // Perform the bisection and resolve the folding done earlier.
+    f1 *= ratio1 * halfSecHalfTheta;
+    f2a *= ratio2;
+    f2b *= ratio2;
+    *alpha *= f1 + f2a;
+    *beta = f1 + f2b;
+}
+
+#if !defined(C3D_MATH_SSE)
+void C3DMathSIMD::setupSSE(C3DMathSIMD* table)
+{
+    (void)table;
+}
+#endif
+
+#if !defined(C3D_MATH_AVX)
+void C3DMathSIMD::setupAVX(C3DMathSIMD* table)
+{
+    (void)table;
+}
+#endif
+
+#if !defined(C3D_MATH_NEON)
+void C3DMathSIMD::setupNEON(C3DMathSIMD* table)
+{
+    (void)table;
+}
+#endif
+}
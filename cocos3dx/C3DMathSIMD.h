@@ -0,0 +1,191 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef C3DMATHSIMD_H_
+#define C3DMATHSIMD_H_
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define C3D_MATH_SSE
+#if defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#define C3D_MATH_AVX
+#endif
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define C3D_MATH_NEON
+#endif
+
+// weight of the overlap on the edge axes in collideBoxes, face axes give more stable contacts
+#define C3D_MATH_SAT_EDGE_WEIGHT 1.05f
+
+namespace cocos3d
+{
+/**
+ * Dispatch table of the vectorized math routines used by C3DMatrix and C3DQuaternion.
+ *
+ * The fastest backend supported by the cpu is selected at runtime the first time the
+ * table is used. The scalar backend is the reference implementation, the other backends
+ * must give the same results up to float rounding.
+ * Matrices are column major arrays of 16 floats, points and vectors are packed arrays of
+ * 3 floats and quaternions are arrays of 4 floats (x, y, z, w).
+ */
+class C3DMathSIMD
+{
+public:
+
+    enum Backend
+    {
+        Backend_Scalar,
+        Backend_SSE,
+        Backend_AVX,
+        Backend_NEON,
+        Backend_Count
+    };
+
+    static C3DMathSIMD& getInstance();
+
+    /**
+     * Is the backend compiled in and supported by the cpu ?
+     */
+    static bool isSupported(Backend backend);
+
+    static const char* getBackendName(Backend backend);
+
+    /**
+     * Forces the backend, returns false and keeps the current one if it is not supported.
+     */
+    bool setBackend(Backend backend);
+    Backend getBackend() const { return _backend; }
+
+    /**
+     * dst = m1 * m2, dst may be m1 or m2.
+     */
+    void (*multiplyMatrix)(const float* m1, const float* m2, float* dst);
+
+    /**
+     * Inverts m into dst, dst may be m. Returns false and leaves dst untouched if m can't be inverted.
+     */
+    bool (*invertMatrix)(const float* m, float* dst);
+
+    /**
+     * Transforms count points (w = 1) or vectors (w = 0) by m, dst may be src.
+     */
+    void (*transformPoints)(const float* m, const float* src, float* dst, unsigned int count);
+    void (*transformVectors)(const float* m, const float* src, float* dst, unsigned int count);
+
+    /**
+     * Spherical linear interpolation, see C3DQuaternion::slerp.
+     */
+    void (*slerpQuaternion)(const float* q1, const float* q2, float t, float* dst);
+
+    /**
+     * Frustum culling of count boxes packed component by component: bounds[0..2] are the
+     * arrays of the center x, y and z, bounds[3..5] the arrays of the extents. Planes are
+     * (normal, distance) quadruples, a box is culled when it is entirely in front of one
+     * of them, see C3DPlane::pointClassify.
+     * The bit i % 32 of visibility[i / 32] is set when the box i is visible, the other bits
+     * of the (count + 31) / 32 words are cleared.
+     * lastPlane[i] is the plane which culled the box the last time, or CULL_NO_PLANE. It is
+     * tested first and updated.
+     */
+    void (*cullBoxes)(const float* planes, unsigned int planeCount, const float* const* bounds,
+                      unsigned char* lastPlane, unsigned int count, unsigned int* visibility);
+
+    enum { CULL_NO_PLANE = 0xff, CULL_MAX_PLANES = 8 };
+
+    /**
+     * Rasterizes count triangles into a depth buffer of width * height floats, keeping the
+     * nearest depth. Triangles are three (x, y, z) vertices in pixels and window depth, 9
+     * floats each, counter clockwise; the back facing ones are skipped. A pixel is covered
+     * when its center (x + 0.5, y + 0.5) is inside or on an edge, so the triangles sharing an
+     * edge leave no hole. width must be a multiple of 4.
+     */
+    void (*rasterizeDepth)(const float* triangles, unsigned int count, float* depth, unsigned int width, unsigned int height);
+
+    /**
+     * Separating axis test of count pairs of oriented boxes. A box is BOX_FLOATS floats: the
+     * center, the three unit axes and the three half extents, a pair is the box a then the box b.
+     * The 15 axes are the face axes of both boxes and the cross products of their edges, the
+     * nearly parallel edges are skipped and the overlap on the other edge axes is weighted by
+     * C3D_MATH_SAT_EDGE_WEIGHT.
+     * depth[i] is the smallest weighted overlap of the pair i, or -1 when an axis separates the
+     * boxes. normal[i * 3] is then the unit axis of that overlap, from a to b.
+     */
+    void (*collideBoxes)(const float* pairs, unsigned int count, float* depth, float* normal);
+
+    enum { BOX_FLOATS = 15, BOX_PAIR_FLOATS = 30 };
+
+    /**
+     * Equations of a triangle for rasterizeDepth. The pixel center (x, y) is covered when the
+     * three edge[i][0] * x + (edge[i][1] * y + edge[i][2]) are not negative, its depth is
+     * depth[0] * x + (depth[1] * y + depth[2]).
+     */
+    struct DepthTriangle
+    {
+        float edge[3][3];
+        float depth[3];
+        int minX, minY, maxX, maxY; // pixels to scan, inclusive
+    };
+
+    /**
+     * Sets up a triangle for rasterizeDepth, shared by all the backends. Returns false when
+     * it is back facing, degenerated or out of the buffer.
+     */
+    static bool setupDepthTriangle(const float* vertices, unsigned int width, unsigned int height, DepthTriangle* triangle);
+
+    /**
+     * Culls the boxes [begin, end) one by one, shared by all the backends for the boxes left
+     * over by their vector loop. The visibility bits of the range must be cleared.
+     */
+    static void cullBoxRange(const float* planes, unsigned int planeCount, const float* const* bounds,
+                             unsigned char* lastPlane, unsigned int begin, unsigned int end, unsigned int* visibility);
+
+    /**
+     * Tests the box pairs [begin, end) one by one, shared by all the backends for the pairs left
+     * over by their vector loop.
+     */
+    static void collideBoxRange(const float* pairs, unsigned int begin, unsigned int end, float* depth, float* normal);
+
+    /**
+     * Computes the weights of q1 and q2 in the slerp, shared by all the backends.
+     * The result still needs the length correction done at the end of C3DQuaternion::slerp.
+     */
+    static void computeSlerpWeights(float cosTheta, float t, float* alpha, float* beta);
+
+private:
+
+    C3DMathSIMD();
+
+    static void slerpQuaternionScalar(const float* q1, const float* q2, float t, float* dst);
+
+    // each backend fills the table, implemented in C3DMathSIMD_*.cpp
+    static void setupScalar(C3DMathSIMD* table);
+    static void setupSSE(C3DMathSIMD* table);
+    static void setupAVX(C3DMathSIMD* table);
+    static void setupNEON(C3DMathSIMD* table);
+
+    Backend _backend;
+};
+}
+
+#endif
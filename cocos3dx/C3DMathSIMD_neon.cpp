@@ -0,0 +1,443 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include <float.h>
+#include "Base.h"
+#include "C3DMathSIMD.h"
+
+#if defined(C3D_MATH_NEON)
+
+#include <arm_neon.h>
+
+namespace cocos3d
+{
+static inline void storeVector3(float* dst, float32x4_t v)
+{
+    vst1_f32(dst, vget_low_f32(v));
+    vst1q_lane_f32(dst + 2, v, 2);
+}
+
+static inline float dot4(float32x4_t a, float32x4_t b)
+{
+    float32x4_t product = vmulq_f32(a, b);
+#if defined(__aarch64__)
+    return vaddvq_f32(product);
+#else
+    float32x2_t sum = vadd_f32(vget_low_f32(product), vget_high_f32(product));
+    return vget_lane_f32(vpadd_f32(sum, sum), 0);
+#endif
+}
+
+static void multiplyMatrixNEON(const float* m1, const float* m2, float* dst)
+{
+    float32x4_t c0 = vld1q_f32(m1);
+    float32x4_t c1 = vld1q_f32(m1 + 4);
+    float32x4_t c2 = vld1q_f32(m1 + 8);
+    float32x4_t c3 = vld1q_f32(m1 + 12);
+
+    // every column of the product is a combination of the columns of m1,
+    // compute them all before storing since dst may be m1 or m2
+    float32x4_t product[4];
+    for (int i = 0; i < 4; i++)
+    {
+        float32x4_t b = vld1q_f32(m2 + i * 4);
+        float32x4_t r = vmulq_lane_f32(c0, vget_low_f32(b), 0);
+        r = vmlaq_lane_f32(r, c1, vget_low_f32(b), 1);
+        r = vmlaq_lane_f32(r, c2, vget_high_f32(b), 0);
+        r = vmlaq_lane_f32(r, c3, vget_high_f32(b), 1);
+        product[i] = r;
+    }
+
+    vst1q_f32(dst, product[0]);
+    vst1q_f32(dst + 4, product[1]);
+    vst1q_f32(dst + 8, product[2]);
+    vst1q_f32(dst + 12, product[3]);
+}
+
+static inline float32x4_t pairVector(float b, float a)
+{
+    return vcombine_f32(vdup_n_f32(b), vdup_n_f32(a));
+}
+
+static bool invertMatrixNEON(const float* m, float* dst)
+{
+    // same cofactor expansion as the scalar version, the 2x2 determinants are scalar
+    // and the 16 cofactors are computed a column at a time
+    float a0 = m[0] * m[5] - m[1] * m[4];
+    float a1 = m[0] * m[6] - m[2] * m[4];
+    float a2 = m[0] * m[7] - m[3] * m[4];
+    float a3 = m[1] * m[6] - m[2] * m[5];
+    float a4 = m[1] * m[7] - m[3] * m[5];
+    float a5 = m[2] * m[7] - m[3] * m[6];
+    float b0 = m[8] * m[13] - m[9] * m[12];
+    float b1 = m[8] * m[14] - m[10] * m[12];
+    float b2 = m[8] * m[15] - m[11] * m[12];
+    float b3 = m[9] * m[14] - m[10] * m[13];
+    float b4 = m[9] * m[15] - m[11] * m[13];
+    float b5 = m[10] * m[15] - m[11] * m[14];
+
+    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+    if (fabs(det) <= MATH_TOLERANCE)
+        return false;
+
+    // rows of m with swapped pairs: p = (m4, m0, m12, m8), x = (m5, m1, m13, m9) ...
+    float32x4x4_t rows = vld4q_f32(m);
+    float32x4_t p = vrev64q_f32(rows.val[0]);
+    float32x4_t x = vrev64q_f32(rows.val[1]);
+    float32x4_t y = vrev64q_f32(rows.val[2]);
+    float32x4_t z = vrev64q_f32(rows.val[3]);
+
+    float32x4_t f0 = pairVector(b0, a0);
+    float32x4_t f1 = pairVector(b1, a1);
+    float32x4_t f2 = pairVector(b2, a2);
+    float32x4_t f3 = pairVector(b3, a3);
+    float32x4_t f4 = pairVector(b4, a4);
+    float32x4_t f5 = pairVector(b5, a5);
+
+    float scale = 1.0f / det;
+    float signs[8] = { scale, -scale, scale, -scale, -scale, scale, -scale, scale };
+    float32x4_t s0 = vld1q_f32(signs);
+    float32x4_t s1 = vld1q_f32(signs + 4);
+
+    float32x4_t col0 = vmlaq_f32(vmlsq_f32(vmulq_f32(x, f5), y, f4), z, f3);
+    float32x4_t col1 = vmlaq_f32(vmlsq_f32(vmulq_f32(p, f5), y, f2), z, f1);
+    float32x4_t col2 = vmlaq_f32(vmlsq_f32(vmulq_f32(p, f4), x, f2), z, f0);
+    float32x4_t col3 = vmlaq_f32(vmlsq_f32(vmulq_f32(p, f3), x, f1), y, f0);
+
+    vst1q_f32(dst, vmulq_f32(col0, s0));
+    vst1q_f32(dst + 4, vmulq_f32(col1, s1));
+    vst1q_f32(dst + 8, vmulq_f32(col2, s0));
+    vst1q_f32(dst + 12, vmulq_f32(col3, s1));
+
+    return true;
+}
+
+static void transformPointsNEON(const float* m, const float* src, float* dst, unsigned int count)
+{
+    float32x4_t c0 = vld1q_f32(m);
+    float32x4_t c1 = vld1q_f32(m + 4);
+    float32x4_t c2 = vld1q_f32(m + 8);
+    float32x4_t c3 = vld1q_f32(m + 12);
+
+    for (unsigned int i = 0; i < count; i++, src += 3, dst += 3)
+    {
+        float32x4_t r = vmlaq_n_f32(c3, c0, src[0]);
+        r = vmlaq_n_f32(r, c1, src[1]);
+        r = vmlaq_n_f32(r, c2, src[2]);
+        storeVector3(dst, r);
+    }
+}
+
+static void transformVectorsNEON(const float* m, const float* src, float* dst, unsigned int count)
+{
+    float32x4_t c0 = vld1q_f32(m);
+    float32x4_t c1 = vld1q_f32(m + 4);
+    float32x4_t c2 = vld1q_f32(m + 8);
+
+    for (unsigned int i = 0; i < count; i++, src += 3, dst += 3)
+    {
+        float32x4_t r = vmulq_n_f32(c0, src[0]);
+        r = vmlaq_n_f32(r, c1, src[1]);
+        r = vmlaq_n_f32(r, c2, src[2]);
+        storeVector3(dst, r);
+    }
+}
+
+static void slerpQuaternionNEON(const float* q1, const float* q2, float t, float* dst)
+{
+    float32x4_t a = vld1q_f32(q1);
+    float32x4_t b = vld1q_f32(q2);
+
+    if (t == 0.0f || (q1[0] == q2[0] && q1[1] == q2[1] && q1[2] == q2[2] && q1[3] == q2[3]))
+    {
+        vst1q_f32(dst, a);
+        return;
+    }
+    else if (t == 1.0f)
+    {
+        vst1q_f32(dst, b);
+        return;
+    }
+
+    float alpha, beta;
+    C3DMathSIMD::computeSlerpWeights(dot4(a, b), t, &alpha, &beta);
+
+    // correct the length of the result, see C3DQuaternion::slerp
+    float32x4_t r = vmlaq_n_f32(vmulq_n_f32(a, alpha), b, beta);
+    float correction = 1.5f - 0.5f * dot4(r, r);
+    vst1q_f32(dst, vmulq_n_f32(r, correction));
+}
+
+// one bit per lane of a comparison result
+static inline int moveMask(uint32x4_t mask)
+{
+    static const uint32_t bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t m = vandq_u32(mask, vld1q_u32(bits));
+#if defined(__aarch64__)
+    return (int)vaddvq_u32(m);
+#else
+    uint32x2_t sum = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+    return (int)vget_lane_u32(vpadd_u32(sum, sum), 0);
+#endif
+}
+
+// mask of the boxes entirely in front of the plane, |n| is passed in absNormal
+static inline uint32x4_t boxesOutside(const float32x4_t* plane, const float32x4_t* absNormal, const float32x4_t* center, const float32x4_t* extent)
+{
+    float32x4_t dist = vmulq_f32(plane[0], center[0]);
+    dist = vmlaq_f32(dist, plane[1], center[1]);
+    dist = vmlaq_f32(dist, plane[2], center[2]);
+    dist = vsubq_f32(dist, plane[3]);
+    dist = vmlsq_f32(dist, absNormal[0], extent[0]);
+    dist = vmlsq_f32(dist, absNormal[1], extent[1]);
+    dist = vmlsq_f32(dist, absNormal[2], extent[2]);
+    return vcgtq_f32(dist, vdupq_n_f32(0.0f));
+}
+
+static void cullBoxesNEON(const float* planes, unsigned int planeCount, const float* const* bounds,
+                          unsigned char* lastPlane, unsigned int count, unsigned int* visibility)
+{
+    assert(planeCount <= C3DMathSIMD::CULL_MAX_PLANES);
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+
+    float32x4_t n[C3DMathSIMD::CULL_MAX_PLANES][4];
+    float32x4_t a[C3DMathSIMD::CULL_MAX_PLANES][3];
+    uint32x4_t index[C3DMathSIMD::CULL_MAX_PLANES];
+    for (unsigned int p = 0; p < planeCount; p++)
+    {
+        for (int k = 0; k < 4; k++)
+            n[p][k] = vdupq_n_f32(planes[p * 4 + k]);
+        for (int k = 0; k < 3; k++)
+            a[p][k] = vabsq_f32(n[p][k]);
+        index[p] = vdupq_n_u32(p);
+    }
+
+    // four boxes at once, a group never straddles two visibility words
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t center[3], extent[3];
+        for (int k = 0; k < 3; k++)
+        {
+            center[k] = vld1q_f32(bounds[k] + i);
+            extent[k] = vld1q_f32(bounds[k + 3] + i);
+        }
+
+        // neighbour boxes are mostly culled by the same plane, start with it
+        unsigned int first = lastPlane[i];
+        if (lastPlane[i + 1] != first || lastPlane[i + 2] != first || lastPlane[i + 3] != first)
+            first = C3DMathSIMD::CULL_NO_PLANE;
+
+        uint32x4_t culled = vdupq_n_u32(0);
+        uint32x4_t culledBy = vdupq_n_u32(C3DMathSIMD::CULL_NO_PLANE);
+        if (first < planeCount)
+        {
+            culled = boxesOutside(n[first], a[first], center, extent);
+            culledBy = vbslq_u32(culled, index[first], culledBy);
+        }
+
+        for (unsigned int p = 0; p < planeCount && moveMask(culled) != 0xf; p++)
+        {
+            if (p == first)
+                continue;
+
+            // remember the first plane culling each box
+            uint32x4_t out = vbicq_u32(boxesOutside(n[p], a[p], center, extent), culled);
+            culledBy = vbslq_u32(out, index[p], culledBy);
+            culled = vorrq_u32(culled, out);
+        }
+
+        // the plane indices fit in a byte
+        uint16x4_t words = vmovn_u32(culledBy);
+        uint8x8_t bytes = vmovn_u16(vcombine_u16(words, words));
+        unsigned char planeBytes[8];
+        vst1_u8(planeBytes, bytes);
+        memcpy(lastPlane + i, planeBytes, 4);
+
+        unsigned int visibleMask = ~moveMask(culled) & 0xf;
+        visibility[i >> 5] |= visibleMask << (i & 31);
+    }
+
+    C3DMathSIMD::cullBoxRange(planes, planeCount, bounds, lastPlane, i, count, visibility);
+}
+
+static void rasterizeDepthNEON(const float* triangles, unsigned int count, float* depth, unsigned int width, unsigned int height)
+{
+    static const float offsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+    const float32x4_t laneOffset = vld1q_f32(offsets);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    C3DMathSIMD::DepthTriangle t;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (!C3DMathSIMD::setupDepthTriangle(triangles + i * 9, width, height, &t))
+            continue;
+
+        // four pixels at once from a multiple of 4, see rasterizeDepthSSE
+        int startX = t.minX & ~3;
+        for (int y = t.minY; y <= t.maxY; y++)
+        {
+            float py = y + 0.5f;
+            float32x4_t rowEdge0 = vdupq_n_f32(t.edge[0][1] * py + t.edge[0][2]);
+            float32x4_t rowEdge1 = vdupq_n_f32(t.edge[1][1] * py + t.edge[1][2]);
+            float32x4_t rowEdge2 = vdupq_n_f32(t.edge[2][1] * py + t.edge[2][2]);
+            float32x4_t rowDepth = vdupq_n_f32(t.depth[1] * py + t.depth[2]);
+            float* row = depth + y * width;
+
+            for (int x = startX; x <= t.maxX; x += 4)
+            {
+                float32x4_t px = vaddq_f32(vdupq_n_f32((float)x), laneOffset);
+                uint32x4_t inside = vcgeq_f32(vaddq_f32(vmulq_n_f32(px, t.edge[0][0]), rowEdge0), zero);
+                inside = vandq_u32(inside, vcgeq_f32(vaddq_f32(vmulq_n_f32(px, t.edge[1][0]), rowEdge1), zero));
+                inside = vandq_u32(inside, vcgeq_f32(vaddq_f32(vmulq_n_f32(px, t.edge[2][0]), rowEdge2), zero));
+                if (moveMask(inside) == 0)
+                    continue;
+
+                float32x4_t z = vaddq_f32(vmulq_n_f32(px, t.depth[0]), rowDepth);
+                float32x4_t old = vld1q_f32(row + x);
+                uint32x4_t nearer = vandq_u32(inside, vcltq_f32(z, old));
+                vst1q_f32(row + x, vbslq_f32(nearer, z, old));
+            }
+        }
+    }
+}
+
+static inline float32x4_t dot3(const float32x4_t* a, const float32x4_t* b)
+{
+    return vmlaq_f32(vmlaq_f32(vmulq_f32(a[0], b[0]), a[1], b[1]), a[2], b[2]);
+}
+
+static inline float32x4_t inverseSqrt(float32x4_t v)
+{
+#if defined(__aarch64__)
+    return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(v));
+#else
+    // the estimate has 8 bits, two newton steps bring it near float precision
+    float32x4_t r = vrsqrteq_f32(v);
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(v, r), r));
+    return vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(v, r), r));
+#endif
+}
+
+// radius of the boxes projected on the unit axes, see C3DMathSIMD::collideBoxRange
+static inline float32x4_t projectBoxes(const float32x4_t* box, const float32x4_t* axis)
+{
+    float32x4_t r = vmulq_f32(vabsq_f32(dot3(box + 3, axis)), box[12]);
+    r = vmlaq_f32(r, vabsq_f32(dot3(box + 6, axis)), box[13]);
+    return vmlaq_f32(r, vabsq_f32(dot3(box + 9, axis)), box[14]);
+}
+
+static void collideBoxesNEON(const float* pairs, unsigned int count, float* depth, float* normal)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t minLength = vdupq_n_f32(1e-3f);
+    const uint32x4_t signMask = vdupq_n_u32(0x80000000);
+
+    // four pairs at once, a lane per pair
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* p = pairs + i * C3DMathSIMD::BOX_PAIR_FLOATS;
+        float32x4_t v[C3DMathSIMD::BOX_PAIR_FLOATS];
+        for (int k = 0; k < C3DMathSIMD::BOX_PAIR_FLOATS; k++)
+        {
+            float lanes[4] = { p[k], p[C3DMathSIMD::BOX_PAIR_FLOATS + k], p[C3DMathSIMD::BOX_PAIR_FLOATS * 2 + k], p[C3DMathSIMD::BOX_PAIR_FLOATS * 3 + k] };
+            v[k] = vld1q_f32(lanes);
+        }
+
+        const float32x4_t* a = v;
+        const float32x4_t* b = v + C3DMathSIMD::BOX_FLOATS;
+        float32x4_t offset[3] = { vsubq_f32(b[0], a[0]), vsubq_f32(b[1], a[1]), vsubq_f32(b[2], a[2]) };
+
+        float32x4_t minDepth = vdupq_n_f32(FLT_MAX);
+        float32x4_t n[3] = { zero, zero, zero };
+        uint32x4_t separated = vdupq_n_u32(0);
+        for (int k = 0; k < 15 && moveMask(separated) != 0xf; k++)
+        {
+            float32x4_t axis[3];
+            if (k < 6)
+            {
+                const float32x4_t* face = (k < 3 ? a + 3 + k * 3 : b + 3 + (k - 3) * 3);
+                axis[0] = face[0];
+                axis[1] = face[1];
+                axis[2] = face[2];
+            }
+            else
+            {
+                const float32x4_t* u = a + 3 + ((k - 6) / 3) * 3;
+                const float32x4_t* w = b + 3 + ((k - 6) % 3) * 3;
+                axis[0] = vmlsq_f32(vmulq_f32(u[1], w[2]), u[2], w[1]);
+                axis[1] = vmlsq_f32(vmulq_f32(u[2], w[0]), u[0], w[2]);
+                axis[2] = vmlsq_f32(vmulq_f32(u[0], w[1]), u[1], w[0]);
+            }
+
+            // the skipped axes are normalized by 1, they must not give inf or NaN
+            float32x4_t len2 = dot3(axis, axis);
+            uint32x4_t valid = vcgeq_f32(len2, minLength);
+            float32x4_t invLength = inverseSqrt(vbslq_f32(valid, len2, one));
+            axis[0] = vmulq_f32(axis[0], invLength);
+            axis[1] = vmulq_f32(axis[1], invLength);
+            axis[2] = vmulq_f32(axis[2], invLength);
+
+            float32x4_t dist = dot3(offset, axis);
+            float32x4_t overlap = vsubq_f32(vaddq_f32(projectBoxes(a, axis), projectBoxes(b, axis)), vabsq_f32(dist));
+            separated = vorrq_u32(separated, vandq_u32(valid, vcltq_f32(overlap, zero)));
+
+            if (k >= 6)
+                overlap = vmulq_n_f32(overlap, C3D_MATH_SAT_EDGE_WEIGHT);
+            uint32x4_t better = vandq_u32(valid, vcltq_f32(overlap, minDepth));
+            minDepth = vbslq_f32(better, overlap, minDepth);
+
+            // the normal goes from a to b
+            uint32x4_t flip = vandq_u32(vcltq_f32(dist, zero), signMask);
+            for (int c = 0; c < 3; c++)
+            {
+                float32x4_t flipped = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(axis[c]), flip));
+                n[c] = vbslq_f32(better, flipped, n[c]);
+            }
+        }
+
+        vst1q_f32(depth + i, vbslq_f32(separated, vdupq_n_f32(-1.0f), minDepth));
+
+        float32x4x3_t interleaved = { { n[0], n[1], n[2] } };
+        vst3q_f32(normal + i * 3, interleaved);
+    }
+
+    C3DMathSIMD::collideBoxRange(pairs, i, count, depth, normal);
+}
+
+void C3DMathSIMD::setupNEON(C3DMathSIMD* table)
+{
+    table->multiplyMatrix = multiplyMatrixNEON;
+    table->invertMatrix = invertMatrixNEON;
+    table->transformPoints = transformPointsNEON;
+    table->transformVectors = transformVectorsNEON;
+    table->slerpQuaternion = slerpQuaternionNEON;
+    table->cullBoxes = cullBoxesNEON;
+    table->rasterizeDepth = rasterizeDepthNEON;
+    table->collideBoxes = collideBoxesNEON;
+}
+}
+
+#endif
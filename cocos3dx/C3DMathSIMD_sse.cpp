@@ -0,0 +1,617 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include <float.h>
+#include "Base.h"
+#include "C3DMathSIMD.h"
+
+#if defined(C3D_MATH_SSE)
+
+#include <emmintrin.h>
+#if defined(C3D_MATH_AVX)
+#include <immintrin.h>
+#endif
+
+// gcc and clang only emit avx code in functions asking for it, msvc always does
+#if defined(__GNUC__)
+#define C3D_AVX_FUNCTION __attribute__((target("avx")))
+#else
+#define C3D_AVX_FUNCTION
+#endif
+
+namespace cocos3d
+{
+static inline void storeVector3(float* dst, __m128 v)
+{
+    _mm_storel_pi((__m64*)dst, v);
+    _mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+}
+
+static inline __m128 dot4(__m128 a, __m128 b)
+{
+    __m128 product = _mm_mul_ps(a, b);
+    __m128 sum = _mm_add_ps(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+static void multiplyMatrixSSE(const float* m1, const float* m2, float* dst)
+{
+    __m128 c0 = _mm_loadu_ps(m1);
+    __m128 c1 = _mm_loadu_ps(m1 + 4);
+    __m128 c2 = _mm_loadu_ps(m1 + 8);
+    __m128 c3 = _mm_loadu_ps(m1 + 12);
+
+    // every column of the product is a combination of the columns of m1,
+    // compute them all before storing since dst may be m1 or m2
+    __m128 product[4];
+    for (int i = 0; i < 4; i++)
+    {
+        const float* b = m2 + i * 4;
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(b[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(b[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(b[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_set1_ps(b[3])));
+        product[i] = r;
+    }
+
+    _mm_storeu_ps(dst, product[0]);
+    _mm_storeu_ps(dst + 4, product[1]);
+    _mm_storeu_ps(dst + 8, product[2]);
+    _mm_storeu_ps(dst + 12, product[3]);
+}
+
+static bool invertMatrixSSE(const float* m, float* dst)
+{
+    // same cofactor expansion as the scalar version, the 2x2 determinants are scalar
+    // and the 16 cofactors are computed a column at a time
+    float a0 = m[0] * m[5] - m[1] * m[4];
+    float a1 = m[0] * m[6] - m[2] * m[4];
+    float a2 = m[0] * m[7] - m[3] * m[4];
+    float a3 = m[1] * m[6] - m[2] * m[5];
+    float a4 = m[1] * m[7] - m[3] * m[5];
+    float a5 = m[2] * m[7] - m[3] * m[6];
+    float b0 = m[8] * m[13] - m[9] * m[12];
+    float b1 = m[8] * m[14] - m[10] * m[12];
+    float b2 = m[8] * m[15] - m[11] * m[12];
+    float b3 = m[9] * m[14] - m[10] * m[13];
+    float b4 = m[9] * m[15] - m[11] * m[13];
+    float b5 = m[10] * m[15] - m[11] * m[14];
+
+    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
+    if (fabs(det) <= MATH_TOLERANCE)
+        return false;
+
+    // rows of m with swapped pairs: p = (m4, m0, m12, m8), x = (m5, m1, m13, m9) ...
+    __m128 r0 = _mm_loadu_ps(m);
+    __m128 r1 = _mm_loadu_ps(m + 4);
+    __m128 r2 = _mm_loadu_ps(m + 8);
+    __m128 r3 = _mm_loadu_ps(m + 12);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    __m128 p = _mm_shuffle_ps(r0, r0, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 x = _mm_shuffle_ps(r1, r1, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 y = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 z = _mm_shuffle_ps(r3, r3, _MM_SHUFFLE(2, 3, 0, 1));
+
+    __m128 f0 = _mm_setr_ps(b0, b0, a0, a0);
+    __m128 f1 = _mm_setr_ps(b1, b1, a1, a1);
+    __m128 f2 = _mm_setr_ps(b2, b2, a2, a2);
+    __m128 f3 = _mm_setr_ps(b3, b3, a3, a3);
+    __m128 f4 = _mm_setr_ps(b4, b4, a4, a4);
+    __m128 f5 = _mm_setr_ps(b5, b5, a5, a5);
+
+    float scale = 1.0f / det;
+    __m128 s0 = _mm_setr_ps(scale, -scale, scale, -scale);
+    __m128 s1 = _mm_setr_ps(-scale, scale, -scale, scale);
+
+    __m128 col0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(x, f5), _mm_mul_ps(y, f4)), _mm_mul_ps(z, f3));
+    __m128 col1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(p, f5), _mm_mul_ps(y, f2)), _mm_mul_ps(z, f1));
+    __m128 col2 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(p, f4), _mm_mul_ps(x, f2)), _mm_mul_ps(z, f0));
+    __m128 col3 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(p, f3), _mm_mul_ps(x, f1)), _mm_mul_ps(y, f0));
+
+    _mm_storeu_ps(dst, _mm_mul_ps(col0, s0));
+    _mm_storeu_ps(dst + 4, _mm_mul_ps(col1, s1));
+    _mm_storeu_ps(dst + 8, _mm_mul_ps(col2, s0));
+    _mm_storeu_ps(dst + 12, _mm_mul_ps(col3, s1));
+
+    return true;
+}
+
+static void transformPointsSSE(const float* m, const float* src, float* dst, unsigned int count)
+{
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+
+    for (unsigned int i = 0; i < count; i++, src += 3, dst += 3)
+    {
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(src[0])), c3);
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(src[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(src[2])));
+        storeVector3(dst, r);
+    }
+}
+
+static void transformVectorsSSE(const float* m, const float* src, float* dst, unsigned int count)
+{
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+
+    for (unsigned int i = 0; i < count; i++, src += 3, dst += 3)
+    {
+        __m128 r = _mm_mul_ps(c0, _mm_set1_ps(src[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(src[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(src[2])));
+        storeVector3(dst, r);
+    }
+}
+
+static void slerpQuaternionSSE(const float* q1, const float* q2, float t, float* dst)
+{
+    __m128 a = _mm_loadu_ps(q1);
+    __m128 b = _mm_loadu_ps(q2);
+
+    if (t == 0.0f || _mm_movemask_ps(_mm_cmpneq_ps(a, b)) == 0)
+    {
+        _mm_storeu_ps(dst, a);
+        return;
+    }
+    else if (t == 1.0f)
+    {
+        _mm_storeu_ps(dst, b);
+        return;
+    }
+
+    float alpha, beta;
+    C3DMathSIMD::computeSlerpWeights(_mm_cvtss_f32(dot4(a, b)), t, &alpha, &beta);
+
+    // correct the length of the result, see C3DQuaternion::slerp
+    __m128 r = _mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(alpha)), _mm_mul_ps(b, _mm_set1_ps(beta)));
+    __m128 correction = _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_set1_ps(0.5f), dot4(r, r)));
+    _mm_storeu_ps(dst, _mm_mul_ps(r, correction));
+}
+
+// mask of the boxes entirely in front of the plane, |n| is passed in absNormal
+static inline __m128 boxesOutside(const __m128* plane, const __m128* absNormal, const __m128* center, const __m128* extent)
+{
+    __m128 dist = _mm_add_ps(_mm_mul_ps(plane[0], center[0]), _mm_mul_ps(plane[1], center[1]));
+    dist = _mm_sub_ps(_mm_add_ps(dist, _mm_mul_ps(plane[2], center[2])), plane[3]);
+    __m128 radius = _mm_add_ps(_mm_mul_ps(absNormal[0], extent[0]), _mm_mul_ps(absNormal[1], extent[1]));
+    radius = _mm_add_ps(radius, _mm_mul_ps(absNormal[2], extent[2]));
+    return _mm_cmpgt_ps(_mm_sub_ps(dist, radius), _mm_setzero_ps());
+}
+
+// the cached plane of a group of boxes when they all share it, CULL_NO_PLANE otherwise
+static inline unsigned int commonPlane(const unsigned char* lastPlane, unsigned int laneCount)
+{
+    unsigned int p = lastPlane[0];
+    for (unsigned int lane = 1; lane < laneCount; lane++)
+    {
+        if (lastPlane[lane] != p)
+            return C3DMathSIMD::CULL_NO_PLANE;
+    }
+    return p;
+}
+
+static void cullBoxesSSE(const float* planes, unsigned int planeCount, const float* const* bounds,
+                         unsigned char* lastPlane, unsigned int count, unsigned int* visibility)
+{
+    assert(planeCount <= C3DMathSIMD::CULL_MAX_PLANES);
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+
+    __m128 n[C3DMathSIMD::CULL_MAX_PLANES][4];
+    __m128 a[C3DMathSIMD::CULL_MAX_PLANES][3];
+    __m128i index[C3DMathSIMD::CULL_MAX_PLANES];
+    for (unsigned int p = 0; p < planeCount; p++)
+    {
+        for (int k = 0; k < 4; k++)
+            n[p][k] = _mm_set1_ps(planes[p * 4 + k]);
+        for (int k = 0; k < 3; k++)
+            a[p][k] = _mm_andnot_ps(signMask, n[p][k]);
+        index[p] = _mm_set1_epi32(p);
+    }
+
+    // four boxes at once, a group never straddles two visibility words
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 center[3], extent[3];
+        for (int k = 0; k < 3; k++)
+        {
+            center[k] = _mm_loadu_ps(bounds[k] + i);
+            extent[k] = _mm_loadu_ps(bounds[k + 3] + i);
+        }
+
+        // neighbour boxes are mostly culled by the same plane, start with it
+        unsigned int first = commonPlane(lastPlane + i, 4);
+        __m128 culled = _mm_setzero_ps();
+        __m128i culledBy = _mm_set1_epi32(C3DMathSIMD::CULL_NO_PLANE);
+        if (first < planeCount)
+        {
+            culled = boxesOutside(n[first], a[first], center, extent);
+            culledBy = _mm_or_si128(_mm_and_si128(_mm_castps_si128(culled), index[first]), _mm_andnot_si128(_mm_castps_si128(culled), culledBy));
+        }
+
+        for (unsigned int p = 0; p < planeCount && _mm_movemask_ps(culled) != 0xf; p++)
+        {
+            if (p == first)
+                continue;
+
+            // remember the first plane culling each box
+            __m128 out = _mm_andnot_ps(culled, boxesOutside(n[p], a[p], center, extent));
+            culledBy = _mm_or_si128(_mm_and_si128(_mm_castps_si128(out), index[p]), _mm_andnot_si128(_mm_castps_si128(out), culledBy));
+            culled = _mm_or_ps(culled, out);
+        }
+
+        // the plane indices fit in a byte
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(culledBy, culledBy), culledBy);
+        int planeBytes = _mm_cvtsi128_si32(packed);
+        memcpy(lastPlane + i, &planeBytes, 4);
+
+        unsigned int visibleMask = ~_mm_movemask_ps(culled) & 0xf;
+        visibility[i >> 5] |= visibleMask << (i & 31);
+    }
+
+    C3DMathSIMD::cullBoxRange(planes, planeCount, bounds, lastPlane, i, count, visibility);
+}
+
+static void rasterizeDepthSSE(const float* triangles, unsigned int count, float* depth, unsigned int width, unsigned int height)
+{
+    const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    C3DMathSIMD::DepthTriangle t;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (!C3DMathSIMD::setupDepthTriangle(triangles + i * 9, width, height, &t))
+            continue;
+
+        __m128 edgeX[3];
+        for (int k = 0; k < 3; k++)
+            edgeX[k] = _mm_set1_ps(t.edge[k][0]);
+        __m128 depthX = _mm_set1_ps(t.depth[0]);
+
+        // four pixels at once from a multiple of 4, the rows never end in the middle of a group
+        int startX = t.minX & ~3;
+        for (int y = t.minY; y <= t.maxY; y++)
+        {
+            float py = y + 0.5f;
+            __m128 rowEdge0 = _mm_set1_ps(t.edge[0][1] * py + t.edge[0][2]);
+            __m128 rowEdge1 = _mm_set1_ps(t.edge[1][1] * py + t.edge[1][2]);
+            __m128 rowEdge2 = _mm_set1_ps(t.edge[2][1] * py + t.edge[2][2]);
+            __m128 rowDepth = _mm_set1_ps(t.depth[1] * py + t.depth[2]);
+            float* row = depth + y * width;
+
+            for (int x = startX; x <= t.maxX; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffset);
+                __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[0], px), rowEdge0), zero);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[1], px), rowEdge1), zero));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeX[2], px), rowEdge2), zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(depthX, px), rowDepth);
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_and_ps(inside, _mm_cmplt_ps(z, old));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(nearer, z), _mm_andnot_ps(nearer, old)));
+            }
+        }
+    }
+}
+
+static inline __m128 dot3(const __m128* a, const __m128* b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+}
+
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// radius of the boxes projected on the unit axes, see C3DMathSIMD::collideBoxRange
+static inline __m128 projectBoxes(const __m128* box, const __m128* axis, __m128 signMask)
+{
+    __m128 r = _mm_mul_ps(_mm_andnot_ps(signMask, dot3(box + 3, axis)), box[12]);
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_andnot_ps(signMask, dot3(box + 6, axis)), box[13]));
+    return _mm_add_ps(r, _mm_mul_ps(_mm_andnot_ps(signMask, dot3(box + 9, axis)), box[14]));
+}
+
+static void collideBoxesSSE(const float* pairs, unsigned int count, float* depth, float* normal)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minLength = _mm_set1_ps(1e-3f);
+    const __m128 edgeWeight = _mm_set1_ps(C3D_MATH_SAT_EDGE_WEIGHT);
+
+    // four pairs at once, a lane per pair
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* p = pairs + i * C3DMathSIMD::BOX_PAIR_FLOATS;
+        __m128 v[C3DMathSIMD::BOX_PAIR_FLOATS];
+        for (int k = 0; k < 28; k += 4)
+        {
+            __m128 r0 = _mm_loadu_ps(p + k);
+            __m128 r1 = _mm_loadu_ps(p + C3DMathSIMD::BOX_PAIR_FLOATS + k);
+            __m128 r2 = _mm_loadu_ps(p + C3DMathSIMD::BOX_PAIR_FLOATS * 2 + k);
+            __m128 r3 = _mm_loadu_ps(p + C3DMathSIMD::BOX_PAIR_FLOATS * 3 + k);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            v[k] = r0;
+            v[k + 1] = r1;
+            v[k + 2] = r2;
+            v[k + 3] = r3;
+        }
+        for (int k = 28; k < C3DMathSIMD::BOX_PAIR_FLOATS; k++)
+        {
+            v[k] = _mm_setr_ps(p[k], p[C3DMathSIMD::BOX_PAIR_FLOATS + k], p[C3DMathSIMD::BOX_PAIR_FLOATS * 2 + k], p[C3DMathSIMD::BOX_PAIR_FLOATS * 3 + k]);
+        }
+
+        const __m128* a = v;
+        const __m128* b = v + C3DMathSIMD::BOX_FLOATS;
+        __m128 offset[3] = { _mm_sub_ps(b[0], a[0]), _mm_sub_ps(b[1], a[1]), _mm_sub_ps(b[2], a[2]) };
+
+        __m128 minDepth = _mm_set1_ps(FLT_MAX);
+        __m128 n[3] = { zero, zero, zero };
+        __m128 separated = zero;
+        for (int k = 0; k < 15 && _mm_movemask_ps(separated) != 0xf; k++)
+        {
+            __m128 axis[3];
+            if (k < 6)
+            {
+                const __m128* face = (k < 3 ? a + 3 + k * 3 : b + 3 + (k - 3) * 3);
+                axis[0] = face[0];
+                axis[1] = face[1];
+                axis[2] = face[2];
+            }
+            else
+            {
+                const __m128* u = a + 3 + ((k - 6) / 3) * 3;
+                const __m128* w = b + 3 + ((k - 6) % 3) * 3;
+                axis[0] = _mm_sub_ps(_mm_mul_ps(u[1], w[2]), _mm_mul_ps(u[2], w[1]));
+                axis[1] = _mm_sub_ps(_mm_mul_ps(u[2], w[0]), _mm_mul_ps(u[0], w[2]));
+                axis[2] = _mm_sub_ps(_mm_mul_ps(u[0], w[1]), _mm_mul_ps(u[1], w[0]));
+            }
+
+            // the skipped axes are normalized by 1, they must not give inf or NaN
+            __m128 len2 = dot3(axis, axis);
+            __m128 valid = _mm_cmpge_ps(len2, minLength);
+            __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(select(valid, len2, one)));
+            axis[0] = _mm_mul_ps(axis[0], invLength);
+            axis[1] = _mm_mul_ps(axis[1], invLength);
+            axis[2] = _mm_mul_ps(axis[2], invLength);
+
+            __m128 dist = dot3(offset, axis);
+            __m128 overlap = _mm_add_ps(projectBoxes(a, axis, signMask), projectBoxes(b, axis, signMask));
+            overlap = _mm_sub_ps(overlap, _mm_andnot_ps(signMask, dist));
+            separated = _mm_or_ps(separated, _mm_and_ps(valid, _mm_cmplt_ps(overlap, zero)));
+
+            if (k >= 6)
+                overlap = _mm_mul_ps(overlap, edgeWeight);
+            __m128 better = _mm_and_ps(valid, _mm_cmplt_ps(overlap, minDepth));
+            minDepth = select(better, overlap, minDepth);
+
+            // the normal goes from a to b
+            __m128 flip = _mm_and_ps(_mm_cmplt_ps(dist, zero), signMask);
+            for (int c = 0; c < 3; c++)
+                n[c] = select(better, _mm_xor_ps(axis[c], flip), n[c]);
+        }
+
+        _mm_storeu_ps(depth + i, select(separated, _mm_set1_ps(-1.0f), minDepth));
+
+        float nx[4], ny[4], nz[4];
+        _mm_storeu_ps(nx, n[0]);
+        _mm_storeu_ps(ny, n[1]);
+        _mm_storeu_ps(nz, n[2]);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            float* dst = normal + (i + lane) * 3;
+            dst[0] = nx[lane];
+            dst[1] = ny[lane];
+            dst[2] = nz[lane];
+        }
+    }
+
+    C3DMathSIMD::collideBoxRange(pairs, i, count, depth, normal);
+}
+
+void C3DMathSIMD::setupSSE(C3DMathSIMD* table)
+{
+    table->multiplyMatrix = multiplyMatrixSSE;
+    table->invertMatrix = invertMatrixSSE;
+    table->transformPoints = transformPointsSSE;
+    table->transformVectors = transformVectorsSSE;
+    table->slerpQuaternion = slerpQuaternionSSE;
+    table->cullBoxes = cullBoxesSSE;
+    table->rasterizeDepth = rasterizeDepthSSE;
+    table->collideBoxes = collideBoxesSSE;
+}
+
+#if defined(C3D_MATH_AVX)
+
+C3D_AVX_FUNCTION static inline __m256 broadcast128(const float* v)
+{
+    __m128 lo = _mm_loadu_ps(v);
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), lo, 1);
+}
+
+C3D_AVX_FUNCTION static inline __m256 set2(float lo, float hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(lo)), _mm_set1_ps(hi), 1);
+}
+
+C3D_AVX_FUNCTION static void multiplyMatrixAVX(const float* m1, const float* m2, float* dst)
+{
+    // columns of m1 in both lanes, two columns of the product at once
+    __m256 c0 = broadcast128(m1);
+    __m256 c1 = broadcast128(m1 + 4);
+    __m256 c2 = broadcast128(m1 + 8);
+    __m256 c3 = broadcast128(m1 + 12);
+
+    __m256 b01 = _mm256_loadu_ps(m2);
+    __m256 b23 = _mm256_loadu_ps(m2 + 8);
+
+    __m256 r01 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(0, 0, 0, 0)));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(c1, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(1, 1, 1, 1))));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(c2, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(2, 2, 2, 2))));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(c3, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(3, 3, 3, 3))));
+
+    __m256 r23 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(0, 0, 0, 0)));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(c1, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(1, 1, 1, 1))));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(c2, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(2, 2, 2, 2))));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(c3, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(3, 3, 3, 3))));
+
+    _mm256_storeu_ps(dst, r01);
+    _mm256_storeu_ps(dst + 8, r23);
+    _mm256_zeroupper();
+}
+
+C3D_AVX_FUNCTION static void transformAVX(const float* m, const float* src, float* dst, unsigned int count, bool point)
+{
+    __m256 c0 = broadcast128(m);
+    __m256 c1 = broadcast128(m + 4);
+    __m256 c2 = broadcast128(m + 8);
+    __m256 c3 = point ? broadcast128(m + 12) : _mm256_setzero_ps();
+
+    // two points at once, one per lane
+    unsigned int i = 0;
+    for (; i + 1 < count; i += 2, src += 6, dst += 6)
+    {
+        __m256 r = _mm256_add_ps(_mm256_mul_ps(c0, set2(src[0], src[3])), c3);
+        r = _mm256_add_ps(r, _mm256_mul_ps(c1, set2(src[1], src[4])));
+        r = _mm256_add_ps(r, _mm256_mul_ps(c2, set2(src[2], src[5])));
+        storeVector3(dst, _mm256_castps256_ps128(r));
+        storeVector3(dst + 3, _mm256_extractf128_ps(r, 1));
+    }
+    _mm256_zeroupper();
+
+    if (i < count)
+    {
+        if (point)
+            transformPointsSSE(m, src, dst, 1);
+        else
+            transformVectorsSSE(m, src, dst, 1);
+    }
+}
+
+static void transformPointsAVX(const float* m, const float* src, float* dst, unsigned int count)
+{
+    transformAVX(m, src, dst, count, true);
+}
+
+static void transformVectorsAVX(const float* m, const float* src, float* dst, unsigned int count)
+{
+    transformAVX(m, src, dst, count, false);
+}
+
+C3D_AVX_FUNCTION static inline __m256 boxesOutsideAVX(const __m256* plane, const __m256* absNormal, const __m256* center, const __m256* extent)
+{
+    __m256 dist = _mm256_add_ps(_mm256_mul_ps(plane[0], center[0]), _mm256_mul_ps(plane[1], center[1]));
+    dist = _mm256_sub_ps(_mm256_add_ps(dist, _mm256_mul_ps(plane[2], center[2])), plane[3]);
+    __m256 radius = _mm256_add_ps(_mm256_mul_ps(absNormal[0], extent[0]), _mm256_mul_ps(absNormal[1], extent[1]));
+    radius = _mm256_add_ps(radius, _mm256_mul_ps(absNormal[2], extent[2]));
+    return _mm256_cmp_ps(_mm256_sub_ps(dist, radius), _mm256_setzero_ps(), _CMP_GT_OQ);
+}
+
+C3D_AVX_FUNCTION static void cullBoxesAVX(const float* planes, unsigned int planeCount, const float* const* bounds,
+                                          unsigned char* lastPlane, unsigned int count, unsigned int* visibility)
+{
+    assert(planeCount <= C3DMathSIMD::CULL_MAX_PLANES);
+    memset(visibility, 0, ((count + 31) / 32) * sizeof(unsigned int));
+
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    // avx has no 256 bits integer ops, the plane indices are blended as floats
+    __m256 n[C3DMathSIMD::CULL_MAX_PLANES][4];
+    __m256 a[C3DMathSIMD::CULL_MAX_PLANES][3];
+    __m256 index[C3DMathSIMD::CULL_MAX_PLANES];
+    for (unsigned int p = 0; p < planeCount; p++)
+    {
+        for (int k = 0; k < 4; k++)
+            n[p][k] = _mm256_set1_ps(planes[p * 4 + k]);
+        for (int k = 0; k < 3; k++)
+            a[p][k] = _mm256_andnot_ps(signMask, n[p][k]);
+        index[p] = _mm256_set1_ps((float)p);
+    }
+
+    // eight boxes at once, see cullBoxesSSE
+    unsigned int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 center[3], extent[3];
+        for (int k = 0; k < 3; k++)
+        {
+            center[k] = _mm256_loadu_ps(bounds[k] + i);
+            extent[k] = _mm256_loadu_ps(bounds[k + 3] + i);
+        }
+
+        unsigned int first = commonPlane(lastPlane + i, 8);
+        __m256 culled = _mm256_setzero_ps();
+        __m256 culledBy = _mm256_set1_ps((float)C3DMathSIMD::CULL_NO_PLANE);
+        if (first < planeCount)
+        {
+            culled = boxesOutsideAVX(n[first], a[first], center, extent);
+            culledBy = _mm256_blendv_ps(culledBy, index[first], culled);
+        }
+
+        for (unsigned int p = 0; p < planeCount && _mm256_movemask_ps(culled) != 0xff; p++)
+        {
+            if (p == first)
+                continue;
+
+            __m256 out = _mm256_andnot_ps(culled, boxesOutsideAVX(n[p], a[p], center, extent));
+            culledBy = _mm256_blendv_ps(culledBy, index[p], out);
+            culled = _mm256_or_ps(culled, out);
+        }
+
+        __m256i indices = _mm256_cvtps_epi32(culledBy);
+        __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(indices), _mm256_extractf128_si256(indices, 1));
+        _mm_storel_epi64((__m128i*)(lastPlane + i), _mm_packus_epi16(words, words));
+
+        unsigned int visibleMask = ~_mm256_movemask_ps(culled) & 0xff;
+        visibility[i >> 5] |= visibleMask << (i & 31);
+    }
+    _mm256_zeroupper();
+
+    C3DMathSIMD::cullBoxRange(planes, planeCount, bounds, lastPlane, i, count, visibility);
+}
+
+void C3DMathSIMD::setupAVX(C3DMathSIMD* table)
+{
+    // inverse, slerp, the depth rasterizer and the box tests don't gain from the wider registers,
+    // the sse versions are kept
+    table->multiplyMatrix = multiplyMatrixAVX;
+    table->transformPoints = transformPointsAVX;
+    table->transformVectors = transformVectorsAVX;
+    table->cullBoxes = cullBoxesAVX;
+}
+
+#endif
+}
+
+#endif
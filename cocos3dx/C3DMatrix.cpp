@@ -22,7 +22,7 @@ THE SOFTWARE.
 
 #include "C3DMath.h"
 
-#include "C3Dneon_matrix_impl.h"
+#include "C3DMathSIMD.h"
 
 #define MATRIX_SIZE     ( sizeof(float) * 16 )
 
@@ -682,51 +682,7 @@ bool C3DMatrix::invert()
 
 bool C3DMatrix::invert(C3DMatrix* dst) const
 {
-    float a0 = m[0] * m[5] - m[1] * m[4];
-    float a1 = m[0] * m[6] - m[2] * m[4];
-    float a2 = m[0] * m[7] - m[3] * m[4];
-    float a3 = m[1] * m[6] - m[2] * m[5];
-    float a4 = m[1] * m[7] - m[3] * m[5];
-    float a5 = m[2] * m[7] - m[3] * m[6];
-    float b0 = m[8] * m[13] - m[9] * m[12];
-    float b1 = m[8] * m[14] - m[10] * m[12];
-    float b2 = m[8] * m[15] - m[11] * m[12];
-    float b3 = m[9] * m[14] - m[10] * m[13];
-    float b4 = m[9] * m[15] - m[11] * m[13];
-    float b5 = m[10] * m[15] - m[11] * m[14];
-
-    // Calculate the determinant.
-    float det = a0 * b5 - a1 * b4 + a2 * b3 + a3 * b2 - a4 * b1 + a5 * b0;
-
-    // Close to zero, can't invert.
-    if (fabs(det) <= MATH_TOLERANCE)
-        return false;
-
-    // Support the case where m == dst.
-    C3DMatrix inverse;
-    inverse.m[0]  = m[5] * b5 - m[6] * b4 + m[7] * b3;
-    inverse.m[1]  = -m[1] * b5 + m[2] * b4 - m[3] * b3;
-    inverse.m[2]  = m[13] * a5 - m[14] * a4 + m[15] * a3;
-    inverse.m[3]  = -m[9] * a5 + m[10] * a4 - m[11] * a3;
-
-    inverse.m[4]  = -m[4] * b5 + m[6] * b2 - m[7] * b1;
-    inverse.m[5]  = m[0] * b5 - m[2] * b2 + m[3] * b1;
-    inverse.m[6]  = -m[12] * a5 + m[14] * a2 - m[15] * a1;
-    inverse.m[7]  = m[8] * a5 - m[10] * a2 + m[11] * a1;
-
-    inverse.m[8]  = m[4] * b4 - m[5] * b2 + m[7] * b0;
-    inverse.m[9]  = -m[0] * b4 + m[1] * b2 - m[3] * b0;
-    inverse.m[10] = m[12] * a4 - m[13] * a2 + m[15] * a0;
-    inverse.m[11] = -m[8] * a4 + m[9] * a2 - m[11] * a0;
-
-    inverse.m[12] = -m[4] * b3 + m[5] * b1 - m[6] * b0;
-    inverse.m[13] = m[0] * b3 - m[1] * b1 + m[2] * b0;
-    inverse.m[14] = -m[12] * a3 + m[13] * a1 - m[14] * a0;
-    inverse.m[15] = m[8] * a3 - m[9] * a1 + m[10] * a0;
-
-    multiply(inverse, 1.0f / det, dst);
-
-    return true;
+    return C3DMathSIMD::getInstance().invertMatrix(m, dst->m);
 }
 
 bool C3DMatrix::isIdentity() const
@@ -778,9 +734,6 @@ void C3DMatrix::multiplyTransMatrix(const C3DMatrix& m1)
 
 void C3DMatrix::multiplyTransMatrix(const C3DMatrix& m1, const C3DMatrix& m2, C3DMatrix* dst)
 {
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-    NEON_Matrix4AffineMul(&m2.m[0], &m1.m[0], &dst->m[0] );
-#else
     float product[16];
 
     product[0]  = m1.m[0] * m2.m[0]  + m1.m[4] * m2.m[1] + m1.m[8]   * m2.m[2];
@@ -804,48 +757,13 @@ void C3DMatrix::multiplyTransMatrix(const C3DMatrix& m1, const C3DMatrix& m2, C3
     product[15] = 1.0f;
 
     memcpy(dst->m, product, MATRIX_SIZE);
-#endif
 }
 
 void C3DMatrix::multiply(const C3DMatrix& m1, const C3DMatrix& m2, C3DMatrix* dst)
 {
     //assert(dst);
 
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-
-    // It is possible to skip the memcpy() since "out" does not overwrite p1 or p2.
-    // otherwise a temp must be needed.
-
-    // Invert column-order with row-order
-    NEON_Matrix4Mul( &m2.m[0], &m1.m[0], &dst->m[0] );
-
-#else
-
-    // Support the case where m1 or m2 is the same array as dst.
-    float product[16];
-
-    product[0]  = m1.m[0] * m2.m[0]  + m1.m[4] * m2.m[1] + m1.m[8]   * m2.m[2]  + m1.m[12] * m2.m[3];
-    product[1]  = m1.m[1] * m2.m[0]  + m1.m[5] * m2.m[1] + m1.m[9]   * m2.m[2]  + m1.m[13] * m2.m[3];
-    product[2]  = m1.m[2] * m2.m[0]  + m1.m[6] * m2.m[1] + m1.m[10]  * m2.m[2]  + m1.m[14] * m2.m[3];
-    product[3]  = m1.m[3] * m2.m[0]  + m1.m[7] * m2.m[1] + m1.m[11]  * m2.m[2]  + m1.m[15] * m2.m[3];
-
-    product[4]  = m1.m[0] * m2.m[4]  + m1.m[4] * m2.m[5] + m1.m[8]   * m2.m[6]  + m1.m[12] * m2.m[7];
-    product[5]  = m1.m[1] * m2.m[4]  + m1.m[5] * m2.m[5] + m1.m[9]   * m2.m[6]  + m1.m[13] * m2.m[7];
-    product[6]  = m1.m[2] * m2.m[4]  + m1.m[6] * m2.m[5] + m1.m[10]  * m2.m[6]  + m1.m[14] * m2.m[7];
-    product[7]  = m1.m[3] * m2.m[4]  + m1.m[7] * m2.m[5] + m1.m[11]  * m2.m[6]  + m1.m[15] * m2.m[7];
-
-    product[8]  = m1.m[0] * m2.m[8]  + m1.m[4] * m2.m[9] + m1.m[8]   * m2.m[10] + m1.m[12] * m2.m[11];
-    product[9]  = m1.m[1] * m2.m[8]  + m1.m[5] * m2.m[9] + m1.m[9]   * m2.m[10] + m1.m[13] * m2.m[11];
-    product[10] = m1.m[2] * m2.m[8]  + m1.m[6] * m2.m[9] + m1.m[10]  * m2.m[10] + m1.m[14] * m2.m[11];
-    product[11] = m1.m[3] * m2.m[8]  + m1.m[7] * m2.m[9] + m1.m[11]  * m2.m[10] + m1.m[15] * m2.m[11];
-
-    product[12] = m1.m[0] * m2.m[12] + m1.m[4] * m2.m[13] + m1.m[8]  * m2.m[14] + m1.m[12] * m2.m[15];
-    product[13] = m1.m[1] * m2.m[12] + m1.m[5] * m2.m[13] + m1.m[9]  * m2.m[14] + m1.m[13] * m2.m[15];
-    product[14] = m1.m[2] * m2.m[12] + m1.m[6] * m2.m[13] + m1.m[10] * m2.m[14] + m1.m[14] * m2.m[15];
-    product[15] = m1.m[3] * m2.m[12] + m1.m[7] * m2.m[13] + m1.m[11] * m2.m[14] + m1.m[15] * m2.m[15];
-
-    memcpy(dst->m, product, MATRIX_SIZE);
-#endif
+    C3DMathSIMD::getInstance().multiplyMatrix(m1.m, m2.m, dst->m);
 }
 
 void C3DMatrix::negate()
@@ -904,18 +822,9 @@ void C3DMatrix::rotateX(float angle)
 
 void C3DMatrix::rotateX(float angle, C3DMatrix* dst) const
 {
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-    float d[2] = {
-        cosf(angle),
-        sinf(angle)
-    };
-    NEON_Matrix4Copy(m, dst->m);
-    NEON_Matrix4RotateX(dst->m, d);
-#else
     C3DMatrix r;
     createRotationX(angle, &r);
     multiply(*this, r, dst);
-#endif
 }
 
 void C3DMatrix::rotateY(float angle)
@@ -925,18 +834,9 @@ void C3DMatrix::rotateY(float angle)
 
 void C3DMatrix::rotateY(float angle, C3DMatrix* dst) const
 {
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-    float d[2] = {
-        cosf(angle),
-        sinf(angle)
-    };
-    NEON_Matrix4Copy(m, dst->m);
-    NEON_Matrix4RotateY(dst->m, d);
-#else
     C3DMatrix r;
     createRotationY(angle, &r);
     multiply(*this, r, dst);
-#endif
 }
 
 void C3DMatrix::rotateZ(float angle)
@@ -948,18 +848,9 @@ void C3DMatrix::rotateZ(float angle, C3DMatrix* dst) const
 {
     assert(dst);
 
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-     float d[2] = {
-            cosf(angle),
-            sinf(angle)
-        };
-    NEON_Matrix4Copy(m, dst->m);
-    NEON_Matrix4RotateZ(dst->m, d);
-#else
     C3DMatrix r;
     createRotationZ(angle, &r);
     multiply(*this, r, dst);
-#endif
 }
 
 void C3DMatrix::scale(float value)
@@ -1025,20 +916,12 @@ void C3DMatrix::set(float m11, float m12, float m13, float m14, float m21, float
 
 void C3DMatrix::set(const float* m1)
 {
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-    NEON_Matrix4Copy(m1, m);
-#else
     memcpy(this->m, m1, MATRIX_SIZE);
-#endif
 }
 
 void C3DMatrix::set(const C3DMatrix& m1)
 {
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-    NEON_Matrix4Copy(m1.m, m);
-#else
     memcpy(this->m, m1.m, MATRIX_SIZE);
-#endif
 }
 
 void C3DMatrix::setCol(int idx, const C3DVector3& col)
@@ -1126,17 +1009,10 @@ void C3DMatrix::transformVector(const C3DVector3& vector, C3DVector3* dst) const
 
 void C3DMatrix::transformVector(float x, float y, float z, float w, C3DVector3* dst) const
 {
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-    float d[4];
-    float v[4] = {x, y, z, w};
-    NEON_Matrix4Vector4Mul(m, v, d);
-    dst->set(d[0], d[1], d[2]);
-#else
     dst->set(
         x * m[0] + y * m[4] + z * m[8] + w * m[12],
         x * m[1] + y * m[5] + z * m[9] + w * m[13],
         x * m[2] + y * m[6] + z * m[10] + w * m[14] );
-#endif
 }
 
 void C3DMatrix::transformVector(float x, float y, float z, C3DVector3* dst) const
@@ -1148,6 +1024,16 @@ void C3DMatrix::transformVector(float x, float y, float z, C3DVector3* dst) cons
              x * m[2] + y * m[6] + z * m[10]);
 }
 
+void C3DMatrix::transformPoints(const C3DVector3* points, C3DVector3* dst, unsigned int count) const
+{
+    C3DMathSIMD::getInstance().transformPoints(m, &points->x, &dst->x, count);
+}
+
+void C3DMatrix::transformVectors(const C3DVector3* vectors, C3DVector3* dst, unsigned int count) const
+{
+    C3DMathSIMD::getInstance().transformVectors(m, &vectors->x, &dst->x, count);
+}
+
 void C3DMatrix::transformVector(C3DVector4* vector) const
 {
     transformVector(*vector, vector);
@@ -1171,15 +1057,9 @@ void C3DMatrix::translate(float x, float y, float z)
 
 void C3DMatrix::translate(float x, float y, float z, C3DMatrix* dst) const
 {
-#if defined(__ARM_NEON__) && !defined(__arm64__)
-    float d[3] = {x, y, z};
-    NEON_Matrix4Copy(m, dst->m);
-    NEON_Matrix4Translate(dst->m, d);
-#else
     C3DMatrix t;
     createTranslation(x, y, z, &t);
     multiply(*this, t, dst);
-#endif
 }
 
 void C3DMatrix::translate(const C3DVector3& t)
@@ -806,6 +806,24 @@ public:
      */
     void transformVector(float x, float y, float z, C3DVector3* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix, using the vectorized math backend.
+     *
+     * @param points The points to transform.
+     * @param dst An array to store the transformed points in, may be points.
+     * @param count The number of points.
+     */
+    void transformPoints(const C3DVector3* points, C3DVector3* dst, unsigned int count) const;
+
+    /**
+     * Transforms an array of vectors (w = 0) by this matrix, using the vectorized math backend.
+     *
+     * @param vectors The vectors to transform.
+     * @param dst An array to store the transformed vectors in, may be vectors.
+     * @param count The number of vectors.
+     */
+    void transformVectors(const C3DVector3* vectors, C3DVector3* dst, unsigned int count) const;
+
     /**
      * Transforms the specified vector by this matrix.
      *
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include "C3DSubMesh.h"
 #include "C3DVertexFormat.h"
 #include "C3DAABB.h"
+#include "C3DStateCache.h"
 
 namespace cocos3d
 {
@@ -51,7 +52,7 @@ C3DMesh::~C3DMesh()
 
 	if (_vertexBuffer)
 	{
-		glDeleteBuffers(1, &_vertexBuffer);
+		C3DStateCache::deleteBuffer(_vertexBuffer);
 		_vertexBuffer = 0;
 	}
 
@@ -85,22 +86,22 @@ bool C3DMesh::init(C3DVertexFormat* vertexFormat, unsigned int vertexCount, bool
         return false;
     }
 
-    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, vbo) );
+    C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, vbo);
     if (GL_LAST_ERROR())
     {
-        glDeleteBuffers(1, &vbo);
+        C3DStateCache::deleteBuffer(vbo);
         return false;
     }
 
     GL_CHECK( glBufferData(GL_ARRAY_BUFFER, vertexFormat->getVertexSize() * vertexCount, NULL, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) );
     if (GL_LAST_ERROR())
     {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDeleteBuffers(1, &vbo);
+        C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+        C3DStateCache::deleteBuffer(vbo);
         return false;
     }
 
-	GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+	C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
 
 	_vertexCount	= vertexCount;
 	_vertexBuffer	= vbo;
@@ -146,7 +147,7 @@ bool C3DMesh::isDynamic() const
 
 void C3DMesh::setVertexData(void* vertexData, unsigned int vertexStart, unsigned int vertexCount)
 {
-    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer) );
+    C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
 
     if (vertexStart == 0 && vertexCount == 0)
     {
@@ -162,7 +163,7 @@ void C3DMesh::setVertexData(void* vertexData, unsigned int vertexStart, unsigned
         GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, vertexStart * _vertexFormat->getVertexSize(), vertexCount * _vertexFormat->getVertexSize(), vertexData) );
     }
 
-	GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+	C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 unsigned int C3DMesh::getTriangleCount() const
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include "C3DBone.h"
 #include "BonePart.h"
 #include "C3DModel.h"
+#include "C3DRenderSystem.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
@@ -32,7 +33,7 @@ THE SOFTWARE.
 namespace cocos3d
 {
 C3DMeshSkin::C3DMeshSkin()
-    : _rootJoint(NULL), _matrixPalette(NULL), _model(NULL), _partCount(0), _parts(NULL), _curPartIndex(0)
+    : _rootJoint(NULL), _matrixPalette(NULL), _paletteFrameIndex(0), _model(NULL), _partCount(0), _parts(NULL), _curPartIndex(0)
 {
 }
 
@@ -57,6 +58,7 @@ const C3DMatrix& C3DMeshSkin::getBindShape()
 void C3DMeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    _paletteFrameIndex = 0;
 }
 
 unsigned int C3DMeshSkin::getJointCount()
@@ -109,6 +111,7 @@ void C3DMeshSkin::setJointCount(unsigned int jointCount)
             _matrixPalette[i+2].set(0.0f, 0.0f, 1.0f, 0.0f);
         }
     }
+    _paletteFrameIndex = 0;
 }
 
 void C3DMeshSkin::setJoint(C3DBone* joint, unsigned int index)
@@ -128,6 +131,7 @@ void C3DMeshSkin::setJoint(C3DBone* joint, unsigned int index)
         joint->retain();
         joint->_skinCount++;
     }
+    _paletteFrameIndex = 0;
 }
 
 //C3DVector4* C3DMeshSkin::getMatrixPalette() const
@@ -150,18 +154,37 @@ unsigned int C3DMeshSkin::getBonePartIndex()
 	return _curPartIndex;
 }
 
+void C3DMeshSkin::updateMatrixPalette()
+{
+    // frame 0 is before the first render, never consider it cached
+    unsigned int frameIndex = C3DRenderSystem::getInstance()->getFrameIndex();
+    if (frameIndex != 0 && _paletteFrameIndex == frameIndex)
+        return;
+
+    unsigned int count = _joints.size();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+    }
+    _paletteFrameIndex = frameIndex;
+}
+
 C3DVector4* C3DMeshSkin::getMatrixPalette(unsigned int index)
 {
+	updateMatrixPalette();
+
 	BonePart* part = _parts[index];
-	std::vector<unsigned int>& indices = part->_indices;
-	unsigned int count = indices.size();
-	for (unsigned int i = 0; i < count; i++)
+	if (part->_paletteFrameIndex != _paletteFrameIndex || _paletteFrameIndex == 0)
 	{
-		unsigned int boneIndex = indices[i];
-
-	    _joints[boneIndex]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+		std::vector<unsigned int>& indices = part->_indices;
+		unsigned int count = indices.size();
+		for (unsigned int i = 0; i < count; i++)
+		{
+			memcpy(&part->_matrixPalette[i * PALETTE_ROWS], &_matrixPalette[indices[i] * PALETTE_ROWS], sizeof(C3DVector4) * PALETTE_ROWS);
+		}
+		part->_paletteFrameIndex = _paletteFrameIndex;
 	}
-	return _matrixPalette;
+	return part->_matrixPalette;
 }
 
 unsigned int C3DMeshSkin::getMatrixPaletteSize(unsigned int index)
@@ -71,6 +71,11 @@ public:
 	void setBonePartIndex(unsigned int index);
 	unsigned int getBonePartIndex();
 
+    /**
+     * Gets the palette of the bones used by a bone part. The palette of the whole
+     * skeleton is computed once a frame and the part palettes are gathered from it,
+     * so every part and every pass of the frame reuses the same joint matrices.
+     */
     C3DVector4* getMatrixPalette(unsigned int index);
 
     unsigned int getMatrixPaletteSize(unsigned index);
@@ -91,6 +96,11 @@ private:
 
     void clearJoints();
 
+    /**
+     * Updates the palette of all the joints if it was not done this frame.
+     */
+    void updateMatrixPalette();
+
     C3DMatrix _bindShape;
     std::vector<C3DBone*> _joints;
     C3DBone* _rootJoint;
@@ -100,6 +110,7 @@ private:
     // Each 4x3 row-wise matrix is represented as 3 C3DVector4's.
     // The number of C3DVector4's is (_joints.size() * 3).
     C3DVector4* _matrixPalette;
+    unsigned int _paletteFrameIndex;
     C3DModel* _model;
 
 	unsigned int _partCount;
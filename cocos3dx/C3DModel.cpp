@@ -42,6 +42,7 @@ THE SOFTWARE.
 #include "C3DAnimatedLight.h"
 #include "C3DShadowMap.h"
 #include "C3DMaterialManager.h"
+#include "C3DLightGrid.h"
 #include "C3DRenderChannel.h"
 #include "C3DRenderSystem.h"
 #include "C3DDeviceAdapter.h"
@@ -51,7 +52,7 @@ namespace cocos3d
 C3DLightFilter* C3DModel::s_lightFilter = NULL;
 
 C3DModel::C3DModel() :
-    _mesh(NULL), _material(NULL), _partCount(0), _partMaterials(NULL), _node(NULL), _wireframe(false)
+    _mesh(NULL), _material(NULL), _partCount(0), _partMaterials(NULL), _node(NULL), _wireframe(false), _instancing(true), _lodFade(0.0f)
 {
 	_materialName = "";
 }
@@ -344,6 +345,33 @@ C3DRenderChannel* C3DModel::getRenderChannel()
 	return channel;
 }
 
+void C3DModel::getSortIds(unsigned int& effectId, unsigned int& materialId, unsigned int& vaoId)
+{
+    effectId = 0;
+    materialId = 0;
+    vaoId = 0;
+
+    C3DMaterial* material = getMaterial(_partCount > 0 ? 0 : -1);
+    if (material)
+    {
+        materialId = material->getSortId();
+
+        C3DTechnique* technique = material->getTechnique(C3DMaterial::TECH_USAGE_SCREEN);
+        if (technique && technique->getPassCount() > 0)
+        {
+            C3DPass* pass = technique->getPass(0u);
+            if (pass->getEffect())
+                effectId = pass->getEffect()->getProgram();
+            if (pass->getVertexAttributeBinding())
+                vaoId = pass->getVertexAttributeBinding()->getHandle();
+        }
+    }
+
+    // no vertex array object, group by vertex buffer
+    if (vaoId == 0 && _mesh)
+        vaoId = _mesh->getVertexBuffer();
+}
+
 C3DNode* C3DModel::getNode() const
 {
     return _node;
@@ -426,11 +454,14 @@ void C3DModel::applyInternalParam(C3DPass* pass)
 	applyLightParam(pass);
 	applyShadowMap(pass);
 	applyFogParam(pass);
+
+	if (pass->isLODFade())
+		pass->getParameter("u_lodFade")->setValue(_lodFade);
 }
 
 void C3DModel::applyFogParam(C3DPass* pass)
 {
-	if (_node == NULL || _node->get3DScene() == NULL)
+	if (_node == NULL || _node->get3DScene() == NULL || _node->get3DScene()->getLayer() == NULL)
 		return;
 
 	const C3DEnvConf& env = _node->get3DScene()->getLayer()->getEnvConf();
@@ -444,21 +475,34 @@ void C3DModel::applyLightParam(C3DPass* pass)
     if (_node == NULL)
         return;
 
+    C3DScene* scene = _node->get3DScene();
+    const C3DPassLightParams* params = pass->getLightParams();
+
     int nDirlight = 0, nPointlight = 0, nSpotlight = 0, nAnimlight = 0;
-    int nMaxDirLight = pass->getMaxDirLight();
-    int nMaxPointLight = pass->getMaxPointLight();
-    int nMaxSpotLight = pass->getMaxSpotLight();
-	int nMaxAnimLight = pass->getMaxAnimLight();
-
-    char paraName[128];
-    int i;
-    for (i = 0; i < _node->get3DScene()->getLightCount(); i++) {
-        C3DLight* light = _node->get3DScene()->getLight(i);
-		if (!light->isActive())
-			continue;
+    int nMaxDirLight = (int)params->dirLights.size();
+    int nMaxPointLight = (int)params->pointLights.size();
+    int nMaxSpotLight = (int)params->spotLights.size();
+	int nMaxAnimLight = min(pass->getMaxAnimLight(), 1); // no more than one animated light allowed
+
+    // directional lights first, then the local lights touching the model, nearest first
+    static std::vector<C3DLight*> lights;
+    lights.clear();
+
+    C3DAABB* aabb = _node->getAABB();
+    if (aabb && aabb->_min.x <= aabb->_max.x)
+    {
+        scene->getLightGrid()->query(*aabb, lights);
+    }
+    else
+    {
+        C3DVector3 position = _node->getTranslationWorld();
+        scene->getLightGrid()->query(C3DAABB(position, position), lights);
+    }
+
+    size_t i;
+    for (i = 0; i < lights.size(); i++) {
+        C3DLight* light = lights[i];
 		C3DLightComponent* lightComp = light->getComponent();
-		if (!lightComp)
-			continue;
 
         if (s_lightFilter == NULL || (s_lightFilter && s_lightFilter->isLightValidate(this, light)))
         {
@@ -475,10 +519,8 @@ void C3DModel::applyLightParam(C3DPass* pass)
                     if (nDirlight >= nMaxDirLight)
                         break;
 					pDirLight = static_cast<C3DDirectionalLight*> (lightComp);
-                    sprintf(paraName, "u_dirlight[%d].dir", nDirlight);
-                    pass->getParameter(paraName)->setValue(light->getForwardVectorWorld());
-                    sprintf(paraName, "u_dirlight[%d].color", nDirlight);
-                    pass->getParameter(paraName)->setValue(pDirLight->getColor());
+                    params->dirLights[nDirlight].dir->setValue(light->getForwardVectorWorld());
+                    params->dirLights[nDirlight].color->setValue(pDirLight->getColor());
                     nDirlight++;
                     break;
 
@@ -487,13 +529,9 @@ void C3DModel::applyLightParam(C3DPass* pass)
                         break;
 					pPointLight = static_cast<C3DPointLight*> (lightComp);
 
-                    sprintf(paraName, "u_pointlight[%d].position", nPointlight);
-                    pass->getParameter(paraName)->setValue(light->getTranslationView());
-					//pass->getParameter(paraName)->setValue(light->getTranslationWorld());
-                    sprintf(paraName, "u_pointlight[%d].color", nPointlight);
-                    pass->getParameter(paraName)->setValue(pPointLight->getColor());
-                    sprintf(paraName, "u_pointlight[%d].rangeInverse", nPointlight);
-                    pass->getParameter(paraName)->setValue(pPointLight->getRangeInverse());
+                    params->pointLights[nPointlight].position->setValue(light->getTranslationView());
+                    params->pointLights[nPointlight].color->setValue(pPointLight->getColor());
+                    params->pointLights[nPointlight].rangeInverse->setValue(pPointLight->getRangeInverse());
                     nPointlight++;
 
                     break;
@@ -503,24 +541,18 @@ void C3DModel::applyLightParam(C3DPass* pass)
                         break;
 					pSpotLight = static_cast<C3DSpotLight*> (lightComp);
 
-                    sprintf(paraName, "u_spotlight[%d].position", nSpotlight);
-                    pass->getParameter(paraName)->setValue(light->getTranslationView());
-                    sprintf(paraName, "u_spotlight[%d].color", nSpotlight);
-                    pass->getParameter(paraName)->setValue(pSpotLight->getColor());
-                    sprintf(paraName, "u_spotlight[%d].rangeInverse", nSpotlight);
-                    pass->getParameter(paraName)->setValue(pSpotLight->getRangeInverse());
-                    sprintf(paraName, "u_spotlight[%d].dir", nSpotlight);
-                    pass->getParameter(paraName)->setValue(light->getForwardVectorView());
-                    sprintf(paraName, "u_spotlight[%d].innerAngleCos", nSpotlight);
-                    pass->getParameter(paraName)->setValue(pSpotLight->getInnerAngleCos());
-                    sprintf(paraName, "u_spotlight[%d].outerAngleCos", nSpotlight);
-                    pass->getParameter(paraName)->setValue(pSpotLight->getOuterAngleCos());
+                    params->spotLights[nSpotlight].position->setValue(light->getTranslationView());
+                    params->spotLights[nSpotlight].color->setValue(pSpotLight->getColor());
+                    params->spotLights[nSpotlight].rangeInverse->setValue(pSpotLight->getRangeInverse());
+                    params->spotLights[nSpotlight].dir->setValue(light->getForwardVectorView());
+                    params->spotLights[nSpotlight].innerAngleCos->setValue(pSpotLight->getInnerAngleCos());
+                    params->spotLights[nSpotlight].outerAngleCos->setValue(pSpotLight->getOuterAngleCos());
                     nSpotlight++;
 
                     break;
 
 				case C3DLight::ANIMATE:
-					if (nAnimlight >= min(nMaxAnimLight, 1)) // no more than one animated light allowed
+					if (nAnimlight >= nMaxAnimLight)
 						break;
 					pAnimLight = static_cast<C3DAnimatedLight*> (lightComp);
 
@@ -528,24 +560,16 @@ void C3DModel::applyLightParam(C3DPass* pass)
 					light->getWorldMatrix().getUpVector(&upVector);
 					light->getWorldMatrix().getPosition(&posVector);
 
-					sprintf(paraName, "u_animLightAxisU");
-					pass->getParameter(paraName)->setValue(rightVector);
-					sprintf(paraName, "u_animLightAxisV");
-					pass->getParameter(paraName)->setValue(upVector);
-					sprintf(paraName, "u_animLightPos");
-					pass->getParameter(paraName)->setValue(posVector);
-
-					sprintf(paraName, "u_animLightTexOffset");
-					pass->getParameter(paraName)->setValue(pAnimLight->getUVOffset());
-					sprintf(paraName, "u_animLightTexRotScale1");
-					pass->getParameter(paraName)->setValue(pAnimLight->getUV1RotScale());
-					sprintf(paraName, "u_animLightTexRotScale2");
-					pass->getParameter(paraName)->setValue(pAnimLight->getUV2RotScale());
-
-					sprintf(paraName, "u_animLightIntensity");
-					pass->getParameter(paraName)->setValue(pAnimLight->getIntensity());
-					sprintf(paraName, "u_lightTexture");
-					pass->getParameter(paraName)->setValue(pAnimLight->getSampler());
+					params->animLightAxisU->setValue(rightVector);
+					params->animLightAxisV->setValue(upVector);
+					params->animLightPos->setValue(posVector);
+
+					params->animLightTexOffset->setValue(pAnimLight->getUVOffset());
+					params->animLightTexRotScale1->setValue(pAnimLight->getUV1RotScale());
+					params->animLightTexRotScale2->setValue(pAnimLight->getUV2RotScale());
+
+					params->animLightIntensity->setValue(pAnimLight->getIntensity());
+					params->lightTexture->setValue(pAnimLight->getSampler());
 
 					nAnimlight++;
 
@@ -557,19 +581,16 @@ void C3DModel::applyLightParam(C3DPass* pass)
         }
     }
 
-    if (nMaxDirLight > 0)
-        pass->getParameter("u_ndirlight")->setValue(nDirlight);
-    if (nMaxPointLight > 0)
-        pass->getParameter("u_npointlight")->setValue(nPointlight);
-    if (nMaxSpotLight > 0)
-        pass->getParameter("u_nspotlight")->setValue(nSpotlight);
-	if (nMaxAnimLight > 0)
-		pass->getParameter("u_nanimlight")->setValue(nAnimlight);
+    if (params->nDirLight)
+        params->nDirLight->setValue(nDirlight);
+    if (params->nPointLight)
+        params->nPointLight->setValue(nPointlight);
+    if (params->nSpotLight)
+        params->nSpotLight->setValue(nSpotlight);
+	if (params->nAnimLight)
+		params->nAnimLight->setValue(nAnimlight);
 
-	if ( pass->getParameter( "u_ambientColor" ) != NULL )
-	{
-		pass->getParameter( "u_ambientColor" )->setValue( getNode()->get3DScene()->getAmbientColor() );
-	}
+	params->ambientColor->setValue( scene->getAmbientColor() );
 }
 
 void C3DModel::applyShadowMap(C3DPass* pass)
@@ -590,12 +611,20 @@ void C3DModel::applyShadowMap(C3DPass* pass)
         return;
 
     pass->getParameter("u_shadowMatrix")->setValue(shadowMap->getTextureMatrix());
+    if (nMaxShadowMap > 1)
+    {
+        // SHADOWCASCADE, the cascade is picked in the fragment shader
+        pass->getParameter("u_shadowSplits")->setValue(shadowMap->getCascadeSplits());
+        pass->getParameter("u_shadowCascadeScale")->setValue(shadowMap->getCascadeScales(), C3DShadowMap::MAX_CASCADES);
+        pass->getParameter("u_shadowCascadeOffset")->setValue(shadowMap->getCascadeOffsets(), C3DShadowMap::MAX_CASCADES);
+    }
     pass->getParameter("u_shadowTexture")->setValue(shadowMap->getSampler());
 }
 
 void C3DModel::copyFrom(const C3DModel* other)
 {
 	setMesh(other->_mesh);
+	_instancing = other->_instancing;
 	_partCount = other->_partCount;
 	C3DMaterial* newMaterial;
 
@@ -101,6 +101,12 @@ public:
 
 	C3DRenderChannel* getRenderChannel();
 
+	/**
+	 * get the ids used to sort the model in its render channel:
+	 * program of the first screen pass, material and vertex array (or vertex buffer).
+	 */
+	void getSortIds(unsigned int& effectId, unsigned int& materialId, unsigned int& vaoId);
+
     /**
      * get or set light filter
      * subclass C3DLightFilter to determine wether light validate for this model
@@ -112,6 +118,21 @@ public:
 
 	void showWireframe(bool show){_wireframe = show;}
 
+	/**
+	 * enable or disable the instanced drawing of this model with the models sharing its
+	 * mesh and materials, see C3DSkinlessModel::canInstanceWith.
+	 */
+	void setInstancing(bool instancing){_instancing = instancing;}
+	bool isInstancing() const {return _instancing;}
+
+	/**
+	 * set by C3DLODNode during a dithered transition between two levels of detail: the level
+	 * fading in draws the fraction fade of the pixels (fade > 0) and the one fading out the
+	 * other pixels (fade < 0). 0 draws every pixel. Only the passes with LODFADE use it.
+	 */
+	void setLODFade(float fade){_lodFade = fade;}
+	float getLODFade() const {return _lodFade;}
+
 	void setNode(C3DNode* node);
 
 	void setMesh(C3DMesh* mesh);
@@ -149,6 +170,10 @@ protected:
 
     bool _wireframe;
 
+    bool _instancing;
+
+    float _lodFade;
+
 public:
 
 	C3DMesh* _mesh;
@@ -80,26 +80,36 @@ C3DModel* C3DModelNode::getModel()
     return _model;
 }
 
+unsigned int C3DModelNode::getModelCount() const
+{
+    return _model ? 1 : 0;
+}
+
+C3DModel* C3DModelNode::getModel(unsigned int index)
+{
+    assert(index < getModelCount());
+
+    return _model;
+}
+
 void C3DModelNode::draw()
 {
 	if (_model)
+		drawModel(_model);
+}
+
+void C3DModelNode::drawModel(C3DModel* model)
+{
+	C3DRenderChannel* channel = model->getRenderChannel();
+	if(channel != NULL && !_scene->isInShadowPass() )
 	{
-		C3DRenderChannel* channel = _model->getRenderChannel();
-		if(channel != NULL && !_scene->isInShadowPass() )
-		{
-			if(channel->getName() == RenderChannelManager::ChannelOpacity)
-			{
-				channel->addItem( _model, _model->distanceToCamera(), _model->getMaterial()->getResourceName() );
-			}
-			else
-			{
-				channel->addItem( _model, _model->distanceToCamera(), "Transparency");
-			}
-		}
-		else
-		{
-			_model->draw();
-		}
+		unsigned int effectId, materialId, vaoId;
+		model->getSortIds( effectId, materialId, vaoId );
+		channel->addItem( model, model->distanceToCamera(), effectId, materialId, vaoId );
+	}
+	else
+	{
+		model->draw();
 	}
 }
 
@@ -40,6 +40,13 @@ public:
     C3DModel* getModel();
     void setModel(C3DModel* model);
 
+	/**
+	 * Gets the models drawn by the node, the levels of detail of a C3DLODNode, finest first.
+	 * The model of a plain model node is the only one.
+	 */
+	virtual unsigned int getModelCount() const;
+	virtual C3DModel* getModel(unsigned int index);
+
 	virtual void draw();
 
 	virtual const C3DMatrix& getWorldMatrix();
@@ -52,6 +59,11 @@ protected:
 
     virtual ~C3DModelNode();
 
+	/**
+	 * Queues the model into its render channel, or draws it right away in the shadow pass.
+	 */
+	void drawModel(C3DModel* model);
+
 public:
 
 	 /**
@@ -24,6 +24,7 @@ THE SOFTWARE.
 #include "C3DMorphMesh.h"
 #include "C3DMorph.h"
 #include "C3DVertexFormat.h"
+#include "C3DStateCache.h"
 
 namespace cocos3d
 {
@@ -79,10 +80,10 @@ void C3DMorphMesh::clearMorph(C3DMorph* morph)
 	if(_vertexData == NULL)
 		return;
 
-	GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer) );
+	C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
 
     GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, _vertexCount * _vertexFormat->getVertexSize(), _vertexData) );
-	GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+	C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
     morph->clearCurTarget();
 }
 
@@ -121,10 +122,10 @@ void C3DMorphMesh::applyMorph(C3DMorph* morph)
 		}
 	}
 
-	GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer) );
+	C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
 
 	GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, _vertexCount * _vertexFormat->getVertexSize(), vertexData) );
-	GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+	C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
 	SAFE_DELETE_ARRAY(vertexData);
 }
 
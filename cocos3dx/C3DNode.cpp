@@ -31,12 +31,14 @@ THE SOFTWARE.
 
 #include "C3DAABB.h"
 #include "C3DOBB.h"
+#include "C3DOctree.h"
 
 namespace cocos3d
 {
 C3DNode::C3DNode()
-	: _scene(NULL),_parent(NULL),_visible(true),_active(true),
-    _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _listeners(NULL)
+	: _scene(NULL),_parent(NULL),_visible(true),_active(true),_castShadow(true),
+    _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _listeners(NULL),
+    _octreeCell(NULL), _octreeIndex(0), _octreeDirty(false)
 {
    _id = "";
 
@@ -50,8 +52,9 @@ C3DNode::C3DNode()
 }
 
 C3DNode::C3DNode(const std::string& id)
-    : _scene(NULL),_parent(NULL),_visible(true),_active(true),
-    _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _listeners(NULL)
+    : _scene(NULL),_parent(NULL),_visible(true),_active(true),_castShadow(true),
+    _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _listeners(NULL),
+    _octreeCell(NULL), _octreeIndex(0), _octreeDirty(false)
 {
     if (!id.empty())
     {
@@ -235,8 +238,7 @@ void C3DNode::update(long elapsedTime)
     if(!isActive())
         return;
     
-	getAABB();
-	_visible = _scene->getActiveCamera()->isVisible(*_bb);
+	updateVisibility();
 
     if(!isVisible())
         return;
@@ -249,6 +251,14 @@ void C3DNode::update(long elapsedTime)
     }
 }
 
+void C3DNode::updateVisibility()
+{
+	getAABB();
+
+	if (_octreeCell == NULL)
+		_visible = _scene->getActiveCamera()->isVisible(*_bb);
+}
+
 void C3DNode::draw()
 {
     if(!isActive() || !isVisible())
@@ -583,6 +593,9 @@ void C3DNode::transformChanged()
     // Our local transform was changed, so mark our world matrices dirty.
     _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS_AABB | NODE_DIRTY_BOUNDS_OBB;
 
+	if (_octreeCell != NULL)
+		_scene->getOctree()->markDirty(this);
+
 	if (_listeners)
     {
         for (std::list<Listener*>::iterator itr = _listeners->begin(); itr != _listeners->end(); itr++)
@@ -601,7 +614,10 @@ void C3DNode::transformChanged()
 void C3DNode::setBoundsDirty()
 {
     // Mark ourself and our parent nodes as dirty
-   // _dirtyBits |= NODE_DIRTY_BOUNDS;
+    _dirtyBits |= NODE_DIRTY_BOUNDS_AABB | NODE_DIRTY_BOUNDS_OBB;
+
+	if (_octreeCell != NULL)
+		_scene->getOctree()->markDirty(this);
 
     // Mark our parent bounds as dirty as well
     /*if (_parent)
@@ -659,6 +675,7 @@ void C3DNode::copyFrom(const C3DTransform* other, C3DNode::CloneContext& context
 	C3DTransform::copyFrom(other);
 	const C3DNode* otherNode = static_cast<const C3DNode*>(other);
 	_visible = otherNode->_visible;
+	_castShadow = otherNode->_castShadow;
 	//_scene = otherNode->_scene;
 	_id = otherNode->_id + context.idSuffix;
 	_world = otherNode->_world;
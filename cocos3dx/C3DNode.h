@@ -48,6 +48,8 @@ class C3DViewport;
 class C3DMeshSkin;
 class C3DAABB;
 class C3DOBB;
+class C3DOctree;
+struct C3DOctreeCell;
 
 /**
  * Defines a basic hierachial structure of transformation spaces.
@@ -60,6 +62,7 @@ class C3DNode : public C3DTransform, public virtual cocos2d::CCObject
     friend class C3DMeshSkin;
 	friend class C3DSkeleton;
 	friend class C3DParticleSystem;
+	friend class C3DOctree;
 
 public:
 	C3DNode();
@@ -419,6 +422,16 @@ public:
      */
 	virtual bool isActive();
 
+	/**
+     * Sets whether the node is drawn into the shadow map, true by default.
+     */
+	void setCastShadow(bool castShadow) { _castShadow = castShadow; }
+
+	/**
+     * Determines if the node is drawn into the shadow map
+     */
+	bool isCastShadow() const { return _castShadow; }
+
 	/**
      *  Gets child list
      */
@@ -458,6 +471,11 @@ public:
 	virtual void drawAABB();
     virtual void drawOBB();
 
+	/**
+     * Is this node culled by the scene octree instead of by its own update
+     */
+	bool isInOctree() const { return _octreeCell != NULL; }
+
 	void setParent(C3DNode* parent)
 	{
 		_parent = parent;
@@ -485,6 +503,11 @@ protected:
 	 */
 	virtual void onChildChanged(ChangeEvent eventType, C3DNode* child);
 
+	/**
+	 * update the visible flag with the active camera, skipped when the scene octree culls this node
+	 */
+	void updateVisibility();
+
 protected:
 
     C3DScene* _scene;
@@ -516,6 +539,7 @@ protected:
     bool _notifyHierarchyChanged;
 	bool _visible;
     bool _active;
+	bool _castShadow;
 
 	C3DAABB* _bb;
     C3DAABB* _bbOrigin; // original bounding box
@@ -525,6 +549,10 @@ protected:
 
 	bool _showAABB;
 	bool _showOBB;
+
+	C3DOctreeCell* _octreeCell; // cell of the scene octree holding this node
+	unsigned int _octreeIndex; // index in the cell
+	bool _octreeDirty; // bounds changed since last octree refit
 };
 }
 
@@ -0,0 +1,192 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "Base.h"
+#include "C3DOcclusionBuffer.h"
+#include "C3DAABB.h"
+#include "C3DVector3.h"
+#include "C3DMathSIMD.h"
+
+namespace cocos3d
+{
+C3DOcclusionBuffer::C3DOcclusionBuffer(unsigned int width, unsigned int height)
+    : _triangleCount(0)
+{
+    _tilesX = (std::max(width, 1u) + TILE_SIZE - 1) / TILE_SIZE;
+    _tilesY = (std::max(height, 1u) + TILE_SIZE - 1) / TILE_SIZE;
+    _width = _tilesX * TILE_SIZE;
+    _height = _tilesY * TILE_SIZE;
+
+    _depth.resize(_width * _height, 1.0f);
+    _tileDepth.resize(_tilesX * _tilesY, 1.0f);
+}
+
+C3DOcclusionBuffer::~C3DOcclusionBuffer()
+{
+}
+
+void C3DOcclusionBuffer::begin(const C3DMatrix& viewProjection)
+{
+    _viewProjection = viewProjection;
+    std::fill(_depth.begin(), _depth.end(), 1.0f);
+    _triangleCount = 0;
+}
+
+void C3DOcclusionBuffer::addOccluder(const C3DMatrix& world, const C3DVector3* positions, unsigned int vertexCount,
+                                     const unsigned short* indices, unsigned int indexCount)
+{
+    if (vertexCount == 0 || indexCount < 3)
+        return;
+
+    C3DMatrix transform;
+    C3DMatrix::multiply(_viewProjection, world, &transform);
+    const float* m = transform.m;
+
+    // window coordinates, w is kept to find the vertices in front of the near plane
+    _vertices.resize(vertexCount * 4);
+    float halfWidth = _width * 0.5f;
+    float halfHeight = _height * 0.5f;
+    for (unsigned int i = 0; i < vertexCount; i++)
+    {
+        const C3DVector3& p = positions[i];
+        float x = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
+        float y = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
+        float z = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14];
+        float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+
+        float* v = &_vertices[i * 4];
+        if (z < -w)
+        {
+            v[3] = -1.0f;
+            continue;
+        }
+
+        float invW = 1.0f / w;
+        v[0] = (x * invW + 1.0f) * halfWidth;
+        v[1] = (y * invW + 1.0f) * halfHeight;
+        v[2] = z * invW * 0.5f + 0.5f;
+        v[3] = w;
+    }
+
+    _triangles.clear();
+    for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+    {
+        const float* v0 = &_vertices[indices[i] * 4];
+        const float* v1 = &_vertices[indices[i + 1] * 4];
+        const float* v2 = &_vertices[indices[i + 2] * 4];
+
+        // clipping would only make the occluder smaller, the triangle is left out
+        if (v0[3] < 0.0f || v1[3] < 0.0f || v2[3] < 0.0f)
+            continue;
+
+        _triangles.insert(_triangles.end(), v0, v0 + 3);
+        _triangles.insert(_triangles.end(), v1, v1 + 3);
+        _triangles.insert(_triangles.end(), v2, v2 + 3);
+    }
+
+    unsigned int count = (unsigned int)_triangles.size() / 9;
+    if (count > 0)
+        C3DMathSIMD::getInstance().rasterizeDepth(&_triangles[0], count, &_depth[0], _width, _height);
+
+    _triangleCount += count;
+}
+
+void C3DOcclusionBuffer::end()
+{
+    for (unsigned int ty = 0; ty < _tilesY; ty++)
+    {
+        for (unsigned int tx = 0; tx < _tilesX; tx++)
+        {
+            float farthest = 0.0f;
+            for (unsigned int y = 0; y < TILE_SIZE; y++)
+            {
+                const float* row = &_depth[(ty * TILE_SIZE + y) * _width + tx * TILE_SIZE];
+                for (unsigned int x = 0; x < TILE_SIZE; x++)
+                    farthest = std::max(farthest, row[x]);
+            }
+            _tileDepth[ty * _tilesX + tx] = farthest;
+        }
+    }
+}
+
+bool C3DOcclusionBuffer::isOccluded(const C3DAABB& box) const
+{
+    if (_triangleCount == 0)
+        return false;
+
+    // screen rectangle and nearest depth of the box
+    const float* m = _viewProjection.m;
+    float minX = (float)_width, maxX = 0.0f, minY = (float)_height, maxY = 0.0f, minZ = 1.0f;
+    for (int i = 0; i < 8; i++)
+    {
+        float px = (i & 1) ? box._max.x : box._min.x;
+        float py = (i & 2) ? box._max.y : box._min.y;
+        float pz = (i & 4) ? box._max.z : box._min.z;
+        float x = m[0] * px + m[4] * py + m[8] * pz + m[12];
+        float y = m[1] * px + m[5] * py + m[9] * pz + m[13];
+        float z = m[2] * px + m[6] * py + m[10] * pz + m[14];
+        float w = m[3] * px + m[7] * py + m[11] * pz + m[15];
+        if (z < -w)
+            return false;
+
+        float invW = 1.0f / w;
+        float sx = (x * invW + 1.0f) * _width * 0.5f;
+        float sy = (y * invW + 1.0f) * _height * 0.5f;
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        minZ = std::min(minZ, z * invW * 0.5f + 0.5f);
+    }
+
+    // partly out of the buffer, what is outside is unknown
+    if (minX < 0.0f || minY < 0.0f || maxX >= (float)_width || maxY >= (float)_height)
+        return false;
+
+    int x0 = (int)minX, x1 = (int)maxX;
+    int y0 = (int)minY, y1 = (int)maxY;
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++)
+    {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++)
+        {
+            // the whole tile is in front of the box
+            if (_tileDepth[ty * _tilesX + tx] <= minZ)
+                continue;
+
+            // the pixels of the tile under the box
+            int startX = std::max(x0, tx * (int)TILE_SIZE), endX = std::min(x1, tx * (int)TILE_SIZE + (int)TILE_SIZE - 1);
+            int startY = std::max(y0, ty * (int)TILE_SIZE), endY = std::min(y1, ty * (int)TILE_SIZE + (int)TILE_SIZE - 1);
+            for (int y = startY; y <= endY; y++)
+            {
+                const float* row = &_depth[y * _width];
+                for (int x = startX; x <= endX; x++)
+                {
+                    if (row[x] > minZ)
+                        return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+}
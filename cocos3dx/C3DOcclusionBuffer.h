@@ -0,0 +1,105 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef C3DOCCLUSIONBUFFER_H_
+#define C3DOCCLUSIONBUFFER_H_
+
+#include <vector>
+#include "C3DMatrix.h"
+
+namespace cocos3d
+{
+class C3DAABB;
+class C3DVector3;
+
+/**
+ * Defines a small depth buffer drawn on the cpu for the occlusion culling.
+ *
+ * The occluders, simplified meshes of big objects, are rasterized into it with the
+ * view projection of the camera, then the boxes of the other objects are tested against
+ * the farthest depth of each tile and, where needed, of each pixel. It needs no gpu and
+ * no read back, the same frame is culled with it.
+ */
+class C3DOcclusionBuffer
+{
+public:
+    enum { TILE_SIZE = 8 };
+
+    /**
+     * Constructor & Destructor.
+     *
+     * @param width, height Size of the buffer in pixels, rounded up to a multiple of TILE_SIZE.
+     */
+    C3DOcclusionBuffer(unsigned int width = 256, unsigned int height = 128);
+    ~C3DOcclusionBuffer();
+
+    unsigned int getWidth() const { return _width; }
+    unsigned int getHeight() const { return _height; }
+
+    /**
+     * Clears the buffer to the far plane, the occluders and the tests use the view projection.
+     */
+    void begin(const C3DMatrix& viewProjection);
+
+    /**
+     * Rasterizes an occluder. The positions are transformed by world, the indices are counter
+     * clockwise triangles. The triangles crossing the near plane are skipped.
+     */
+    void addOccluder(const C3DMatrix& world, const C3DVector3* positions, unsigned int vertexCount,
+                     const unsigned short* indices, unsigned int indexCount);
+
+    /**
+     * Builds the depth of the tiles once all the occluders are rasterized.
+     */
+    void end();
+
+    /**
+     * Determines if the world box is hidden by the occluders. It is not when it crosses the near
+     * plane or the sides of the buffer, and when no occluder was drawn.
+     */
+    bool isOccluded(const C3DAABB& box) const;
+
+    /**
+     * Gets the window depth of the pixels, row by row from the bottom.
+     */
+    const float* getDepth() const { return &_depth[0]; }
+
+    /**
+     * Gets the number of triangles sent to the rasterizer since begin().
+     */
+    unsigned int getTriangleCount() const { return _triangleCount; }
+
+private:
+    unsigned int _width;
+    unsigned int _height;
+    unsigned int _tilesX;
+    unsigned int _tilesY;
+    std::vector<float> _depth;
+    std::vector<float> _tileDepth; // farthest depth of each tile
+    C3DMatrix _viewProjection;
+    std::vector<float> _vertices; // clip space vertices of the occluder being added
+    std::vector<float> _triangles; // screen space triangles of the occluder being added
+    unsigned int _triangleCount;
+};
+}
+
+#endif
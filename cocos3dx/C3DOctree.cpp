@@ -0,0 +1,362 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "Base.h"
+#include "C3DOctree.h"
+#include "C3DNode.h"
+#include "C3DFrustum.h"
+#include "C3DRay.h"
+
+namespace cocos3d
+{
+C3DOctree::C3DOctree(const C3DAABB& bounds, int maxDepth)
+    : _maxDepth(maxDepth), _root(NULL)
+{
+    setBounds(bounds);
+}
+
+C3DOctree::~C3DOctree()
+{
+    std::vector<C3DNode*> nodes;
+    queryAll(nodes);
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        nodes[i]->_octreeCell = NULL;
+        nodes[i]->_octreeDirty = false;
+    }
+    _dirtyNodes.clear();
+
+    destroyCell(_root);
+    _root = NULL;
+}
+
+void C3DOctree::setBounds(const C3DAABB& bounds)
+{
+    std::vector<C3DNode*> nodes;
+    if (_root)
+    {
+        queryAll(nodes);
+        for (size_t i = 0; i < nodes.size(); i++)
+        {
+            nodes[i]->_octreeCell = NULL;
+        }
+        destroyCell(_root);
+    }
+
+    _bounds = bounds;
+
+    // the root is the cube enclosing the bounds
+    C3DVector3 size = (_bounds._max - _bounds._min) * 0.5f;
+    float halfSize = C3D_Max(size.x, C3D_Max(size.y, size.z));
+    _root = createCell(NULL, (_bounds._min + _bounds._max) * 0.5f, halfSize);
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        insert(findCell(*nodes[i]->_bb), nodes[i]);
+    }
+}
+
+C3DOctreeCell* C3DOctree::createCell(C3DOctreeCell* parent, const C3DVector3& center, float halfSize)
+{
+    C3DOctreeCell* cell = new C3DOctreeCell();
+    cell->center = center;
+    cell->halfSize = halfSize;
+    cell->depth = parent ? parent->depth + 1 : 0;
+
+    C3DVector3 looseExtent(halfSize * 2.0f, halfSize * 2.0f, halfSize * 2.0f);
+    cell->looseBox.set(center - looseExtent, center + looseExtent);
+
+    cell->parent = parent;
+    for (int i = 0; i < 8; i++)
+    {
+        cell->children[i] = NULL;
+    }
+    cell->subtreeCount = 0;
+
+    return cell;
+}
+
+void C3DOctree::destroyCell(C3DOctreeCell* cell)
+{
+    if (cell == NULL)
+        return;
+
+    for (int i = 0; i < 8; i++)
+    {
+        destroyCell(cell->children[i]);
+    }
+    delete cell;
+}
+
+C3DOctreeCell* C3DOctree::findCell(const C3DAABB& aabb)
+{
+    C3DVector3 center = (aabb._min + aabb._max) * 0.5f;
+    C3DVector3 extent = (aabb._max - aabb._min) * 0.5f;
+    float radius = C3D_Max(extent.x, C3D_Max(extent.y, extent.z));
+
+    C3DOctreeCell* cell = _root;
+
+    // nodes outside of the world bounds live in the root
+    if (fabsf(center.x - cell->center.x) > cell->halfSize ||
+        fabsf(center.y - cell->center.y) > cell->halfSize ||
+        fabsf(center.z - cell->center.z) > cell->halfSize)
+    {
+        return cell;
+    }
+
+    // descend while the node still fits in the loose bounds of the child containing its center
+    while (cell->depth < _maxDepth)
+    {
+        float childHalfSize = cell->halfSize * 0.5f;
+        if (radius > childHalfSize)
+            break;
+
+        int index = 0;
+        C3DVector3 childCenter = cell->center;
+        if (center.x >= cell->center.x) { index |= 1; childCenter.x += childHalfSize; } else { childCenter.x -= childHalfSize; }
+        if (center.y >= cell->center.y) { index |= 2; childCenter.y += childHalfSize; } else { childCenter.y -= childHalfSize; }
+        if (center.z >= cell->center.z) { index |= 4; childCenter.z += childHalfSize; } else { childCenter.z -= childHalfSize; }
+
+        if (cell->children[index] == NULL)
+        {
+            cell->children[index] = createCell(cell, childCenter, childHalfSize);
+        }
+        cell = cell->children[index];
+    }
+
+    return cell;
+}
+
+void C3DOctree::insert(C3DOctreeCell* cell, C3DNode* node)
+{
+    node->_octreeCell = cell;
+    node->_octreeIndex = (unsigned int)cell->nodes.size();
+    cell->nodes.push_back(node);
+    cell->boxes.add(*node->_bb);
+
+    for (C3DOctreeCell* c = cell; c != NULL; c = c->parent)
+    {
+        c->subtreeCount++;
+    }
+}
+
+void C3DOctree::erase(C3DNode* node)
+{
+    C3DOctreeCell* cell = node->_octreeCell;
+
+    // swap remove, keep the index of the moved node up to date
+    C3DNode* last = cell->nodes.back();
+    cell->nodes[node->_octreeIndex] = last;
+    cell->boxes.swapRemove(node->_octreeIndex);
+    last->_octreeIndex = node->_octreeIndex;
+    cell->nodes.pop_back();
+
+    for (C3DOctreeCell* c = cell; c != NULL; c = c->parent)
+    {
+        c->subtreeCount--;
+    }
+
+    node->_octreeCell = NULL;
+}
+
+void C3DOctree::prune(C3DOctreeCell* cell)
+{
+    while (cell != _root && cell->subtreeCount == 0)
+    {
+        C3DOctreeCell* parent = cell->parent;
+        for (int i = 0; i < 8; i++)
+        {
+            if (parent->children[i] == cell)
+            {
+                parent->children[i] = NULL;
+                break;
+            }
+        }
+        destroyCell(cell);
+        cell = parent;
+    }
+}
+
+void C3DOctree::add(C3DNode* node)
+{
+    if (node->_octreeCell != NULL)
+        return;
+
+    C3DAABB* aabb = node->getAABB();
+    if (aabb == NULL)
+        return;
+
+    insert(findCell(*aabb), node);
+}
+
+void C3DOctree::remove(C3DNode* node)
+{
+    if (node->_octreeCell == NULL)
+        return;
+
+    if (node->_octreeDirty)
+    {
+        std::vector<C3DNode*>::iterator it = std::find(_dirtyNodes.begin(), _dirtyNodes.end(), node);
+        if (it != _dirtyNodes.end())
+            _dirtyNodes.erase(it);
+        node->_octreeDirty = false;
+    }
+
+    C3DOctreeCell* cell = node->_octreeCell;
+    erase(node);
+    prune(cell);
+}
+
+void C3DOctree::markDirty(C3DNode* node)
+{
+    if (node->_octreeCell == NULL || node->_octreeDirty)
+        return;
+
+    node->_octreeDirty = true;
+    _dirtyNodes.push_back(node);
+}
+
+void C3DOctree::refit()
+{
+    for (size_t i = 0; i < _dirtyNodes.size(); i++)
+    {
+        C3DNode* node = _dirtyNodes[i];
+        node->_octreeDirty = false;
+
+        C3DOctreeCell* oldCell = node->_octreeCell;
+        C3DOctreeCell* newCell = findCell(*node->getAABB());
+        if (newCell == oldCell)
+        {
+            oldCell->boxes.set(node->_octreeIndex, *node->_bb);
+            continue;
+        }
+
+        erase(node);
+        insert(newCell, node);
+        prune(oldCell);
+    }
+    _dirtyNodes.clear();
+}
+
+void C3DOctree::collect(const C3DOctreeCell* cell, std::vector<C3DNode*>& result) const
+{
+    result.insert(result.end(), cell->nodes.begin(), cell->nodes.end());
+
+    for (int i = 0; i < 8; i++)
+    {
+        if (cell->children[i])
+            collect(cell->children[i], result);
+    }
+}
+
+void C3DOctree::queryAll(std::vector<C3DNode*>& result) const
+{
+    collect(_root, result);
+}
+
+void C3DOctree::queryFrustum(const C3DFrustum& frustum, std::vector<C3DNode*>& result) const
+{
+    queryFrustum(_root, frustum, result);
+}
+
+void C3DOctree::queryFrustum(const C3DOctreeCell* cell, const C3DFrustum& frustum, std::vector<C3DNode*>& result) const
+{
+    // the root also holds the nodes outside of the world bounds, never reject it by its bounds
+    if (cell != _root)
+    {
+        if (frustum.isOutFrustum(cell->looseBox))
+            return;
+
+        if (frustum.isInFrustum(cell->looseBox))
+        {
+            collect(cell, result);
+            return;
+        }
+    }
+
+    // the nodes of the cell are culled in one batch
+    if (!cell->nodes.empty())
+    {
+        frustum.cullBoxes(cell->boxes, _visibility);
+        for (size_t i = 0; i < cell->nodes.size(); i++)
+        {
+            if (_visibility[i >> 5] & (1u << (i & 31)))
+                result.push_back(cell->nodes[i]);
+        }
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+        if (cell->children[i])
+            queryFrustum(cell->children[i], frustum, result);
+    }
+}
+
+void C3DOctree::queryRay(const C3DRay& ray, std::vector<C3DNode*>& result) const
+{
+    queryRay(_root, ray, result);
+}
+
+void C3DOctree::queryRay(const C3DOctreeCell* cell, const C3DRay& ray, std::vector<C3DNode*>& result) const
+{
+    // C3DRay::intersects misses the boxes holding the origin
+    if (cell != _root && !cell->looseBox.containPoint(ray.getOrigin()) && !ray.intersects(&cell->looseBox))
+        return;
+
+    for (size_t i = 0; i < cell->nodes.size(); i++)
+    {
+        C3DNode* node = cell->nodes[i];
+        if (node->_bb->containPoint(ray.getOrigin()) || ray.intersects(node->_bb))
+            result.push_back(node);
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+        if (cell->children[i])
+            queryRay(cell->children[i], ray, result);
+    }
+}
+
+void C3DOctree::querySphere(const C3DVector3& center, float radius, std::vector<C3DNode*>& result) const
+{
+    querySphere(_root, center, radius, result);
+}
+
+void C3DOctree::querySphere(const C3DOctreeCell* cell, const C3DVector3& center, float radius, std::vector<C3DNode*>& result) const
+{
+    if (cell != _root && !cell->looseBox.containSphere(center, radius))
+        return;
+
+    for (size_t i = 0; i < cell->nodes.size(); i++)
+    {
+        C3DNode* node = cell->nodes[i];
+        if (node->_bb->distance(center) <= radius)
+            result.push_back(node);
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+        if (cell->children[i])
+            querySphere(cell->children[i], center, radius, result);
+    }
+}
+}
@@ -0,0 +1,157 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef C3DOCTREE_H_
+#define C3DOCTREE_H_
+
+#include <vector>
+#include "C3DAABB.h"
+#include "C3DVector3.h"
+#include "C3DFrustum.h"
+
+namespace cocos3d
+{
+class C3DNode;
+class C3DFrustum;
+class C3DRay;
+
+/**
+ * Defines a cell of the octree. Cells are created on demand and released when their subtree gets empty.
+ */
+struct C3DOctreeCell
+{
+    C3DVector3 center;                  // center of the cell
+    float halfSize;                     // half size of the tight cell
+    C3DAABB looseBox;                   // loose bounds, twice the tight cell size
+    int depth;
+
+    C3DOctreeCell* parent;
+    C3DOctreeCell* children[8];
+
+    std::vector<C3DNode*> nodes;        // nodes stored in this cell
+    C3DBoxArray boxes;                  // world AABBs of the nodes, in the same order
+    unsigned int subtreeCount;          // nodes stored in this cell and all its descendants
+};
+
+/**
+ * Defines a loose octree, the spatial index of the scene.
+ *
+ * Each node is stored in the deepest cell whose loose bounds (twice the tight cell size)
+ * still contain its world AABB, so a node never straddles cells and moving it costs
+ * O(depth). Queries reject whole subtrees by their loose bounds, and accept whole
+ * subtrees without per node tests once a cell is totally inside the frustum.
+ * Nodes outside of the world bounds are kept in the root cell.
+ */
+class C3DOctree
+{
+public:
+    /**
+     * Constructor & Destructor.
+     *
+     * @param bounds World bounds covered by the tree.
+     * @param maxDepth Max depth of the tree, the root is depth 0.
+     */
+    C3DOctree(const C3DAABB& bounds, int maxDepth = 6);
+    ~C3DOctree();
+
+    /**
+     * Rebuilds the tree with the new world bounds, all registered nodes are reinserted.
+     */
+    void setBounds(const C3DAABB& bounds);
+    const C3DAABB& getBounds() const { return _bounds; }
+
+    /**
+     * Adds node to the tree. The world AABB of the node is computed here.
+     */
+    void add(C3DNode* node);
+
+    /**
+     * Removes node from the tree.
+     */
+    void remove(C3DNode* node);
+
+    /**
+     * Marks the bounds of the node as changed, it will be moved on the next refit().
+     */
+    void markDirty(C3DNode* node);
+
+    /**
+     * Recomputes the AABB of every dirty node and moves it to its new cell.
+     */
+    void refit();
+
+    /**
+     * Collects the nodes whose AABB is inside or intersects the frustum.
+     */
+    void queryFrustum(const C3DFrustum& frustum, std::vector<C3DNode*>& result) const;
+
+    /**
+     * Collects the nodes whose AABB is hit by the ray.
+     */
+    void queryRay(const C3DRay& ray, std::vector<C3DNode*>& result) const;
+
+    /**
+     * Collects the nodes whose AABB intersects the sphere.
+     */
+    void querySphere(const C3DVector3& center, float radius, std::vector<C3DNode*>& result) const;
+
+    /**
+     * Collects all the nodes in the tree.
+     */
+    void queryAll(std::vector<C3DNode*>& result) const;
+
+    /**
+     * get number of nodes in the tree
+     */
+    unsigned int getNodeCount() const { return _root->subtreeCount; }
+
+private:
+
+    C3DOctreeCell* createCell(C3DOctreeCell* parent, const C3DVector3& center, float halfSize);
+    void destroyCell(C3DOctreeCell* cell);
+
+    // find or create the cell the aabb belongs to
+    C3DOctreeCell* findCell(const C3DAABB& aabb);
+
+    void insert(C3DOctreeCell* cell, C3DNode* node);
+    void erase(C3DNode* node);
+
+    // release empty cells from cell up to the root
+    void prune(C3DOctreeCell* cell);
+
+    void collect(const C3DOctreeCell* cell, std::vector<C3DNode*>& result) const;
+    void queryFrustum(const C3DOctreeCell* cell, const C3DFrustum& frustum, std::vector<C3DNode*>& result) const;
+    void queryRay(const C3DOctreeCell* cell, const C3DRay& ray, std::vector<C3DNode*>& result) const;
+    void querySphere(const C3DOctreeCell* cell, const C3DVector3& center, float radius, std::vector<C3DNode*>& result) const;
+
+    C3DAABB _bounds;
+    int _maxDepth;
+
+    C3DOctreeCell* _root;
+
+    std::vector<C3DNode*> _dirtyNodes;
+
+    mutable std::vector<unsigned int> _visibility; // visibility bits of the nodes of a cell, see queryFrustum
+};
+}
+
+#endif
@@ -402,47 +402,61 @@ void C3DParticleEmitter::emit(unsigned int particleCount)
     world.m[14] = 0.0f;
 
     // Emit the new particles.
-	C3DParticle**& _particles = _system->_particles;
+	C3DParticleArrays& p = _system->_particles;
 	int& _validParticleCount = _system->_validParticleCount;
+	int Frm = _system->getParticleRender()->getSpriteFrameRandomOffset();
 
+	C3DVector3 position, velocity, rotationAxis;
     for (unsigned int i = 0; i < particleCount; i++)
     {
-		C3DParticle* p = _particles[_validParticleCount++];
+		int index = _validParticleCount++;
 
-        p->_age = generateScalar(_ageMin, _ageMax);
-		p->_ageStart = p->_age;
-		int Frm = _system->getParticleRender()->getSpriteFrameRandomOffset();
-		p->_frameStart = (Frm == 0 ? 0 : generateScalar((long)0, (long)Frm));
-        p->_size = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        p._age[index] = generateScalar(_ageMin, _ageMax);
+		p._ageStart[index] = p._age[index];
+		p._frameStart[index] = (Frm == 0 ? 0 : generateScalar((long)0, (long)Frm));
+		p._frame[index] = p._frameStart[index];
+        p._size[index] = generateScalar(_sizeStartMin, _sizeStartMax);
+        p._rotationPerParticleSpeed[index] = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
+        p._angle[index] = generateScalar(0.0f, p._rotationPerParticleSpeed[index]);
+        float rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
 
         // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
+        generateVector(_position, _positionVar, &position, _ellipsoid);
+        generateVector(_velocity, _velocityVar, &velocity, false);
+        generateVector(_rotationAxis, _rotationAxisVar, &rotationAxis, false);
 
         // Initial position, velocity and acceleration can all be relative to the emitter's transform.
         // Rotate specified properties by the node's rotation.
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(position, &position);
         }
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            world.transformPoint(velocity, &velocity);
         }
 
-        // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        // The rotation axis always orbits the node. The transform action expects a normalized
+        // axis, particles without a valid axis don't rotate at all.
+        if (rotationSpeed != 0.0f && !rotationAxis.isZero())
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            world.transformPoint(rotationAxis, &rotationAxis);
+            rotationAxis.normalize();
+        }
+        else
+        {
+            rotationAxis.set(0.0f, 0.0f, 0.0f);
+            rotationSpeed = 0.0f;
         }
 
         // Translate position relative to the node's world space.
-        p->_position.add(translation);
+        position.add(translation);
+
+        p.setPosition(index, position);
+        p.setVelocity(index, velocity);
+        p.setRotationAxis(index, rotationAxis);
+        p._rotationSpeed[index] = rotationSpeed;
     }
 }
 
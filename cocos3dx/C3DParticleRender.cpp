@@ -254,7 +254,7 @@ void C3DParticleRender::draw()
 
 	_model->clear();
 
-	C3DParticle**& _particles = _system->_particles;
+	const C3DParticleArrays& particles = _system->_particles;
 	int& _validParticleCount = _system->_validParticleCount;
 
     //CCLOG("%d", _validParticleCount);
@@ -276,9 +276,9 @@ void C3DParticleRender::draw()
     static unsigned short index[6] = {0, 1, 3, 0, 3, 2};
 
     for (int i = 0; i < _validParticleCount; i++) {
-        C3DVector3& position = _particles[i]->_position;
-        float size = _particles[i]->_size;
-        float angle = _particles[i]->_angle;
+        C3DVector3 position = particles.getPosition(i);
+        float size = particles._size[i];
+        float angle = particles._angle[i];
 
         right2 = right;
         up2 = up;
@@ -297,13 +297,13 @@ void C3DParticleRender::draw()
         vertex[2].position = position - halfsizeright + halfsizeup;
         vertex[3].position = position + halfsizeright + halfsizeup;
 
-        int coordIdx = _particles[i]->_frame * 4;
+        int coordIdx = particles._frame[i] * 4;
 
         vertex[0].u = _frameCoord[coordIdx].x, vertex[0].v = _frameCoord[coordIdx].y;
         vertex[1].u = _frameCoord[coordIdx + 1].x, vertex[1].v = _frameCoord[coordIdx + 1].y;
         vertex[2].u = _frameCoord[coordIdx + 2].x, vertex[2].v = _frameCoord[coordIdx + 2].y;
         vertex[3].u = _frameCoord[coordIdx + 3].x, vertex[3].v = _frameCoord[coordIdx + 3].y;
-        vertex[0].color = vertex[1].color = vertex[2].color = vertex[3].color = _particles[i]->_color;
+        vertex[0].color = vertex[1].color = vertex[2].color = vertex[3].color = particles.getColor(i);
         //add to buffer
         _model->add((unsigned char*)vertex, 4, index, 6);
 
@@ -328,7 +328,7 @@ void C3DParticleRender::draw()
 		C3DRenderChannel* channel = _model->getRenderChannel();
 		if(channel != NULL)
 		{
-			channel->addItem( _model, z, "Particle" );
+			channel->addItem( _model, z );
 		}
 		else
 		{
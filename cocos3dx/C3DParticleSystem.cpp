@@ -41,6 +41,7 @@ THE SOFTWARE.
 #define PARTICLE_COUNT_MAX                       100
 #define PARTICLE_EMISSION_RATE                   10
 #define PARTICLE_EMISSION_RATE_TIME_INTERVAL     1000.0f / (float)PARTICLE_EMISSION_RATE
+#define PARTICLE_UPDATE_CHUNK                    256
 
 namespace cocos3d
 {
@@ -51,8 +52,6 @@ C3DParticleSystem::C3DParticleSystem(const std::string& id):
 	_emitter = new C3DParticleEmitter(this);
     _render = new C3DParticleRender(this);
 
-	_particles = NULL;
-	_p = NULL;
 	_started = false;
 	_numTintAction = 0;
 
@@ -72,9 +71,6 @@ C3DParticleSystem::~C3DParticleSystem()
 
 	SAFE_DELETE(_emitter);
 	SAFE_DELETE(_render);
-
-	SAFE_DELETE_ARRAY(_p);
-	SAFE_DELETE_ARRAY(_particles);
 }
 
 C3DNode::Type C3DParticleSystem::getType() const
@@ -208,12 +204,7 @@ bool C3DParticleSystem::load(C3DElementNode* psNode)
 		_timeLast = (long)psNode->getElement("timeLast", (long*)0);
 		_timeStart = (long)psNode->getElement("timeStart", (long*)0);
 
-		_p = new C3DParticle[_particleCountMax];
-		_particles = new C3DParticle*[_particleCountMax];
-		for(int i=0; i<_particleCountMax; ++i)
-		{
-			_particles[i] = _p+i;
-		}
+		_particles.allocate(_particleCountMax);
 		_validParticleCount = 0;
 	}
 
@@ -357,13 +348,12 @@ void C3DParticleSystem::update(long elapsedTime)
     if(!isActive())
         return;
     
-	getAABB();
-	_visible = _scene->getActiveCamera()->isVisible(*_bb);
+	updateVisibility();
 
 	if (!isVisible())
 		return;
 
-	if (_particles)
+	if (_particles.getCapacity() > 0)
 	{
 		if(_emitter && _state == RUNNING)
 		{
@@ -373,10 +363,7 @@ void C3DParticleSystem::update(long elapsedTime)
 
 		if (_state != PAUSE)
 		{
-			for(std::vector<C3DBaseParticleAction*>::iterator iter =_actions.begin(); iter!=_actions.end(); ++iter)
-			{
-				(*iter)->action(elapsedTime);
-			}
+			updateParticles(elapsedTime);
 		}
 	}
 
@@ -399,6 +386,36 @@ void C3DParticleSystem::update(long elapsedTime)
 	}
 }
 
+void C3DParticleSystem::updateParticles(long elapsedTime)
+{
+	// all the actions work on one chunk before the next chunk is touched,
+	// a chunk of every particle array fits in the cache
+	for (int begin = 0; begin < _validParticleCount; begin += PARTICLE_UPDATE_CHUNK)
+	{
+		int end = C3D_Min(begin + PARTICLE_UPDATE_CHUNK, _validParticleCount);
+		for(std::vector<C3DBaseParticleAction*>::iterator iter =_actions.begin(); iter!=_actions.end(); ++iter)
+		{
+			(*iter)->action(elapsedTime, begin, end);
+		}
+	}
+
+	// Particle is dead. Move the particle furthest from the start of the arrays
+	// down to take its place, and re-use the slot at the end of the list of living particles.
+	long* age = _particles._age;
+	for (int i = 0; i < _validParticleCount; )
+	{
+		if (age[i] > 0L)
+		{
+			++i;
+			continue;
+		}
+
+		--_validParticleCount;
+		if (i != _validParticleCount)
+			_particles.move(_validParticleCount, i);
+	}
+}
+
 void C3DParticleSystem::draw()
 {
     if(!isActive() || !isVisible())
@@ -406,7 +423,7 @@ void C3DParticleSystem::draw()
 
     STAT_INC_TRIANGLE_TOTAL(_validParticleCount * 2);
 
-    if(_particles && _render && _render->isVisible())
+    if(_particles.getCapacity() > 0 && _render && _render->isVisible())
     {
         STAT_INC_TRIANGLE_DRAW(_validParticleCount * 2);
         STAT_INC_DRAW_CALL(1);
@@ -474,12 +491,7 @@ void C3DParticleSystem::copyFrom(const C3DTransform* other, CloneContext& contex
     _particleCountMax = particle->_particleCountMax;
     _validParticleCount = particle->_validParticleCount;
 
-    _p = new C3DParticle[_particleCountMax];
-    _particles = new C3DParticle*[_particleCountMax];
-    for(int i=0; i<_particleCountMax; ++i)
-    {
-        _particles[i] = _p+i;
-    }
+    _particles.allocate(_particleCountMax);
     _validParticleCount = 0;
 
     _numTintAction = particle->_numTintAction;
@@ -554,15 +566,7 @@ void C3DParticleSystem::setParticleCountMax(int particleCountMax)
 	if (_particleCountMax != particleCountMax)
 	{
 		_particleCountMax = particleCountMax;
-		SAFE_DELETE_ARRAY(_p);
-		SAFE_DELETE_ARRAY(_particles);
-
-		_p = new C3DParticle[_particleCountMax];
-		_particles = new C3DParticle*[_particleCountMax];
-		for(int i=0; i<_particleCountMax; ++i)
-		{
-			_particles[i] = _p+i;
-		}
+		_particles.allocate(_particleCountMax);
 		_validParticleCount = 0;
 
 		_render->reSizeCapacity((unsigned int)_particleCountMax);
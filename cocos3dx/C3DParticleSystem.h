@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "C3DElementNode.h"
 #include "cocos2d.h"
 #include "C3DNode.h"
+#include "C3DParticleSystemCommon.h"
 
 namespace cocos3d
 {
@@ -43,7 +44,6 @@ class C3DParticleEmitter;
 class C3DParticleRender;
 class C3DParticleAction;
 class C3DBaseParticleAction;
-class C3DParticle;
 
 /**
 	C3DParticleSystem represents a 3D particle system. It is loaded from .particle files.
@@ -192,6 +192,11 @@ public:
 	virtual void calculateBoundingBox_();
 protected:
 
+	/**
+     * run the particle actions chunk by chunk, then remove the dead particles
+     */
+	void updateParticles(long elapsedTime);
+
 	/**
      * copy method
      */
@@ -211,8 +216,7 @@ private:
     int _particleCountMax;
     int _validParticleCount;
 
-	C3DParticle* _p;
-	C3DParticle** _particles;
+	C3DParticleArrays _particles;
 
 	int _numTintAction;
 
@@ -27,6 +27,83 @@ THE SOFTWARE.
 
 namespace cocos3d
 {
+#define PARTICLE_FLOAT_ARRAY_COUNT 17
+
+C3DParticleArrays::C3DParticleArrays()
+	: _capacity(0), _floatBlock(NULL), _longBlock(NULL), _intBlock(NULL)
+{
+	free();
+}
+
+C3DParticleArrays::~C3DParticleArrays()
+{
+	free();
+}
+
+void C3DParticleArrays::free()
+{
+	SAFE_DELETE_ARRAY(_floatBlock);
+	SAFE_DELETE_ARRAY(_longBlock);
+	SAFE_DELETE_ARRAY(_intBlock);
+	_capacity = 0;
+
+	_positionX = _positionY = _positionZ = NULL;
+	_velocityX = _velocityY = _velocityZ = NULL;
+	_rotationAxisX = _rotationAxisY = _rotationAxisZ = NULL;
+	_colorR = _colorG = _colorB = _colorA = NULL;
+	_rotationSpeed = _rotationPerParticleSpeed = _angle = _size = NULL;
+	_age = _ageStart = NULL;
+	_frame = _frameStart = NULL;
+}
+
+void C3DParticleArrays::allocate(int capacity)
+{
+	free();
+	if (capacity <= 0)
+		return;
+
+	_capacity = capacity;
+
+	// one block per type, each array starts on its own slice of the block
+	_floatBlock = new float[capacity * PARTICLE_FLOAT_ARRAY_COUNT];
+	memset(_floatBlock, 0, sizeof(float) * capacity * PARTICLE_FLOAT_ARRAY_COUNT);
+	float** floatArrays[PARTICLE_FLOAT_ARRAY_COUNT] =
+	{
+		&_positionX, &_positionY, &_positionZ,
+		&_velocityX, &_velocityY, &_velocityZ,
+		&_rotationAxisX, &_rotationAxisY, &_rotationAxisZ,
+		&_colorR, &_colorG, &_colorB, &_colorA,
+		&_rotationSpeed, &_rotationPerParticleSpeed, &_angle, &_size,
+	};
+	for (int i = 0; i < PARTICLE_FLOAT_ARRAY_COUNT; i++)
+	{
+		*floatArrays[i] = _floatBlock + i * capacity;
+	}
+
+	_longBlock = new long[capacity * 2];
+	memset(_longBlock, 0, sizeof(long) * capacity * 2);
+	_age = _longBlock;
+	_ageStart = _longBlock + capacity;
+
+	_intBlock = new int[capacity * 2];
+	memset(_intBlock, 0, sizeof(int) * capacity * 2);
+	_frame = _intBlock;
+	_frameStart = _intBlock + capacity;
+}
+
+void C3DParticleArrays::move(int src, int dst)
+{
+	for (int i = 0; i < PARTICLE_FLOAT_ARRAY_COUNT; i++)
+	{
+		float* array = _floatBlock + i * _capacity;
+		array[dst] = array[src];
+	}
+	_age[dst] = _age[src];
+	_ageStart[dst] = _ageStart[src];
+	_frame[dst] = _frame[src];
+	_frameStart[dst] = _frameStart[src];
+}
+
 C3DBaseParticleAction::C3DBaseParticleAction(C3DParticleSystem* system)
 {
 	_system = system;
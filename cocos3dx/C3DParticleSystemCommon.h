@@ -41,36 +41,111 @@ class C3DElementNode;
 class C3DParticleSystem;
 
 /**
-Defines properties for single particle
+Defines the state of all the particles of a particle system.
+Every property is stored in its own array so that the particle actions can update
+a range of particles with simple loops over contiguous floats. A particle is an index
+into the arrays, dead particles are removed by moving the last living one into their slot.
 */
-class C3DParticle
+class C3DParticleArrays
 {
 public:
 	/**
      * Constructor & Destructor
      */
-	C3DParticle()
+	C3DParticleArrays();
+	~C3DParticleArrays();
+
+	/**
+     * reallocate the arrays for capacity particles, the content is lost
+     */
+	void allocate(int capacity);
+
+	/**
+     * release the arrays
+     */
+	void free();
+
+	/**
+     * copy the particle at index src to index dst
+     */
+	void move(int src, int dst);
+
+	/**
+     * get maximum number of particles
+     */
+	int getCapacity() const { return _capacity; }
+
+	/**
+     * set & get particle position
+     */
+	void setPosition(int index, const C3DVector3& position)
 	{
-		_visible = true;
-		_frame = 0;
-	};
-	virtual ~C3DParticle(){};
+		_positionX[index] = position.x;
+		_positionY[index] = position.y;
+		_positionZ[index] = position.z;
+	}
+	C3DVector3 getPosition(int index) const { return C3DVector3(_positionX[index], _positionY[index], _positionZ[index]); }
+
+	/**
+     * set particle velocity & rotation axis
+     */
+	void setVelocity(int index, const C3DVector3& velocity)
+	{
+		_velocityX[index] = velocity.x;
+		_velocityY[index] = velocity.y;
+		_velocityZ[index] = velocity.z;
+	}
+	void setRotationAxis(int index, const C3DVector3& axis)
+	{
+		_rotationAxisX[index] = axis.x;
+		_rotationAxisY[index] = axis.y;
+		_rotationAxisZ[index] = axis.z;
+	}
+
+	/**
+     * get particle color
+     */
+	C3DVector4 getColor(int index) const { return C3DVector4(_colorR[index], _colorG[index], _colorB[index], _colorA[index]); }
 
 public:
-    C3DVector3 _position;
-    C3DVector3 _velocity;
-    C3DVector3 _acceleration;
-    C3DVector4 _color;
-    float _rotationPerParticleSpeed;
-    C3DVector3 _rotationAxis;
-    float _rotationSpeed;
-    float _angle;
-    long _age;
-    float _size;
-    bool _visible;
-	int _frame;
-	int _frameStart;
-	long _ageStart;//
+    float* _positionX;
+    float* _positionY;
+    float* _positionZ;
+    float* _velocityX;
+    float* _velocityY;
+    float* _velocityZ;
+    float* _rotationAxisX; // normalized rotation axis, zero if the particle does not rotate
+    float* _rotationAxisY;
+    float* _rotationAxisZ;
+    float* _colorR;
+    float* _colorG;
+    float* _colorB;
+    float* _colorA;
+    float* _rotationSpeed;
+    float* _rotationPerParticleSpeed;
+    float* _angle;
+    float* _size;
+    long* _age;
+    long* _ageStart;
+	int* _frame;
+	int* _frameStart;
+
+private:
+
+	/**
+     * Hidden copy constructor.
+     */
+	C3DParticleArrays(const C3DParticleArrays& copy);
+
+	/**
+     * Hidden copy assignment operator.
+     */
+	C3DParticleArrays& operator=(const C3DParticleArrays&);
+
+	int _capacity;
+	float* _floatBlock;
+	long* _longBlock;
+	int* _intBlock;
 };
 
 /**
@@ -93,9 +168,11 @@ public:
 	virtual void save(C3DElementNode* psaNode);
 
 	/**
-     * particle action, affect particle movement
+     * particle action, affect the movement of the particles in [begin, end).
+     * The particle system calls all of its actions on one range before moving to the
+     * next one, so the particle state stays in cache between the actions.
      */
-	virtual void action(long elapsedTime){};
+	virtual void action(long elapsedTime, int begin, int end){};
 
 	/**
      * particle action clone method
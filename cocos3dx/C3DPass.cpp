@@ -30,16 +30,19 @@ THE SOFTWARE.
 #include "C3DRenderBlock.h"
 
 #include "C3DEffectManager.h"
+#include "C3DShadowMap.h"
 
 namespace cocos3d
 {
 C3DPass::C3DPass() :
-    _id(""), _technique(NULL), _effect(NULL),_vaBinding(NULL), _nMaxDirLight(0), _nMaxPointLight(0), _nMaxSpotLight(0), _nMaxAnimLight(0), _nMaxShadowMap(0)
+    _id(""), _technique(NULL), _effect(NULL),_vaBinding(NULL), _nMaxDirLight(0), _nMaxPointLight(0), _nMaxSpotLight(0), _nMaxAnimLight(0), _nMaxShadowMap(0), _lodFade(false), _lightParams(NULL),
+    _instancedEffect(NULL), _instancedVaBinding(NULL), _instancedEffectResolved(false)
 {
 }
 
 C3DPass::C3DPass(const std::string& id, C3DTechnique* technique, C3DEffect* effect) :
-    _id(id), _technique(technique), _effect(effect), _vaBinding(NULL), _nMaxDirLight(0), _nMaxPointLight(0), _nMaxSpotLight(0), _nMaxAnimLight(0), _nMaxShadowMap(0)
+    _id(id), _technique(technique), _effect(effect), _vaBinding(NULL), _nMaxDirLight(0), _nMaxPointLight(0), _nMaxSpotLight(0), _nMaxAnimLight(0), _nMaxShadowMap(0), _lodFade(false), _lightParams(NULL),
+    _instancedEffect(NULL), _instancedVaBinding(NULL), _instancedEffectResolved(false)
 {
     assert(technique);
 
@@ -50,6 +53,9 @@ C3DPass::~C3DPass()
 {
     SAFE_RELEASE(_effect);
     SAFE_RELEASE(_vaBinding);
+    SAFE_DELETE(_lightParams);
+    SAFE_RELEASE(_instancedVaBinding);
+    SAFE_RELEASE(_instancedEffect);
 }
 
 const std::string& C3DPass::getId() const
@@ -104,6 +110,60 @@ void C3DPass::unbind()
 	//GL_ASSERT( glUseProgram(0) );
 }
 
+void C3DPass::bindParameters(C3DEffect* effect)
+{
+    C3DRenderState::bind(this, effect);
+}
+
+C3DEffect* C3DPass::getInstancedEffect()
+{
+    if (_instancedEffectResolved)
+        return _instancedEffect;
+
+    _instancedEffectResolved = true;
+
+    // clones do not keep the shader paths, extend the id of the effect the way generateID would
+    std::string uniqueId = _effect->getResourceName();
+    uniqueId += "#define INSTANCING\n";
+
+    _instancedEffect = static_cast<C3DEffect*>(C3DEffectManager::getInstance()->getResource(uniqueId));
+
+    // shaders without an INSTANCING path compile to a copy of the regular effect
+    if (_instancedEffect && (_instancedEffect->getProgram() == 0 || _instancedEffect->getVertexAttribute("a_instanceRow0") == -1))
+    {
+        SAFE_RELEASE(_instancedEffect);
+    }
+
+    return _instancedEffect;
+}
+
+void C3DPass::bindInstanced(C3DMesh* mesh)
+{
+    assert(_instancedEffect);
+
+    if (_instancedVaBinding == NULL)
+    {
+        _instancedVaBinding = C3DVertexDeclaration::create(mesh, _instancedEffect);
+    }
+
+    _instancedEffect->bind();
+
+    C3DRenderState::bind(this, _instancedEffect);
+
+    if (_instancedVaBinding)
+    {
+        _instancedVaBinding->bind();
+    }
+}
+
+void C3DPass::unbindInstanced()
+{
+    if (_instancedVaBinding)
+    {
+        _instancedVaBinding->unbind();
+    }
+}
+
 void C3DPass::reload()
 {
 	LOG_TRACE_VARG("    C3DPass:%s begin reload", _id.c_str());
@@ -111,6 +171,9 @@ void C3DPass::reload()
 	
 	if(_vaBinding)
 		_vaBinding->reload();
+
+	if(_instancedVaBinding)
+		_instancedVaBinding->reload();
 }
 
 C3DPass* C3DPass::clone() const
@@ -125,14 +188,87 @@ C3DPass* C3DPass::clone() const
 	other->_nMaxPointLight = _nMaxPointLight;
 	other->_nMaxSpotLight = _nMaxSpotLight;
     other->_nMaxShadowMap = _nMaxShadowMap;
+    other->_lodFade = _lodFade;
 	other->autorelease();
 	return other;
 }
 
+const C3DPassLightParams* C3DPass::getLightParams()
+{
+    if (_lightParams)
+        return _lightParams;
+
+    _lightParams = new C3DPassLightParams();
+
+    char paraName[128];
+    int i;
+    for (i = 0; i < _nMaxDirLight; i++)
+    {
+        C3DPassLightParams::DirLight light;
+        sprintf(paraName, "u_dirlight[%d].dir", i);
+        light.dir = getParameter(paraName);
+        sprintf(paraName, "u_dirlight[%d].color", i);
+        light.color = getParameter(paraName);
+        _lightParams->dirLights.push_back(light);
+    }
+
+    for (i = 0; i < _nMaxPointLight; i++)
+    {
+        C3DPassLightParams::PointLight light;
+        sprintf(paraName, "u_pointlight[%d].position", i);
+        light.position = getParameter(paraName);
+        sprintf(paraName, "u_pointlight[%d].color", i);
+        light.color = getParameter(paraName);
+        sprintf(paraName, "u_pointlight[%d].rangeInverse", i);
+        light.rangeInverse = getParameter(paraName);
+        _lightParams->pointLights.push_back(light);
+    }
+
+    for (i = 0; i < _nMaxSpotLight; i++)
+    {
+        C3DPassLightParams::SpotLight light;
+        sprintf(paraName, "u_spotlight[%d].position", i);
+        light.position = getParameter(paraName);
+        sprintf(paraName, "u_spotlight[%d].color", i);
+        light.color = getParameter(paraName);
+        sprintf(paraName, "u_spotlight[%d].rangeInverse", i);
+        light.rangeInverse = getParameter(paraName);
+        sprintf(paraName, "u_spotlight[%d].dir", i);
+        light.dir = getParameter(paraName);
+        sprintf(paraName, "u_spotlight[%d].innerAngleCos", i);
+        light.innerAngleCos = getParameter(paraName);
+        sprintf(paraName, "u_spotlight[%d].outerAngleCos", i);
+        light.outerAngleCos = getParameter(paraName);
+        _lightParams->spotLights.push_back(light);
+    }
+
+    // no more than one animated light allowed
+    bool animLight = _nMaxAnimLight > 0;
+    _lightParams->animLightAxisU = animLight ? getParameter("u_animLightAxisU") : NULL;
+    _lightParams->animLightAxisV = animLight ? getParameter("u_animLightAxisV") : NULL;
+    _lightParams->animLightPos = animLight ? getParameter("u_animLightPos") : NULL;
+    _lightParams->animLightTexOffset = animLight ? getParameter("u_animLightTexOffset") : NULL;
+    _lightParams->animLightTexRotScale1 = animLight ? getParameter("u_animLightTexRotScale1") : NULL;
+    _lightParams->animLightTexRotScale2 = animLight ? getParameter("u_animLightTexRotScale2") : NULL;
+    _lightParams->animLightIntensity = animLight ? getParameter("u_animLightIntensity") : NULL;
+    _lightParams->lightTexture = animLight ? getParameter("u_lightTexture") : NULL;
+
+    _lightParams->nDirLight = _nMaxDirLight > 0 ? getParameter("u_ndirlight") : NULL;
+    _lightParams->nPointLight = _nMaxPointLight > 0 ? getParameter("u_npointlight") : NULL;
+    _lightParams->nSpotLight = _nMaxSpotLight > 0 ? getParameter("u_nspotlight") : NULL;
+    _lightParams->nAnimLight = _nMaxAnimLight > 0 ? getParameter("u_nanimlight") : NULL;
+    _lightParams->ambientColor = getParameter("u_ambientColor");
+
+    return _lightParams;
+}
+
 void C3DPass::setupParametersFromEffect()
 {
     static int zeros[4] = {0};
 
+    // parameters may be released below, resolve the light parameters again on next use
+    SAFE_DELETE(_lightParams);
+
     for ( unsigned int i = 0; i < _effect->getUniformCount(); i++)
     {
         Uniform* uniform = _effect->getUniform(i);
@@ -275,6 +411,16 @@ bool C3DPass::load(C3DElementNode* node)
         {
             this->_nMaxShadowMap = 1;
         }
+        ptr = strstr(_defines.c_str(), "SHADOWCASCADE");
+        if (ptr)
+        {
+            this->_nMaxShadowMap = C3DShadowMap::MAX_CASCADES;
+        }
+        ptr = strstr(_defines.c_str(), "LODFADE");
+        if (ptr)
+        {
+            this->_lodFade = true;
+        }
     }
 
     // Load render state
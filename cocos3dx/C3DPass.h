@@ -30,6 +30,56 @@ namespace cocos3d
 class C3DTechnique;
 class C3DVertexDeclaration;
 class C3DEffect;
+class C3DMesh;
+class MaterialParameter;
+
+/**
+ * Light parameters of a pass, resolved once from their uniform names.
+ */
+struct C3DPassLightParams
+{
+    struct DirLight
+    {
+        MaterialParameter* dir;
+        MaterialParameter* color;
+    };
+
+    struct PointLight
+    {
+        MaterialParameter* position;
+        MaterialParameter* color;
+        MaterialParameter* rangeInverse;
+    };
+
+    struct SpotLight
+    {
+        MaterialParameter* position;
+        MaterialParameter* color;
+        MaterialParameter* rangeInverse;
+        MaterialParameter* dir;
+        MaterialParameter* innerAngleCos;
+        MaterialParameter* outerAngleCos;
+    };
+
+    std::vector<DirLight> dirLights;
+    std::vector<PointLight> pointLights;
+    std::vector<SpotLight> spotLights;
+
+    MaterialParameter* animLightAxisU;
+    MaterialParameter* animLightAxisV;
+    MaterialParameter* animLightPos;
+    MaterialParameter* animLightTexOffset;
+    MaterialParameter* animLightTexRotScale1;
+    MaterialParameter* animLightTexRotScale2;
+    MaterialParameter* animLightIntensity;
+    MaterialParameter* lightTexture;
+
+    MaterialParameter* nDirLight;
+    MaterialParameter* nPointLight;
+    MaterialParameter* nSpotLight;
+    MaterialParameter* nAnimLight;
+    MaterialParameter* ambientColor;
+};
 
 /**
  * Defines a pass for an model to be rendered.
@@ -57,11 +107,33 @@ public:
 
     void setVertexAttributeBinding(C3DVertexDeclaration* binding);
 
+    C3DVertexDeclaration* getVertexAttributeBinding() const { return _vaBinding; }
+
     void bind();
 	void setParamMethonAutoUniform();
 
     void unbind();
 
+    /**
+     * Binds the parameters and render states of the pass to effect, the program already
+     * bound by a pass of a model sharing the mesh and the material.
+     */
+    void bindParameters(C3DEffect* effect);
+
+    /**
+     * Gets the variant of the effect compiled with INSTANCING, which reads the world
+     * matrix of each instance from the a_instanceRow0-2 attributes. NULL if the shader
+     * does not support instancing.
+     */
+    C3DEffect* getInstancedEffect();
+
+    /**
+     * Binds the pass with its instanced effect, for the vertex buffer of the mesh.
+     */
+    void bindInstanced(C3DMesh* mesh);
+
+    void unbindInstanced();
+
 	virtual void reload();
 
     // get max support lights each type
@@ -71,6 +143,16 @@ public:
 	int getMaxAnimLight() const { return _nMaxAnimLight; }
     int getMaxShadowMap() const { return _nMaxShadowMap; }
 
+    /**
+     * whether the pass dithers the transitions between levels of detail, LODFADE define
+     */
+    bool isLODFade() const { return _lodFade; }
+
+    /**
+     * get the light parameters of the pass, resolved on first use
+     */
+    const C3DPassLightParams* getLightParams();
+
 	C3DPass* clone() const;
 
     void setupParametersFromEffect();
@@ -112,6 +194,14 @@ private:
 	int _nMaxAnimLight;
 
     int _nMaxShadowMap;
+
+    bool _lodFade;
+
+    C3DPassLightParams* _lightParams;
+
+    C3DEffect* _instancedEffect;
+    C3DVertexDeclaration* _instancedVaBinding;
+    bool _instancedEffectResolved;
 };
 }
 
@@ -20,23 +20,106 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 
+
 #include "Base.h"
 #include "cocos3d.h"
 #include "cocos2d.h"
 #include "C3DProfile.h"
-#include "CCStdC.h"
+#include "C3DStat.h"
+#include <chrono>
+#include <float.h>
+
+#if defined(_MSC_VER)
+#define C3D_THREAD_LOCAL __declspec(thread)
+#else
+#define C3D_THREAD_LOCAL __thread
+#endif
 
 using namespace cocos2d;
 
 namespace cocos3d
 {
-    C3DProfile::C3DProfile()
+    enum ProfileEventType
+    {
+        ProfileEvent_Begin,
+        ProfileEvent_End,
+    };
+
+    struct C3DProfileEvent
+    {
+        unsigned long long time;
+        unsigned short marker;
+        unsigned short type;
+    };
+
+    /**
+     *  events & frame accumulators of a thread, written by its thread and read by
+     *  update, reset & the export, all of them under its lock
+     */
+    class C3DProfileThread
+    {
+    public:
+        C3DProfileThread(unsigned int index) : _index(index), _writeIndex(0), _depth(0)
+        {
+            memset(_frameTime, 0, sizeof(_frameTime));
+            memset(_frameCalls, 0, sizeof(_frameCalls));
+            memset(_frameDepth, 0, sizeof(_frameDepth));
+        }
+
+        void record(unsigned short marker, unsigned short type, unsigned long long time)
+        {
+            C3DProfileEvent& event = _events[_writeIndex & (C3D_PROFILE_RING_SIZE - 1)];
+            event.time = time;
+            event.marker = marker;
+            event.type = type;
+            _writeIndex++;
+        }
+
+        unsigned int _index;
+        std::mutex _mutex;
+
+        C3DProfileEvent _events[C3D_PROFILE_RING_SIZE];
+        unsigned int _writeIndex; // number of events ever written, the ring keeps the last ones
+
+        // the open scopes, counted while the profile is disabled too so the scopes open
+        // across a switch end the way they began. Only touched by the thread itself
+        unsigned int _depth;
+        bool _recorded[C3D_PROFILE_MAX_DEPTH];
+        unsigned long long _beginTime[C3D_PROFILE_MAX_DEPTH];
+
+        unsigned long long _frameTime[C3D_PROFILE_MAX_MARKERS];
+        unsigned int _frameCalls[C3D_PROFILE_MAX_MARKERS];
+        unsigned int _frameDepth[C3D_PROFILE_MAX_MARKERS];
+    };
+
+    static C3D_THREAD_LOCAL C3DProfileThread* __profileThread = NULL;
+
+    C3DProfileMarker::C3DProfileMarker(const char* name) : _name(name)
+    {
+        _id = C3DProfile::getInstance()->registerMarker(name);
+    }
+
+    C3DProfile::C3DProfile() : _enabled(true), _pendingEnabled(true), _markerCount(0)
     {
+        memset(_markerNames, 0, sizeof(_markerNames));
+        memset(_stats, 0, sizeof(_stats));
+        for (unsigned int i = 0; i < C3D_PROFILE_MAX_MARKERS; i++)
+        {
+            _stats[i].minTime = FLT_MAX;
+        }
+        _startTime = getTime();
+
+        // the last id is shared by the markers that don't fit
+        _markerNames[C3D_PROFILE_MAX_MARKERS - 1] = "others";
     }
 
     C3DProfile::~C3DProfile()
     {
-        removeAllProfile();
+        for (size_t i = 0; i < _threads.size(); i++)
+        {
+            delete _threads[i];
+        }
+        _threads.clear();
     }
 
     C3DProfile* C3DProfile::getInstance()
@@ -46,67 +129,268 @@ namespace cocos3d
         return &instance;
     }
 
-    void C3DProfile::beginProfile(const std::string& itemname)
+    unsigned long long C3DProfile::getTime()
     {
-#ifdef ENABLE_C3D_PROFILE
-        ProfileItem*& item = _profileItems[itemname];
-        if (item == NULL)
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    unsigned short C3DProfile::registerMarker(const char* name)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_markerCount >= C3D_PROFILE_MAX_MARKERS - 1)
         {
-            item = new ProfileItem;
-            item->_name = itemname;
+            WARN_VARG("too many profile markers, %s is counted as others", name);
+            return C3D_PROFILE_MAX_MARKERS - 1;
         }
 
-        struct timeval now;
-        gettimeofday( &now, NULL);
-        item->_startTime = 1000000 * (now.tv_sec) + (now.tv_usec);
-#endif
+        unsigned short id = (unsigned short)_markerCount++;
+        _markerNames[id] = name;
+        _stats[id].name = name;
+        return id;
     }
 
-    void C3DProfile::endProfile(const std::string& itemname)
+    C3DProfileThread* C3DProfile::createThread()
     {
-#ifdef ENABLE_C3D_PROFILE
-        struct timeval now;
-        gettimeofday( &now, NULL);
-        ProfileItem*& item = _profileItems[itemname];
-        //CCAssert(item, "profile item null");
-        item->_accTime += 1000000 * (now.tv_sec) + (now.tv_usec) - item->_startTime;
-#endif
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        C3DProfileThread* thread = new C3DProfileThread((unsigned int)_threads.size());
+        _threads.push_back(thread);
+        return thread;
+    }
+
+    C3DProfileThread* C3DProfile::getThread()
+    {
+        if (__profileThread == NULL)
+            __profileThread = createThread();
+        return __profileThread;
+    }
+
+    void C3DProfile::begin(const C3DProfileMarker& marker)
+    {
+        C3DProfileThread* thread = getThread();
+
+        // the scopes past the max depth follow the deepest tracked one
+        bool enabled = thread->_depth < C3D_PROFILE_MAX_DEPTH ? _enabled.load() : thread->_recorded[C3D_PROFILE_MAX_DEPTH - 1];
+        if (thread->_depth < C3D_PROFILE_MAX_DEPTH)
+            thread->_recorded[thread->_depth] = enabled;
+        if (!enabled)
+        {
+            thread->_depth++;
+            return;
+        }
+
+        unsigned long long time = getTime();
+
+        std::lock_guard<std::mutex> lock(thread->_mutex);
+        thread->record(marker.getId(), ProfileEvent_Begin, time);
+
+        if (thread->_depth < C3D_PROFILE_MAX_DEPTH)
+        {
+            thread->_beginTime[thread->_depth] = time;
+            thread->_frameDepth[marker.getId()] = thread->_depth;
+        }
+        thread->_depth++;
+    }
+
+    void C3DProfile::end(const C3DProfileMarker& marker)
+    {
+        C3DProfileThread* thread = getThread();
+        if (thread->_depth == 0)
+            return;
+
+        unsigned int depth = C3D_Min(thread->_depth - 1, (unsigned int)C3D_PROFILE_MAX_DEPTH - 1);
+        if (!thread->_recorded[depth])
+        {
+            thread->_depth--;
+            return;
+        }
+
+        unsigned long long time = getTime();
+
+        std::lock_guard<std::mutex> lock(thread->_mutex);
+        thread->record(marker.getId(), ProfileEvent_End, time);
+
+        thread->_depth--;
+        if (thread->_depth < C3D_PROFILE_MAX_DEPTH)
+        {
+            thread->_frameTime[marker.getId()] += time - thread->_beginTime[thread->_depth];
+            thread->_frameCalls[marker.getId()]++;
+        }
     }
 
     void C3DProfile::update()
     {
-#ifdef ENABLE_C3D_PROFILE
-        for (std::map<std::string, ProfileItem*>::iterator it = _profileItems.begin(); it != _profileItems.end(); it++)
+        // sum the frame of every thread, the loader threads included
+        unsigned long long frameTime[C3D_PROFILE_MAX_MARKERS];
+        unsigned int frameCalls[C3D_PROFILE_MAX_MARKERS];
+        unsigned int frameDepth[C3D_PROFILE_MAX_MARKERS];
+        memset(frameTime, 0, sizeof(frameTime));
+        memset(frameCalls, 0, sizeof(frameCalls));
+        memset(frameDepth, 0, sizeof(frameDepth));
         {
-            ProfileItem*& item = it->second;
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            for (size_t t = 0; t < _threads.size(); t++)
+            {
+                C3DProfileThread* other = _threads[t];
+                std::lock_guard<std::mutex> threadLock(other->_mutex);
+
+                for (unsigned int i = 0; i < C3D_PROFILE_MAX_MARKERS; i++)
+                {
+                    if (other->_frameCalls[i] == 0)
+                        continue;
+
+                    if (frameCalls[i] == 0 || other->_frameDepth[i] < frameDepth[i])
+                        frameDepth[i] = other->_frameDepth[i];
+                    frameTime[i] += other->_frameTime[i];
+                    frameCalls[i] += other->_frameCalls[i];
+
+                    other->_frameTime[i] = 0;
+                    other->_frameCalls[i] = 0;
+                }
+            }
+        }
 
-            if (item->numberOfCalls != 0)
+        for (unsigned int i = 0; i < C3D_PROFILE_MAX_MARKERS; i++)
+        {
+            if (frameCalls[i] == 0)
             {
-                item->_durTime = item->_accTime;
-                item->totalTime += item->_durTime;
-                item->_avgTime = item->totalTime / item->numberOfCalls;
-                item->_startTime = 0;
-                if (item->_durTime > item->maxTime)
-                    item->maxTime = item->_durTime;
-                if (item->_durTime < item->minTime)
-                    item->minTime = item->_durTime;
+                _stats[i].calls = 0;
+                _stats[i].frameTime = 0.0f;
+                continue;
             }
-            else
-                item->reset();
 
-            item->_accTime = 0;
-            item->numberOfCalls++;
+            C3DProfileMarkerStat& stat = _stats[i];
+            stat.name = _markerNames[i];
+            stat.depth = frameDepth[i];
+            stat.calls = frameCalls[i];
+            stat.frameTime = (float)(frameTime[i] * 1e-6);
+            stat.totalTime += stat.frameTime;
+            stat.frameCount++;
+            stat.avgTime = (float)(stat.totalTime / stat.frameCount);
+            stat.minTime = C3D_Min(stat.minTime, stat.frameTime);
+            stat.maxTime = C3D_Max(stat.maxTime, stat.frameTime);
         }
-#endif
+
+        C3DStat::getInstance()->setProfileStats(_stats, _markerCount);
+
+        // switching at the frame boundary, the frame stats cover whole frames. The scopes open
+        // across the switch still end the way they began
+        _enabled = _pendingEnabled.load();
+    }
+
+    int C3DProfile::findMarker(const char* name) const
+    {
+        for (unsigned int i = 0; i < _markerCount; i++)
+        {
+            if (strcmp(_markerNames[i], name) == 0)
+                return (int)i;
+        }
+        return -1;
     }
 
-    void C3DProfile::removeAllProfile()
+    void C3DProfile::reset()
     {
-        for (std::map<std::string, ProfileItem*>::iterator it = _profileItems.begin(); it != _profileItems.end(); it++)
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        for (size_t i = 0; i < _threads.size(); i++)
         {
-            delete it->second;
+            C3DProfileThread* thread = _threads[i];
+            std::lock_guard<std::mutex> threadLock(thread->_mutex);
+            thread->_writeIndex = 0;
+            memset(thread->_frameTime, 0, sizeof(thread->_frameTime));
+            memset(thread->_frameCalls, 0, sizeof(thread->_frameCalls));
+        }
+
+        for (unsigned int i = 0; i < C3D_PROFILE_MAX_MARKERS; i++)
+        {
+            const char* name = _stats[i].name;
+            memset(&_stats[i], 0, sizeof(_stats[i]));
+            _stats[i].name = name;
+            _stats[i].minTime = FLT_MAX;
         }
-        _profileItems.clear();
+    }
+
+    static void writeJsonString(FILE* file, const char* str)
+    {
+        fputc('"', file);
+        for (; str && *str; str++)
+        {
+            if (*str == '"' || *str == '\\')
+                fputc('\\', file);
+            if ((unsigned char)*str >= 0x20)
+                fputc(*str, file);
+        }
+        fputc('"', file);
+    }
+
+    bool C3DProfile::exportChromeTrace(const std::string& fileName)
+    {
+        FILE* file = fopen(fileName.c_str(), "w");
+        if (file == NULL)
+        {
+            LOG_ERROR_VARG("Failed to open file: %s", fileName.c_str());
+            return false;
+        }
+
+        // the threads are only deleted with the profile, the list can be copied
+        std::vector<C3DProfileThread*> threads;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            threads = _threads;
+        }
+
+        std::vector<C3DProfileEvent> events;
+        fprintf(file, "{\"traceEvents\":[\n");
+        bool first = true;
+        for (size_t t = 0; t < threads.size(); t++)
+        {
+            C3DProfileThread* thread = threads[t];
+
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", first ? "" : ",\n", thread->_index, thread->_index);
+            first = false;
+
+            // copy the ring under the lock of the thread, so it is only held during the copy
+            {
+                std::lock_guard<std::mutex> threadLock(thread->_mutex);
+
+                unsigned int writeIndex = thread->_writeIndex;
+                unsigned int count = C3D_Min(writeIndex, (unsigned int)C3D_PROFILE_RING_SIZE);
+                events.resize(count);
+                for (unsigned int i = 0; i < count; i++)
+                {
+                    events[i] = thread->_events[(writeIndex - count + i) & (C3D_PROFILE_RING_SIZE - 1)];
+                }
+            }
+
+            // the ring keeps the last events, the oldest ones may close scopes opened before it
+            int depth = 0;
+            for (size_t i = 0; i < events.size(); i++)
+            {
+                const C3DProfileEvent& event = events[i];
+                if (event.type == ProfileEvent_End)
+                {
+                    if (depth == 0)
+                        continue;
+                    depth--;
+                }
+                else
+                {
+                    depth++;
+                }
+
+                fprintf(file, ",\n{\"name\":");
+                writeJsonString(file, _markerNames[event.marker]);
+                fprintf(file, ",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}",
+                    event.type == ProfileEvent_Begin ? "B" : "E",
+                    (double)(event.time - _startTime) * 0.001, thread->_index);
+            }
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+
+        return true;
     }
 
 ////////////////////////////////Implement of C3DProfileDisplay//////////////////////////////////////////
@@ -137,17 +421,19 @@ void C3DProfileDisplay::update()
     if (_label == NULL)
         return;
 
-    std::map<std::string, C3DProfile::ProfileItem*>& items = C3DProfile::getInstance()->_profileItems;
-    std::map<std::string, C3DProfile::ProfileItem*>::iterator it = items.begin();
+    C3DProfile* profile = C3DProfile::getInstance();
     char str[128];
     std::string strlabel;
-    for (; it != items.end(); it++)
+    for (unsigned int i = 0; i < profile->getMarkerCount(); i++)
     {
-        C3DProfile::ProfileItem*& item = it->second;
-        sprintf(str, "%10s, frame time: %5d, average frame time: %5d, min: %5d, max: %5d\n", item->_name.c_str(), item->_durTime, item->_avgTime, item->minTime, item->maxTime);
+        const C3DProfileMarkerStat& stat = profile->getMarkerStat(i);
+        if (stat.frameCount == 0)
+            continue;
+
+        snprintf(str, sizeof(str), "%*s%-20s frame time: %6.2f, average frame time: %6.2f, min: %6.2f, max: %6.2f, calls: %u\n", stat.depth * 2, "", stat.name, stat.frameTime, stat.avgTime, stat.minTime, stat.maxTime, stat.calls);
         strlabel += str;
     }
     _label->setString(strlabel.c_str());
 #endif
 }
-}
\ No newline at end of file
+}
@@ -20,51 +20,73 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 
+
 #ifndef C3DPROFILE_H_
 #define C3DPROFILE_H_
 #include <limits.h>
+#include <vector>
+#include <mutex>
+#include <atomic>
 #include "cocos3d.h"
 
 #include "cocos2d.h"
 
+#define C3D_PROFILE_MAX_MARKERS     256     // markers of the whole application
+#define C3D_PROFILE_MAX_DEPTH       64      // nesting depth of the markers
+#define C3D_PROFILE_RING_SIZE       16384   // events kept per thread, power of two
+
 namespace cocos3d
 {
+    class C3DProfileThread;
+
     /**
-     *  class for performance profile
-	 *
+     *  named profile marker.
+     *  Markers are static objects created by PROFILE_SCOPE, they get their id once
+     *  so begin & end never look up names.
+     */
+    class C3DProfileMarker
+    {
+    public:
+        C3DProfileMarker(const char* name);
+
+        const char* getName() const { return _name; }
+        unsigned short getId() const { return _id; }
+
+    private:
+        const char* _name;
+        unsigned short _id;
+    };
+
+    /**
+     *  frame statistics of a marker, summed over all the threads at C3DProfile::update()
+     *  times are in milliseconds
+     */
+    struct C3DProfileMarkerStat
+    {
+        const char* name;
+        unsigned int depth; // lowest nesting depth of the marker in the last frame
+        unsigned int calls; // calls during the last frame
+        float frameTime; // time during the last frame
+        float avgTime; // average time of the frames the marker was hit
+        float minTime;
+        float maxTime;
+        unsigned int frameCount; // frames the marker was hit
+        double totalTime;
+    };
+
+    /**
+     *  hierarchical profiler.
+     *  Every thread records begin & end events in its own ring buffer, allocated the first
+     *  time the thread hits a marker, so the markers never allocate and only take the lock
+     *  of their thread, contended while update(), reset() or the export read the buffer.
+     *  update() sums the frame time of every marker over the threads, the frame stats are
+     *  given to C3DStat. The recorded events can be exported to the chrome trace format
+     *  (chrome://tracing).
      */
     class C3DProfile
     {
         friend class C3DProfileDisplay;
-
-        struct ProfileItem
-        {
-            std::string _name;
-            int _accTime; // accumulate time during frame
-            int _durTime; //time current frame
-            int _avgTime; // average time
-            int _startTime;
-
-            int minTime;
-            int maxTime;
-            int totalTime; // total time
-            int numberOfCalls;
-            ProfileItem():_name("")
-            {
-                reset();
-            }
-            void reset()
-            {
-                _startTime = 0;
-                _accTime = 0;
-                _durTime = 0;
-                minTime = INT_MAX;
-                maxTime = 0;
-                totalTime = 0;
-                _avgTime = 0;
-                numberOfCalls = 0;
-            }
-        };
+        friend class C3DProfileMarker;
     public:
 	/**
      * Destructor
@@ -77,22 +99,91 @@ namespace cocos3d
         static C3DProfile* getInstance();
 
 		/**
-         * begin & end profile
+         * begin & end profile, called by C3DProfileScope
          */
-        void beginProfile(const std::string& itemname);
-        void endProfile(const std::string& itemname);
+        void begin(const C3DProfileMarker& marker);
+        void end(const C3DProfileMarker& marker);
 
-        void removeAllProfile();
+		/**
+         * get & set profile enable, the change is applied at next update()
+         */
+        void setEnabled(bool enabled) { _pendingEnabled = enabled; }
+        bool isEnabled() const { return _enabled; }
 
+		/**
+         * end of frame, computes the frame stats of the markers
+         */
         void update();
 
+		/**
+         * clear the recorded events and the stats
+         */
+        void reset();
+
+		/**
+         * write the recorded events as chrome trace json
+         */
+        bool exportChromeTrace(const std::string& fileName);
+
+		/**
+         * get markers stats
+         */
+        unsigned int getMarkerCount() const { return _markerCount; }
+        const C3DProfileMarkerStat& getMarkerStat(unsigned int id) const { return _stats[id]; }
+
+		/**
+         * get the id of the marker named name, -1 if it was never hit
+         */
+        int findMarker(const char* name) const;
+
+		/**
+         * current time in nanoseconds
+         */
+        static unsigned long long getTime();
+
     protected:
 		/**
          * Constructor
          */
         C3DProfile();
 
-		std::map<std::string, ProfileItem*> _profileItems;
+        unsigned short registerMarker(const char* name);
+
+        // get the buffer of the calling thread, created on first use
+        C3DProfileThread* getThread();
+        C3DProfileThread* createThread();
+
+        // read by the markers of every thread
+        std::atomic<bool> _enabled;
+        std::atomic<bool> _pendingEnabled;
+
+        const char* _markerNames[C3D_PROFILE_MAX_MARKERS];
+        unsigned int _markerCount;
+        C3DProfileMarkerStat _stats[C3D_PROFILE_MAX_MARKERS];
+
+        std::vector<C3DProfileThread*> _threads;
+        std::mutex _mutex; // guards markers & threads registration
+
+        unsigned long long _startTime;
+    };
+
+    /**
+     *  profiles the enclosing scope
+     */
+    class C3DProfileScope
+    {
+    public:
+        C3DProfileScope(const C3DProfileMarker& marker) : _marker(marker)
+        {
+            C3DProfile::getInstance()->begin(_marker);
+        }
+        ~C3DProfileScope()
+        {
+            C3DProfile::getInstance()->end(_marker);
+        }
+
+    private:
+        const C3DProfileMarker& _marker;
     };
 
     /**
@@ -124,15 +215,19 @@ namespace cocos3d
 }
 
 #ifdef ENABLE_C3D_PROFILE
-#define BEGIN_PROFILE(name) C3DProfile::getInstance()->beginProfile(name)
-#define END_PROFILE(name) C3DProfile::getInstance()->endProfile(name)
+#define C3D_PROFILE_CONCAT_(a, b) a##b
+#define C3D_PROFILE_CONCAT(a, b) C3D_PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) \
+    static cocos3d::C3DProfileMarker C3D_PROFILE_CONCAT(c3dProfileMarker, __LINE__)(name); \
+    cocos3d::C3DProfileScope C3D_PROFILE_CONCAT(c3dProfileScope, __LINE__)(C3D_PROFILE_CONCAT(c3dProfileMarker, __LINE__))
 #define PROFILE_UPDATE() C3DProfile::getInstance()->update()
+#define PROFILE_EXPORT(fileName) C3DProfile::getInstance()->exportChromeTrace(fileName)
 #define SET_PROFILE_DISPLAY(label) C3DProfileDisplay::getInstance()->setLabelBMPFont(label)
 #define PROFILE_DISPLAY_UPDATE() C3DProfileDisplay::getInstance()->update()
 #else
-#define BEGIN_PROFILE(name)
-#define END_PROFILE(name)
+#define PROFILE_SCOPE(name)
 #define PROFILE_UPDATE()
+#define PROFILE_EXPORT(fileName)
 #define SET_PROFILE_DISPLAY(label)
 #define PROFILE_DISPLAY_UPDATE()
 #endif
@@ -22,6 +22,7 @@ THE SOFTWARE.
 
 #include "Base.h"
 #include "C3DQuaternion.h"
+#include "C3DMathSIMD.h"
 
 namespace cocos3d
 {
@@ -287,7 +288,7 @@ void C3DQuaternion::lerp(const C3DQuaternion& q1, const C3DQuaternion& q2, float
 
 void C3DQuaternion::slerp(const C3DQuaternion& q1, const C3DQuaternion& q2, float t, C3DQuaternion* dst)
 {
-    slerp(q1.x, q1.y, q1.z, q1.w, q2.x, q2.y, q2.z, q2.w, t, &dst->x, &dst->y, &dst->z, &dst->w);
+    C3DMathSIMD::getInstance().slerpQuaternion(&q1.x, &q2.x, t, &dst->x);
 }
 
 void C3DQuaternion::squad(const C3DQuaternion& q1, const C3DQuaternion& q2, const C3DQuaternion& s1, const C3DQuaternion& s2, float t, C3DQuaternion* dst)
@@ -338,51 +339,9 @@ void C3DQuaternion::slerp(float q1x, float q1y, float q1z, float q1w, float q2x,
         return;
     }
 
-    float halfY, alpha, beta;
-    float u, f1, f2a, f2b;
-    float ratio1, ratio2;
-    float halfSecHalfTheta, versHalfTheta;
-    float sqNotU, sqU;
-
+    float alpha, beta;
     float cosTheta = q1w * q2w + q1x * q2x + q1y * q2y + q1z * q2z;
-
-    // As usual in all slerp implementations, we fold theta.
-    alpha = cosTheta >= 0 ? 1.0f : -1.0f;
-    halfY = 1.0f + alpha * cosTheta;
-
-    // Here we bisect the interval, so we need to fold t as well.
-    f2b = t - 0.5f;
-    u = f2b >= 0 ? f2b : -f2b;
-    f2a = u - f2b;
-    f2b += u;
-    u += u;
-    f1 = 1.0f - u;
-
-    // One iteration of Newton to get 1-cos(theta / 2) to good accuracy.
-    halfSecHalfTheta = 1.09f - (0.476537f - 0.0903321f * halfY) * halfY;
-    halfSecHalfTheta *= 1.5f - halfY * halfSecHalfTheta * halfSecHalfTheta;
-    versHalfTheta = 1.0f - halfY * halfSecHalfTheta;
-
-    // Evaluate series expansions of the coefficients.
-    sqNotU = f1 * f1;
-    ratio2 = 0.0000440917108f * versHalfTheta;
-    ratio1 = -0.00158730159f + (sqNotU - 16.0f) * ratio2;
-    ratio1 = 0.0333333333f + ratio1 * (sqNotU - 9.0f) * versHalfTheta;
-    ratio1 = -0.333333333f + ratio1 * (sqNotU - 4.0f) * versHalfTheta;
-    ratio1 = 1.0f + ratio1 * (sqNotU - 1.0f) * versHalfTheta;
-
-    sqU = u * u;
-    ratio2 = -0.00158730159f + (sqU - 16.0f) * ratio2;
-    ratio2 = 0.0333333333f + ratio2 * (sqU - 9.0f) * versHalfTheta;
-    ratio2 = -0.333333333f + ratio2 * (sqU - 4.0f) * versHalfTheta;
-    ratio2 = 1.0f + ratio2 * (sqU - 1.0f) * versHalfTheta;
-
-    // Perform the bisection and resolve the folding done earlier.
-    f1 *= ratio1 * halfSecHalfTheta;
-    f2a *= ratio2;
-    f2b *= ratio2;
-    alpha *= f1 + f2a;
-    beta = f1 + f2b;
+    C3DMathSIMD::computeSlerpWeights(cosTheta, t, &alpha, &beta);
 
     // Apply final coefficients to a and b as usual.
     float w = alpha * q1w + beta * q2w;
@@ -395,7 +354,7 @@ void C3DQuaternion::slerp(float q1x, float q1y, float q1z, float q1w, float q2x,
     // can see, it comes at the cost of 9 additional multiplication
     // operations. If this error-correcting feature is not required,
     // the following code may be removed.
-    f1 = 1.5f - 0.5f * (w * w + x * x + y * y + z * z);
+    float f1 = 1.5f - 0.5f * (w * w + x * x + y * y + z * z);
     *dstw = w * f1;
     *dstx = x * f1;
     *dsty = y * f1;
@@ -61,6 +61,7 @@ class C3DMatrix;
 class  C3DQuaternion
 {
     friend class C3DAnimationCurve;
+    friend class C3DMathSIMD;
 
 public:
 
@@ -24,6 +24,7 @@ THE SOFTWARE.
 #include "C3DRenderBlock.h"
 
 #include "C3DElementNode.h"
+#include "C3DStateCache.h"
 
 // Render state override bits
 #define RS_BLEND 1
@@ -81,31 +82,31 @@ void C3DStateBlock::bindNoRestore()
     // Update any state that differs from _defaultState and flip _defaultState bits
     if ((_bits & RS_BLEND) &&  !(_defaultState->_bits & RS_BLEND))
     {
-        glEnable(GL_BLEND);
+        C3DStateCache::setEnabled(GL_BLEND, true);
 	    _defaultState->_bits |= RS_BLEND;
         _defaultState->_blendEnabled = _blendEnabled;
     }
     if ((_bits & RS_BLEND_FUNC) && (_srcBlend != _defaultState->_srcBlend || _dstBlend != _defaultState->_dstBlend))
     {
-        glBlendFunc((GLenum)_srcBlend, (GLenum)_dstBlend);
+        C3DStateCache::blendFunc((GLenum)_srcBlend, (GLenum)_dstBlend);
         _defaultState->_srcBlend = _srcBlend;
         _defaultState->_dstBlend = _dstBlend;
     }
     if ((_bits & RS_CULL_FACE) && !(_defaultState->_bits & RS_CULL_FACE))
     {
-        glEnable(GL_CULL_FACE);
+        C3DStateCache::setEnabled(GL_CULL_FACE, true);
 		_defaultState->_bits |= RS_CULL_FACE;
         _defaultState->_cullFaceEnabled = _cullFaceEnabled;
     }
     if ((_bits & RS_DEPTH_TEST) && !(_defaultState->_bits & RS_DEPTH_TEST))
     {
-        glEnable(GL_DEPTH_TEST);
+        C3DStateCache::setEnabled(GL_DEPTH_TEST, true);
 		_defaultState->_bits |= RS_DEPTH_TEST;
         _defaultState->_depthTestEnabled = _depthTestEnabled;
     }
     if ((_bits & RS_DEPTH_WRITE) && !(_defaultState->_bits & RS_DEPTH_WRITE))
     {
-        glDepthMask(GL_TRUE);
+        C3DStateCache::depthMask(true);
 		_defaultState->_bits |= RS_DEPTH_WRITE;
         _defaultState->_depthWriteEnabled = _depthWriteEnabled;
     }
@@ -124,32 +125,32 @@ void C3DStateBlock::restore(long stateOverrideBits)
     // Restore any state that is not overridden and is not default
     if (!(stateOverrideBits & RS_BLEND) && (_defaultState->_bits & RS_BLEND))
     {
-        glDisable(GL_BLEND);
+        C3DStateCache::setEnabled(GL_BLEND, false);
         _defaultState->_bits &= ~RS_BLEND;
         _defaultState->_blendEnabled = false;
     }
     if (!(stateOverrideBits & RS_BLEND_FUNC) && (_defaultState->_bits & RS_BLEND_FUNC))
     {
-        glBlendFunc(GL_ONE, GL_ONE);
+        C3DStateCache::blendFunc(GL_ONE, GL_ONE);
         _defaultState->_bits &= ~RS_BLEND_FUNC;
         _defaultState->_srcBlend = C3DStateBlock::BLEND_ONE;
         _defaultState->_dstBlend = C3DStateBlock::BLEND_ONE;
     }
     if (!(stateOverrideBits & RS_CULL_FACE) && (_defaultState->_bits & RS_CULL_FACE))
     {
-        glDisable(GL_CULL_FACE);
+        C3DStateCache::setEnabled(GL_CULL_FACE, false);
         _defaultState->_bits &= ~RS_CULL_FACE;
         _defaultState->_cullFaceEnabled = false;
     }
     if (!(stateOverrideBits & RS_DEPTH_TEST) && (_defaultState->_bits & RS_DEPTH_TEST))
     {
-        glDisable(GL_DEPTH_TEST);
+        C3DStateCache::setEnabled(GL_DEPTH_TEST, false);
         _defaultState->_bits &= ~RS_DEPTH_TEST;
         _defaultState->_depthTestEnabled = false;
     }
     if (!(stateOverrideBits & RS_DEPTH_WRITE) && (_defaultState->_bits & RS_DEPTH_WRITE))
     {
-        glDepthMask(GL_FALSE);
+        C3DStateCache::depthMask(false);
         _defaultState->_bits &= ~RS_DEPTH_WRITE;
         _defaultState->_depthWriteEnabled = false;
     }
@@ -162,7 +163,7 @@ void C3DStateBlock::enableDepthWrite()
     // next frame leaves depth writing disabled.
     if (!_defaultState->_depthWriteEnabled)
     {
-        glDepthMask(GL_TRUE);
+        C3DStateCache::depthMask(true);
         _defaultState->_bits &= ~RS_DEPTH_WRITE;
         _defaultState->_depthWriteEnabled = true;
     }
@@ -313,60 +314,63 @@ void C3DStateBlock::restoreGLState(bool bforce)
 {
     if (bforce)
     {
+        // forget what the cache knows so that every state is really sent to GL
+        C3DStateCache::invalidate();
+
         if (_blendEnabled)
-            glEnable(GL_BLEND);
+            C3DStateCache::setEnabled(GL_BLEND, true);
         else
-            glDisable(GL_BLEND);
+            C3DStateCache::setEnabled(GL_BLEND, false);
         if (_cullFaceEnabled)
-            glEnable(GL_CULL_FACE);
+            C3DStateCache::setEnabled(GL_CULL_FACE, true);
         else
-            glDisable(GL_CULL_FACE);
+            C3DStateCache::setEnabled(GL_CULL_FACE, false);
         if (_depthTestEnabled)
-            glEnable(GL_DEPTH_TEST);
+            C3DStateCache::setEnabled(GL_DEPTH_TEST, true);
         else
-            glDisable(GL_DEPTH_TEST);
+            C3DStateCache::setEnabled(GL_DEPTH_TEST, false);
 
         if (_depthWriteEnabled)
-            glDepthMask(GL_TRUE);
+            C3DStateCache::depthMask(true);
         else
-            glDepthMask(GL_FALSE);
+            C3DStateCache::depthMask(false);
 
-        glBlendFunc(_srcBlend, _dstBlend);
+        C3DStateCache::blendFunc(_srcBlend, _dstBlend);
     }
     else
     {
         if (_blendEnabled != _defaultState->_blendEnabled )
         {
             if (_blendEnabled)
-                glEnable(GL_BLEND);
+                C3DStateCache::setEnabled(GL_BLEND, true);
             else
-                glDisable(GL_BLEND);
+                C3DStateCache::setEnabled(GL_BLEND, false);
         }
         if (_cullFaceEnabled != _defaultState->_cullFaceEnabled)
         {
             if (_cullFaceEnabled)
-                glEnable(GL_CULL_FACE);
+                C3DStateCache::setEnabled(GL_CULL_FACE, true);
             else
-                glDisable(GL_CULL_FACE);
+                C3DStateCache::setEnabled(GL_CULL_FACE, false);
         }
         if (_depthTestEnabled != _defaultState->_depthTestEnabled)
         {
             if (_depthTestEnabled)
-                glEnable(GL_DEPTH_TEST);
+                C3DStateCache::setEnabled(GL_DEPTH_TEST, true);
             else
-                glDisable(GL_DEPTH_TEST);
+                C3DStateCache::setEnabled(GL_DEPTH_TEST, false);
         }
 
         if (_depthWriteEnabled != _defaultState->_depthWriteEnabled)
         {
             if (_depthWriteEnabled)
-                glDepthMask(GL_TRUE);
+                C3DStateCache::depthMask(true);
             else
-                glDepthMask(GL_FALSE);
+                C3DStateCache::depthMask(false);
         }
         if (_srcBlend != _defaultState->_srcBlend || _dstBlend != _defaultState->_dstBlend)
         {
-            glBlendFunc(_srcBlend, _dstBlend);
+            C3DStateCache::blendFunc(_srcBlend, _dstBlend);
         }
     }
 
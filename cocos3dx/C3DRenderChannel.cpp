@@ -36,21 +36,76 @@ THE SOFTWARE.
 
 namespace cocos3d
 {
-bool greater( const BaseChannelDrawItem* a, const BaseChannelDrawItem* b )
+// quantize a distance to the top 25 bits of its float representation,
+// the bit pattern of a positive float grows with its value
+static unsigned int quantizeDepth( float depth )
 {
-	return a->getSortParam() > b->getSortParam();
-}
-bool less(const BaseChannelDrawItem* a, const BaseChannelDrawItem* b)
-{
-	return a->getSortParam() < b->getSortParam();
+	if ( !(depth > 0.0f) )
+		return 0;
+
+	union { float f; unsigned int u; } bits;
+	bits.f = depth;
+	return bits.u >> 6;
 }
 
-void ModelDrawItem::draw()
+static const unsigned int DEPTH_BITS = 25;
+static const unsigned int DEPTH_MASK = (1u << DEPTH_BITS) - 1;
+static const unsigned int ID_BITS = 12;
+static const unsigned int ID_MASK = (1u << ID_BITS) - 1;
+
+// stable LSD radix sort on the keys, 8 bits per pass. All the histograms are built
+// in one pass over the items, and the passes whose byte is the same for every key are skipped.
+static void radixSort( C3DRenderChannel::ChannelDrawItems& items, C3DRenderChannel::ChannelDrawItems& buffer )
 {
-	_model->draw();
-}
+	size_t count = items.size();
+	if ( count < 2 )
+		return;
+
+	unsigned int histograms[8][256];
+	memset( histograms, 0, sizeof(histograms) );
 
-C3DRenderChannel::ChannelDrawItems C3DRenderChannel::ItemPool;
+	for ( size_t i = 0; i < count; ++i )
+	{
+		unsigned long long key = items[i].key;
+		for ( int pass = 0; pass < 8; ++pass )
+		{
+			histograms[pass][(key >> (pass * 8)) & 0xff]++;
+		}
+	}
+
+	buffer.resize( count );
+	C3DRenderChannel::DrawItem* src = &items[0];
+	C3DRenderChannel::DrawItem* dst = &buffer[0];
+
+	for ( int pass = 0; pass < 8; ++pass )
+	{
+		unsigned int* histogram = histograms[pass];
+		if ( histogram[(src[0].key >> (pass * 8)) & 0xff] == count )
+			continue;
+
+		unsigned int offset = 0;
+		for ( int i = 0; i < 256; ++i )
+		{
+			unsigned int n = histogram[i];
+			histogram[i] = offset;
+			offset += n;
+		}
+
+		for ( size_t i = 0; i < count; ++i )
+		{
+			dst[histogram[(src[i].key >> (pass * 8)) & 0xff]++] = src[i];
+		}
+
+		C3DRenderChannel::DrawItem* tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if ( src != &items[0] )
+	{
+		items.swap( buffer );
+	}
+}
 
 C3DRenderChannel::~C3DRenderChannel()
 {
@@ -59,100 +114,109 @@ C3DRenderChannel::~C3DRenderChannel()
 
 void C3DRenderChannel::resetChannelSize()
 {
-	for ( ChannelDrawItems::iterator ite = ItemPool.begin(); ite != ItemPool.end(); ++ite )
+	ChannelDrawItems().swap( _drawItems );
+	ChannelDrawItems().swap( _sortBuffer );
+	std::vector<C3DBaseModel*>().swap( _instanceGroup );
+}
+
+unsigned long long C3DRenderChannel::makeSortKey( float depth, unsigned int effectId, unsigned int materialId, unsigned int vaoId ) const
+{
+	unsigned long long key = (unsigned long long)(_channelIndex & 0x3) << 62;
+
+	unsigned long long state = ((unsigned long long)(effectId & ID_MASK) << (ID_BITS * 2))
+		| ((unsigned long long)(materialId & ID_MASK) << ID_BITS)
+		| (vaoId & ID_MASK);
+
+	if ( _sortType == ST_Greater )
+	{
+		// translucent, back to front first
+		unsigned long long farFirst = DEPTH_MASK - quantizeDepth( depth );
+		key |= 1ULL << 61;
+		key |= farFirst << (ID_BITS * 3);
+		key |= state;
+	}
+	else
 	{
-		SAFE_DELETE( (*ite) );
+		key |= state << DEPTH_BITS;
+		key |= quantizeDepth( depth );
 	}
-	ItemPool.clear();
+
+	return key;
 }
 
-void C3DRenderChannel::addItem( C3DBaseModel* model, float sortParamFlo, const std::string& sortParamStr )
+void C3DRenderChannel::addItem( C3DBaseModel* model, float depth, unsigned int effectId, unsigned int materialId, unsigned int vaoId )
 {
 	if ( model == NULL )
 	{
 		LOG_ERROR( "C3DRenderChannel::addItem C3DModel* is NULL" );
 		return;
 	}
-	static ModelDrawItem* item(NULL);
-	if ( ItemPool.empty() )
-	{
-		item = new ModelDrawItem( model, sortParamFlo );
-	}
-	else
-	{
-		item = (ModelDrawItem*)(*ItemPool.begin());
-		ItemPool.pop_front();
-		item->setModel( model );
-		item->setSortParam( sortParamFlo );
-	}
 
-	_drawItems[sortParamStr].push_back( item );
+	DrawItem item;
+	item.key = makeSortKey( depth, effectId, materialId, vaoId );
+	item.model = model;
+	_drawItems.push_back( item );
 }
 
 void C3DRenderChannel::preDraw(void)
 {
-	switch ( _sortType )
+	if ( _sortType != ST_None )
 	{
-	case ST_Greater:
-		{
-			compare = greater;
-		}break;
-	case  ST_Less:
-		{
-			compare = less;
-		}break;
-	case ST_None:
-		{
-			compare = NULL;
-		}break;
+		radixSort( _drawItems, _sortBuffer );
 	}
+}
 
-	if ( compare != NULL )
+void C3DRenderChannel::draw(void)
+{
+	size_t count = _drawItems.size();
+	if ( _sortType == ST_Greater )
 	{
-		std::map<std::string, ChannelDrawItems>::iterator iter_map = _drawItems.begin();
-		for (;iter_map != _drawItems.end(); iter_map++)
+		for ( size_t i = 0; i < count; ++i )
 		{
-			iter_map->second.sort( compare );
+			_drawItems[i].model->draw();
 		}
+		return;
 	}
-}
 
-void C3DRenderChannel::draw(void)
-{
-	std::map<std::string, ChannelDrawItems>::iterator iter_map = _drawItems.begin();
-	for (;iter_map != _drawItems.end(); iter_map++)
+	// the sort keys put the items sharing program, material and vertex buffer next to each other
+	size_t i = 0;
+	while ( i < count )
 	{
-		ChannelDrawItems::iterator iter = iter_map->second.begin();
-		for (;iter != iter_map->second.end(); ++iter)
+		C3DBaseModel* model = _drawItems[i].model;
+
+		size_t end = i + 1;
+		while ( end < count && model->canInstanceWith( _drawItems[end].model ) )
+		{
+			++end;
+		}
+
+		if ( end - i > 1 )
 		{
-			(*iter)->draw();
+			_instanceGroup.clear();
+			for ( size_t j = i; j < end; ++j )
+			{
+				_instanceGroup.push_back( _drawItems[j].model );
+			}
+			model->drawInstances( &_instanceGroup[0], (unsigned int)_instanceGroup.size() );
 		}
+		else
+		{
+			model->draw();
+		}
+
+		i = end;
 	}
 }
 
 void C3DRenderChannel::postDraw(void)
 {
-	std::map<std::string, ChannelDrawItems>::iterator iter_map = _drawItems.begin();
-	for (;iter_map != _drawItems.end(); iter_map++)
-	{
-		for ( ChannelDrawItems::iterator ite = iter_map->second.begin(); ite != iter_map->second.end(); ++ite )
-		{
-			(*ite)->clear();
-		}
-		ItemPool.insert( ItemPool.end(), iter_map->second.begin(), iter_map->second.end() );
-	}
+	// keep the capacity for the next frame
 	_drawItems.clear();
 }
 
 int C3DRenderChannel::itemCount(void)
 {
-	int count = 0;
-	std::map<std::string, ChannelDrawItems>::iterator iter_map = _drawItems.begin();
-	for (;iter_map != _drawItems.end(); iter_map++)
-	{
-		count += iter_map->second.size();
-	}
-	return count;
+	return (int)_drawItems.size();
 }
 
 ///////////////////////////////////////////////////////////////////////////////////
@@ -179,6 +243,10 @@ RenderChannelManager* RenderChannelManager::getInstance()
 RenderChannelManager::RenderChannelManager()
 	: _frameBuffer( NULL )
 {
+	for ( unsigned int i = 0; i < CN_Count; ++i )
+	{
+		_channels[i].setIndex( i );
+	}
 	_channels[CN_Background].setSortType( C3DRenderChannel::ST_Less );
 	_channels[CN_Background].setName( ChannelBackground );
 	_channels[CN_Opacity].setSortType( C3DRenderChannel::ST_Less );
@@ -34,90 +34,24 @@ namespace cocos3d
 class C3DTexture;
 class C3DFrameBuffer;
 
-class BaseChannelDrawItem;
 class C3DScene;
-
-class BaseChannelDrawItem
-{
-public:
-	BaseChannelDrawItem( float sortParam )
-		: _sortParam( sortParam )
-	{
-	}
-
-	virtual ~BaseChannelDrawItem()
-	{
-	}
-
-	// ͳһýӿ
-	virtual void draw() = 0;
-	virtual inline void clear()
-	{
-		_sortParam = 0.0f;
-	}
-public:
-
-	virtual float getSortParam(void) const
-	{
-		return _sortParam;
-	}
-
-	inline void setSortParam( float f )
-	{
-		_sortParam = f;
-	}
-
-protected:
-	float _sortParam;
-};
-
 class C3DBaseModel;
 
-class ModelDrawItem : public BaseChannelDrawItem
-{
-public:
-	typedef std::vector<ModelDrawItem*> ModelItems;
-
-public:
-	ModelDrawItem( C3DBaseModel* model, float sortParam )
-		: BaseChannelDrawItem( sortParam )
-		, _model( model )
-	{
-	}
-
-	virtual ~ModelDrawItem()
-	{
-	}
-
-protected:
-	virtual void draw();
-
-private:
-	C3DBaseModel* _model;
-
-public:
-	inline C3DBaseModel* getModel()
-	{
-		return _model;
-	}
-	inline void setModel( C3DBaseModel* model )
-	{
-		_model = model;
-	}
-	virtual inline void clear()
-	{
-		BaseChannelDrawItem::clear();
-		_model = NULL;
-	}
-};
-
-class C3DBatchModel;
-
 /**
  * This class is the base class and the manager for the visual channels. A
  * channel is essentially a bucket of objects with similar rendering rules.
  * The channels are traversed fixed global order, and within each channel items
  * are drawn, possibly in a sorted order.
+ *
+ * Every item carries a packed 64 bit sort key, the items of a frame are kept in
+ * a flat array and ordered by a radix sort on the keys. Key layout, from the
+ * most significant bit:
+ *
+ *  opaque      | channel:2 | 0:1 | effect:12 | material:12 | vao:12 | depth:25 |
+ *  translucent | channel:2 | 1:1 | ~depth:25 | effect:12 | material:12 | vao:12 |
+ *
+ * so opaque items are grouped by program, material and vertex array, then drawn
+ * front to back, while translucent items are drawn back to front.
  */
 class C3DRenderChannel
 {
@@ -129,8 +63,16 @@ public:
 		ST_Less,
 		ST_None,
 	};
-	typedef std::list<BaseChannelDrawItem*> ChannelDrawItems;
-	typedef std::map<std::string,ChannelDrawItems> ChannelDrawItemsMap;
+
+	/**
+	 * draw item, the model and its sort key
+	 */
+	struct DrawItem
+	{
+		unsigned long long key;
+		C3DBaseModel* model;
+	};
+	typedef std::vector<DrawItem> ChannelDrawItems;
 
 public:
 	/**
@@ -138,6 +80,7 @@ public:
 	 */
 	C3DRenderChannel()
 		: _channelName( "" )
+		, _channelIndex( 0 )
 		, _sortType( ST_None )
 		, _enable(true)
 	{
@@ -149,13 +92,21 @@ public:
 
 	/**
 	 * add draw item
+	 *
+	 * @param model The model to draw.
+	 * @param depth Distance to the camera.
+	 * @param effectId Program of the model, items with the same program are drawn together.
+	 * @param materialId Material of the model.
+	 * @param vaoId Vertex array or vertex buffer of the model.
 	 */
-	virtual void addItem( C3DBaseModel* model, float sortParamFlo, const std::string& sortParamStr = "" );
+	virtual void addItem( C3DBaseModel* model, float depth, unsigned int effectId = 0, unsigned int materialId = 0, unsigned int vaoId = 0 );
 
 	// Ⱦڴ˽
 	virtual void preDraw(void);
 	/**
-	 * draw routine
+	 * draw routine. Consecutive items whose models accept each other in
+	 * C3DBaseModel::canInstanceWith are drawn as one group, except in
+	 * the back to front sorted channels.
 	 */
 	virtual void draw(void);
 
@@ -178,6 +129,18 @@ public:
 		_channelName = name;
 	}
 
+	/**
+	 * index of the channel in the global draw order, stored in the high bits of the sort keys
+	 */
+	inline unsigned int getIndex() const
+	{
+		return _channelIndex;
+	}
+	inline void setIndex( unsigned int index )
+	{
+		_channelIndex = index;
+	}
+
 	int itemCount(void);
 
 	bool getEnable(void) const
@@ -185,19 +148,20 @@ public:
 		return _enable;
 	}
 
-protected:
-	// 򷽷
-	bool (*compare)( const BaseChannelDrawItem* a, const BaseChannelDrawItem* b );
+	/**
+	 * build the sort key of an item of this channel
+	 */
+	unsigned long long makeSortKey( float depth, unsigned int effectId, unsigned int materialId, unsigned int vaoId ) const;
+
 private:
-	SortType _sortType;
-	ChannelDrawItemsMap _drawItems;
-	unsigned int _drawItemAlloc;
 	std::string _channelName;
+	unsigned int _channelIndex;
+	SortType _sortType;
+	ChannelDrawItems _drawItems;
+	ChannelDrawItems _sortBuffer;
+	std::vector<C3DBaseModel*> _instanceGroup;
 
 	bool _enable;
-
-public:
-	static ChannelDrawItems ItemPool;
 };
 
 /**
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "C3DMaterial.h"
 #include "C3DRenderChannel.h"
 #include "C3DMesh.h"
+#include "C3DSubMesh.h"
 #include "C3DMeshSkin.h"
 #include "C3DSkinModel.h"
 #include "C3DBone.h"
@@ -110,9 +111,48 @@ void C3DRenderNode::reload()
 	bundle->release();
 }
 
+size_t C3DRenderNode::calculateGPUSize(void) const
+{
+	std::set<C3DMesh*> meshes;
+	for (std::vector<C3DNode*>::const_iterator iter = _children.begin(); iter!=_children.end(); ++iter)
+	{
+		C3DNode* node = *iter;
+
+		if(node->getType()!=C3DNode::NodeType_Model )
+			continue;
+
+		C3DModelNode* modelNode = static_cast<C3DModelNode*>(node);
+		for (unsigned int i = 0; i < modelNode->getModelCount(); i++)
+		{
+			C3DMesh* mesh = modelNode->getModel(i)->getMesh();
+			if (mesh)
+				meshes.insert(mesh);
+		}
+	}
+
+	size_t size = 0;
+	for (std::set<C3DMesh*>::const_iterator iter = meshes.begin(); iter != meshes.end(); ++iter)
+	{
+		C3DMesh* mesh = *iter;
+		size += mesh->getVertexCount() * mesh->getVertexSize();
+
+		for (unsigned int i = 0; i < mesh->getSubMeshCount(); i++)
+		{
+			C3DSubMesh* subMesh = mesh->getSubMesh(i);
+			unsigned int indexSize = subMesh->getIndexFormat() == IndexFormat_INDEX8 ? 1 : (subMesh->getIndexFormat() == IndexFormat_INDEX16 ? 2 : 4);
+			size += subMesh->getIndexCount() * indexSize;
+		}
+	}
+	return size;
+}
+
 void C3DRenderNode::draw()
 {
-    if(!isActive() || !isVisible())
+    if(!isActive())
+        return;
+
+    // shadow casters out of the view of the camera still draw into the shadow map
+    if(!isVisible() && !_scene->isInShadowPass())
         return;
 
 	for(std::vector<C3DNode*>::const_iterator iter=_children.begin(); iter!=_children.end(); ++iter)
@@ -140,8 +180,7 @@ void C3DRenderNode::update(long elapsedTime)
     if(!isActive())
         return;
     
-	getAABB();
-	_visible = _scene->getActiveCamera()->isVisible(*_bb);
+	updateVisibility();
 
     if (!isVisible())
         return;
@@ -329,7 +368,9 @@ void C3DRenderNode::setMaterial(const std::string& matName)
 
         if(node->getType()!=C3DNode::NodeType_Model )
             continue;
-        static_cast<C3DModelNode*>(node)->getModel()->setMaterial(matName.c_str());
+        C3DModelNode* modelNode = static_cast<C3DModelNode*>(node);
+        for (unsigned int i = 0; i < modelNode->getModelCount(); i++)
+            modelNode->getModel(i)->setMaterial(matName.c_str());
     }
 }
 
@@ -343,7 +384,9 @@ void C3DRenderNode::setMaterial(C3DMaterial* material)
 		{
 			continue;
 		}
-		static_cast<C3DModelNode*>(node)->getModel()->setMaterial( material );
+		C3DModelNode* modelNode = static_cast<C3DModelNode*>(node);
+		for (unsigned int i = 0; i < modelNode->getModelCount(); i++)
+			modelNode->getModel(i)->setMaterial( material );
 	}
 }
 
@@ -355,7 +398,9 @@ void C3DRenderNode::setDefaultMaterial(const std::string& path)
 
         if(node->getType()!=C3DNode::NodeType_Model )
             continue;
-        static_cast<C3DModelNode*>(node)->getModel()->setDefaultMaterial(path);
+        C3DModelNode* modelNode = static_cast<C3DModelNode*>(node);
+        for (unsigned int i = 0; i < modelNode->getModelCount(); i++)
+            modelNode->getModel(i)->setDefaultMaterial(path);
     }
 }
 
@@ -379,7 +424,9 @@ void C3DRenderNode::removeMaterial(const std::string& matName)
 
 		if(node->getType()!=C3DNode::NodeType_Model )
 			continue;
-		static_cast<C3DModelNode*>(node)->getModel()->removeMaterial();
+		C3DModelNode* modelNode = static_cast<C3DModelNode*>(node);
+		for (unsigned int i = 0; i < modelNode->getModelCount(); i++)
+			modelNode->getModel(i)->removeMaterial();
 	}
 }
 
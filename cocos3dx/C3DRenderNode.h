@@ -73,6 +73,11 @@ public:
 	virtual bool load(C3DResourceLoader* loader, bool isLoadAll = false){ return false; };
 	virtual void reload();
 
+	/**
+    * the vertex and index buffers of the meshes.
+    */
+	virtual size_t calculateGPUSize(void) const;
+
 	/**
     * Render for handling rendering routines.
     */
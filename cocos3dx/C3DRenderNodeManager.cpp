@@ -55,11 +55,17 @@ C3DRenderNodeManager* C3DRenderNodeManager::getInstance()
 C3DResource* C3DRenderNodeManager::createResource(const std::string& name)
 {
 	C3DResourceLoader* loader = C3DResourceLoader::create(name);
-	loader->autorelease();
 
 	if (loader == NULL)
 		return NULL;
 
+	loader->autorelease();
+
+	return createResource(name, loader);
+}
+
+C3DResource* C3DRenderNodeManager::createResource(const std::string& name, C3DResourceLoader* loader)
+{
 	C3DRenderNode* renderNode = NULL;
 	if(loader->_isSkin == true)
 	{
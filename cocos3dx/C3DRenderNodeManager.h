@@ -30,6 +30,7 @@ namespace cocos3d
 {
 class C3DElementNode;
 class C3DEffect;
+class C3DResourceLoader;
 
 /**
  *A materialManager manager material's loadpreload, and so on.
@@ -42,6 +43,11 @@ public:
 
 	virtual C3DResource* createResource(const std::string& name);
 
+	/**
+	 * Creates the render node name from an already opened bundle.
+	 */
+	C3DResource* createResource(const std::string& name, C3DResourceLoader* loader);
+
 	virtual C3DResource* cloneResource(C3DResource* sprite);
 
 	virtual void preload( const std::string& name );
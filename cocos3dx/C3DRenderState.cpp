@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "EnumDef_GL.h"
 #include "C3DSampler.h"
 #include "C3DSamplerCube.h"
+#include "C3DStateCache.h"
 
 namespace cocos3d
 {
@@ -86,8 +87,6 @@ static const std::string AUTO_BINDING_VARIABLES[C3DRenderState::AUTO_BINDING_NUM
 	"u_time",
 };
 
-GLint C3DRenderState::_activeTexture = 0;
-
 C3DRenderState::C3DRenderState()
     : _nodeBinding(NULL), _stateBlock(NULL), _parent(NULL)
 {
@@ -231,6 +230,83 @@ C3DStateBlock* C3DRenderState::getStateBlock() const
     return _stateBlock;
 }
 
+// 64 bits FNV-1a, chained through hash
+static unsigned long long hashBytes(const void* data, size_t size, unsigned long long hash)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+unsigned long long C3DRenderState::getParameterHash()
+{
+    unsigned long long hash = 14695981039346656037ULL;
+
+    C3DRenderState* rs = NULL;
+    while ((rs = getTopmost(rs)))
+    {
+        for (std::list<MaterialParameter*>::iterator iter = rs->_parameters.begin(); iter != rs->_parameters.end(); ++iter)
+        {
+            MaterialParameter* param = *iter;
+            hash = hashBytes(param->_name.c_str(), param->_name.size(), hash);
+            hash = hashBytes(&param->_type, sizeof(param->_type), hash);
+
+            // the values are read the way MaterialParameter::bind reads them
+            unsigned int components = 0;
+            switch (param->_type)
+            {
+            case MaterialParameter::FLOAT:
+            case MaterialParameter::INT:
+                if (param->_count == 1)
+                    hash = hashBytes(&param->_value.floatValue, sizeof(float), hash);
+                else
+                    components = 1;
+                break;
+            case MaterialParameter::VECTOR2:
+                components = 2;
+                break;
+            case MaterialParameter::VECTOR3:
+                components = 3;
+                break;
+            case MaterialParameter::VECTOR4:
+                components = 4;
+                break;
+            case MaterialParameter::MATRIX:
+                components = 16;
+                break;
+            case MaterialParameter::SAMPLER:
+            case MaterialParameter::SAMPLERCUBE:
+            case MaterialParameter::TEXTURE:
+                hash = hashBytes(&param->_value.samplerValue, sizeof(param->_value.samplerValue), hash);
+                break;
+            default:
+                break;
+            }
+
+            if (components > 0 && param->_value.floatPtrValue)
+                hash = hashBytes(param->_value.floatPtrValue, sizeof(float) * components * param->_count, hash);
+        }
+
+        C3DStateBlock* block = rs->_stateBlock;
+        if (block)
+        {
+            hash = hashBytes(&block->_bits, sizeof(block->_bits), hash);
+            hash = hashBytes(&block->_blendEnabled, sizeof(block->_blendEnabled), hash);
+            hash = hashBytes(&block->_cullFaceEnabled, sizeof(block->_cullFaceEnabled), hash);
+            hash = hashBytes(&block->_depthTestEnabled, sizeof(block->_depthTestEnabled), hash);
+            hash = hashBytes(&block->_depthWriteEnabled, sizeof(block->_depthWriteEnabled), hash);
+            hash = hashBytes(&block->_srcBlend, sizeof(block->_srcBlend), hash);
+            hash = hashBytes(&block->_dstBlend, sizeof(block->_dstBlend), hash);
+        }
+    }
+
+    return hash;
+}
+
 void C3DRenderState::setNodeAutoBinding(C3DNode* node)
 {
     _nodeBinding = node;
@@ -355,7 +431,7 @@ const std::string C3DRenderState::getAutoBindingName(AutoBinding autoBinding)
     return "";
 }
 
-void C3DRenderState::bind(C3DPass* pass)
+void C3DRenderState::bind(C3DPass* pass, C3DEffect* effect)
 {
     // Get the combined modified state bits for our C3DRenderState hierarchy.
     long stateOverrideBits = _stateBlock ? _stateBlock->_bits : 0;
@@ -374,7 +450,8 @@ void C3DRenderState::bind(C3DPass* pass)
 
     // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
     rs = NULL;
-    C3DEffect* effect = pass->getEffect();
+    if (effect == NULL)
+        effect = pass->getEffect();
     while ((rs = getTopmost(rs)))
     {
 		for (std::list<MaterialParameter*>::iterator iter = rs->_parameters.begin();iter != rs->_parameters.end();++iter)
@@ -400,7 +477,8 @@ void paramterReload(MaterialParameter* param)
 
 void C3DRenderState::reload()
 {
-	C3DRenderState::_activeTexture = std::numeric_limits<size_t>::max();
+	// the context was lost, nothing in the cache is valid anymore
+	C3DStateCache::invalidate();
 	for_each(_parameters.begin(), _parameters.end(), paramterReload);
 }
 
@@ -442,11 +520,7 @@ C3DRenderState* C3DRenderState::getTopmost(C3DRenderState* below)
 
 void C3DRenderState::activeTexture(GLenum textrue)
 {
-    if (_activeTexture != textrue)
-    {
-        GL_ASSERT(glActiveTexture(textrue));
-        _activeTexture = textrue;
-    }
+    C3DStateCache::activeTexture(textrue);
 }
 
 void C3DRenderState::copyFrom(const C3DRenderState* other)
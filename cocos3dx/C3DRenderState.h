@@ -45,6 +45,7 @@ enum
 class MaterialParameter;
 class C3DElementNode;
 class C3DStateBlock;
+class C3DEffect;
 
 /**
  * Defines a renderState for an model to be rendered.
@@ -188,6 +189,12 @@ public:
      */
     C3DStateBlock* getStateBlock() const;
 
+    /**
+     * Hash of the parameter values and the render states of this C3DRenderState and its
+     * parents. Parameters bound to a method, like the node auto-bindings, only count by name.
+     */
+    unsigned long long getParameterHash();
+
 	virtual void copyFrom(const C3DRenderState* other);
 
     static void activeTexture(GLenum textrue);
@@ -246,9 +253,10 @@ protected:
 
     /**
      * Binds the render state for this C3DRenderState and any of its parents, top-down,
-     * for the given pass.
+     * for the given pass. The parameters are bound to the effect of the pass unless
+     * another effect of the same material is given.
      */
-    void bind(C3DPass* pass);
+    void bind(C3DPass* pass, C3DEffect* effect = NULL);
 
 	void setParamMethonAutoUniform(C3DPass* pass);
 
@@ -294,8 +302,6 @@ protected:
      * The RenderState's parent.
      */
     C3DRenderState* _parent;
-
-    static GLint _activeTexture;// GL_TEXTURE0....
 };
 }
 
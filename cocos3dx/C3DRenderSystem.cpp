@@ -43,6 +43,9 @@ THE SOFTWARE.
 #include "C3DPostProcess.h"
 
 #include "C3DDeviceAdapter.h"
+#include "CCGLView.h"
+#include "C3DSkinlessModel.h"
+#include "C3DAsyncLoader.h"
 #include "C3DMaterialManager.h"
 
 namespace cocos3d
@@ -54,6 +57,7 @@ C3DRenderSystem::C3DRenderSystem()
 	_clearColor = NULL;
 	_clearDepth = 1.0f;
 	_clearStencil = 0;
+	_frameIndex = 0;
 
 	_effectManager = C3DEffectManager::getInstance();
 	_effectManager->retain();
@@ -73,6 +77,9 @@ C3DRenderSystem::C3DRenderSystem()
 	_frameBufMgr = C3DFrameBufferMgr::getInstance();
 	_frameBufMgr->retain();
 
+	_asyncLoader = C3DAsyncLoader::getInstance();
+	_asyncLoader->retain();
+
     initialize();
 }
 
@@ -87,6 +94,8 @@ void C3DRenderSystem::reload()
 	_textureMgr->reload();
 	_frameBufMgr->reload();
 
+	C3DSkinlessModel::resetInstanceBuffer();
+
 	C3DEffectManager::getInstance()->reload();
 	C3DRenderNodeManager::getInstance()->reload();
 
@@ -124,6 +133,9 @@ C3DRenderSystem::~C3DRenderSystem()
 
 	__renderSystemInstance = NULL;
 
+	// joins the workers before the managers they load into go away
+	SAFE_RELEASE(_asyncLoader);
+
 	SAFE_RELEASE(_renderChannelManager);
 
 	SAFE_RELEASE(_materialManager); 
@@ -141,8 +153,11 @@ void C3DRenderSystem::initialize()
 	_renderChannelManager->init();
 
     C3DStateBlock::initialize();
-    // initialize as window size
-	cocos2d::CCSize size = cocos2d::CCDirector::getInstance()->getOpenGLView()->getFrameSize();
+    // initialize as window size, a headless application sets the viewport itself
+	cocos2d::CCSize size(0, 0);
+	cocos2d::GLView* view = cocos2d::CCDirector::getInstance()->getOpenGLView();
+	if (view != NULL)
+		size = view->getFrameSize();
 
     _viewport = new C3DViewport(0, 0, (int)size.width, (int)size.height);
 
@@ -190,6 +205,8 @@ void C3DRenderSystem::update(long elapsedTime)
 	C3DRenderNodeManager::getInstance()->update(elapsedTime);
 	C3DEffectManager::getInstance()->update(elapsedTime);
     C3DMaterialManager::getInstance()->update(elapsedTime);
+
+	_asyncLoader->update();
 }
 
 void C3DRenderSystem::clear(ClearFlags flags, const C3DVector4* clearColor, float clearDepth, int clearStencil)
@@ -41,6 +41,7 @@ class C3DDeviceAdapter;
 class C3DSamplerMgr;
 class C3DTextureMgr;
 class C3DFrameBufferMgr;
+class C3DAsyncLoader;
 
 /**
 Defines the view port and clear flag
@@ -81,6 +82,12 @@ public:
     void clear(ClearFlags flags, const C3DVector4* clearColor, float clearDepth, int clearStencil);
 	void onLostDevice();
 	void reload();
+
+	/**
+	 * get the index of the frame being rendered, advanced by C3DLayer::beginRender.
+	 * Per frame caches compare it to know whether they are stale.
+	 */
+	unsigned int getFrameIndex() const { return _frameIndex; }
 protected:
 
 	/**
@@ -107,6 +114,7 @@ protected:
 	C3DEffectManager*	_effectManager;
 	C3DMaterialManager* _materialManager;
 	C3DFrameBufferMgr*	_frameBufMgr;
+	C3DAsyncLoader*		_asyncLoader;
 
     C3DVector4* _clearColor;                        // The clear color value last used for clearing the color buffer.
 
@@ -114,6 +122,8 @@ protected:
     int _clearStencil;                          // The clear stencil value last used for clearing the stencil buffer.
 
 	C3DDeviceAdapter* _deviceAdapter;
+
+	unsigned int _frameIndex;
 };
 }
 
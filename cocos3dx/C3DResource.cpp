@@ -26,7 +26,7 @@ THE SOFTWARE.
 #include "StringTool.h"
 namespace cocos3d
 {
-C3DResource::C3DResource(): _id(""),_resourceName(""),_size(0)
+C3DResource::C3DResource(): _id(""),_resourceName(""),_size(0),_cpuSize(0),_gpuSize(0),_cloned(false)
 {
 	_checkWaitTime = 0;
 	_waitTime = 100;
@@ -34,7 +34,7 @@ C3DResource::C3DResource(): _id(""),_resourceName(""),_size(0)
 	_cloneNum = 0;
 }
 
-C3DResource::C3DResource(const std::string& id): _id(id),_resourceName(id),_size(0)
+C3DResource::C3DResource(const std::string& id): _id(id),_resourceName(id),_size(0),_cpuSize(0),_gpuSize(0),_cloned(false)
 {
 	_checkWaitTime = 0;
 	_waitTime = 100;
@@ -51,6 +51,21 @@ size_t C3DResource::getSize(void) const
     return _size;
 }
 
+void C3DResource::updateSize()
+{
+	if (_cloned)
+	{
+		_cpuSize = 0;
+		_gpuSize = 0;
+	}
+	else
+	{
+		_cpuSize = calculateCPUSize();
+		_gpuSize = calculateGPUSize();
+	}
+	_size = _cpuSize + _gpuSize;
+}
+
 const std::string& C3DResource::getID(void) const
 {
     return _id;
@@ -110,7 +125,10 @@ void C3DResource::copyFrom(const C3DResource* other)
 
 	_resourceName = other->_resourceName;
 	_id = other->_id + "_" + StringTool::toString(other->_cloneNum);
-	_size = other->_size;
+	_size = 0;
+	_cpuSize = 0;
+	_gpuSize = 0;
+	_cloned = true;
 	_state = C3DResource::State_Init;
 	_waitTime = other->_waitTime;
 }
@@ -121,7 +139,7 @@ C3DResource* C3DResource::clone() const
 
 	other->_resourceName = _resourceName;
 	other->_id = _id;
-	other->_size = _size;
+	other->_cloned = true;
 	other->_state = C3DResource::State_Init;
 	other->_waitTime = _waitTime;
 
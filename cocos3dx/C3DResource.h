@@ -55,6 +55,18 @@ public:
 
 	/** Calculate the size of a resource; this will only be called after 'load' */
 	virtual size_t calculateSize(void) const
+	{
+		return calculateCPUSize() + calculateGPUSize();
+	}
+
+	/** Calculate the bytes the resource holds in main memory */
+	virtual size_t calculateCPUSize(void) const
+	{
+		return 0;
+	}
+
+	/** Calculate the bytes the resource holds in GL buffers and textures */
+	virtual size_t calculateGPUSize(void) const
 	{
 		return 0;
 	}
@@ -81,6 +93,14 @@ public:
 	virtual void unload(){};
 
     size_t getSize(void) const;
+	size_t getCPUSize(void) const { return _cpuSize; }
+	size_t getGPUSize(void) const { return _gpuSize; }
+
+	/**
+    * Recomputes the sizes, called by the pools when the resource enters them.
+    * A clone shares the buffers and textures of its source, it counts for nothing.
+    */
+	void updateSize();
 
 	/**
     * Returns the unique string identifier for the resource.
@@ -114,6 +134,9 @@ private:
 	std::string _resourceName;
 
     size_t _size;  // The size of the resource in bytes
+	size_t _cpuSize;
+	size_t _gpuSize;
+	bool _cloned;
 
 	long _waitTime;
 	long _checkWaitTime;
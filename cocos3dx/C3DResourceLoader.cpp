@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "C3DModel.h"
 #include "C3DModelNode.h"
+#include "C3DLODNode.h"
 #include "C3DSkinModel.h"
 #include "C3DSkinlessModel.h"
 #include "C3DSkinMorphModel.h"
@@ -96,16 +97,34 @@ C3DResourceLoader::~C3DResourceLoader()
     }
 }
 
-C3DResourceLoader* C3DResourceLoader::create(const std::string& path)
+C3DResourceLoader* C3DResourceLoader::create(const std::string& path, bool mapped)
 {
     // Open the bundle
-    C3DStream* stream = C3DStreamManager::openStream(path, "rb");
+    // mapped, so mesh data goes from the file to the GL buffers without copy
+    C3DStream* stream = C3DStreamManager::openStream(path, "rb", mapped ? C3DStreamManager::StreamType_Mapped : C3DStreamManager::StreamType_Memory);
     if (!stream)
     {
         WARN_VARG("Failed to open file: '%s'.", path.c_str());
         return NULL;
     }
 
+    return create(path, stream);
+}
+
+C3DResourceLoader* C3DResourceLoader::createFromFullPath(const std::string& fullPath, bool mapped)
+{
+    C3DStream* stream = C3DStreamManager::openFullPathStream(fullPath, "rb", mapped ? C3DStreamManager::StreamType_Mapped : C3DStreamManager::StreamType_Memory);
+    if (!stream)
+    {
+        WARN_VARG("Failed to open file: '%s'.", fullPath.c_str());
+        return NULL;
+    }
+
+    return create(fullPath, stream);
+}
+
+C3DResourceLoader* C3DResourceLoader::create(const std::string& path, C3DStream* stream)
+{
 	char identifier[] = { 'C', 'K', 'B', '\n' };
 
     // Read header info
@@ -173,6 +192,11 @@ C3DResourceLoader* C3DResourceLoader::create(const std::string& path)
     return bundle;
 }
 
+unsigned int C3DResourceLoader::getDataSize() const
+{
+	return _stream ? (unsigned int)_stream->length() : 0;
+}
+
 C3DResourceLoader::Reference* C3DResourceLoader::find(const std::string& id) const
 {
     // Search the ref table for the given id (case-sensitive)
@@ -299,6 +323,7 @@ void C3DResourceLoader::loadSuperModel(C3DSprite* superModel,std::string nodeNam
     }
 
 	 resolveJointReferences(superModel);
+	 resolveLODChains(superModel);
     return ;
 }
 
@@ -315,6 +340,7 @@ void C3DResourceLoader::loadSuperModel(C3DSprite* superModel,std::list<std::stri
     }
 
 	resolveJointReferences(superModel);
+	resolveLODChains(superModel);
 
     return ;
 }
@@ -418,6 +444,29 @@ seekCheck::~seekCheck()
 		_object->seekToNextType();
 }
 
+// id of the model node loaded as a level of detail of the model node id
+static std::string getLODLevelId(const std::string& id, unsigned int level)
+{
+	char suffix[16];
+	sprintf(suffix, "_LOD%u", level);
+	return id + suffix;
+}
+
+// model of the level of detail loaded from the node levelId, a child of parent in the file
+static C3DModel* findLODLevel(C3DNode* parent, const std::string& levelId)
+{
+	size_t pos = levelId.rfind("_LOD");
+	if (pos == std::string::npos || pos == 0)
+		return NULL;
+
+	C3DLODNode* lodNode = dynamic_cast<C3DLODNode*>(parent->findNode(levelId.substr(0, pos), false));
+	unsigned int level = (unsigned int)atoi(levelId.c_str() + pos + 4);
+	if (lodNode == NULL || level == 0 || level >= lodNode->getModelCount())
+		return NULL;
+
+	return lodNode->getModel(level);
+}
+
 bool C3DResourceLoader::reloadNode(C3DNode* context)
 {
 	seekCheck	autoSeek(this);
@@ -437,8 +486,15 @@ bool C3DResourceLoader::reloadNode(C3DNode* context)
 	}
 
     C3DNode* curNode = context->findNode(nodeID, false);
+	C3DModel* lodModel = NULL;
 	if(NULL==curNode)
-		return false;
+	{
+		// the nodes of the levels of detail were removed, their models are in the C3DLODNode
+		lodModel = findLODLevel(context, nodeID);
+		if(NULL==lodModel)
+			return false;
+		curNode = context;
+	}
 
 	// skip the transform
 	_stream->seek(sizeof(float)*16, SEEK_CUR);
@@ -459,10 +515,10 @@ bool C3DResourceLoader::reloadNode(C3DNode* context)
 	}
 
 	//--------------------------------------------------------------
-	if(C3DNode::NodeType_Model == curNode->getType())
+	if(lodModel || C3DNode::NodeType_Model == curNode->getType())
 	{
 		// Read model
-		C3DModelNode* modelNode = static_cast<C3DModelNode*>(curNode);
+		C3DModel* model = lodModel ? lodModel : static_cast<C3DModelNode*>(curNode)->getModel();
 
 		// reloadModel:-----------------------------------------------------------------
 		unsigned char hasMesh;
@@ -505,7 +561,7 @@ bool C3DResourceLoader::reloadNode(C3DNode* context)
 			}
 
 			// Create C3DMesh
-			C3DMesh* mesh = modelNode->getModel()->getMesh();
+			C3DMesh* mesh = model->getMesh();
 			if (mesh == NULL)
 			{
 				LOG_ERROR_VARG("Failed to create mesh: %s", nodeID.c_str());
@@ -584,6 +640,7 @@ void C3DResourceLoader::loadSuperModel(C3DSprite* superModel)
 	loadAnimation(superModel);
 
     resolveJointReferences(superModel);
+    resolveLODChains(superModel);
 
     return ;
 }
@@ -617,6 +674,8 @@ void C3DResourceLoader::loadSceneModel(C3DStaticObj* sceneModel)
         }
     }
 
+    resolveLODChains(sceneModel);
+
     return ;
 }
 
@@ -669,7 +728,11 @@ C3DNode* C3DResourceLoader::readNode(C3DRenderNode* compoundModelContext)
         node = C3DBone::create(id);
         break;
 	case C3DNode::NodeType_Model:
-        node = C3DModelNode::create(id);
+        // the coarser levels are moved into it by resolveLODChains
+        if (contains(getLODLevelId(id, 1)))
+            node = C3DLODNode::create(id);
+        else
+            node = C3DModelNode::create(id);
         break;
 	case C3DNode::NodeType_Camera:
         node = C3DCamera::create(id);
@@ -1249,6 +1312,45 @@ void C3DResourceLoader::resolveJointReferences(C3DSprite* superModelContext)
     }
     _meshSkins->clear();
 }
+
+void C3DResourceLoader::resolveLODChains(C3DNode* parent)
+{
+    std::vector<C3DLODNode*> lodNodes;
+
+    std::vector<C3DNode*>& children = parent->getChildrenList();
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+        resolveLODChains(children[i]);
+
+        C3DLODNode* lodNode = dynamic_cast<C3DLODNode*>(children[i]);
+        if (lodNode && lodNode->getModelCount() == 1)
+            lodNodes.push_back(lodNode);
+    }
+
+    for (size_t i = 0; i < lodNodes.size(); ++i)
+    {
+        C3DLODNode* lodNode = lodNodes[i];
+        for (unsigned int level = 1; ; ++level)
+        {
+            C3DNode* node = parent->findNode(getLODLevelId(lodNode->getId(), level), false);
+            if (node == NULL || node->getType() != C3DNode::NodeType_Model)
+                break;
+
+            C3DModelNode* levelNode = static_cast<C3DModelNode*>(node);
+            C3DModel* model = levelNode->getModel();
+            if (model == NULL)
+                break;
+
+            // the level is drawn with the transform of the lod node
+            model->retain();
+            levelNode->setModel(NULL);
+            lodNode->addLevel(model, C3DLODNode::getDefaultScreenSize(level));
+            model->release();
+
+            parent->removeChild(levelNode);
+        }
+    }
+}
 void C3DResourceLoader::readAnimationChannelData(C3DAnimation* animation, const std::string& id, C3DBone* bone)
 {
     // length of the arrays
@@ -1429,11 +1531,19 @@ MeshData* C3DResourceLoader::readMeshData()
         return NULL;
     }
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat->getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+    meshData->vertexData = (unsigned char*)_stream->readPointer(vertexByteCount);
+    if (meshData->vertexData)
     {
-        SAFE_DELETE(meshData);
-        return NULL;
+        meshData->ownVertexData = false;
+    }
+    else
+    {
+        meshData->vertexData = new unsigned char[vertexByteCount];
+        if (_stream->read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+        {
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
     }
 
     // Read mesh parts
@@ -1477,11 +1587,19 @@ MeshData* C3DResourceLoader::readMeshData()
 
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+        partData->indexData = (unsigned char*)_stream->readPointer(iByteCount);
+        if (partData->indexData)
         {
-            SAFE_DELETE(meshData);
-            return NULL;
+            partData->ownIndexData = false;
+        }
+        else
+        {
+            partData->indexData = new unsigned char[iByteCount];
+            if (_stream->read(partData->indexData, 1, iByteCount) != iByteCount)
+            {
+                SAFE_DELETE(meshData);
+                return NULL;
+            }
         }
     }
 
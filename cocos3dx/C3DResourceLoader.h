@@ -66,8 +66,22 @@ public:
 
     /**
      * Returns a C3DResourceLoader for the given resource path.
+     *
+     * @param mapped false reads the whole file at once instead of mapping it, for the
+     *        loads done in a background thread.
+     */
+    static C3DResourceLoader* create(const std::string& path, bool mapped = true);
+
+    /**
+     * Returns a C3DResourceLoader for a path already resolved by CCFileUtils::fullPathForFilename.
+     * The search paths are not looked up, so the loader threads can call it.
+     */
+    static C3DResourceLoader* createFromFullPath(const std::string& fullPath, bool mapped = true);
+
+	/**
+     * Returns the size of the bundle file in bytes.
      */
-    static C3DResourceLoader* create(const std::string& path);
+	unsigned int getDataSize() const;
 
 	/**
      * load 3D sprite.
@@ -132,6 +146,11 @@ private:
     C3DResourceLoader(const std::string& path);
     ~C3DResourceLoader();
 
+    /**
+     * Reads the header and the reference table of an opened bundle, takes the stream.
+     */
+    static C3DResourceLoader* create(const std::string& path, C3DStream* stream);
+
     /**
      * Finds a reference by ID.
      */
@@ -265,6 +284,11 @@ private:
      */
 	void resolveJointReferences(C3DSprite* superModelContext);
 
+    /**
+     * Moves the models of the nodes <id>_LOD1, <id>_LOD2, ... into the C3DLODNode <id> next to them.
+     */
+	void resolveLODChains(C3DNode* parent);
+
 	/**
      * read animation data.
      */
@@ -24,10 +24,11 @@ THE SOFTWARE.
 #include "C3DResource.h"
 #include "C3DResourcePool.h"
 #include "Base.h"
+#include "C3DProfile.h"
 
 namespace cocos3d
 {
-C3DResourceManager::C3DResourceManager():_memoryUsage(0)
+C3DResourceManager::C3DResourceManager():_memoryBudget(0)
 {
 	_usedPool = new C3DUsedResourcePool(this);
 	_waitPool = new C3DWaitResourcePool(this);
@@ -44,6 +45,19 @@ C3DResourceManager::~C3DResourceManager()
 	SAFE_DELETE(_waitPool);
 }
 
+size_t C3DResourceManager::getMemoryUsage(void) const
+{
+	return _usedPool->getMemoryUsage() + _waitPool->getMemoryUsage();
+}
+
+void C3DResourceManager::setMemoryBudget(size_t budget)
+{
+	_memoryBudget = budget;
+
+	if (_memoryBudget > 0)
+		_waitPool->evict(_memoryBudget);
+}
+
 C3DResource* C3DResourceManager::findResource(const std::string& name)
 {
 	C3DResource* res = NULL;
@@ -79,6 +93,7 @@ C3DResource* C3DResourceManager::getResource(const std::string& name)
     }
     else
 	{
+		PROFILE_SCOPE("resource load");
 		return createResource(name);
 	}
 }
@@ -129,6 +144,10 @@ void C3DResourceManager::setResourceState(C3DResource* res,C3DResource::State st
 		if(res->getState()==C3DResource::State_Init && state==C3DResource::State_Used)
 		{
 			_usedPool->addItem(res);
+
+			// make room for the new resource right away
+			if (_memoryBudget > 0)
+				_waitPool->evict(_memoryBudget);
 		}
 
 		if(res->getState()==C3DResource::State_Used && state==C3DResource::State_Wait)
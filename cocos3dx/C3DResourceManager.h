@@ -47,6 +47,9 @@ public:
 
 	C3DResource* getResource(const std::string& name);
 
+	/** Returns true if the resource is in the used or the wait pool. */
+	bool hasResource(const std::string& name) { return findResource(name) != NULL; }
+
 	virtual C3DResource* createResource(const std::string& name){return NULL;}
 
 	virtual C3DResource* cloneResource(C3DResource* resource) {return NULL;}
@@ -54,7 +57,15 @@ public:
 	virtual void preload(const std::string& name){};
 
 	/** Gets the current memory usage, in bytes. */
-	virtual size_t getMemoryUsage(void) const { return _memoryUsage; }
+	virtual size_t getMemoryUsage(void) const;
+
+	/**
+	 * Sets the memory budget of the manager, in bytes. Unused resources are then kept
+	 * until the budget is exceeded and released least recently used first, instead of
+	 * after a fixed wait time. 0 means no budget.
+	 */
+	void setMemoryBudget(size_t budget);
+	size_t getMemoryBudget(void) const { return _memoryBudget; }
 
 	virtual void removeResource(const std::string& name);
 	virtual void removeResource(C3DResource* r);
@@ -78,7 +89,7 @@ protected:
 	C3DResource* findResource(const std::string& name);
 
 public:
-    size_t _memoryUsage; // In bytes
+    size_t _memoryBudget; // In bytes
 
 	std::string _type;
 
@@ -29,6 +29,7 @@ namespace cocos3d
 C3DResourcePool::C3DResourcePool(C3DResourceManager* manager)
 {
 	_manager = manager;
+	_memoryUsage = 0;
 }
 
 C3DResourcePool::~C3DResourcePool()
@@ -40,18 +41,24 @@ C3DResourcePool::~C3DResourcePool()
 
 void C3DResourcePool::clear()
 {
-	for (std::map<std::string,C3DResource*>::iterator iter = _items.begin(); iter != _items.end(); ++iter)
+	for (ItemList::iterator iter = _order.begin(); iter != _order.end(); ++iter)
 	{
-		iter->second->release();
+		(*iter)->release();
 	}
 	_items.clear();
+	_order.clear();
+	_memoryUsage = 0;
 }
 
 bool C3DResourcePool::addItem(C3DResource* item)
 {
 	if(_items.find(item->getID()) == _items.end())
 	{
-		_items[item->getID()] = item;
+		item->updateSize();
+		_memoryUsage += item->getSize();
+
+		_order.push_front(item);
+		_items[item->getID()] = _order.begin();
 		item->retain();
 		return true;
 	}
@@ -59,14 +66,24 @@ bool C3DResourcePool::addItem(C3DResource* item)
 		return false;
 }
 
+void C3DResourcePool::eraseItem(ItemMap::iterator iter)
+{
+	C3DResource* item = *iter->second;
+
+	_memoryUsage -= item->getSize();
+	_order.erase(iter->second);
+	_items.erase(iter);
+
+	item->release();
+}
+
 bool C3DResourcePool::removeItem(const std::string& name)
 {
-	std::map<std::string,C3DResource*>::iterator iter = _items.find(name);
+	ItemMap::iterator iter = _items.find(name);
 
 	if(iter != _items.end())
 	{
-		iter->second->release();
-		_items.erase(iter);
+		eraseItem(iter);
 		return true;
 	}
 	else
@@ -75,22 +92,29 @@ bool C3DResourcePool::removeItem(const std::string& name)
 
 C3DResource* C3DResourcePool::getItem(const std::string& name)
 {
-	std::map<std::string,C3DResource*>::iterator iter = _items.find(name);
+	ItemMap::iterator iter = _items.find(name);
 	if(iter != _items.end())
 	{
-		return iter->second;
+		_order.splice(_order.begin(), _order, iter->second);
+		return *iter->second;
 	}
 	else
 		return NULL;
 }
 
+void C3DResourcePool::evict(size_t budget)
+{
+	while (!_order.empty() && _manager->getMemoryUsage() > budget)
+	{
+		eraseItem(_items.find(_order.back()->getID()));
+	}
+}
+
 void C3DResourcePool::reload()
 {
-	std::map<std::string, C3DResource*>::iterator iter = _items.begin();
-	while(iter != _items.end())
+	for (ItemList::iterator iter = _order.begin(); iter != _order.end(); ++iter)
 	{
-		iter->second->reload();
-		++iter;
+		(*iter)->reload();
 	}
 }
 
@@ -103,20 +127,17 @@ C3DUsedResourcePool::C3DUsedResourcePool(C3DResourceManager* manager)
 void C3DUsedResourcePool::update(long elapsedTime)
 {
 	C3DResource* item = NULL;
-	for (std::map<std::string,C3DResource*>::iterator iter = _items.begin(); iter != _items.end(); )
+	for (ItemList::iterator iter = _order.begin(); iter != _order.end(); )
 	{
-		item = iter->second;
+		item = *iter;
+		++iter;
 
 		if(item->getReferenceCount() ==1)
 		{
+			// the wait pool takes its own reference before this one goes
 			item->setState(C3DResource::State_Wait);
 			_manager->addResource(item);
-			item->release();
-			_items.erase(iter++);
-		}
-		else
-		{
-			++iter;
+			eraseItem(_items.find(item->getID()));
 		}
 	}
 }
@@ -130,22 +151,25 @@ C3DWaitResourcePool::C3DWaitResourcePool(C3DResourceManager* manager)
 
 void C3DWaitResourcePool::update(long elapsedTime)
 {
+	if (_manager->getMemoryBudget() > 0)
+	{
+		// kept as long as the budget allows
+		evict(_manager->getMemoryBudget());
+		return;
+	}
+
 	C3DResource* item = NULL;
-	for (std::map<std::string,C3DResource*>::iterator iter = _items.begin(); iter != _items.end(); )
+	for (ItemList::iterator iter = _order.begin(); iter != _order.end(); )
 	{
-		item = iter->second;
+		item = *iter;
+		++iter;
 
 		item->_checkWaitTime += elapsedTime;
 		if(item->_checkWaitTime > item->_waitTime)
 		{
 			item->_checkWaitTime = 0;
 
-			item->release();
-			_items.erase(iter++);
-		}
-		else
-		{
-			++iter;
+			eraseItem(_items.find(item->getID()));
 		}
 	}
 }
@@ -23,7 +23,8 @@ THE SOFTWARE.
 #ifndef ResourcePool_H_
 #define ResourcePool_H_
 
-#include <map>
+#include <list>
+#include <unordered_map>
 #include <string>
 
 namespace cocos3d
@@ -32,11 +33,14 @@ class C3DResource;
 class C3DResourceManager;
 
 /**
-Resource pool
+Resource pool, the items are kept in least recently used order
 */
 class  C3DResourcePool
 {
 public:
+	typedef std::list<C3DResource*> ItemList;
+	typedef std::unordered_map<std::string, ItemList::iterator> ItemMap;
+
 	C3DResourcePool(C3DResourceManager* manager);
 	virtual ~C3DResourcePool();
 
@@ -44,15 +48,31 @@ public:
 
 	bool addItem(C3DResource* item);
 
+	/**
+	 * Finds an item and makes it the most recently used one.
+	 */
     C3DResource* getItem(const std::string& name);
 	void clear();
 
 	virtual void update(long elapsedTime) = 0;
 
+	/**
+	 * Releases the least recently used items until the manager uses at most budget bytes.
+	 */
+	void evict(size_t budget);
+
 	void reload();
 
+	/** Gets the bytes held by the items, in bytes. */
+	size_t getMemoryUsage(void) const { return _memoryUsage; }
+
+protected:
+	void eraseItem(ItemMap::iterator iter);
+
 public:
-	std::map<std::string,C3DResource*> _items;
+	ItemMap _items;
+	ItemList _order; // most recently used first
+	size_t _memoryUsage;
 	C3DResourceManager* _manager;
 };
 
@@ -63,6 +83,10 @@ public:
 	virtual void update(long elapsedTime);
 };
 
+/**
+Unused resources, released once their wait time is over or, when the manager has a
+memory budget, when the budget is exceeded
+*/
 class C3DWaitResourcePool : public C3DResourcePool
 {
 public:
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include "C3DTexture.h"
 #include "C3DStream.h"
 #include "C3DElementNode.h"
+#include "C3DStateCache.h"
 
 namespace cocos3d
 {
@@ -148,7 +149,7 @@ void C3DSampler::bind()
 	if(_3DTexture == NULL)
 		return;
 
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _3DTexture->getHandle()) );
+    C3DStateCache::bindTexture(GL_TEXTURE_2D, _3DTexture->getHandle());
     if (_dirtyBit & Texture_Wrap_Dirty)
     {
         GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLenum)_wrapS) );
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #include "C3DTexture3D.h"
 #include "C3DStream.h"
 #include "C3DElementNode.h"
+#include "C3DStateCache.h"
 
 namespace cocos3d
 {
@@ -69,7 +70,7 @@ void C3DSamplerCube::bind()
 
     //glEnable(GL_TEXTURE_CUBE_MAP);
 
-	GL_ASSERT( glBindTexture(GL_TEXTURE_CUBE_MAP, _texture->getHandle()) );
+	C3DStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, _texture->getHandle());
 
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
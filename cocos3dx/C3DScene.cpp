@@ -46,6 +46,11 @@ THE SOFTWARE.
 #include "C3DPostProcess.h"
 #include "C3DGeoWireRender.h"
 #include "C3DDeviceAdapter.h"
+#include "C3DOctree.h"
+#include "C3DLightGrid.h"
+#include "C3DOcclusionBuffer.h"
+#include "C3DProfile.h"
+#include "physics/PhysicsWorld.h"
 
 namespace cocos3d
 {
@@ -63,11 +68,15 @@ void C3DScene::removeAllNode()
 
     removeAllChildren();
 
+	if (_physicsWorld)
+		_physicsWorld->removeAllBodies();
+
     size_t i;
     for (i = 0; i < _lights.size(); i++) {
         SAFE_RELEASE(_lights[i]);
     }
     _lights.clear();
+    _lightGrid->build(_lights);
 
     for (i = 0; i < _cameras.size(); i++) {
         SAFE_RELEASE(_cameras[i]);
@@ -88,6 +97,9 @@ void C3DScene::removeAllNode()
 		SAFE_RELEASE(_postDrawNode[i]);
 	}
 	_postDrawNode.clear();
+
+	_unindexedNodes.clear();
+	_visibleNodes.clear();
 }
 
 C3DScene::C3DScene(const std::string& str) : C3DNode(str)
@@ -108,6 +120,13 @@ C3DScene::C3DScene(const std::string& str) : C3DNode(str)
 
     _layer = NULL;
 	_geoWireRender = NULL;
+
+	_octree = new C3DOctree(C3DAABB(C3DVector3(-1024.0f, -1024.0f, -1024.0f), C3DVector3(1024.0f, 1024.0f, 1024.0f)));
+	_lightGrid = new C3DLightGrid();
+	_occlusionCulling = false;
+	_occlusionBuffer = NULL;
+	_physicsWorld = NULL;
+
     setScene(this);
 }
 
@@ -121,6 +140,10 @@ C3DScene::~C3DScene()
     removeAllNode();
 
 	SAFE_DELETE(_geoWireRender);
+	SAFE_DELETE(_octree);
+	SAFE_DELETE(_lightGrid);
+	SAFE_DELETE(_occlusionBuffer);
+	SAFE_DELETE(_physicsWorld);
 }
 
 C3DScene* C3DScene::createScene(C3DLayer* layer)
@@ -226,34 +249,59 @@ void C3DScene::preDraw()
 	{
 		if (_activeShadowMap && _activeShadowMap->isVisible())
 		{
-			_inShadowPass = true;
+			_activeShadowMap->fitCascades(_activeCamera);
 
-			_activeShadowMap->beginDraw();
-			
-			//draw scene
-			for (size_t i = 0; i < _children.size(); ++i)
+			for (unsigned int cascade = 0; cascade < _activeShadowMap->getCascadeCount(); ++cascade)
 			{
-				C3DNode* node = _children[i];
-				if(node->isVisible())
+				if (!_activeShadowMap->isCascadeDue(cascade))
+					continue;
+
+				cullShadowCasters(cascade);
+
+				// the cascade is kept as long as the light and its casters stay still
+				if (!_activeShadowMap->updateCasters(cascade, _shadowCasters, _activeCamera))
+					continue;
+
+				_inShadowPass = true;
+
+				_activeShadowMap->beginDraw(cascade);
+
+				//draw casters
+				for (size_t i = 0; i < _shadowCasters.size(); ++i)
 				{
+					C3DNode* node = _shadowCasters[i];
 					node->draw();
 
 					STAT_INC_TRIANGLE_TOTAL(node->getTriangleCount());
 				}
-			}
 
-			_activeShadowMap->endDraw();
+				_activeShadowMap->endDraw();
 
-			_inShadowPass = false;
+				_inShadowPass = false;
+			}
 		}
 	}
 }
 
 void C3DScene::draw()
 {
-	for (size_t i = 0; i < _children.size(); ++i)
+	PROFILE_SCOPE("3dscene submit");
+
+	size_t i;
+	for (i = 0; i < _unindexedNodes.size(); ++i)
 	{
-		C3DNode* node = _children[i];
+		C3DNode* node = _unindexedNodes[i];
+		if(node->isVisible())
+		{
+			node->draw();
+
+			STAT_INC_TRIANGLE_TOTAL(node->getTriangleCount());
+		}
+	}
+
+	for (i = 0; i < _visibleNodes.size(); ++i)
+	{
+		C3DNode* node = _visibleNodes[i];
 		if(node->isVisible())
 		{
 			node->draw();
@@ -265,6 +313,8 @@ void C3DScene::draw()
 
 void C3DScene::postDraw()
 {
+	PROFILE_SCOPE("3dscene flush");
+
 	if( C3DDeviceAdapter::getInstance()->isSupportPostProcess() == true)
 	{
 		if (_activePostProcess && _activePostProcess->isVisible())
@@ -308,16 +358,36 @@ void C3DScene::update(long elapsedTime)
     if (!isActive())
         return;
 
+    PROFILE_SCOPE("3dscene update");
+
+	// bodies move their nodes before the nodes get updated & culled
+	if (_physicsWorld)
+	{
+		PROFILE_SCOPE("3dscene physics");
+		_physicsWorld->step(elapsedTime);
+	}
+
     //update children then
    // C3DNode::update(elapsedTime);
 
 	size_t i;
-    for (i = 0; i < _children.size(); ++i)
+    for (i = 0; i < _unindexedNodes.size(); ++i)
 	{
-		C3DNode* node = _children[i];
+		C3DNode* node = _unindexedNodes[i];
 			node->update(elapsedTime);
     }
 
+	// sprites and static objects are culled by the octree, only the visible ones get updated
+	cullNodes();
+
+	for (i = 0; i < _visibleNodes.size(); ++i)
+	{
+		_visibleNodes[i]->update(elapsedTime);
+	}
+
+	// lights may follow any node, build the grid once everything moved
+	_lightGrid->build(_lights);
+
 	if (_geoWireRender)
 		_geoWireRender->begin();
 }
@@ -327,10 +397,119 @@ C3DNode::Type C3DScene::getType() const
 	return C3DNode::NodeType_Scene;
 }
 
+void C3DScene::cullNodes()
+{
+	PROFILE_SCOPE("3dscene cull");
+
+	size_t i;
+	for (i = 0; i < _visibleNodes.size(); ++i)
+	{
+		_visibleNodes[i]->_visible = false;
+	}
+	_visibleNodes.clear();
+
+	_octree->refit();
+
+	if (_activeCamera && _activeCamera->isFrustumCullEnalbed())
+		_octree->queryFrustum(_activeCamera->getFrustum(), _visibleNodes);
+	else
+		_octree->queryAll(_visibleNodes);
+
+	if (_occlusionCulling && _activeCamera)
+		cullOccludedNodes();
+
+	for (i = 0; i < _visibleNodes.size(); ++i)
+	{
+		_visibleNodes[i]->_visible = true;
+	}
+}
+
+void C3DScene::cullOccludedNodes()
+{
+	PROFILE_SCOPE("3dscene occlusion");
+
+	C3DOcclusionBuffer* buffer = getOcclusionBuffer();
+	buffer->begin(_activeCamera->getViewProjectionMatrix());
+
+	size_t i;
+	for (i = 0; i < _visibleNodes.size(); ++i)
+	{
+		C3DNode* node = _visibleNodes[i];
+		if (node->getType() == C3DNode::NodeType_SceneModel && static_cast<C3DStaticObj*>(node)->isOccluder())
+			static_cast<C3DStaticObj*>(node)->rasterizeOccluder(buffer);
+	}
+
+	buffer->end();
+
+	size_t count = 0;
+	for (i = 0; i < _visibleNodes.size(); ++i)
+	{
+		C3DNode* node = _visibleNodes[i];
+		bool occluder = node->getType() == C3DNode::NodeType_SceneModel && static_cast<C3DStaticObj*>(node)->isOccluder();
+		C3DAABB* box = node->getAABB();
+		if (occluder || box == NULL || !buffer->isOccluded(*box))
+			_visibleNodes[count++] = node;
+	}
+	_visibleNodes.resize(count);
+}
+
+void C3DScene::setOcclusionCulling(bool enable)
+{
+	_occlusionCulling = enable;
+}
+
+C3DOcclusionBuffer* C3DScene::getOcclusionBuffer()
+{
+	if (_occlusionBuffer == NULL)
+		_occlusionBuffer = new C3DOcclusionBuffer();
+
+	return _occlusionBuffer;
+}
+
+void C3DScene::cullShadowCasters(unsigned int cascade)
+{
+	PROFILE_SCOPE("3dscene shadow cull");
+
+	_shadowCasters.clear();
+	_octree->queryFrustum(_activeShadowMap->getCasterFrustum(cascade), _shadowCasters);
+
+	size_t count = 0;
+	for (size_t i = 0; i < _shadowCasters.size(); ++i)
+	{
+		C3DNode* node = _shadowCasters[i];
+		if (node->isActive() && node->isCastShadow())
+			_shadowCasters[count++] = node;
+	}
+	_shadowCasters.resize(count);
+}
+
+PhysicsWorld* C3DScene::getPhysicsWorld()
+{
+	if (_physicsWorld == NULL)
+		_physicsWorld = new PhysicsWorld();
+
+	return _physicsWorld;
+}
+
+void C3DScene::setSceneBounds(const C3DAABB& bounds)
+{
+	_octree->setBounds(bounds);
+}
+
 void C3DScene::addNodeToRenderList(C3DNode* node)
 {
 	node->setScene(this);
 
+	// direct children are drawn by the scene, sprites and static objects are culled through the octree
+	if (node->getParent() == this)
+	{
+		C3DNode::Type nodeType = node->getType();
+		if (nodeType == C3DNode::NodeType_SuperModel || nodeType == C3DNode::NodeType_SceneModel)
+			_octree->add(node);
+		else
+			_unindexedNodes.push_back(node);
+	}
+
 	C3DNode::Type type = node->getType();
 	switch (type)
 	{
@@ -453,6 +632,21 @@ void C3DScene::addNodeToRenderList(C3DNode* node)
 
 void C3DScene::removeNodeFromRenderList(C3DNode* node)
 {
+	if (node->isInOctree())
+	{
+		_octree->remove(node);
+
+		std::vector<C3DNode*>::iterator it = find(_visibleNodes.begin(), _visibleNodes.end(), node);
+		if (it != _visibleNodes.end())
+			_visibleNodes.erase(it);
+	}
+	else
+	{
+		std::vector<C3DNode*>::iterator it = find(_unindexedNodes.begin(), _unindexedNodes.end(), node);
+		if (it != _unindexedNodes.end())
+			_unindexedNodes.erase(it);
+	}
+
 	C3DNode::Type type = node->getType();
 	switch (type)
 	{
@@ -481,6 +675,7 @@ void C3DScene::removeNodeFromRenderList(C3DNode* node)
 			if (it != _lights.end())
 			{
 				_lights.erase(it);
+				_lightGrid->build(_lights);
 				node->release();
 			}
 			else
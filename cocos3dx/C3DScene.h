@@ -46,6 +46,10 @@ class C3DPostProcess;
 class C3DGeoWireRender;
 
 class C3DOctree;
+class C3DAABB;
+class C3DLightGrid;
+class C3DOcclusionBuffer;
+class PhysicsWorld;
 
 /**
 *Defines the scene node,which includes all the scene object,for example,light,camera,sprite,and so on.
@@ -76,6 +80,11 @@ public:
     // get light by index
     C3DLight* getLight(int index);
 
+    /**
+     * get the grid of the active lights, rebuilt in each update
+     */
+    C3DLightGrid* getLightGrid() const { return _lightGrid; }
+
     /**
      *  set default depth, used when z is not provided during function call C3DNode::setScreenPos()
      */
@@ -127,9 +136,56 @@ public:
 
 	const C3DVector4& getTimeParam(void) const;
 
+	/**
+	 * Gets the spatial index of the scene, can be used for ray and sphere queries.
+	 */
+	C3DOctree* getOctree() const { return _octree; }
+
+	/**
+	 * Sets the world bounds covered by the octree, nodes outside of them are still managed but not culled hierarchically.
+	 */
+	void setSceneBounds(const C3DAABB& bounds);
+
+	/**
+	 * Gets the nodes of the octree that passed the culling of the active camera in the last update.
+	 */
+	const std::vector<C3DNode*>& getVisibleNodes() const { return _visibleNodes; }
+
+	/**
+	 * Gets the rigid body world of the scene, created on first use and stepped at the beginning of update().
+	 */
+	PhysicsWorld* getPhysicsWorld();
+
+	/**
+	 * Sets whether the nodes hidden by the occluders, the static objects flagged with
+	 * C3DStaticObj::setOccluder, are culled after the frustum culling. Off by default.
+	 */
+	void setOcclusionCulling(bool enable);
+	bool isOcclusionCulling() const { return _occlusionCulling; }
+
+	/**
+	 * Gets the buffer the occluders were drawn into in the last update, created on first use.
+	 */
+	C3DOcclusionBuffer* getOcclusionBuffer();
+
 protected:
 	virtual void onChildChanged(ChangeEvent eventType, C3DNode* child);
 
+	/**
+	 * refit the octree and collect the visible nodes with the active camera
+	 */
+	void cullNodes();
+
+	/**
+	 * draw the visible occluders into the occlusion buffer and remove the visible nodes they hide
+	 */
+	void cullOccludedNodes();
+
+	/**
+	 * collect the shadow casters of a cascade of the active shadow map, they may be out of the view of the camera
+	 */
+	void cullShadowCasters(unsigned int cascade);
+
 private:
 
     C3DVector3* _ambientColor;
@@ -158,6 +214,17 @@ private:
 
 	C3DGeoWireRender* _geoWireRender;
 
+	C3DOctree* _octree; // spatial index of sprites and static objects
+	std::vector<C3DNode*> _unindexedNodes; // children not in the octree, always updated and drawn
+	std::vector<C3DNode*> _visibleNodes; // octree nodes visible by the active camera
+	std::vector<C3DNode*> _shadowCasters; // octree nodes drawn into a cascade of the active shadow map
+
+	C3DLightGrid* _lightGrid;
+
+	bool _occlusionCulling;
+	C3DOcclusionBuffer* _occlusionBuffer;
+
+	PhysicsWorld* _physicsWorld;
 };
 }
 
@@ -26,6 +26,12 @@ THE SOFTWARE.
 #include "C3DTexture.h"
 #include "C3DSampler.h"
 #include "C3DDeviceAdapter.h"
+#include "C3DRenderSystem.h"
+#include "C3DCamera.h"
+#include "C3DSprite.h"
+#include "C3DAnimation.h"
+#include "C3DLODNode.h"
+#include "C3DAABB.h"
 namespace cocos3d
 {
     enum
@@ -34,8 +40,14 @@ namespace cocos3d
         DIRTY_MATRIX = 2,
     };
 
+    C3DShadowMap::Cascade::Cascade() : radius(1.0f), nearExtension(0.0f), updateInterval(1), contentDirty(true), reloadCount(0)
+    {
+        casterFrustum.setClipNear(false);
+    }
+
     C3DShadowMap::C3DShadowMap(const std::string& id) : C3DNode(id), _framebuffer(NULL), _texWidth(0), _texHeight(0),
-        _dimension(1.0f, 1.0f, 1.0f), _dirty(0), _sampler(NULL)
+        _dimension(1.0f, 1.0f, 1.0f), _dirty(DIRTY_MATRIX), _sampler(NULL), _cascadeCount(1), _drawCascade(0),
+        _shadowDistance(0.0f), _splitLambda(0.75f), _frame(0), _cascadeSplits(2.0f, 2.0f, 2.0f, 2.0f)
     {
     }
 
@@ -91,22 +103,57 @@ namespace cocos3d
     {
         if (_dirty)
             updateMatrix();
-        return _viewProjMatrix;
+        return _cascades[_drawCascade].viewProjMatrix;
     }
 
     const C3DMatrix& C3DShadowMap::getTextureMatrix()
     {
         if (_dirty)
             updateMatrix();
-        return _textureMatrix;
+        return _cascades[0].textureMatrix;
+    }
+
+    const C3DVector4* C3DShadowMap::getCascadeScales()
+    {
+        if (_dirty)
+            updateMatrix();
+        return _cascadeScales;
     }
 
-    bool C3DShadowMap::beginDraw()
+    const C3DVector4* C3DShadowMap::getCascadeOffsets()
+    {
+        if (_dirty)
+            updateMatrix();
+        return _cascadeOffsets;
+    }
+
+    bool C3DShadowMap::beginDraw(unsigned int cascade)
     {
         CCAssert(_framebuffer, "Empty frame buffer");;
+        CCAssert(cascade < _cascadeCount, "Invalid cascade");
         _framebuffer->bind();
 
-        glClear(GL_DEPTH_BUFFER_BIT);
+        _drawCascade = cascade;
+        if (_cascadeCount > 1)
+        {
+            // only the tile of the cascade is cleared, the others may be kept from previous frames
+            unsigned int cols = 2;
+            unsigned int rows = _cascadeCount > 2 ? 2 : 1;
+            unsigned int width = _texWidth / cols;
+            unsigned int height = _texHeight / rows;
+            unsigned int x = (cascade % cols) * width;
+            unsigned int y = (cascade / cols) * height;
+
+            C3DRenderSystem::getInstance()->setViewport(x, y, width, height);
+            GL_ASSERT( glEnable(GL_SCISSOR_TEST) );
+            GL_ASSERT( glScissor(x, y, width, height) );
+            GL_ASSERT( glClear(GL_DEPTH_BUFFER_BIT) );
+            GL_ASSERT( glDisable(GL_SCISSOR_TEST) );
+        }
+        else
+        {
+            GL_ASSERT( glClear(GL_DEPTH_BUFFER_BIT) );
+        }
         return true;
     }
 
@@ -114,12 +161,14 @@ namespace cocos3d
     {
         CCAssert(_framebuffer, "Empty frame buffer");;
         _framebuffer->unbind();
+        _drawCascade = 0;
     }
 
     void C3DShadowMap::transformChanged()
     {
         C3DNode::transformChanged();
         _dirty |= DIRTY_MATRIX;
+        invalidateCascades();
     }
 
     C3DNode* C3DShadowMap::clone(C3DNode::CloneContext& context) const
@@ -127,6 +176,13 @@ namespace cocos3d
         C3DShadowMap* other = C3DShadowMap::create(_id, _texWidth, _texHeight);
         other->copyFrom(this, context);
         other->setDimension(_dimension.x, _dimension.y, _dimension.z);
+        other->setCascadeCount(_cascadeCount);
+        other->setShadowDistance(_shadowDistance);
+        other->setSplitLambda(_splitLambda);
+        for (unsigned int i = 0; i < MAX_CASCADES; i++)
+        {
+            other->setCascadeUpdateInterval(i, _cascades[i].updateInterval);
+        }
         return other;
     }
 
@@ -134,18 +190,240 @@ namespace cocos3d
     {
         _dimension.set(width, height, depth);
         _dirty |= DIRTY_DIMENSION;
+        invalidateCascades();
     }
 
-    void C3DShadowMap::updateMatrix()
+    void C3DShadowMap::setCascadeCount(unsigned int count)
+    {
+        if (count < 1)
+            count = 1;
+        else if (count > MAX_CASCADES)
+            count = MAX_CASCADES;
+
+        if (count == _cascadeCount)
+            return;
+
+        _cascadeCount = count;
+        _dirty |= DIRTY_DIMENSION;
+        invalidateCascades();
+    }
+
+    void C3DShadowMap::setShadowDistance(float distance)
+    {
+        _shadowDistance = distance;
+        invalidateCascades();
+    }
+
+    void C3DShadowMap::setSplitLambda(float lambda)
+    {
+        _splitLambda = lambda;
+        invalidateCascades();
+    }
+
+    void C3DShadowMap::setCascadeUpdateInterval(unsigned int cascade, unsigned int frames)
+    {
+        CCAssert(cascade < MAX_CASCADES, "Invalid cascade");
+        _cascades[cascade].updateInterval = frames > 0 ? frames : 1;
+    }
+
+    unsigned int C3DShadowMap::getCascadeUpdateInterval(unsigned int cascade) const
+    {
+        CCAssert(cascade < MAX_CASCADES, "Invalid cascade");
+        return _cascades[cascade].updateInterval;
+    }
+
+    void C3DShadowMap::invalidateCascades()
+    {
+        for (unsigned int i = 0; i < MAX_CASCADES; i++)
+        {
+            _cascades[i].contentDirty = true;
+        }
+    }
+
+    bool C3DShadowMap::isCascadeDue(unsigned int cascade) const
+    {
+        const Cascade& c = _cascades[cascade];
+        if (c.contentDirty || c.reloadCount != _framebuffer->getReloadCount())
+            return true;
+
+        // the cascades sharing an interval are spread over its frames
+        return (_frame + cascade) % c.updateInterval == 0;
+    }
+
+    void C3DShadowMap::fitCascades(C3DCamera* camera)
+    {
+        ++_frame;
+
+        if (_cascadeCount == 1 || camera == NULL)
+            return;
+
+        if (_dirty)
+            updateMatrix();
+        const C3DMatrix& lightView = _viewMatrix;
+
+        float nearPlane = camera->getNearPlane();
+        float farPlane = camera->getFarPlane();
+        if (_shadowDistance > 0.0f && _shadowDistance < farPlane)
+            farPlane = _shadowDistance;
+
+        // split distances between the uniform and the logarithmic ones, and their window depth
+        const C3DMatrix& proj = camera->getProjectionMatrix();
+        float splits[MAX_CASCADES + 1];
+        float depths[MAX_CASCADES + 1];
+        for (unsigned int i = 0; i <= _cascadeCount; i++)
+        {
+            float p = (float)i / _cascadeCount;
+            float logSplit = nearPlane * powf(farPlane / nearPlane, p);
+            float uniformSplit = nearPlane + (farPlane - nearPlane) * p;
+            splits[i] = _splitLambda * logSplit + (1.0f - _splitLambda) * uniformSplit;
+
+            float z = proj.m[10] * -splits[i] + proj.m[14];
+            float w = proj.m[11] * -splits[i] + proj.m[15];
+            depths[i] = z / w;
+        }
+
+        float windowDepths[MAX_CASCADES];
+        for (unsigned int i = 0; i < MAX_CASCADES; i++)
+        {
+            windowDepths[i] = i < _cascadeCount ? depths[i + 1] * 0.5f + 0.5f : 2.0f;
+        }
+        _cascadeSplits.set(windowDepths[0], windowDepths[1], windowDepths[2], windowDepths[3]);
+
+        C3DMatrix invViewProj = camera->getViewProjectionMatrix();
+        invViewProj.invert();
+
+        unsigned int tileSize = std::min(_texWidth / 2, _cascadeCount > 2 ? _texHeight / 2 : _texHeight);
+
+        for (unsigned int i = 0; i < _cascadeCount; i++)
+        {
+            if (!isCascadeDue(i))
+                continue;
+
+            // corners of the slice in light view space
+            C3DVector3 corners[8];
+            C3DVector3 center(0.0f, 0.0f, 0.0f);
+            for (int k = 0; k < 8; k++)
+            {
+                C3DVector4 corner((k & 1) ? 1.0f : -1.0f, (k & 2) ? 1.0f : -1.0f, (k & 4) ? depths[i + 1] : depths[i], 1.0f);
+                invViewProj.transformVector(&corner);
+                lightView.transformPoint(C3DVector3(corner.x / corner.w, corner.y / corner.w, corner.z / corner.w), &corners[k]);
+                center += corners[k];
+            }
+            center *= 0.125f;
+
+            // the box is fitted to the bounding sphere of the slice so it keeps its size when the camera turns
+            float radius = 0.0f;
+            for (int k = 0; k < 8; k++)
+            {
+                float distance = corners[k].distance(center);
+                if (distance > radius)
+                    radius = distance;
+            }
+            radius = ceilf(radius * 16.0f) / 16.0f;
+
+            // the center moves by whole texels so the shadow edges do not shimmer when the camera moves
+            float texel = radius * 2.0f / tileSize;
+            center.x = floorf(center.x / texel) * texel;
+            center.y = floorf(center.y / texel) * texel;
+            // and toward the light by quarters of the radius, the far plane is pushed back by as much
+            center.z = ceilf(center.z / (radius * 0.25f)) * radius * 0.25f;
+
+            Cascade& c = _cascades[i];
+            if (c.center != center || c.radius != radius)
+            {
+                c.center = center;
+                c.radius = radius;
+                _dirty |= DIRTY_MATRIX;
+            }
+        }
+    }
+
+    const C3DFrustum& C3DShadowMap::getCasterFrustum(unsigned int cascade)
+    {
+        if (_dirty)
+            updateMatrix();
+        return _cascades[cascade].casterFrustum;
+    }
+
+    static unsigned int getCasterLevel(C3DNode* node, C3DCamera* camera)
     {
-        C3DMatrix viewMatrix = getWorldMatrix();
-        viewMatrix.invert();
+        C3DLODNode* lodNode = dynamic_cast<C3DLODNode*>(node);
+        return lodNode && camera ? lodNode->getShadowLevel(camera) : 0;
+    }
+
+    bool C3DShadowMap::updateCasters(unsigned int cascade, const std::vector<C3DNode*>& casters, C3DCamera* camera)
+    {
+        if (_dirty)
+            updateMatrix();
+
+        Cascade& c = _cascades[cascade];
+        bool redraw = c.contentDirty || _framebuffer->getReloadCount() != c.reloadCount || casters.size() != c.casters.size();
 
-        C3DMatrix projMatrix;
+        // the light looks down -z, the casters in front of the box have a depth above its near plane
+        const float* m = _viewMatrix.m;
+        float boxNear = _cascadeCount > 1 ? c.center.z + c.radius : 0.0f;
+        float nearest = 0.0f;
+        for (size_t i = 0; i < casters.size(); i++)
+        {
+            C3DNode* node = casters[i];
+            const C3DAABB* aabb = node->getAABB();
+            C3DVector3 center = (aabb->_min + aabb->_max) * 0.5f;
+            C3DVector3 extent = (aabb->_max - aabb->_min) * 0.5f;
+            float depth = m[2] * center.x + m[6] * center.y + m[10] * center.z + m[14]
+                + fabsf(m[2]) * extent.x + fabsf(m[6]) * extent.y + fabsf(m[10]) * extent.z - boxNear;
+            if (depth > nearest)
+                nearest = depth;
+
+            if (redraw)
+                continue;
+
+            if (node != c.casters[i] || memcmp(node->getWorldMatrix().m, c.casterWorlds[i].m, sizeof(c.casterWorlds[i].m)) != 0
+                || getCasterLevel(node, camera) != c.casterLevels[i])
+            {
+                redraw = true;
+            }
+            else if (node->getType() == C3DNode::NodeType_SuperModel)
+            {
+                // skinned casters change their shape without moving
+                C3DAnimation* animation = static_cast<C3DSprite*>(node)->getAnimation();
+                if (animation && animation->isPlaying())
+                    redraw = true;
+            }
+        }
+
+        // extended by steps of 1/8 of the depth, casters moving a bit keep the same projection
+        float step = (_cascadeCount > 1 ? c.radius * 2.0f : _dimension.z) * 0.125f;
+        float extension = nearest > 0.0f ? ceilf(nearest / step) * step : 0.0f;
+        if (extension != c.nearExtension)
+        {
+            c.nearExtension = extension;
+            updateMatrix();
+        }
 
-        C3DMatrix::createOrthographic(_dimension.x * 2, _dimension.y * 2, 0.0, _dimension.z, &projMatrix);
+        if (memcmp(c.viewProjMatrix.m, c.drawnViewProj.m, sizeof(c.drawnViewProj.m)) != 0)
+            redraw = true;
 
-        C3DMatrix::multiply(projMatrix, viewMatrix, &_viewProjMatrix);
+        if (!redraw)
+            return false;
+
+        c.casters = casters;
+        c.casterWorlds.resize(casters.size());
+        c.casterLevels.resize(casters.size());
+        for (size_t i = 0; i < casters.size(); i++)
+        {
+            c.casterWorlds[i] = casters[i]->getWorldMatrix();
+            c.casterLevels[i] = getCasterLevel(casters[i], camera);
+        }
+        c.drawnViewProj = c.viewProjMatrix;
+        c.contentDirty = false;
+        c.reloadCount = _framebuffer->getReloadCount();
+        return true;
+    }
+
+    void C3DShadowMap::updateMatrix()
+    {
+        _viewMatrix = getWorldMatrix();
+        _viewMatrix.invert();
 
         C3DMatrix texBiasMatrix(
             0.5f, 0, 0, 0.5f,
@@ -154,7 +432,60 @@ namespace cocos3d
             0, 0, 0, 1
             );
 
-        C3DMatrix::multiply(texBiasMatrix, _viewProjMatrix, &_textureMatrix);
+        unsigned int cols = _cascadeCount > 1 ? 2 : 1;
+        unsigned int rows = _cascadeCount > 2 ? 2 : 1;
+
+        C3DMatrix firstToTexture;
+        for (unsigned int i = 0; i < MAX_CASCADES; i++)
+        {
+            if (i >= _cascadeCount)
+            {
+                // lit everywhere, the shaders pick it beyond the last split
+                _cascadeScales[i].set(0.0f, 0.0f, 0.0f, 0.0f);
+                _cascadeOffsets[i].set(0.0f, 0.0f, -1.0f, 0.0f);
+                continue;
+            }
+
+            Cascade& c = _cascades[i];
+            C3DMatrix projMatrix;
+            if (_cascadeCount > 1)
+            {
+                C3DMatrix::createOrthographicOffCenter(c.center.x - c.radius, c.center.x + c.radius, c.center.y - c.radius, c.center.y + c.radius,
+                    -c.center.z - c.radius - c.nearExtension, -c.center.z + c.radius * 1.25f, &projMatrix);
+            }
+            else
+            {
+                C3DMatrix::createOrthographic(_dimension.x * 2, _dimension.y * 2, -c.nearExtension, _dimension.z, &projMatrix);
+            }
+
+            C3DMatrix::multiply(projMatrix, _viewMatrix, &c.viewProjMatrix);
+
+            // the cascade is drawn into its tile of the texture
+            C3DMatrix tileMatrix(
+                1.0f / cols, 0, 0, (float)(i % cols) / cols,
+                0, 1.0f / rows, 0, (float)(i / cols) / rows,
+                0, 0, 1, 0,
+                0, 0, 0, 1
+                );
+
+            C3DMatrix lightToTexture;
+            C3DMatrix::multiply(tileMatrix, texBiasMatrix, &lightToTexture);
+            C3DMatrix::multiply(lightToTexture, projMatrix, &lightToTexture);
+            C3DMatrix::multiply(lightToTexture, _viewMatrix, &c.textureMatrix);
+
+            // all orthographic along the same axes, the texture space of the first cascade maps to
+            // the others with a scale and an offset. it stays close to [0, 1] so mediump is enough
+            if (i == 0)
+                firstToTexture = lightToTexture;
+
+            C3DVector3 scale(lightToTexture.m[0] / firstToTexture.m[0], lightToTexture.m[5] / firstToTexture.m[5], lightToTexture.m[10] / firstToTexture.m[10]);
+            _cascadeScales[i].set(scale.x, scale.y, scale.z, 0.0f);
+            _cascadeOffsets[i].set(lightToTexture.m[12] - firstToTexture.m[12] * scale.x,
+                lightToTexture.m[13] - firstToTexture.m[13] * scale.y,
+                lightToTexture.m[14] - firstToTexture.m[14] * scale.z, 0.0f);
+
+            c.casterFrustum.initFrustum(c.viewProjMatrix);
+        }
 
         _dirty = 0;
     }
@@ -163,4 +494,4 @@ namespace cocos3d
     {
         return _sampler;
     }
-}
\ No newline at end of file
+}
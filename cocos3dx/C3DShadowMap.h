@@ -24,33 +24,116 @@ THE SOFTWARE.
 #define SHADOWMAP_H
 
 #include "C3DNode.h"
+#include "C3DFrustum.h"
+#include "C3DVector4.h"
 
 namespace cocos3d
 {
 class C3DFrameBuffer;
 class C3DTexture;
 class C3DSampler;
+class C3DCamera;
 
 /**
 *Defines the shadow map.
 *One model casts the shadow through rendering the depth of models into texture.
 *One model receive the shadow through compare the value between self depth and the depth from the depth textue.
+*
+*The map can be split into cascades fitted to the view of the camera, each one rendered into a tile of the texture.
 */
 class C3DShadowMap : public C3DNode
 {
 public:
 
+    enum
+    {
+        MAX_CASCADES = 4
+    };
+
     static C3DShadowMap* create(const std::string& id, unsigned int texWidth, unsigned int texHeight);
 
     C3DTexture* getDepthTexture() const;
     C3DSampler* getSampler() const;
+
+    /**
+     * Gets the view projection matrix of the cascade being drawn.
+     */
     const C3DMatrix& getViewProjectionMatrix();
+
+    /**
+     * Gets the texture matrix of the first cascade, the whole map when there is a single cascade.
+     */
     const C3DMatrix& getTextureMatrix();
     const C3DVector3& getDimension() const { return _dimension; }
     void setDimension(float width, float height, float depth);
-    bool beginDraw();
+
+    /**
+     * Sets the number of cascades, 1 to MAX_CASCADES. A single cascade covers the box of setDimension
+     * in front of the light. More cascades split the view of the camera up to the shadow distance,
+     * each one covering its slice with a tile of the texture.
+     */
+    void setCascadeCount(unsigned int count);
+    unsigned int getCascadeCount() const { return _cascadeCount; }
+
+    /**
+     * Sets the distance from the camera covered by the cascades, 0 for the far plane of the camera.
+     */
+    void setShadowDistance(float distance);
+    float getShadowDistance() const { return _shadowDistance; }
+
+    /**
+     * Sets the blend between uniform (0) and logarithmic (1) split distances, 0.75 by default.
+     */
+    void setSplitLambda(float lambda);
+    float getSplitLambda() const { return _splitLambda; }
+
+    /**
+     * Sets the number of frames between two updates of a cascade, 1 by default.
+     * Far cascades can be refitted and redrawn less often than the near ones.
+     */
+    void setCascadeUpdateInterval(unsigned int cascade, unsigned int frames);
+    unsigned int getCascadeUpdateInterval(unsigned int cascade) const;
+
+    /**
+     * Fits the cascades due this frame to the view of the camera, called once per frame before drawing.
+     */
+    void fitCascades(C3DCamera* camera);
+
+    /**
+     * Determines if the cascade is refitted and may be redrawn this frame.
+     */
+    bool isCascadeDue(unsigned int cascade) const;
+
+    /**
+     * Gets the volume of the cascade in world space, open toward the light so the casters
+     * in front of the light box are kept. Casters are culled against it.
+     */
+    const C3DFrustum& getCasterFrustum(unsigned int cascade = 0);
+
+    /**
+     * Sets the casters found in the caster frustum of the cascade and extends its box toward the
+     * light to contain them. Returns true when the cascade has to be redrawn: the light, the box or
+     * the set of casters changed, one of them moved, is animated or switched to another LOD level
+     * for the camera, or the frame buffer was reloaded.
+     */
+    bool updateCasters(unsigned int cascade, const std::vector<C3DNode*>& casters, C3DCamera* camera);
+
+    bool beginDraw(unsigned int cascade = 0);
     void endDraw();
 
+    /**
+     * Gets the window depths of the far end of the cascades, 2.0 for the unused ones.
+     */
+    const C3DVector4& getCascadeSplits() const { return _cascadeSplits; }
+
+    /**
+     * Gets the MAX_CASCADES scales and offsets from the texture space of the first cascade to the one
+     * of each cascade. Shaders defining SHADOWCASCADE pick the cascade with the split depths then map
+     * the coordinates given by the texture matrix with them.
+     */
+    const C3DVector4* getCascadeScales();
+    const C3DVector4* getCascadeOffsets();
+
     virtual void transformChanged();
 
     void updateMatrix();
@@ -62,14 +145,44 @@ private:
     C3DShadowMap(const std::string& id);
     virtual ~C3DShadowMap();
 
+    struct Cascade
+    {
+        Cascade();
+
+        C3DMatrix viewProjMatrix;
+        C3DMatrix textureMatrix;
+        C3DFrustum casterFrustum;
+        C3DVector3 center; // center of the fitted box in light view space
+        float radius; // half size of the fitted box
+        float nearExtension; // distance the box is extended toward the light
+        unsigned int updateInterval;
+        std::vector<C3DNode*> casters; // casters of the last draw
+        std::vector<C3DMatrix> casterWorlds; // and their world matrices
+        std::vector<unsigned int> casterLevels; // and the levels drawn for the LOD nodes, 0 for the others
+        C3DMatrix drawnViewProj; // view projection of the last draw
+        bool contentDirty;
+        unsigned int reloadCount;
+    };
+
+    void invalidateCascades();
+
     C3DFrameBuffer* _framebuffer;
-    C3DMatrix _viewProjMatrix;
-    C3DMatrix _textureMatrix;
+    C3DMatrix _viewMatrix;
     unsigned int _texWidth;
     unsigned int _texHeight;
     C3DVector3 _dimension;
     C3DSampler* _sampler;
     int _dirty;
+
+    Cascade _cascades[MAX_CASCADES];
+    unsigned int _cascadeCount;
+    unsigned int _drawCascade;
+    float _shadowDistance;
+    float _splitLambda;
+    unsigned int _frame;
+    C3DVector4 _cascadeSplits;
+    C3DVector4 _cascadeScales[MAX_CASCADES];
+    C3DVector4 _cascadeOffsets[MAX_CASCADES];
 };
 }
 
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "C3DMaterial.h"
 #include "BonePart.h"
 #include "C3DStat.h"
+#include "C3DStateCache.h"
 #include "C3DRenderSystem.h"
 
 namespace cocos3d
@@ -94,7 +95,7 @@ void C3DSkinModel::draw()
                 //applyShadowMap(pass);
 
                 pass->bind();
-                GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+                C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 				if (_wireframe && (_mesh->getPrimitiveType() == PrimitiveType_TRIANGLES || _mesh->getPrimitiveType() == PrimitiveType_TRIANGLE_STRIP))
 				{
@@ -139,7 +140,7 @@ void C3DSkinModel::draw()
 					applyInternalParam(pass);
 
                     pass->bind();
-                    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, C3DSubMesh->_indexBuffer) );
+                    C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, C3DSubMesh->_indexBuffer);
 
 					C3DMeshSkin * skin = this->getSkin();
 					if(skin != NULL)
@@ -182,7 +183,7 @@ void C3DSkinModel::draw()
 							}
 						}
 					}
-                    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+                    C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
                     pass->unbind();
                 }
             }
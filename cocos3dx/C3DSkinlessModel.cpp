@@ -27,9 +27,45 @@ THE SOFTWARE.
 #include "C3DPass.h"
 #include "C3DMaterial.h"
 #include "C3DStat.h"
+#include "C3DStateCache.h"
+#include "C3DEffect.h"
+#include "C3DDeviceAdapter.h"
 
 namespace cocos3d
 {
+// world matrices of the instances drawn by the current group, 3 rows of a 4x3 matrix each
+static GLuint __instanceBuffer = 0;
+static std::vector<C3DVector4> __instanceRows;
+
+static const char* __instanceRowNames[3] = { "a_instanceRow0", "a_instanceRow1", "a_instanceRow2" };
+
+// local lights are gathered per model, so only passes without them can be shared
+static bool isInstanceableMaterial(C3DMaterial* material)
+{
+	C3DTechnique* technique = material->getTechnique(C3DMaterial::TECH_USAGE_SCREEN);
+	if (technique == NULL)
+		return false;
+
+	for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+	{
+		C3DPass* pass = technique->getPass(i);
+		if (pass->getMaxPointLight() > 0 || pass->getMaxSpotLight() > 0 || pass->getMaxAnimLight() > 0)
+			return false;
+	}
+
+	return true;
+}
+
+// the instanced shaders use the world matrix as its inverse transpose
+static bool hasUniformScale(C3DNode* node)
+{
+	C3DVector3 scale;
+	node->getWorldMatrix().getScale(&scale);
+
+	float tolerance = 1e-4f * fabsf(scale.x);
+	return fabsf(scale.y - scale.x) <= tolerance && fabsf(scale.z - scale.x) <= tolerance;
+}
+
 C3DSkinlessModel::C3DSkinlessModel()
 {
 }
@@ -86,7 +122,7 @@ void C3DSkinlessModel::draw(void)
 				//applyShadowMap(pass);
 				applyInternalParam(pass);
 				pass->bind();
-				GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+				C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 				if (_wireframe && (_mesh->getPrimitiveType() == GL_TRIANGLES || _mesh->getPrimitiveType() == GL_TRIANGLE_STRIP))
 				{
 					unsigned int vertexCount = _mesh->getVertexCount();
@@ -130,7 +166,7 @@ void C3DSkinlessModel::draw(void)
 					//applyShadowMap(pass);
 					applyInternalParam(pass);
 					pass->bind();
-					GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh->getIndexBuffer()) );
+					C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh->getIndexBuffer());
 
 					// check whether show the wireframe
 					if (_wireframe && (_mesh->getPrimitiveType() == PrimitiveType_TRIANGLES || _mesh->getPrimitiveType() == PrimitiveType_TRIANGLE_STRIP))
@@ -166,5 +202,164 @@ void C3DSkinlessModel::draw(void)
 	}
 }
 
+bool C3DSkinlessModel::isInstanceable() const
+{
+	return _instancing && !_wireframe && _lodFade == 0.0f;
+}
+
+bool C3DSkinlessModel::canInstanceWith(C3DBaseModel* other)
+{
+	if (!isInstanceable() || _mesh == NULL || _node == NULL || _mesh->getSubMeshCount() == 0)
+		return false;
+
+	C3DSkinlessModel* model = dynamic_cast<C3DSkinlessModel*>(other);
+	if (model == NULL || model == this || model->_mesh != _mesh || model->_node == NULL || !model->isInstanceable())
+		return false;
+
+	if (model->_lodFade != _lodFade || !hasUniformScale(_node) || !hasUniformScale(model->_node))
+		return false;
+
+	for (unsigned int i = 0, partCount = _mesh->getSubMeshCount(); i < partCount; ++i)
+	{
+		C3DMaterial* material = getMaterial(i);
+		C3DMaterial* otherMaterial = model->getMaterial(i);
+		if (material == NULL || otherMaterial == NULL)
+			return false;
+
+		if (material == otherMaterial)
+			continue;
+
+		// clones of the same material, the instances only differ by their node bound parameters
+		if (material->getSortId() != otherMaterial->getSortId() || !isInstanceableMaterial(material))
+			return false;
+
+		C3DTechnique* technique = material->getTechnique(C3DMaterial::TECH_USAGE_SCREEN);
+		C3DTechnique* otherTechnique = otherMaterial->getTechnique(C3DMaterial::TECH_USAGE_SCREEN);
+		if (otherTechnique == NULL || technique->getPassCount() != otherTechnique->getPassCount())
+			return false;
+
+		for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
+		{
+			if (technique->getPass(j)->getParameterHash() != otherTechnique->getPass(j)->getParameterHash())
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void C3DSkinlessModel::drawInstances(C3DBaseModel** models, unsigned int count)
+{
+	bool hardware = C3DDeviceAdapter::getInstance()->isSupportInstancing();
+	if (hardware)
+	{
+		__instanceRows.resize(count * 3);
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const C3DMatrix& m = static_cast<C3DSkinlessModel*>(models[i])->_node->getWorldMatrix();
+			__instanceRows[i * 3 + 0].set(m.m[0], m.m[4], m.m[8], m.m[12]);
+			__instanceRows[i * 3 + 1].set(m.m[1], m.m[5], m.m[9], m.m[13]);
+			__instanceRows[i * 3 + 2].set(m.m[2], m.m[6], m.m[10], m.m[14]);
+		}
+
+		if (__instanceBuffer == 0)
+		{
+			GL_ASSERT( glGenBuffers(1, &__instanceBuffer) );
+		}
+
+		// new storage each group, the previous one may still be in use by the GPU
+		C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, __instanceBuffer);
+		GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, sizeof(C3DVector4) * __instanceRows.size(), &__instanceRows[0], GL_STREAM_DRAW) );
+	}
 
-}
\ No newline at end of file
+	for (unsigned int i = 0, partCount = _mesh->getSubMeshCount(); i < partCount; ++i)
+	{
+		C3DMaterial* material = getMaterial(i);
+		C3DSubMesh* subMesh = _mesh->getSubMesh(i);
+		C3DTechnique* technique = material->getTechnique(C3DMaterial::TECH_USAGE_SCREEN);
+		unsigned int passCount = technique->getPassCount();
+
+		for (unsigned int j = 0; j < passCount; ++j)
+		{
+			STAT_INC_TRIANGLE_DRAW(subMesh->getTriangleCount() * count);
+
+			C3DPass* pass = technique->getPass(j);
+			applyInternalParam(pass);
+
+			if (hardware && pass->getInstancedEffect())
+			{
+				STAT_INC_DRAW_CALL(1);
+
+				drawInstanced(pass, subMesh, count);
+			}
+			else
+			{
+				STAT_INC_DRAW_CALL(count);
+
+				// the program, vertex and index buffers are bound once, every parameter of each instance is bound again
+				pass->bind();
+				C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh->getIndexBuffer());
+				for (unsigned int k = 0; k < count; ++k)
+				{
+					if (k > 0)
+					{
+						C3DSkinlessModel* model = static_cast<C3DSkinlessModel*>(models[k]);
+						C3DPass* instancePass = model->getMaterial(i)->getTechnique(C3DMaterial::TECH_USAGE_SCREEN)->getPass(j);
+						model->applyInternalParam(instancePass);
+						instancePass->bindParameters(pass->getEffect());
+					}
+
+					GL_ASSERT( glDrawElements(subMesh->getPrimitiveType(), subMesh->getIndexCount(), subMesh->getIndexFormat(), 0) );
+				}
+				pass->unbind();
+			}
+		}
+	}
+}
+
+void C3DSkinlessModel::drawInstanced(C3DPass* pass, C3DSubMesh* subMesh, unsigned int count)
+{
+	C3DEffect* effect = pass->getInstancedEffect();
+	pass->bindInstanced(_mesh);
+
+	// the instanced shader builds its world matrices from the instance rows
+	Uniform* uniform = effect->getUniform("u_viewProjectionMatrix");
+	if (uniform)
+		effect->bindValue(uniform, _node->getViewProjectionMatrix());
+	uniform = effect->getUniform("u_viewMatrix");
+	if (uniform)
+		effect->bindValue(uniform, _node->getViewMatrix());
+
+	VertexAttribute attribs[3];
+	C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, __instanceBuffer);
+	for (int r = 0; r < 3; ++r)
+	{
+		attribs[r] = effect->getVertexAttribute(__instanceRowNames[r]);
+		if (attribs[r] == -1)
+			continue;
+
+		GL_ASSERT( glEnableVertexAttribArray(attribs[r]) );
+		GL_ASSERT( glVertexAttribPointer(attribs[r], 4, GL_FLOAT, GL_FALSE, sizeof(C3DVector4) * 3, (const GLvoid*)(sizeof(C3DVector4) * r)) );
+		GL_ASSERT( glVertexAttribDivisor(attribs[r], 1) );
+	}
+
+	C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh->getIndexBuffer());
+	GL_ASSERT( glDrawElementsInstanced(subMesh->getPrimitiveType(), subMesh->getIndexCount(), subMesh->getIndexFormat(), 0, count) );
+
+	for (int r = 0; r < 3; ++r)
+	{
+		if (attribs[r] == -1)
+			continue;
+
+		GL_ASSERT( glVertexAttribDivisor(attribs[r], 0) );
+		GL_ASSERT( glDisableVertexAttribArray(attribs[r]) );
+	}
+
+	pass->unbindInstanced();
+}
+
+void C3DSkinlessModel::resetInstanceBuffer()
+{
+	__instanceBuffer = 0;
+}
+}
@@ -28,6 +28,8 @@ THE SOFTWARE.
 
 namespace cocos3d
 {
+class C3DSubMesh;
+
 /**
  * Defines a model which doesn't have skin mesh.
  */
@@ -58,6 +60,33 @@ public:
     */
 	virtual void draw(void);
 
+	/**
+	 * Models of the same type sharing the mesh and clones of the same materials with the
+	 * same parameter values are drawn as a group: one instanced draw per pass when the device
+	 * supports instancing and the shader has an INSTANCING path, otherwise one program and
+	 * buffer bind for the group with the parameters bound again per instance. Passes with
+	 * local lights are not grouped, those lights are gathered per model, nor are nodes with
+	 * a non uniform scale.
+	 */
+	virtual bool canInstanceWith(C3DBaseModel* other);
+	virtual void drawInstances(C3DBaseModel** models, unsigned int count);
+
+	/**
+	 * forget the instance buffer, the GL context was lost
+	 */
+	static void resetInstanceBuffer();
+
+protected:
+
+	/**
+	 * whether this kind of model can be drawn instanced at all
+	 */
+	virtual bool isInstanceable() const;
+
+private:
+
+	void drawInstanced(C3DPass* pass, C3DSubMesh* subMesh, unsigned int count);
+
 
 };
 
@@ -52,6 +52,9 @@ public:
 protected:
 	virtual void copyFrom(const C3DSkinlessMorphModel* other);
 
+	// the morph targets are applied per model
+	virtual bool isInstanceable() const { return false; }
+
 private:
 	 C3DMorph* _morph;
 };
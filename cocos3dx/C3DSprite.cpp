@@ -179,8 +179,7 @@ void C3DSprite::update(long elapsedTime)
     if(!isActive())
         return;
     
-	getAABB();
-	_visible = _scene->getActiveCamera()->isVisible(*_bb);
+	updateVisibility();
 
     if (!isVisible())
         return;
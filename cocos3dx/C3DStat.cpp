@@ -24,10 +24,11 @@ THE SOFTWARE.
 #include "cocos3d.h"
 #include "cocos2d.h"
 #include "C3DStat.h"
+#include "C3DProfile.h"
 
 namespace cocos3d
 {
-    C3DStat::C3DStat():_nTriangleDraw(0), _nTriangleTotal(0), _nDrawCall(0), _bStart(false), _bEnable(true)
+    C3DStat::C3DStat():_nTriangleDraw(0), _nTriangleTotal(0), _nDrawCall(0), _nUniformIssued(0), _nUniformSkipped(0), _nStateIssued(0), _nStateElided(0), _profileStats(NULL), _profileStatCount(0), _bStart(false), _bEnable(true)
     {
     }
 
@@ -47,6 +48,10 @@ namespace cocos3d
         _nTriangleDraw = 0;
         _nTriangleTotal = 0;
         _nDrawCall = 0;
+        _nUniformIssued = 0;
+        _nUniformSkipped = 0;
+        _nStateIssued = 0;
+        _nStateElided = 0;
         _bStart = _bEnable;
     }
 
@@ -78,20 +83,33 @@ C3DStatRender::C3DStatRender(cocos2d::CCNode* parent, float statfont):_parent(pa
 	_TriangleDrawLabel = cocos2d::CCLabelTTF::create("draw triangles: ", "Arial", _fontSize);
 	_TriangleTotalLabel = cocos2d::CCLabelTTF::create("total triangles: ", "Arial", _fontSize);
 	_DrawCallLabel = cocos2d::CCLabelTTF::create("draw call: ", "Arial", _fontSize);
+	_UniformLabel = cocos2d::CCLabelTTF::create("uniforms: ", "Arial", _fontSize);
+	_StateLabel = cocos2d::CCLabelTTF::create("states: ", "Arial", _fontSize);
+	_ProfileLabel = cocos2d::CCLabelTTF::create("", "Arial", _fontSize);
+	_ProfileLabel->setAnchorPoint(cocos2d::CCPoint(0.5f, 1.0f));
 
 	_parent->addChild(_TriangleDrawLabel);
 	_parent->addChild(_TriangleTotalLabel);
 	_parent->addChild(_DrawCallLabel);
+	_parent->addChild(_UniformLabel);
+	_parent->addChild(_StateLabel);
+	_parent->addChild(_ProfileLabel);
 
 	_TriangleDrawLabel->retain();
 	_TriangleTotalLabel->retain();
 	_DrawCallLabel->retain();
+	_UniformLabel->retain();
+	_StateLabel->retain();
+	_ProfileLabel->retain();
 
 	cocos2d::CCSize size = _parent->getContentSize();
 	setStatLabelPos(cocos2d::CCPoint(size.width*0.5f - _fontSize * 10, size.height*0.5f - _fontSize * 3));
 }
 C3DStatRender::~C3DStatRender()
 {
+	SAFE_RELEASE(_ProfileLabel);
+	SAFE_RELEASE(_StateLabel);
+	SAFE_RELEASE(_UniformLabel);
 	SAFE_RELEASE(_DrawCallLabel);
 	SAFE_RELEASE(_TriangleTotalLabel);
 	SAFE_RELEASE(_TriangleDrawLabel);
@@ -101,6 +119,9 @@ void C3DStatRender::setStatLabelPos(const cocos2d::CCPoint& point)
 {
 	cocos2d::CCPoint pt = point;
 	_DrawCallLabel->setPosition(pt);
+	_UniformLabel->setPosition(cocos2d::CCPoint(pt.x, pt.y - _fontSize));
+	_StateLabel->setPosition(cocos2d::CCPoint(pt.x, pt.y - _fontSize * 2));
+	_ProfileLabel->setPosition(cocos2d::CCPoint(pt.x, pt.y - _fontSize * 3));
 	pt.y += _fontSize;
 	_TriangleDrawLabel->setPosition(pt);
 	pt.y += _fontSize;
@@ -114,6 +135,9 @@ void C3DStatRender::setStatFont(float fontsize)
 	_TriangleDrawLabel->setFontSize(fontsize);
 	_TriangleTotalLabel->setFontSize(fontsize);
 	_DrawCallLabel->setFontSize(fontsize);
+	_UniformLabel->setFontSize(fontsize);
+	_StateLabel->setFontSize(fontsize);
+	_ProfileLabel->setFontSize(fontsize);
 }
 
 void C3DStatRender::update(long elapsedTime)
@@ -126,6 +150,9 @@ void C3DStatRender::update(long elapsedTime)
 			_TriangleDrawLabel->setVisible(false);
 			_TriangleTotalLabel->setVisible(false);
 			_DrawCallLabel->setVisible(false);
+			_UniformLabel->setVisible(false);
+			_StateLabel->setVisible(false);
+			_ProfileLabel->setVisible(false);
 		}
 		return;
 	}
@@ -135,6 +162,9 @@ void C3DStatRender::update(long elapsedTime)
 		_TriangleDrawLabel->setVisible(true);
 		_TriangleTotalLabel->setVisible(true);
 		_DrawCallLabel->setVisible(true);
+		_UniformLabel->setVisible(true);
+		_StateLabel->setVisible(true);
+		_ProfileLabel->setVisible(true);
 	}
 
 	_UpdateIntervalAcc += elapsedTime;
@@ -145,10 +175,26 @@ void C3DStatRender::update(long elapsedTime)
 		char str[128];
 		sprintf(str, "draw call: %d", statInstance->getDrawCall());
 		_DrawCallLabel->setString(str);
+		sprintf(str, "uniforms: %d issued, %d skipped", statInstance->getUniformIssued(), statInstance->getUniformSkipped());
+		_UniformLabel->setString(str);
+		sprintf(str, "states: %d issued, %d elided", statInstance->getStateIssued(), statInstance->getStateElided());
+		_StateLabel->setString(str);
 		sprintf(str, "draw triangles: %d", statInstance->getTriangleDraw());
 		_TriangleDrawLabel->setString(str);
 		sprintf(str, "total triangles: %d", statInstance->getTriangleTotal());
 		_TriangleTotalLabel->setString(str);
+
+		// frame time of the top level profile markers
+		std::string profile;
+		const C3DProfileMarkerStat* stats = statInstance->getProfileStats();
+		for (unsigned int i = 0; i < statInstance->getProfileStatCount(); i++)
+		{
+			if (stats[i].calls == 0 || stats[i].depth > 1)
+				continue;
+			sprintf(str, "%s: %.2f ms\n", stats[i].name, stats[i].frameTime);
+			profile += str;
+		}
+		_ProfileLabel->setString(profile.c_str());
 	}
 }
 
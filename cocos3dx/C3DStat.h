@@ -29,6 +29,8 @@ THE SOFTWARE.
 
 namespace cocos3d
 {
+    struct C3DProfileMarkerStat;
+
     /**
      *  class for statistic the 3D scene
 	 *  stat the total triangles, drawing triangles, and draw calls
@@ -69,6 +71,18 @@ namespace cocos3d
          */
         void incDrawCall(int nDrawCall) { if (_bStart) _nDrawCall += nDrawCall; }
 
+		/**
+         * add uniform uploads issued to GL & skipped because the program already holds the value
+         */
+        void incUniformIssued(int nUniform) { if (_bStart) _nUniformIssued += nUniform; }
+        void incUniformSkipped(int nUniform) { if (_bStart) _nUniformSkipped += nUniform; }
+
+		/**
+         * add GL state changes issued & elided by C3DStateCache
+         */
+        void incStateIssued(int nState) { if (_bStart) _nStateIssued += nState; }
+        void incStateElided(int nState) { if (_bStart) _nStateElided += nState; }
+
 		/**
          * get & set stat enable
          */
@@ -87,6 +101,23 @@ namespace cocos3d
          * get draw calls
          */
         int getDrawCall() const { return _nDrawCall; }
+		/**
+         * get uniform uploads issued & skipped
+         */
+        int getUniformIssued() const { return _nUniformIssued; }
+        int getUniformSkipped() const { return _nUniformSkipped; }
+		/**
+         * get GL state changes issued & elided
+         */
+        int getStateIssued() const { return _nStateIssued; }
+        int getStateElided() const { return _nStateElided; }
+
+		/**
+         * get & set profile stats of last frame, set by C3DProfile
+         */
+        void setProfileStats(const C3DProfileMarkerStat* stats, unsigned int count) { _profileStats = stats; _profileStatCount = count; }
+        const C3DProfileMarkerStat* getProfileStats() const { return _profileStats; }
+        unsigned int getProfileStatCount() const { return _profileStatCount; }
 
     protected:
 		/**
@@ -102,6 +133,17 @@ namespace cocos3d
 
         int _nDrawCall;
 
+        int _nUniformIssued;
+
+        int _nUniformSkipped;
+
+        int _nStateIssued;
+
+        int _nStateElided;
+
+        const C3DProfileMarkerStat* _profileStats;
+        unsigned int _profileStatCount;
+
         bool _bStart; // start stat
 
         bool _bEnable; // enable stat or not
@@ -132,6 +174,9 @@ namespace cocos3d
 		cocos2d::LabelTTF* _TriangleDrawLabel;
 		cocos2d::LabelTTF* _TriangleTotalLabel;
 		cocos2d::LabelTTF* _DrawCallLabel;
+		cocos2d::LabelTTF* _UniformLabel;
+		cocos2d::LabelTTF* _StateLabel;
+		cocos2d::LabelTTF* _ProfileLabel;
 		float _fontSize;
 
 		cocos2d::Node* _parent;
@@ -161,6 +206,30 @@ namespace cocos3d
 	{\
 	C3DStat::getInstance()->incDrawCall(val);\
 	}
+
+#define STAT_INC_UNIFORM_ISSUED(val)\
+	if (C3DStat::getInstance()->isStatEnable())\
+	{\
+	C3DStat::getInstance()->incUniformIssued(val);\
+	}
+
+#define STAT_INC_UNIFORM_SKIPPED(val)\
+	if (C3DStat::getInstance()->isStatEnable())\
+	{\
+	C3DStat::getInstance()->incUniformSkipped(val);\
+	}
+
+#define STAT_INC_STATE_ISSUED(val)\
+	if (C3DStat::getInstance()->isStatEnable())\
+	{\
+	C3DStat::getInstance()->incStateIssued(val);\
+	}
+
+#define STAT_INC_STATE_ELIDED(val)\
+	if (C3DStat::getInstance()->isStatEnable())\
+	{\
+	C3DStat::getInstance()->incStateElided(val);\
+	}
 #else
 #define STAT_BEGIN()
 #define STAT_END()
@@ -168,6 +237,10 @@ namespace cocos3d
 #define STAT_INC_TRIANGLE_TOTAL(val)
 #define STAT_INC_TRIANGLE_DRAW(val)
 #define STAT_INC_DRAW_CALL(val)
+#define STAT_INC_UNIFORM_ISSUED(val)
+#define STAT_INC_UNIFORM_SKIPPED(val)
+#define STAT_INC_STATE_ISSUED(val)
+#define STAT_INC_STATE_ELIDED(val)
 #endif
 }
 
@@ -0,0 +1,258 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "Base.h"
+#include "C3DStateCache.h"
+#include "C3DStat.h"
+
+// texture units tracked by the cache, binds on higher units are always issued
+#define MAX_CACHED_TEXTURE_UNITS 16
+
+#define STATE_UNKNOWN 0xffffffff
+
+namespace cocos3d
+{
+enum
+{
+    STATE_BLEND = 0,
+    STATE_CULL_FACE,
+    STATE_DEPTH_TEST,
+    STATE_CAP_COUNT
+};
+
+static struct
+{
+    GLuint program;
+    GLuint caps[STATE_CAP_COUNT];
+    GLuint depthMask;
+    GLuint blendSrc;
+    GLuint blendDst;
+    GLuint activeTexture;
+    GLuint textures2D[MAX_CACHED_TEXTURE_UNITS];
+    GLuint texturesCube[MAX_CACHED_TEXTURE_UNITS];
+    GLuint arrayBuffer;
+    GLuint elementBuffer;
+    GLuint vertexArray;
+} __state;
+
+static bool __stateValid = false;
+
+// returns true if the call must be issued, and records the new value
+static bool changeState(GLuint& current, GLuint value)
+{
+    if (current == value)
+    {
+        STAT_INC_STATE_ELIDED(1);
+        return false;
+    }
+
+    current = value;
+    STAT_INC_STATE_ISSUED(1);
+    return true;
+}
+
+static void validate()
+{
+    if (!__stateValid)
+        C3DStateCache::invalidate();
+}
+
+static GLuint* getTextureSlot(GLenum target)
+{
+    unsigned int unit = __state.activeTexture - GL_TEXTURE0;
+    if (__state.activeTexture == STATE_UNKNOWN || unit >= MAX_CACHED_TEXTURE_UNITS)
+        return NULL;
+
+    if (target == GL_TEXTURE_2D)
+        return &__state.textures2D[unit];
+    if (target == GL_TEXTURE_CUBE_MAP)
+        return &__state.texturesCube[unit];
+    return NULL;
+}
+
+void C3DStateCache::invalidate()
+{
+    memset(&__state, 0xff, sizeof(__state));
+    __stateValid = true;
+}
+
+void C3DStateCache::useProgram(GLuint program)
+{
+    validate();
+    if (changeState(__state.program, program))
+        GL_ASSERT( glUseProgram(program) );
+}
+
+void C3DStateCache::setEnabled(GLenum cap, bool enabled)
+{
+    validate();
+
+    int index;
+    switch (cap)
+    {
+    case GL_BLEND:
+        index = STATE_BLEND;
+        break;
+    case GL_CULL_FACE:
+        index = STATE_CULL_FACE;
+        break;
+    case GL_DEPTH_TEST:
+        index = STATE_DEPTH_TEST;
+        break;
+    default:
+        STAT_INC_STATE_ISSUED(1);
+        if (enabled)
+            glEnable(cap);
+        else
+            glDisable(cap);
+        return;
+    }
+
+    if (changeState(__state.caps[index], enabled ? 1 : 0))
+    {
+        if (enabled)
+            glEnable(cap);
+        else
+            glDisable(cap);
+    }
+}
+
+void C3DStateCache::depthMask(bool enabled)
+{
+    validate();
+    if (changeState(__state.depthMask, enabled ? 1 : 0))
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void C3DStateCache::blendFunc(GLenum src, GLenum dst)
+{
+    validate();
+    if (__state.blendSrc == src && __state.blendDst == dst)
+    {
+        STAT_INC_STATE_ELIDED(1);
+        return;
+    }
+
+    __state.blendSrc = src;
+    __state.blendDst = dst;
+    STAT_INC_STATE_ISSUED(1);
+    glBlendFunc(src, dst);
+}
+
+void C3DStateCache::activeTexture(GLenum unit)
+{
+    validate();
+    if (changeState(__state.activeTexture, unit))
+        GL_ASSERT( glActiveTexture(unit) );
+}
+
+void C3DStateCache::bindTexture(GLenum target, GLuint texture)
+{
+    validate();
+    GLuint* slot = getTextureSlot(target);
+    if (slot == NULL)
+    {
+        STAT_INC_STATE_ISSUED(1);
+        GL_ASSERT( glBindTexture(target, texture) );
+        return;
+    }
+
+    if (changeState(*slot, texture))
+        GL_ASSERT( glBindTexture(target, texture) );
+}
+
+void C3DStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    validate();
+    GLuint* slot = NULL;
+    if (target == GL_ARRAY_BUFFER)
+        slot = &__state.arrayBuffer;
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+        slot = &__state.elementBuffer;
+
+    if (slot == NULL)
+    {
+        STAT_INC_STATE_ISSUED(1);
+        GL_ASSERT( glBindBuffer(target, buffer) );
+        return;
+    }
+
+    if (changeState(*slot, buffer))
+        GL_ASSERT( glBindBuffer(target, buffer) );
+}
+
+void C3DStateCache::bindVertexArray(GLuint vertexArray)
+{
+    validate();
+    if (changeState(__state.vertexArray, vertexArray))
+    {
+        GL_ASSERT( glBindVertexArray(vertexArray) );
+
+        // the element buffer binding is part of the vertex array state
+        __state.elementBuffer = STATE_UNKNOWN;
+    }
+}
+
+void C3DStateCache::deleteProgram(GLuint program)
+{
+    if (__state.program == program)
+        __state.program = STATE_UNKNOWN;
+
+    GL_ASSERT( glDeleteProgram(program) );
+}
+
+void C3DStateCache::deleteTexture(GLuint texture)
+{
+    for (int i = 0; i < MAX_CACHED_TEXTURE_UNITS; i++)
+    {
+        if (__state.textures2D[i] == texture)
+            __state.textures2D[i] = 0;
+        if (__state.texturesCube[i] == texture)
+            __state.texturesCube[i] = 0;
+    }
+
+    GL_ASSERT( glDeleteTextures(1, &texture) );
+}
+
+void C3DStateCache::deleteBuffer(GLuint buffer)
+{
+    if (__state.arrayBuffer == buffer)
+        __state.arrayBuffer = 0;
+    if (__state.elementBuffer == buffer)
+        __state.elementBuffer = 0;
+
+    glDeleteBuffers(1, &buffer);
+}
+
+void C3DStateCache::deleteVertexArray(GLuint vertexArray)
+{
+    if (__state.vertexArray == vertexArray)
+    {
+        __state.vertexArray = 0;
+        __state.elementBuffer = STATE_UNKNOWN;
+    }
+
+    glDeleteVertexArrays(1, &vertexArray);
+}
+
+}
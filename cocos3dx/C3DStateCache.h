@@ -0,0 +1,85 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef C3DSTATECACHE_H_
+#define C3DSTATECACHE_H_
+
+#include "Base.h"
+
+namespace cocos3d
+{
+
+/**
+ * Shadow copy of the GL state touched by the 3D renderer.
+ *
+ * Every state change of the renderer (program, blend, depth, cull, texture units,
+ * buffers and vertex arrays) goes through this class, which only forwards the calls
+ * that change something. The cache does not know about GL calls made behind its back,
+ * so it must be invalidated whenever someone else (cocos2d) has been rendering.
+ */
+class C3DStateCache
+{
+public:
+
+    /**
+     * Forgets all the cached state, the next change of each state is always issued.
+     */
+    static void invalidate();
+
+    static void useProgram(GLuint program);
+
+    /**
+     * Enables or disables GL_BLEND, GL_CULL_FACE or GL_DEPTH_TEST.
+     */
+    static void setEnabled(GLenum cap, bool enabled);
+
+    static void depthMask(bool enabled);
+    static void blendFunc(GLenum src, GLenum dst);
+
+    static void activeTexture(GLenum unit);
+
+    /**
+     * Binds texture to GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP of the active texture unit.
+     */
+    static void bindTexture(GLenum target, GLuint texture);
+
+    /**
+     * Binds buffer to GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+     */
+    static void bindBuffer(GLenum target, GLuint buffer);
+
+    static void bindVertexArray(GLuint vertexArray);
+
+    /**
+     * Deletes GL objects. GL unbinds a deleted object everywhere and may give its name
+     * to the next object created, so deletions must go through the cache as well.
+     */
+    static void deleteProgram(GLuint program);
+    static void deleteTexture(GLuint texture);
+    static void deleteBuffer(GLuint buffer);
+    static void deleteVertexArray(GLuint vertexArray);
+};
+
+}
+
+#endif
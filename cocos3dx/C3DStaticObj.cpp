@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "C3DSkinModel.h"
 #include "C3DBone.h"
 #include "C3DModelNode.h"
+#include "C3DElementNode.h"
+#include "C3DOcclusionBuffer.h"
 namespace cocos3d
 {
 C3DStaticObj* C3DStaticObj::create(const std::string& id)
@@ -44,7 +46,7 @@ C3DStaticObj* C3DStaticObj::create(const std::string& id)
     return pRet;
 }
 
-C3DStaticObj::C3DStaticObj(const std::string& id):C3DRenderNode(id)
+C3DStaticObj::C3DStaticObj(const std::string& id):C3DRenderNode(id), _occluder(false)
 {
 }
 
@@ -121,6 +123,10 @@ void C3DStaticObj::copyFrom(const C3DTransform* other, C3DNode::CloneContext& co
 			m_collitionBoxs.push_back(pMyCbb);
 		}
 	}
+
+	_occluder = otherNode->_occluder;
+	_occluderPositions = otherNode->_occluderPositions;
+	_occluderIndices = otherNode->_occluderIndices;
 }
 
 C3DNode* C3DStaticObj::clone(C3DNode::CloneContext& context) const
@@ -133,4 +139,88 @@ C3DNode* C3DStaticObj::clone(C3DNode::CloneContext& context) const
 	other->autorelease();
 	return other;
 }
-}
\ No newline at end of file
+
+void C3DStaticObj::setOccluder(bool occluder)
+{
+	_occluder = occluder;
+}
+
+bool C3DStaticObj::isOccluder() const
+{
+	return _occluder;
+}
+
+void C3DStaticObj::setOccluderMesh(const std::vector<C3DVector3>& positions, const std::vector<unsigned short>& indices)
+{
+	_occluderPositions = positions;
+	_occluderIndices = indices;
+}
+
+void C3DStaticObj::addOccluderBox(const C3DAABB& box)
+{
+	// corner i has the max x when bit 0 is set, the max y for bit 1 and the max z for bit 2
+	static const unsigned short faces[36] =
+	{
+		0, 4, 6, 0, 6, 2, // -x
+		1, 3, 7, 1, 7, 5, // +x
+		0, 1, 5, 0, 5, 4, // -y
+		2, 6, 7, 2, 7, 3, // +y
+		0, 2, 3, 0, 3, 1, // -z
+		4, 5, 7, 4, 7, 6, // +z
+	};
+
+	unsigned short first = (unsigned short)_occluderPositions.size();
+	for (int i = 0; i < 8; i++)
+	{
+		_occluderPositions.push_back(C3DVector3(i & 1 ? box._max.x : box._min.x,
+		                                        i & 2 ? box._max.y : box._min.y,
+		                                        i & 4 ? box._max.z : box._min.z));
+	}
+	for (int i = 0; i < 36; i++)
+	{
+		_occluderIndices.push_back(first + faces[i]);
+	}
+}
+
+bool C3DStaticObj::loadOccluder(const std::string& fileName)
+{
+	C3DElementNode* root = C3DElementNode::create(fileName.c_str());
+	if (!root)
+		return false;
+
+	C3DElementNode* occluderNode = root->getNextChild();
+	if (!occluderNode || occluderNode->getNodeType() != "occluder")
+	{
+		SAFE_DELETE(root);
+		return false;
+	}
+
+	_occluderPositions.clear();
+	_occluderIndices.clear();
+
+	C3DElementNode* boxNode = NULL;
+	while ((boxNode = occluderNode->getNextChild()))
+	{
+		if (boxNode->getNodeType() != "box")
+			continue;
+
+		C3DAABB box;
+		boxNode->getElement("min", &box._min);
+		boxNode->getElement("max", &box._max);
+		addOccluderBox(box);
+	}
+	SAFE_DELETE(root);
+
+	_occluder = !_occluderIndices.empty();
+	return true;
+}
+
+void C3DStaticObj::rasterizeOccluder(C3DOcclusionBuffer* buffer)
+{
+	if (_occluderIndices.empty())
+		return;
+
+	buffer->addOccluder(getWorldMatrix(), &_occluderPositions[0], _occluderPositions.size(),
+	                    &_occluderIndices[0], _occluderIndices.size());
+}
+}
@@ -31,6 +31,7 @@ class C3DMaterial;
 class C3DScene;
 class C3DNode;
 class MeshBatch;
+class C3DOcclusionBuffer;
 
 /**
 *Defines this static object of the scene,which can change material.
@@ -48,6 +49,45 @@ public:
 
 	virtual void copyFrom(const C3DTransform* other, C3DNode::CloneContext& context);
 	virtual C3DNode* clone(CloneContext& context) const;
+
+	/**
+	 * Sets whether the object hides the ones behind it when the scene culls the occluded nodes.
+	 * An occluder is drawn into the occlusion buffer with its occluder mesh, which must stay
+	 * inside the object, and is never culled by the other occluders.
+	 */
+	void setOccluder(bool occluder);
+	bool isOccluder() const;
+
+	/**
+	 * Sets the occluder mesh in the space of the object, the indices are counter clockwise triangles.
+	 */
+	void setOccluderMesh(const std::vector<C3DVector3>& positions, const std::vector<unsigned short>& indices);
+
+	/**
+	 * Adds a box to the occluder mesh, in the space of the object.
+	 */
+	void addOccluderBox(const C3DAABB& box);
+
+	/**
+	 * Loads the occluder boxes of the object, the file looks like
+	 *
+	 * occluder
+	 * {
+	 *     box
+	 *     {
+	 *         min = -1, 0, -1
+	 *         max = 1, 2, 1
+	 *     }
+	 * }
+	 *
+	 * and makes the object an occluder.
+	 */
+	bool loadOccluder(const std::string& fileName);
+
+	/**
+	 * Draws the occluder mesh into the buffer with the world matrix of the object.
+	 */
+	void rasterizeOccluder(C3DOcclusionBuffer* buffer);
 protected:
 	static C3DStaticObj* create(const std::string& id);
 
@@ -55,6 +95,10 @@ private:
 
     C3DStaticObj(const std::string& id);
     ~C3DStaticObj();
+
+	bool _occluder;
+	std::vector<C3DVector3> _occluderPositions;
+	std::vector<unsigned short> _occluderIndices;
 };
 }
 
@@ -23,6 +23,13 @@ THE SOFTWARE.
 #include "C3DStream.h"
 #include "cocos2d.h"
 
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace cocos3d
 {
 #if defined(__ANDROID__)
@@ -37,6 +44,10 @@ PFNGLBINDVERTEXARRAYOESPROC glBindVertexArray = NULL;
 PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArrays = NULL;
 PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays = NULL;
 PFNGLISVERTEXARRAYOESPROC glIsVertexArray = NULL;
+PFNC3DDRAWELEMENTSINSTANCEDPROC glDrawElementsInstanced = NULL;
+PFNC3DVERTEXATTRIBDIVISORPROC glVertexAttribDivisor = NULL;
+PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYOESPROC glProgramBinary = NULL;
 #elif WIN32
 extern void printError(const char* format, ...)
 {
@@ -350,6 +361,16 @@ char* C3DMemoryStream::readLine(int num,char* line)
 	return line;
 }
 
+const void* C3DMemoryStream::readPointer(size_t size)
+{
+    if (!m_buffer || m_position < 0 || (size_t)m_position > m_length || m_length - m_position < size)
+        return NULL;
+
+    const char* ptr = m_buffer + m_position;
+    m_position += size;
+    return ptr;
+}
+
 size_t C3DMemoryStream::write(const void* ptr, size_t size, size_t count)
 {
     if (!m_buffer)
@@ -453,6 +474,90 @@ char* C3DMemoryStream::readAll(int* fileSize)
 }
 */
 
+///..............
+C3DMappedStream::C3DMappedStream(char* buffer, size_t length)
+    : C3DMemoryStream(buffer, length)
+{
+#ifdef WIN32
+    _file = NULL;
+    _mapping = NULL;
+#endif
+}
+
+C3DMappedStream::~C3DMappedStream()
+{
+    // unmap here, the base destructor would delete the buffer
+    close();
+}
+
+C3DMappedStream* C3DMappedStream::create(const std::string& filePath)
+{
+#ifdef WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    DWORD size = GetFileSize(file, NULL);
+    HANDLE mapping = (size == 0 || size == INVALID_FILE_SIZE) ? NULL : CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* buffer = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (buffer == NULL)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return NULL;
+    }
+
+    C3DMappedStream* stream = new C3DMappedStream((char*)buffer, size);
+    stream->_file = file;
+    stream->_mapping = mapping;
+    return stream;
+#else
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return NULL;
+    }
+
+    // the mapping keeps its own reference to the file
+    void* buffer = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (buffer == MAP_FAILED)
+        return NULL;
+
+    return new C3DMappedStream((char*)buffer, (size_t)st.st_size);
+#endif
+}
+
+void C3DMappedStream::close()
+{
+    if (m_buffer == NULL)
+        return;
+
+#ifdef WIN32
+    UnmapViewOfFile(m_buffer);
+    CloseHandle((HANDLE)_mapping);
+    CloseHandle((HANDLE)_file);
+    _mapping = NULL;
+    _file = NULL;
+#else
+    munmap(m_buffer, m_length);
+#endif
+    m_buffer = NULL;
+    m_length = 0;
+    m_position = 0;
+}
+
+size_t C3DMappedStream::write(const void* ptr, size_t size, size_t count)
+{
+    return 0;
+}
+
 C3DStreamManager::C3DStreamManager()
 {
 }
@@ -506,6 +611,11 @@ C3DStream* C3DStreamManager::openStream(const std::string& fileName, const std::
         return NULL;
     }
 
+	return openFullPathStream(fullpath, openMode, streamType);
+}
+
+C3DStream* C3DStreamManager::openFullPathStream(const std::string& fullpath, const std::string& openMode, StreamType streamType)
+{
 	C3DStream* stream = NULL;
 	if(streamType == StreamType_File)
 	{
@@ -513,10 +623,23 @@ C3DStream* C3DStreamManager::openStream(const std::string& fileName, const std::
 	}
 	else if(streamType == StreamType_Memory)
 	{
+		// a full path is read as is, the way CCImage::initWithImageFileThreadSafe reads it
 		ssize_t nSize = 0;
         char* pBuffer = reinterpret_cast<char*>(cocos2d::CCFileUtils::getInstance()->getFileData(fullpath.c_str(), openMode.c_str(), &nSize));
 		stream = C3DMemoryStream::create(pBuffer,nSize);
 	}
+	else if(streamType == StreamType_Mapped)
+	{
+		// mapped files are read only
+		if (openMode.find_first_of("wa+") == std::string::npos)
+			stream = C3DMappedStream::create(fullpath);
+
+		if (stream == NULL)
+		{
+			// not a plain file, e.g. packed in the apk
+			return openFullPathStream(fullpath, openMode, StreamType_Memory);
+		}
+	}
 	else{}
 
 	return stream;
@@ -64,6 +64,16 @@ public:
      */
 	virtual char* readLine(int num,char* line) = 0;
 
+	/**
+     * Returns a pointer to the next bytes of the stream and skips them, without copy.
+     * The pointer is valid until the stream is closed.
+	 *
+	 * @param size The number of bytes to read.
+	 *
+	 * @return The pointer, or NULL if the stream can not expose its data or is too short.
+     */
+	virtual const void* readPointer(size_t size) { return NULL; }
+
 	 /**
      * Writes an array of elements.
      *
@@ -237,6 +247,11 @@ public:
      */
     virtual char* readLine(int num,char* line);
 
+	/**
+     * Returns a pointer into the buffer and skips the bytes.
+     */
+	virtual const void* readPointer(size_t size);
+
 	/**
      * Writes an array of elements.
      */
@@ -267,12 +282,54 @@ public:
 	 */
     virtual bool rewind();
 
-private:
+protected:
     long int m_position;
     size_t  m_length;
     char* m_buffer;
 };
 
+/**
+ * Defines a read only stream over a file mapped in memory.
+ *
+ * The pages are loaded by the system on demand and are not counted as heap,
+ * readPointer() exposes the file data without copy.
+ */
+class C3DMappedStream : public C3DMemoryStream
+{
+public:
+	/**
+     * Destructor.
+     */
+	~C3DMappedStream();
+
+	/**
+     * Creates C3DMappedStream, returns NULL if the file can not be mapped
+     * (for example a file packed in the android apk).
+     */
+	static C3DMappedStream* create(const std::string& filePath);
+
+	/**
+     * Unmaps the file.
+     */
+	virtual void close();
+
+	/**
+     * The stream is read only, nothing is written.
+     */
+    virtual size_t write(const void* ptr, size_t size, size_t count);
+
+private:
+	/**
+     * Constructor.
+     */
+	C3DMappedStream(char* buffer, size_t length);
+
+#ifdef WIN32
+	void* _file;
+	void* _mapping;
+#endif
+};
+
 /**
 * Stream is an interface for managing stream.
 */
@@ -295,7 +352,8 @@ public:
 	enum StreamType
     {
 		StreamType_File = 0,
-		StreamType_Memory
+		StreamType_Memory,
+		StreamType_Mapped,	// falls back to StreamType_Memory when the file can not be mapped
     };
 
 	/**
@@ -307,6 +365,12 @@ public:
      * open file by C3DStream.
      */
 	static C3DStream* openStream(const std::string& fileName, const std::string& openMode, StreamType streamType=StreamType_Memory);
+
+	/**
+     * open a file already resolved by CCFileUtils::fullPathForFilename. The search paths
+     * are not looked up, so the loader threads can call it.
+     */
+	static C3DStream* openFullPathStream(const std::string& fullPath, const std::string& openMode, StreamType streamType=StreamType_Memory);
 };
 
 // implements inline methods
@@ -21,6 +21,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "C3DSubMesh.h"
+#include "C3DStateCache.h"
 
 namespace cocos3d
 {
@@ -33,7 +34,7 @@ C3DSubMesh::~C3DSubMesh()
 {
     if (_indexBuffer)
     {
-        glDeleteBuffers(1, &_indexBuffer);
+        C3DStateCache::deleteBuffer(_indexBuffer);
     }
 }
 
@@ -53,10 +54,10 @@ C3DSubMesh* C3DSubMesh::create(C3DMesh* mesh, unsigned int meshIndex, PrimitiveT
         return NULL;
     }
 
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo) );
+    C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo);
     if (GL_LAST_ERROR())
     {
-        glDeleteBuffers(1, &vbo);
+        C3DStateCache::deleteBuffer(vbo);
         return NULL;
     }
 
@@ -76,10 +77,10 @@ C3DSubMesh* C3DSubMesh::create(C3DMesh* mesh, unsigned int meshIndex, PrimitiveT
     GL_CHECK( glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexSize * indexCount, NULL, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW) );
     if (GL_LAST_ERROR())
     {
-        glDeleteBuffers(1, &vbo);
+        C3DStateCache::deleteBuffer(vbo);
         return NULL;
     }
-	 GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+	 C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     C3DSubMesh* part = new C3DSubMesh();
     part->_mesh = mesh;
@@ -125,7 +126,7 @@ bool C3DSubMesh::isDynamic() const
 
 void C3DSubMesh::setIndexData(void* indexData, unsigned int indexStart, unsigned int indexCount)
 {
-    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer) );
+    C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
 
     unsigned int indexSize = 0;
     switch (_indexFormat)
@@ -155,6 +156,6 @@ void C3DSubMesh::setIndexData(void* indexData, unsigned int indexStart, unsigned
         GL_ASSERT( glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexStart * indexSize, indexCount * indexSize, indexData) );
     }
 
-	GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+	C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 }
\ No newline at end of file
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "CCTexture2D.h"
 #include "CCTextureCache.h"
 #include "ccUtils.h"
+#include "C3DStateCache.h"
 
 using namespace std;
 using namespace cocos2d;
@@ -48,11 +49,13 @@ C3DTexture::~C3DTexture()
 	C3DTextureMgr::getInstance()->remove(this);
 	if (_2DTex)
 	{
-		//CCTextureCache::sharedTextureCache()->removeTexture(_2DTex);
+		// the last texture of the image takes it out of the cache, so that it is freed
+		if (!_path.empty() && C3DTextureMgr::getInstance()->getShareCount(this) == 0)
+			CCTextureCache::sharedTextureCache()->removeTexture(_2DTex);
 		SAFE_RELEASE(_2DTex);
 	}else if (_handle)
 	{
-		GL_ASSERT(glDeleteTextures(1, &_handle));
+		C3DStateCache::deleteTexture(_handle);
 	}
 }
 
@@ -89,6 +92,25 @@ C3DTexture* C3DTexture::create(const std::string& path, bool generateMipmaps)
 
 bool C3DTexture::innerInit2D(const std::string& path, bool generateMipmaps)
 {
+#ifdef C3D_GL_NULL
+    // cocos2d would upload the image to GL, there is none: only the size of the image is kept
+    CCImage* image = createImage(path);
+    if (image == NULL)
+    {
+        LOG_ERROR_VARG("failed to load texture file: %s", path.c_str());
+        return false;
+    }
+
+    bool created = init(image->getWidth(), image->getHeight(), RGBA, false);
+    SAFE_RELEASE(image);
+    if (!created)
+        return false;
+
+    _path = path;
+    _mipmapped = generateMipmaps;
+
+    return true;
+#else
     CCTexture2D* tex2D = CCTextureCache::sharedTextureCache()->addImage(path);
     if (tex2D == NULL)
     {
@@ -113,6 +135,7 @@ bool C3DTexture::innerInit2D(const std::string& path, bool generateMipmaps)
 	_mipmapped = generateMipmaps;
 
 	return true;
+#endif
 }
 
 bool C3DTexture::innerInit2D(C3DTexture* rhs)
@@ -229,11 +252,45 @@ cocos2d::CCImage* C3DTexture::createImage(const std::string& path)
 	return pImage;
 }
 
+size_t C3DTexture::getMemorySize() const
+{
+	unsigned int bitsPerPixel = 32;
+	if (_2DTex)
+	{
+		bitsPerPixel = _2DTex->getBitsPerPixelForFormat();
+	}
+	else
+	{
+		switch (_fmt)
+		{
+		case RGB:
+			bitsPerPixel = 24;
+			break;
+		case ALPHA:
+			bitsPerPixel = 8;
+			break;
+		case DEPTH:
+			bitsPerPixel = 16;
+			break;
+		default:
+			break;
+		}
+	}
+
+	size_t size = (size_t)_width * _height * bitsPerPixel / 8;
+
+	// a full mipmap chain adds a third
+	if (_mipmapped)
+		size += size / 3;
+
+	return size;
+}
+
 bool C3DTexture::init(int width, int height, C3DTexture::Format fmt, bool generateMipmaps)
 {
     GLuint handle;
     GL_ASSERT(glGenTextures(1, &handle));
-    GL_ASSERT(glBindTexture(GL_TEXTURE_2D, handle));
+    C3DStateCache::bindTexture(GL_TEXTURE_2D, handle);
 
     // Specify OpenGL texture image
     GLenum internalFormat = GL_RGBA;
@@ -309,10 +366,10 @@ void C3DTexture::setWrapMode(Texture_Wrap wrapS, Texture_Wrap wrapT)
         GLint currentTextureId;
 
         GL_ASSERT( glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTextureId) );
-        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _2DTex->getName()) );
+        C3DStateCache::bindTexture(GL_TEXTURE_2D, _2DTex->getName());
         GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLenum)wrapS) );
         GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLenum)wrapT) );
-        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, (GLuint)currentTextureId) );
+        C3DStateCache::bindTexture(GL_TEXTURE_2D, (GLuint)currentTextureId);
     }
 }
 
@@ -322,10 +379,10 @@ void C3DTexture::setFilterMode(Texture_Filter minificationFilter, Texture_Filter
     {
         GLint currentTextureId;
         GL_ASSERT( glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTextureId) );
-        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _2DTex->getName()) );
+        C3DStateCache::bindTexture(GL_TEXTURE_2D, _2DTex->getName());
         GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLenum)minificationFilter) );
         GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLenum)magnificationFilter) );
-        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, (GLuint)currentTextureId) );
+        C3DStateCache::bindTexture(GL_TEXTURE_2D, (GLuint)currentTextureId);
     }
 }
 
@@ -336,10 +393,10 @@ void C3DTexture::generateMipmaps()
         _2DTex->generateMipmap();
         GLint currentTextureId;
         GL_ASSERT( glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTextureId) );
-        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, _2DTex->getName()) );
+        C3DStateCache::bindTexture(GL_TEXTURE_2D, _2DTex->getName());
         glGenerateMipmap(GL_TEXTURE_2D);
 
-        GL_ASSERT( glBindTexture(GL_TEXTURE_2D, (GLuint)currentTextureId) );
+        C3DStateCache::bindTexture(GL_TEXTURE_2D, (GLuint)currentTextureId);
     }
 }
 
@@ -406,6 +463,48 @@ C3DTexture* C3DTextureMgr::get(const std::string& strID)
 	return NULL;
 }
 
+// the textures created from the same image share its CCTexture2D
+static const void* getSharedKey(const C3DTexture* texture, const cocos2d::Texture2D* texture2D)
+{
+	return texture2D ? (const void*)texture2D : (const void*)texture;
+}
+
+unsigned int C3DTextureMgr::getShareCount(const C3DTexture* texture) const
+{
+	const void* key = getSharedKey(texture, texture->_2DTex);
+
+	unsigned int count = 0;
+	for (T_CACHE_CONTAINER::const_iterator iter = _texCon.begin(); iter != _texCon.end(); ++iter)
+	{
+		if (getSharedKey(*iter, (*iter)->_2DTex) == key)
+			count++;
+	}
+	return count;
+}
+
+size_t C3DTextureMgr::getExclusiveMemorySize(const std::vector<const C3DTexture*>& textures) const
+{
+	std::map<const void*, unsigned int> held;
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		held[getSharedKey(textures[i], textures[i]->_2DTex)]++;
+	}
+
+	size_t size = 0;
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		std::map<const void*, unsigned int>::iterator iter = held.find(getSharedKey(textures[i], textures[i]->_2DTex));
+		if (iter == held.end())
+			continue;
+
+		// the textures outside of the given ones keep the GL texture alive
+		if (getShareCount(textures[i]) <= iter->second)
+			size += textures[i]->getMemorySize();
+		held.erase(iter);
+	}
+	return size;
+}
+
 void C3DTextureMgr::reload()
 {
 	for(T_CACHE_CONTAINER::iterator iter = _texCon.begin(); iter!=_texCon.end(); ++iter)
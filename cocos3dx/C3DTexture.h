@@ -125,6 +125,11 @@ namespace cocos3d
          */
         GLuint getHandle() const;
 
+		/**
+         * Returns the bytes the texture takes in video memory, mipmaps included.
+         */
+        size_t getMemorySize() const;
+
 		/**
          * get texture path
          */
@@ -165,6 +170,17 @@ namespace cocos3d
 		void remove(C3DTexture* texture);
 		C3DTexture* get(const std::string& strID);
 
+		/**
+		 * Returns the bytes freed when the given textures are released: the GL textures they don't
+		 * share with any other texture of the manager, each counted once.
+		 */
+		size_t getExclusiveMemorySize(const std::vector<const C3DTexture*>& textures) const;
+
+		/**
+		 * Returns the number of textures of the manager drawing from the GL texture of the given one.
+		 */
+		unsigned int getShareCount(const C3DTexture* texture) const;
+
 		void reload();
 	protected:
 		C3DTextureMgr();
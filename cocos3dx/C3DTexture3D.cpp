@@ -28,6 +28,7 @@ THE SOFTWARE.
 #include "CCTextureCache.h"
 #include "ccUtils.h"
 #include "platform/CCImage.h"
+#include "C3DStateCache.h"
 
 using namespace std;
 using namespace cocos2d;
@@ -197,7 +198,7 @@ namespace cocos3d
 	{
 		GLuint handle;
 		glGenTextures(1, &handle);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, handle);
+		C3DStateCache::bindTexture(GL_TEXTURE_CUBE_MAP, handle);
 
 		for (int i=0; i<6; i++) 
 		{
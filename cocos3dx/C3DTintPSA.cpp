@@ -152,20 +152,19 @@ int C3DTintPSA::determineIndex(float time) const
     return -1;
 }
 
-void C3DTintPSA::action(long elapsedTime)
+void C3DTintPSA::action(long elapsedTime, int begin, int end)
 {
 	if (_tints.size() == 0)
 		return;
 
-    // Calculate the time passed since last update.
-	C3DParticle**& _particles = _system->_particles;
-	int& _validParticleCount = _system->_validParticleCount;
-	C3DVector4 color;
+	C3DParticleArrays& p = _system->_particles;
     float weight = 1.0f / (float)_system->_numTintAction;
-	for (int i = 0; i < _validParticleCount; ++i)
+	float firstTime = _tints.front()->_time;
+	for (int i = begin; i < end; ++i)
     {
-		C3DParticle*& p = _particles[i];
-		int index = this->determineIndex(p->_age);
+		// dead particles are still in the range, keep them on the first tint
+		float age = (float)p._age[i];
+		int index = age <= firstTime ? 0 : this->determineIndex(age);
 
 		C3DTint* from = _tints[index];
 		C3DVector4 color;
@@ -177,11 +176,13 @@ void C3DTintPSA::action(long elapsedTime)
 		{
 			C3DTint* to = _tints[index + 1];
 			float scale = (to->_time - from->_time);
-			float t = (scale == 0.0f ? 0.0f : (p->_age - from->_time) / scale);
+			float t = (scale == 0.0f ? 0.0f : (age - from->_time) / scale);
 			color = from->_color + (to->_color - from->_color) * t;
 		}
-		color *= weight;
-		p->_color += color;
+		p._colorR[i] += color.x * weight;
+		p._colorG[i] += color.y * weight;
+		p._colorB[i] += color.z * weight;
+		p._colorA[i] += color.w * weight;
     }
 }
 
@@ -69,7 +69,7 @@ public:
 	/**
      * change particle color over time
      */
-	virtual void action(long elapsedTime);
+	virtual void action(long elapsedTime, int begin, int end);
 
 	/**
      * add tint, change to color at specific time
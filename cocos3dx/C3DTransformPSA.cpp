@@ -31,9 +31,7 @@ THE SOFTWARE.
 namespace cocos3d
 {
 C3DTransformPSA::C3DTransformPSA(C3DParticleSystem* system) :
-     C3DBaseParticleAction(system),
-	 _rotation(C3DMatrix::identity())
-
+     C3DBaseParticleAction(system)
 {
 }
 
@@ -59,99 +57,91 @@ void C3DTransformPSA::save(C3DElementNode* properties)
 	properties->setElement("sizeRate",&_sizeRate);
 }
 
-void C3DTransformPSA::action(long elapsedTime)
+void C3DTransformPSA::action(long elapsedTime, int begin, int end)
 {
 	// Calculate the time passed since last update.
     float elapsedSecs = (float)elapsedTime * 0.001f;
-	C3DParticle**& _particles = _system->_particles;
-	int& _validParticleCount = _system->_validParticleCount;
-
-	for (int i = 0; i < _validParticleCount; ++i)
-    {
-		C3DParticle*& p = _particles[i];
-
-        p->_age -= elapsedTime;
-
-        if (p->_age > 0L)
-        {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
-            {
-                C3DMatrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
-
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
-            }
-
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
-
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
-
-			if (_system->_numTintAction == 0)
-				p->_color = C3DVector4(1.0f, 1.0f, 1.0f, 1.0f);
-			else
-				p->_color = C3DVector4(0.0f, 0.0f, 0.0f, 0.0f);
-
-			if ( p->_size > _endSize )
-			{
-				p->_size -= _sizeRate * elapsedSecs;
-				if ( p->_size < _endSize )
-				{
-					p->_size = _endSize;
-				}
-			}
-			else if ( p->_size < _endSize )
-			{
-				p->_size += _sizeRate * elapsedSecs;
-				if ( p->_size > _endSize )
-				{
-					p->_size = _endSize;
-				}
-			}
-
-			if (_system->getParticleRender()->isSpriteAnimated())
+	C3DParticleArrays& p = _system->_particles;
+
+	// Dead particles are removed by the particle system once all the actions are done,
+	// the loops below don't need to care about them.
+	for (int i = begin; i < end; ++i)
+	{
+		p._age[i] -= elapsedTime;
+	}
+
+	// Rotate the velocity around the rotation axis (Rodrigues' formula), the axis is
+	// normalized by the emitter and the speed is zero for the particles that don't rotate.
+	for (int i = begin; i < end; ++i)
+	{
+		float angle = p._rotationSpeed[i] * elapsedSecs;
+		float s = sinf(angle);
+		float c = cosf(angle);
+		float kx = p._rotationAxisX[i], ky = p._rotationAxisY[i], kz = p._rotationAxisZ[i];
+		float vx = p._velocityX[i], vy = p._velocityY[i], vz = p._velocityZ[i];
+		float dot = (kx * vx + ky * vy + kz * vz) * (1.0f - c);
+
+		p._velocityX[i] = vx * c + (ky * vz - kz * vy) * s + kx * dot;
+		p._velocityY[i] = vy * c + (kz * vx - kx * vz) * s + ky * dot;
+		p._velocityZ[i] = vz * c + (kx * vy - ky * vx) * s + kz * dot;
+	}
+
+	for (int i = begin; i < end; ++i)
+	{
+		p._positionX[i] += p._velocityX[i] * elapsedSecs;
+		p._positionY[i] += p._velocityY[i] * elapsedSecs;
+		p._positionZ[i] += p._velocityZ[i] * elapsedSecs;
+		p._angle[i] += p._rotationPerParticleSpeed[i] * elapsedSecs;
+	}
+
+	// the tint actions accumulate their weighted colors from zero
+	float color = _system->_numTintAction == 0 ? 1.0f : 0.0f;
+	for (int i = begin; i < end; ++i)
+	{
+		p._colorR[i] = color;
+		p._colorG[i] = color;
+		p._colorB[i] = color;
+		p._colorA[i] = color;
+	}
+
+	// Move the size towards the end size.
+	float sizeStep = _sizeRate * elapsedSecs;
+	for (int i = begin; i < end; ++i)
+	{
+		float size = p._size[i];
+		if (size > _endSize)
+			size = C3D_Max(size - sizeStep, _endSize);
+		else
+			size = C3D_Min(size + sizeStep, _endSize);
+		p._size[i] = size;
+	}
+
+	C3DParticleRender* render = _system->getParticleRender();
+	if (render->isSpriteAnimated())
+	{
+		int frameCount = render->getFrameCount();
+		if (!render->isSpriteLoop())
+		{
+			// The last frame should finish exactly when the particle dies.
+			for (int i = begin; i < end; ++i)
 			{
-				if (!_system->getParticleRender()->isSpriteLoop())
-				{
-					// The last frame should finish exactly when the particle dies.
-					float percent = 1 - (float)p->_age / (float)p->_ageStart;
-					int frameCount = _system->getParticleRender()->getFrameCount();
-					p->_frame = (int)(percent * frameCount) + p->_frameStart;
-
-					if (p->_frame >= frameCount)
-						p->_frame %= frameCount;
-				}
-				else
-				{
-					// _spriteFrameDurationSecs is an absolute time measured in seconds,
-					// and the animation repeats indefinitely.
-					long duration = _system->getParticleRender()->getSpriteFrameDurationSecs() * 1000;
-					int frameCount = _system->getParticleRender()->getFrameCount();
-					if (duration == 0)
-						p->_frame = p->_frameStart;
-					else
-						p->_frame = (p->_ageStart - p->_age) / duration + p->_frameStart;
-
-					if (p->_frame >= frameCount)
-						p->_frame %= frameCount;
-				}
+				float percent = 1 - (float)p._age[i] / (float)p._ageStart[i];
+				int frame = (int)(percent * frameCount) + p._frameStart[i];
+				p._frame[i] = frame >= frameCount ? frame % frameCount : frame;
 			}
-        }
+		}
 		else
 		{
-			 // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (i != _validParticleCount - 1)
-            {
-				C3DParticle* temp = _particles[i];
-                _particles[i] = _particles[_validParticleCount - 1];
-				_particles[_validParticleCount - 1] = temp;
-				i--;
-            }
-            --_validParticleCount;
+			// _spriteFrameDurationSecs is an absolute time measured in seconds,
+			// and the animation repeats indefinitely.
+			long duration = render->getSpriteFrameDurationSecs() * 1000;
+			for (int i = begin; i < end; ++i)
+			{
+				int frame = duration == 0 ? p._frameStart[i] : (int)((p._ageStart[i] - p._age[i]) / duration) + p._frameStart[i];
+				p._frame[i] = frame >= frameCount ? frame % frameCount : frame;
+			}
 		}
-    }
+	}
 }
 
 C3DBaseParticleAction* C3DTransformPSA::clone(C3DParticleSystem* system) const
@@ -63,7 +63,7 @@ public:
 	/**
      * particle action, change particle state by elapsed time
      */
-	virtual void action(long elapsedTime);
+	virtual void action(long elapsedTime, int begin, int end);
 
 	/**
      * get & set end size
@@ -85,8 +85,6 @@ public:
 private:
 
 	// property
-    C3DMatrix _rotation;
-
 	float _endSize;		// Eventual size of the particles.
 	float _sizeRate;		// Increment per second towards the size.
 };
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include "C3DVertexFormat.h"
 #include "Base.h"
 #include "C3DDeviceAdapter.h"
+#include "C3DStateCache.h"
 
 // Graphics (GLSL)
 #define VERTEX_ATTRIBUTE_POSITION_NAME              "a_position"
@@ -66,7 +67,7 @@ namespace cocos3d
 		{
 			if (_handle)
 			{
-				/*GL_ASSERT*/( glDeleteVertexArrays(1, &_handle) );
+				C3DStateCache::deleteVertexArray(_handle);
 				_handle = 0;
 			}
 		}
@@ -151,8 +152,8 @@ namespace cocos3d
 		{
 			if (mesh && glGenVertexArrays)
 			{
-				GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
-				GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+				C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+				C3DStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 				// Use hardware VAOs.
 				GL_ASSERT( glGenVertexArrays(1, &_handle) );
@@ -163,10 +164,10 @@ namespace cocos3d
 				}
 
 				// Bind the new VAO.
-				GL_ASSERT( glBindVertexArray(_handle) );
+				C3DStateCache::bindVertexArray(_handle);
 
 				// Bind the C3DMesh VBO so our glVertexAttribPointer calls use it.
-				GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, mesh->getVertexBuffer()) );
+				C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, mesh->getVertexBuffer());
 			}
 			else
 			{
@@ -287,8 +288,8 @@ namespace cocos3d
 		{
 			if (_handle)
 			{
-				GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
-				GL_ASSERT( glBindVertexArray(0) );
+				C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+				C3DStateCache::bindVertexArray(0);
 			}
 		}
 
@@ -326,18 +327,18 @@ namespace cocos3d
 			if (_handle)
 			{
 				// Hardware mode
-				GL_ASSERT( glBindVertexArray(_handle) );
+				C3DStateCache::bindVertexArray(_handle);
 			}
 			else
 			{
 				// Software mode
 				if (_mesh)
 				{
-					GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer()) );
+					C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer());
 				}
 				else
 				{
-					GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+					C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
 				}
 
 				for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
@@ -356,11 +357,11 @@ namespace cocos3d
 			// Software mode
 			if (_mesh)
 			{
-				GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer()) );
+				C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, _mesh->getVertexBuffer());
 			}
 			else
 			{
-				GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+				C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
 			}
 
 			for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
@@ -382,14 +383,14 @@ namespace cocos3d
 			if (_handle)
 			{
 				// Hardware mode
-				GL_ASSERT( glBindVertexArray(0) );
+				C3DStateCache::bindVertexArray(0);
 			}
 			else
 			{
 				// Software mode
 				if (_mesh)
 				{
-					GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+					C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
 				}
 
 				for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
@@ -406,7 +407,7 @@ namespace cocos3d
 			// Software mode
 			if (_mesh)
 			{
-				GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+				C3DStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
 			}
 
 			for (unsigned int i = 0; i < __maxVertexAttribs; ++i)
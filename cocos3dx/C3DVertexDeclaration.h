@@ -54,6 +54,11 @@ public:
 
     void unbind();
 
+    /**
+     * get the vertex array object, 0 when vertex arrays are not used.
+     */
+    GLuint getHandle() const { return _handle; }
+
 	void reload();
 
     static int getCurVertAttEnables();
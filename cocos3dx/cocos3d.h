@@ -69,6 +69,7 @@ THE SOFTWARE.
 #include "C3DVertexFormat.h"
 #include "C3DSubMesh.h"
 #include "C3DModelNode.h"
+#include "C3DLODNode.h"
 #include "C3DMaterialManager.h"
 #include "C3DSkinlessModel.h"
 
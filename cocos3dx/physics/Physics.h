@@ -3,5 +3,7 @@
 
 // physics header
 #include "RigidBody.h"
+#include "PhysicsCollision.h"
+#include "PhysicsWorld.h"
  
 #endif
@@ -0,0 +1,390 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include <float.h>
+#include "Base.h"
+#include "PhysicsCollision.h"
+#include "RigidBody.h"
+#include "C3DOBB.h"
+#include "C3DMathSIMD.h"
+
+#define PHYSICS_CONTACT_MARGIN 0.02f
+
+namespace cocos3d
+{
+static float clampf(float v, float lo, float hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// closest point of segment p0p1 to point
+static C3DVector3 closestPointOnSegment(const C3DVector3& p0, const C3DVector3& p1, const C3DVector3& point)
+{
+    C3DVector3 d = p1 - p0;
+    float len2 = d.lengthSquared();
+    if (len2 <= MATH_EPSILON)
+        return p0;
+
+    float t = clampf((point - p0).dot(d) / len2, 0.0f, 1.0f);
+    return p0 + d * t;
+}
+
+// closest points of segments p0p1 & q0q1
+static void closestPointsOfSegments(const C3DVector3& p0, const C3DVector3& p1, const C3DVector3& q0, const C3DVector3& q1,
+    C3DVector3* cp, C3DVector3* cq)
+{
+    C3DVector3 d1 = p1 - p0;
+    C3DVector3 d2 = q1 - q0;
+    C3DVector3 r = p0 - q0;
+    float a = d1.lengthSquared();
+    float e = d2.lengthSquared();
+    float f = d2.dot(r);
+
+    float s, t;
+    if (a <= MATH_EPSILON && e <= MATH_EPSILON)
+    {
+        s = t = 0.0f;
+    }
+    else if (a <= MATH_EPSILON)
+    {
+        s = 0.0f;
+        t = clampf(f / e, 0.0f, 1.0f);
+    }
+    else
+    {
+        float c = d1.dot(r);
+        if (e <= MATH_EPSILON)
+        {
+            t = 0.0f;
+            s = clampf(-c / a, 0.0f, 1.0f);
+        }
+        else
+        {
+            float b = d1.dot(d2);
+            float denom = a * e - b * b;
+
+            // parallel segments pick any s
+            s = denom > MATH_EPSILON ? clampf((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if (t < 0.0f)
+            {
+                t = 0.0f;
+                s = clampf(-c / a, 0.0f, 1.0f);
+            }
+            else if (t > 1.0f)
+            {
+                t = 1.0f;
+                s = clampf((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    *cp = p0 + d1 * s;
+    *cq = q0 + d2 * t;
+}
+
+static C3DVector3 closestPointOnOBB(const C3DOBB& obb, const C3DVector3& point)
+{
+    C3DVector3 d = point - obb.center;
+    return obb.center
+        + obb.xAxis * clampf(d.dot(obb.xAxis), -obb.extents.x, obb.extents.x)
+        + obb.yAxis * clampf(d.dot(obb.yAxis), -obb.extents.y, obb.extents.y)
+        + obb.zAxis * clampf(d.dot(obb.zAxis), -obb.extents.z, obb.extents.z);
+}
+
+// radius of the obb projected on axis
+static float projectOBB(const C3DOBB& obb, const C3DVector3& axis)
+{
+    return fabsf(obb.extX.dot(axis)) + fabsf(obb.extY.dot(axis)) + fabsf(obb.extZ.dot(axis));
+}
+
+// normal from the first segment to the second one
+static bool collideSegments(const C3DVector3& p0, const C3DVector3& p1, float ra,
+    const C3DVector3& q0, const C3DVector3& q1, float rb, PhysicsContact* contact)
+{
+    C3DVector3 cp, cq;
+    closestPointsOfSegments(p0, p1, q0, q1, &cp, &cq);
+
+    C3DVector3 d = cq - cp;
+    float dist2 = d.lengthSquared();
+    float radius = ra + rb;
+    if (dist2 >= radius * radius)
+        return false;
+
+    float dist = sqrtf(dist2);
+    contact->normal = dist > MATH_EPSILON ? d * (1.0f / dist) : C3DVector3::unitY();
+    contact->depth = radius - dist;
+    contact->points[0] = cp + contact->normal * (ra - contact->depth * 0.5f);
+    contact->pointCount = 1;
+
+    return true;
+}
+
+// normal from the box to the segment
+static bool collideOBBSegment(const C3DOBB& obb, const C3DVector3& p0, const C3DVector3& p1, float radius, PhysicsContact* contact)
+{
+    // alternate the closest points, converges in a few steps for a convex box
+    C3DVector3 s = closestPointOnSegment(p0, p1, obb.center);
+    C3DVector3 b = closestPointOnOBB(obb, s);
+    for (int i = 0; i < 2; i++)
+    {
+        s = closestPointOnSegment(p0, p1, b);
+        b = closestPointOnOBB(obb, s);
+    }
+
+    C3DVector3 d = s - b;
+    float dist2 = d.lengthSquared();
+    if (dist2 >= radius * radius)
+        return false;
+
+    if (dist2 > MATH_EPSILON)
+    {
+        float dist = sqrtf(dist2);
+        contact->normal = d * (1.0f / dist);
+        contact->depth = radius - dist;
+        contact->points[0] = b;
+    }
+    else
+    {
+        // the segment is inside the box, push it out through the nearest face
+        const C3DVector3* axes[3] = { &obb.xAxis, &obb.yAxis, &obb.zAxis };
+        const float extents[3] = { obb.extents.x, obb.extents.y, obb.extents.z };
+        C3DVector3 local = s - obb.center;
+
+        float minDepth = FLT_MAX;
+        for (int i = 0; i < 3; i++)
+        {
+            float dist = local.dot(*axes[i]);
+            float depth = extents[i] - fabsf(dist);
+            if (depth < minDepth)
+            {
+                minDepth = depth;
+                contact->normal = dist < 0.0f ? -*axes[i] : *axes[i];
+            }
+        }
+        contact->depth = minDepth + radius;
+        contact->points[0] = s;
+    }
+    contact->pointCount = 1;
+
+    // a capsule lying on the box needs both ends or it rocks around the middle point
+    if (p0 != p1)
+    {
+        C3DVector3 ends[2] = { p0, p1 };
+        int count = 0;
+        for (int i = 0; i < 2; i++)
+        {
+            float dist = (ends[i] - b).dot(contact->normal);
+            if (dist < radius + PHYSICS_CONTACT_MARGIN)
+                ends[count++] = ends[i] - contact->normal * dist;
+        }
+        if (count == 2)
+        {
+            contact->points[0] = ends[0];
+            contact->points[1] = ends[1];
+            contact->pointCount = 2;
+        }
+    }
+
+    return true;
+}
+
+// contact points of the boxes touching along normal, from a to b
+static void collideOBBs(const C3DOBB& a, const C3DOBB& b, const C3DVector3& normal, PhysicsContact* contact)
+{
+    C3DVector3 offset = b.center - a.center;
+    contact->normal = normal;
+    contact->depth = projectOBB(a, normal) + projectOBB(b, normal) - fabsf(offset.dot(normal));
+
+    // corners of b inside a, then corners of a inside b while there is room, the boxes are grown a bit
+    // so resting corners still count, the deepest ones are kept
+    C3DOBB grown[2];
+    grown[0] = a;
+    grown[1] = b;
+    float limits[2] = { a.center.dot(normal) + projectOBB(a, normal), b.center.dot(normal) - projectOBB(b, normal) };
+
+    float depths[PHYSICS_MAX_CONTACT_POINTS];
+    int ids[PHYSICS_MAX_CONTACT_POINTS];
+    contact->pointCount = 0;
+    C3DVector3 corners[16];
+    b.getVertices(corners);
+    a.getVertices(corners + 8);
+    for (int side = 0; side < 2 && contact->pointCount < PHYSICS_MAX_CONTACT_POINTS; side++)
+    {
+        grown[side].extents *= 1.01f;
+
+        const C3DVector3* verts = corners + side * 8;
+        for (int i = 0; i < 8; i++)
+        {
+            if (!grown[side].isPointIn(verts[i]))
+                continue;
+
+            float depth = side == 0 ? limits[0] - verts[i].dot(normal) : verts[i].dot(normal) - limits[1];
+            int k = contact->pointCount;
+            if (k == PHYSICS_MAX_CONTACT_POINTS)
+            {
+                if (depth <= depths[k - 1])
+                    continue;
+                k--;
+            }
+            else
+            {
+                contact->pointCount++;
+            }
+
+            for (; k > 0 && depths[k - 1] < depth; k--)
+            {
+                depths[k] = depths[k - 1];
+                ids[k] = ids[k - 1];
+            }
+            depths[k] = depth;
+            ids[k] = side * 8 + i;
+        }
+    }
+
+    // corner order, the solver matches the points of consecutive steps by index
+    for (int i = 0; i < contact->pointCount; i++)
+    {
+        int id = ids[i];
+        int k = i;
+        for (; k > 0 && ids[k - 1] > id; k--)
+        {
+            ids[k] = ids[k - 1];
+        }
+        ids[k] = id;
+    }
+    for (int i = 0; i < contact->pointCount; i++)
+    {
+        contact->points[i] = corners[ids[i]];
+    }
+
+    // edge against edge, the support points meet around the middle
+    if (contact->pointCount == 0)
+    {
+        const C3DVector3* extA[3] = { &a.extX, &a.extY, &a.extZ };
+        const C3DVector3* extB[3] = { &b.extX, &b.extY, &b.extZ };
+        C3DVector3 sa = a.center;
+        C3DVector3 sb = b.center;
+        for (int i = 0; i < 3; i++)
+        {
+            sa += extA[i]->dot(normal) > 0.0f ? *extA[i] : -*extA[i];
+            sb += extB[i]->dot(normal) < 0.0f ? *extB[i] : -*extB[i];
+        }
+        contact->points[0] = (sa + sb) * 0.5f;
+        contact->pointCount = 1;
+    }
+}
+
+static void packOBB(const C3DOBB& obb, float* dst)
+{
+    const C3DVector3* v[5] = { &obb.center, &obb.xAxis, &obb.yAxis, &obb.zAxis, &obb.extents };
+    for (int i = 0; i < 5; i++)
+    {
+        dst[i * 3] = v[i]->x;
+        dst[i * 3 + 1] = v[i]->y;
+        dst[i * 3 + 2] = v[i]->z;
+    }
+}
+
+static void unpackOBB(const float* src, C3DOBB* obb)
+{
+    C3DVector3* v[5] = { &obb->center, &obb->xAxis, &obb->yAxis, &obb->zAxis, &obb->extents };
+    for (int i = 0; i < 5; i++)
+    {
+        v[i]->set(src[i * 3], src[i * 3 + 1], src[i * 3 + 2]);
+    }
+    obb->completeExtAxis();
+}
+
+static bool isBox(const RigidBody* body)
+{
+    return body->getParameter().shape == RigidBodyParameter::Shape_OBB || body->getParameter().shape == RigidBodyParameter::Shape_AABB;
+}
+
+bool isBoxPair(const RigidBody* bodyA, const RigidBody* bodyB)
+{
+    return isBox(bodyA) && isBox(bodyB);
+}
+
+void packBoxPair(const RigidBody* bodyA, const RigidBody* bodyB, float* pair)
+{
+    C3DOBB obb;
+    bodyA->getOBB(&obb);
+    packOBB(obb, pair);
+    bodyB->getOBB(&obb);
+    packOBB(obb, pair + C3DMathSIMD::BOX_FLOATS);
+}
+
+bool collideBoxPair(RigidBody* bodyA, RigidBody* bodyB, const float* pair, float depth, const float* normal, PhysicsContact* contact)
+{
+    if (depth < 0.0f)
+        return false;
+
+    contact->bodyA = bodyA;
+    contact->bodyB = bodyB;
+
+    C3DOBB a, b;
+    unpackOBB(pair, &a);
+    unpackOBB(pair + C3DMathSIMD::BOX_FLOATS, &b);
+    collideOBBs(a, b, C3DVector3(normal[0], normal[1], normal[2]), contact);
+    return true;
+}
+
+bool collideBodies(RigidBody* bodyA, RigidBody* bodyB, PhysicsContact* contact)
+{
+    contact->bodyA = bodyA;
+    contact->bodyB = bodyB;
+
+    bool boxA = isBox(bodyA);
+    bool boxB = isBox(bodyB);
+
+    if (boxA && boxB)
+    {
+        float pair[C3DMathSIMD::BOX_PAIR_FLOATS];
+        float depth, normal[3];
+        packBoxPair(bodyA, bodyB, pair);
+        C3DMathSIMD::getInstance().collideBoxes(pair, 1, &depth, normal);
+        return collideBoxPair(bodyA, bodyB, pair, depth, normal, contact);
+    }
+
+    if (boxA || boxB)
+    {
+        C3DOBB obb;
+        C3DVector3 p0, p1;
+        (boxA ? bodyA : bodyB)->getOBB(&obb);
+        RigidBody* round = boxA ? bodyB : bodyA;
+        round->getSegment(&p0, &p1);
+        if (!collideOBBSegment(obb, p0, p1, round->getParameter().radius, contact))
+            return false;
+
+        if (!boxA)
+            contact->normal.negate();
+        return true;
+    }
+
+    C3DVector3 p0, p1, q0, q1;
+    bodyA->getSegment(&p0, &p1);
+    bodyB->getSegment(&q0, &q1);
+    return collideSegments(p0, p1, bodyA->getParameter().radius, q0, q1, bodyB->getParameter().radius, contact);
+}
+}
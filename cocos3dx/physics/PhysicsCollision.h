@@ -0,0 +1,64 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef PHYSICSCOLLISION_H_
+#define PHYSICSCOLLISION_H_
+
+#include "C3DVector3.h"
+
+namespace cocos3d
+{
+class RigidBody;
+
+#define PHYSICS_MAX_CONTACT_POINTS 4
+
+/**
+ * Defines the contact manifold of two touching bodies.
+ */
+struct PhysicsContact
+{
+    RigidBody* bodyA;
+    RigidBody* bodyB;
+    C3DVector3 normal;      // unit vector from bodyA to bodyB
+    float depth;            // deepest penetration along the normal
+    C3DVector3 points[PHYSICS_MAX_CONTACT_POINTS];
+    int pointCount;
+};
+
+/**
+ * Computes the contact between the shapes of the bodies, returns false when they don't touch.
+ * Spheres are handled as capsules of zero length, aabbs as obbs without rotation.
+ */
+bool collideBodies(RigidBody* bodyA, RigidBody* bodyB, PhysicsContact* contact);
+
+/**
+ * Box against box, split so PhysicsWorld can run the separating axis tests of all its box pairs
+ * in one C3DMathSIMD::collideBoxes call. packBoxPair writes the pair in the collideBoxes layout,
+ * collideBoxPair computes the contact points from the depth and normal found for it.
+ */
+bool isBoxPair(const RigidBody* bodyA, const RigidBody* bodyB);
+void packBoxPair(const RigidBody* bodyA, const RigidBody* bodyB, float* pair);
+bool collideBoxPair(RigidBody* bodyA, RigidBody* bodyB, const float* pair, float depth, const float* normal, PhysicsContact* contact);
+}
+
+#endif
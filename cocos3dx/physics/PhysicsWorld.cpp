@@ -0,0 +1,769 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include <algorithm>
+#include <float.h>
+#include "Base.h"
+#include "PhysicsWorld.h"
+#include "RigidBody.h"
+#include "C3DMathSIMD.h"
+
+#define PHYSICS_BAUMGARTE               0.2f    // part of the penetration fixed each step
+#define PHYSICS_SLOP                    0.01f   // penetration allowed, keeps resting contacts alive
+#define PHYSICS_RESTITUTION_VELOCITY    1.0f    // slower impacts don't bounce
+#define PHYSICS_SLEEP_LINEAR_VELOCITY   0.05f
+#define PHYSICS_SLEEP_ANGULAR_VELOCITY  0.05f
+#define PHYSICS_TIME_TO_SLEEP           0.5f
+
+namespace cocos3d
+{
+// the solver only moves awake dynamic bodies
+static bool isAwake(const RigidBody* body)
+{
+    return body->isDynamic() && !body->isSleeping();
+}
+
+// bodies which may move during the step, node driven bodies included
+static bool isActive(const RigidBody* body)
+{
+    return isAwake(body) || (!body->isDynamic() && body->getNode() != NULL);
+}
+
+static size_t hashPair(const RigidBody* a, const RigidBody* b)
+{
+    size_t h = (size_t)a * 2654435761u;
+    return (h ^ (h >> 16)) + (size_t)b * 40503u;
+}
+
+PhysicsWorld::PhysicsWorld()
+    : _gravity(0.0f, -9.8f, 0.0f)
+    , _fixedTimeStep(1.0f / 60.0f)
+    , _maxSubSteps(4)
+    , _iterations(10)
+    , _accumulator(0.0f)
+{
+}
+
+PhysicsWorld::~PhysicsWorld()
+{
+    _listeners.clear();
+    removeAllBodies();
+}
+
+void PhysicsWorld::addBody(RigidBody* body)
+{
+    if (body == NULL || body->_world == this)
+        return;
+
+    body->retain();
+    if (body->_world)
+        body->_world->removeBody(body);
+
+    body->_world = this;
+    body->wakeUp();
+    body->updateAABB();
+
+    // the insertion sort of the next step moves it to its place
+    _order.push_back((int)_bodies.size());
+    _bodies.push_back(body);
+}
+
+void PhysicsWorld::removeBody(RigidBody* body)
+{
+    if (body == NULL || body->_world != this)
+        return;
+
+    std::vector<RigidBody*>::iterator it = std::find(_bodies.begin(), _bodies.end(), body);
+    int index = (int)(it - _bodies.begin());
+    int last = (int)_bodies.size() - 1;
+
+    // swap remove, the last body takes the index of the removed one
+    _bodies[index] = _bodies[last];
+    _bodies.pop_back();
+    _order.erase(std::find(_order.begin(), _order.end(), index));
+    for (size_t i = 0; i < _order.size(); i++)
+    {
+        if (_order[i] == last)
+            _order[i] = index;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < _records.size(); i++)
+    {
+        const PairRecord& record = _records[i];
+        if (record.bodyA != body && record.bodyB != body)
+        {
+            _records[kept++] = record;
+            continue;
+        }
+
+        if (record.touching)
+        {
+            for (size_t l = 0; l < _listeners.size(); l++)
+            {
+                _listeners[l]->contactEnded(record.bodyA, record.bodyB);
+            }
+        }
+    }
+    _records.resize(kept);
+    rebuildPairTable();
+
+    for (size_t i = 0; i < _contacts.size(); i++)
+    {
+        if (_contacts[i].bodyA == body || _contacts[i].bodyB == body)
+        {
+            _contacts[i] = _contacts.back();
+            _contacts.pop_back();
+            i--;
+        }
+    }
+    _pairs.clear();
+    _contactRecords.clear();
+
+    body->_world = NULL;
+    body->release();
+}
+
+void PhysicsWorld::removeAllBodies()
+{
+    while (!_bodies.empty())
+    {
+        removeBody(_bodies.back());
+    }
+}
+
+void PhysicsWorld::addListener(Listener* listener)
+{
+    if (std::find(_listeners.begin(), _listeners.end(), listener) == _listeners.end())
+        _listeners.push_back(listener);
+}
+
+void PhysicsWorld::removeListener(Listener* listener)
+{
+    std::vector<Listener*>::iterator it = std::find(_listeners.begin(), _listeners.end(), listener);
+    if (it != _listeners.end())
+        _listeners.erase(it);
+}
+
+void PhysicsWorld::setFixedTimeStep(float timeStep, int maxSubSteps)
+{
+    _fixedTimeStep = timeStep;
+    _maxSubSteps = C3D_Max(maxSubSteps, 1);
+}
+
+void PhysicsWorld::step(long elapsedTime)
+{
+    float frameTime = elapsedTime * 0.001f;
+    if (frameTime <= 0.0f || _bodies.empty())
+        return;
+
+    size_t i;
+    _awakeBodies.clear();
+    for (i = 0; i < _bodies.size(); i++)
+    {
+        RigidBody* body = _bodies[i];
+        if (body->isDynamic())
+        {
+            if (!body->_sleeping)
+                _awakeBodies.push_back(body);
+        }
+        else if (body->_node)
+        {
+            // node driven bodies push the others with the velocity of their node
+            C3DVector3 position = body->_position;
+            body->pullNode();
+            body->_linearVelocity = (body->_position - position) * (1.0f / frameTime);
+        }
+    }
+
+    _accumulator += frameTime;
+    int steps = 0;
+    while (_accumulator >= _fixedTimeStep && steps < _maxSubSteps)
+    {
+        simulate(_fixedTimeStep);
+        _accumulator -= _fixedTimeStep;
+        steps++;
+    }
+
+    // too slow to catch up, drop the time left instead of spiraling
+    if (steps == _maxSubSteps && _accumulator > _fixedTimeStep)
+        _accumulator = 0.0f;
+
+    for (i = 0; i < _bodies.size(); i++)
+    {
+        _bodies[i]->_force.set(0.0f, 0.0f, 0.0f);
+        _bodies[i]->_torque.set(0.0f, 0.0f, 0.0f);
+    }
+
+    if (steps > 0)
+    {
+        for (i = 0; i < _awakeBodies.size(); i++)
+        {
+            _awakeBodies[i]->pushNode();
+        }
+    }
+}
+
+void PhysicsWorld::simulate(float dt)
+{
+    integrateVelocities(dt);
+    broadphase();
+    narrowphase();
+
+    prepareContacts(dt);
+    for (int i = 0; i < _iterations; i++)
+    {
+        solveContacts();
+    }
+    storeImpulses();
+
+    integratePositions(dt);
+    updateIslands(dt);
+    dispatchEvents();
+}
+
+void PhysicsWorld::integrateVelocities(float dt)
+{
+    for (size_t i = 0; i < _bodies.size(); i++)
+    {
+        RigidBody* body = _bodies[i];
+        if (!isAwake(body))
+            continue;
+
+        body->_linearVelocity += (_gravity + body->_force * body->_invMass) * dt;
+        body->_angularVelocity += body->applyInvInertia(body->_torque) * dt;
+
+        body->_linearVelocity *= C3D_Max(1.0f - body->_param.linearDamping * dt, 0.0f);
+        body->_angularVelocity *= C3D_Max(1.0f - body->_param.angularDamping * dt, 0.0f);
+    }
+}
+
+void PhysicsWorld::integratePositions(float dt)
+{
+    for (size_t i = 0; i < _bodies.size(); i++)
+    {
+        RigidBody* body = _bodies[i];
+        if (!isAwake(body))
+            continue;
+
+        body->_position += body->_linearVelocity * dt;
+
+        const C3DVector3& w = body->_angularVelocity;
+        if (w.lengthSquared() > 0.0f)
+        {
+            // q' = q + 0.5 * (w, 0) * q * dt
+            C3DQuaternion spin;
+            C3DQuaternion::multiply(C3DQuaternion(w.x, w.y, w.z, 0.0f), body->_rotation, &spin);
+            C3DQuaternion& q = body->_rotation;
+            float h = 0.5f * dt;
+            q.set(q.x + spin.x * h, q.y + spin.y * h, q.z + spin.z * h, q.w + spin.w * h);
+            q.normalize();
+        }
+
+        body->updateAABB();
+    }
+}
+
+void PhysicsWorld::broadphase()
+{
+    size_t count = _bodies.size();
+    int i, j;
+
+    // the order of the last step is nearly sorted, insertion sort is about linear
+    for (i = 1; i < (int)count; i++)
+    {
+        int index = _order[i];
+        float key = _bodies[index]->_aabb._min.x;
+        for (j = i - 1; j >= 0 && _bodies[_order[j]]->_aabb._min.x > key; j--)
+        {
+            _order[j + 1] = _order[j];
+        }
+        _order[j + 1] = index;
+    }
+
+    // the sweep reads the bounds in order
+    _minX.resize(count); _maxX.resize(count);
+    _minY.resize(count); _maxY.resize(count);
+    _minZ.resize(count); _maxZ.resize(count);
+    for (i = 0; i < (int)count; i++)
+    {
+        const C3DAABB& aabb = _bodies[_order[i]]->_aabb;
+        _minX[i] = aabb._min.x; _maxX[i] = aabb._max.x;
+        _minY[i] = aabb._min.y; _maxY[i] = aabb._max.y;
+        _minZ[i] = aabb._min.z; _maxZ[i] = aabb._max.z;
+    }
+
+    _pairs.clear();
+    for (i = 0; i < (int)count; i++)
+    {
+        RigidBody* a = _bodies[_order[i]];
+        bool activeA = isActive(a);
+        float maxX = _maxX[i];
+        for (j = i + 1; j < (int)count && _minX[j] <= maxX; j++)
+        {
+            if (_maxY[i] < _minY[j] || _minY[i] > _maxY[j] || _maxZ[i] < _minZ[j] || _minZ[i] > _maxZ[j])
+                continue;
+
+            RigidBody* b = _bodies[_order[j]];
+            if (!activeA && !isActive(b))
+                continue;
+            if ((a->_param.group & b->_param.mask) == 0 || (b->_param.group & a->_param.mask) == 0)
+                continue;
+
+            _pairs.push_back(std::make_pair(_order[i], _order[j]));
+        }
+    }
+}
+
+void PhysicsWorld::narrowphase()
+{
+    _contacts.clear();
+    _contactRecords.clear();
+
+    // the separating axis tests of the box pairs run in one batch
+    _boxPairs.clear();
+    for (size_t i = 0; i < _pairs.size(); i++)
+    {
+        RigidBody* a = _bodies[_pairs[i].first];
+        RigidBody* b = _bodies[_pairs[i].second];
+        if (!isBoxPair(a, b))
+            continue;
+
+        _boxPairs.resize(_boxPairs.size() + C3DMathSIMD::BOX_PAIR_FLOATS);
+        packBoxPair(a, b, &_boxPairs[_boxPairs.size() - C3DMathSIMD::BOX_PAIR_FLOATS]);
+    }
+
+    unsigned int boxCount = (unsigned int)(_boxPairs.size() / C3DMathSIMD::BOX_PAIR_FLOATS);
+    if (boxCount > 0)
+    {
+        _boxDepths.resize(boxCount);
+        _boxNormals.resize(boxCount * 3);
+        C3DMathSIMD::getInstance().collideBoxes(&_boxPairs[0], boxCount, &_boxDepths[0], &_boxNormals[0]);
+    }
+
+    PhysicsContact contact;
+    unsigned int box = 0;
+    for (size_t i = 0; i < _pairs.size(); i++)
+    {
+        RigidBody* a = _bodies[_pairs[i].first];
+        RigidBody* b = _bodies[_pairs[i].second];
+        bool touching;
+        if (isBoxPair(a, b))
+        {
+            touching = collideBoxPair(a, b, &_boxPairs[box * C3DMathSIMD::BOX_PAIR_FLOATS], _boxDepths[box], &_boxNormals[box * 3], &contact);
+            box++;
+        }
+        else
+        {
+            touching = collideBodies(a, b, &contact);
+        }
+        if (!touching)
+            continue;
+
+        // a moving body wakes up the sleeping body it touches
+        if (a->isDynamic() && a->_sleeping && (isAwake(b) || b->_linearVelocity.lengthSquared() > 0.0f))
+            a->wakeUp();
+        else if (b->isDynamic() && b->_sleeping && (isAwake(a) || a->_linearVelocity.lengthSquared() > 0.0f))
+            b->wakeUp();
+
+        int record = findPairRecord(a, b);
+        _records[record].contact = (int)_contacts.size();
+        _contactRecords.push_back(record);
+        _contacts.push_back(contact);
+    }
+}
+
+void PhysicsWorld::prepareContacts(float dt)
+{
+    _points.resize(_contacts.size() * PHYSICS_MAX_CONTACT_POINTS);
+
+    for (size_t i = 0; i < _contacts.size(); i++)
+    {
+        const PhysicsContact& contact = _contacts[i];
+        RigidBody* a = contact.bodyA;
+        RigidBody* b = contact.bodyB;
+
+        // any unit vector orthogonal to the normal, then the third axis
+        const C3DVector3& n = contact.normal;
+        C3DVector3 t0 = fabsf(n.x) > 0.57735f ? C3DVector3(n.y, -n.x, 0.0f) : C3DVector3(0.0f, n.z, -n.y);
+        t0.normalize();
+        C3DVector3 t1;
+        C3DVector3::cross(n, t0, &t1);
+
+        float invMassA = isAwake(a) ? a->_invMass : 0.0f;
+        float invMassB = isAwake(b) ? b->_invMass : 0.0f;
+        float restitution = C3D_Max(a->_param.restitution, b->_param.restitution);
+
+        // the contact points of a pair come in the same order while it rests
+        const CachedImpulse* cached = &_records[_contactRecords[i]].impulse;
+        if (cached->bodyA != a || cached->pointCount != contact.pointCount)
+            cached = NULL;
+
+        for (int k = 0; k < contact.pointCount; k++)
+        {
+            ContactPoint& point = _points[i * PHYSICS_MAX_CONTACT_POINTS + k];
+            point.rA = contact.points[k] - a->_position;
+            point.rB = contact.points[k] - b->_position;
+            point.tangent[0] = t0;
+            point.tangent[1] = t1;
+            if (cached)
+            {
+                point.normalImpulse = cached->normalImpulse[k];
+                point.tangentImpulse[0] = cached->tangentImpulse[k][0];
+                point.tangentImpulse[1] = cached->tangentImpulse[k][1];
+            }
+            else
+            {
+                point.normalImpulse = 0.0f;
+                point.tangentImpulse[0] = point.tangentImpulse[1] = 0.0f;
+            }
+
+            // effective mass along the direction d: 1 / (1/ma + 1/mb + d.((Ia^-1 (ra x d)) x ra) + d.((Ib^-1 (rb x d)) x rb))
+            C3DVector3 dirs[3] = { n, t0, t1 };
+            float masses[3];
+            for (int d = 0; d < 3; d++)
+            {
+                float inv = invMassA + invMassB;
+                C3DVector3 rxd, w, c;
+                if (invMassA > 0.0f)
+                {
+                    C3DVector3::cross(point.rA, dirs[d], &rxd);
+                    w = a->applyInvInertia(rxd);
+                    C3DVector3::cross(w, point.rA, &c);
+                    inv += dirs[d].dot(c);
+                }
+                if (invMassB > 0.0f)
+                {
+                    C3DVector3::cross(point.rB, dirs[d], &rxd);
+                    w = b->applyInvInertia(rxd);
+                    C3DVector3::cross(w, point.rB, &c);
+                    inv += dirs[d].dot(c);
+                }
+                masses[d] = inv > 0.0f ? 1.0f / inv : 0.0f;
+            }
+            point.normalMass = masses[0];
+            point.tangentMass[0] = masses[1];
+            point.tangentMass[1] = masses[2];
+
+            // push the bodies apart, or bounce when the impact is fast enough
+            C3DVector3 va, vb;
+            C3DVector3::cross(a->_angularVelocity, point.rA, &va);
+            C3DVector3::cross(b->_angularVelocity, point.rB, &vb);
+            float vn = (b->_linearVelocity + vb - a->_linearVelocity - va).dot(n);
+
+            point.bias = PHYSICS_BAUMGARTE / dt * C3D_Max(contact.depth - PHYSICS_SLOP, 0.0f);
+            if (vn < -PHYSICS_RESTITUTION_VELOCITY)
+                point.bias = C3D_Max(point.bias, -restitution * vn);
+        }
+    }
+
+    // warm start once every bounce velocity is known
+    for (size_t i = 0; i < _contacts.size(); i++)
+    {
+        const PhysicsContact& contact = _contacts[i];
+        RigidBody* a = contact.bodyA;
+        RigidBody* b = contact.bodyB;
+        if (a->isTrigger() || b->isTrigger())
+            continue;
+
+        bool moveA = isAwake(a);
+        bool moveB = isAwake(b);
+        for (int k = 0; k < contact.pointCount; k++)
+        {
+            const ContactPoint& point = _points[i * PHYSICS_MAX_CONTACT_POINTS + k];
+            C3DVector3 p = contact.normal * point.normalImpulse + point.tangent[0] * point.tangentImpulse[0] + point.tangent[1] * point.tangentImpulse[1];
+            C3DVector3 torque;
+            if (moveA)
+            {
+                a->_linearVelocity -= p * a->_invMass;
+                C3DVector3::cross(point.rA, p, &torque);
+                a->_angularVelocity -= a->applyInvInertia(torque);
+            }
+            if (moveB)
+            {
+                b->_linearVelocity += p * b->_invMass;
+                C3DVector3::cross(point.rB, p, &torque);
+                b->_angularVelocity += b->applyInvInertia(torque);
+            }
+        }
+    }
+}
+
+void PhysicsWorld::solveContacts()
+{
+    for (size_t i = 0; i < _contacts.size(); i++)
+    {
+        const PhysicsContact& contact = _contacts[i];
+        RigidBody* a = contact.bodyA;
+        RigidBody* b = contact.bodyB;
+
+        bool moveA = isAwake(a);
+        bool moveB = isAwake(b);
+        if ((!moveA && !moveB) || a->isTrigger() || b->isTrigger())
+            continue;
+
+        float friction = sqrtf(a->_param.friction * b->_param.friction);
+
+        for (int k = 0; k < contact.pointCount; k++)
+        {
+            ContactPoint& point = _points[i * PHYSICS_MAX_CONTACT_POINTS + k];
+
+            for (int d = 0; d < 3; d++)
+            {
+                // friction first, clamped by the normal impulse of the last iteration
+                int t = d < 2 ? d : -1;
+                const C3DVector3& dir = t >= 0 ? point.tangent[t] : contact.normal;
+
+                C3DVector3 va, vb;
+                C3DVector3::cross(a->_angularVelocity, point.rA, &va);
+                C3DVector3::cross(b->_angularVelocity, point.rB, &vb);
+                float v = (b->_linearVelocity + vb - a->_linearVelocity - va).dot(dir);
+
+                float lambda;
+                if (t >= 0)
+                {
+                    float maxImpulse = friction * point.normalImpulse;
+                    float impulse = point.tangentImpulse[t] - v * point.tangentMass[t];
+                    impulse = impulse < -maxImpulse ? -maxImpulse : (impulse > maxImpulse ? maxImpulse : impulse);
+                    lambda = impulse - point.tangentImpulse[t];
+                    point.tangentImpulse[t] = impulse;
+                }
+                else
+                {
+                    float impulse = C3D_Max(point.normalImpulse + (point.bias - v) * point.normalMass, 0.0f);
+                    lambda = impulse - point.normalImpulse;
+                    point.normalImpulse = impulse;
+                }
+
+                C3DVector3 p = dir * lambda;
+                C3DVector3 torque;
+                if (moveA)
+                {
+                    a->_linearVelocity -= p * a->_invMass;
+                    C3DVector3::cross(point.rA, p, &torque);
+                    a->_angularVelocity -= a->applyInvInertia(torque);
+                }
+                if (moveB)
+                {
+                    b->_linearVelocity += p * b->_invMass;
+                    C3DVector3::cross(point.rB, p, &torque);
+                    b->_angularVelocity += b->applyInvInertia(torque);
+                }
+            }
+        }
+    }
+}
+
+void PhysicsWorld::storeImpulses()
+{
+    // the records without contact drop their impulses in dispatchEvents
+    for (size_t i = 0; i < _contacts.size(); i++)
+    {
+        const PhysicsContact& contact = _contacts[i];
+        CachedImpulse& cached = _records[_contactRecords[i]].impulse;
+        cached.bodyA = contact.bodyA;
+        cached.pointCount = contact.pointCount;
+        for (int k = 0; k < contact.pointCount; k++)
+        {
+            const ContactPoint& point = _points[i * PHYSICS_MAX_CONTACT_POINTS + k];
+            cached.normalImpulse[k] = point.normalImpulse;
+            cached.tangentImpulse[k][0] = point.tangentImpulse[0];
+            cached.tangentImpulse[k][1] = point.tangentImpulse[1];
+        }
+    }
+}
+
+int PhysicsWorld::findPairRecord(RigidBody* a, RigidBody* b)
+{
+    if (b < a)
+        std::swap(a, b);
+
+    // at most half full, the probes stay short
+    if ((_records.size() + 1) * 2 > _pairTable.size())
+        rebuildPairTable();
+
+    size_t mask = _pairTable.size() - 1;
+    for (size_t slot = hashPair(a, b) & mask; ; slot = (slot + 1) & mask)
+    {
+        int index = _pairTable[slot];
+        if (index < 0)
+        {
+            PairRecord record;
+            record.bodyA = a;
+            record.bodyB = b;
+            record.contact = -1;
+            record.touching = false;
+            record.impulse.bodyA = NULL;
+            record.impulse.pointCount = 0;
+
+            index = (int)_records.size();
+            _records.push_back(record);
+            _pairTable[slot] = index;
+            return index;
+        }
+        if (_records[index].bodyA == a && _records[index].bodyB == b)
+            return index;
+    }
+}
+
+void PhysicsWorld::rebuildPairTable()
+{
+    size_t size = 16;
+    while (size < (_records.size() + 1) * 2)
+        size *= 2;
+    _pairTable.assign(size, -1);
+
+    size_t mask = size - 1;
+    for (size_t i = 0; i < _records.size(); i++)
+    {
+        size_t slot = hashPair(_records[i].bodyA, _records[i].bodyB) & mask;
+        while (_pairTable[slot] >= 0)
+            slot = (slot + 1) & mask;
+        _pairTable[slot] = (int)i;
+    }
+}
+
+int PhysicsWorld::findIsland(int index)
+{
+    while (_islands[index] != index)
+    {
+        _islands[index] = _islands[_islands[index]];
+        index = _islands[index];
+    }
+    return index;
+}
+
+void PhysicsWorld::updateIslands(float dt)
+{
+    size_t count = _bodies.size();
+    size_t i;
+
+    _islands.resize(count);
+    _islandSleepTime.assign(count, FLT_MAX);
+    for (i = 0; i < count; i++)
+    {
+        _islands[i] = (int)i;
+        _bodies[i]->_island = (int)i;
+    }
+
+    // awake dynamic bodies touching each other share an island, static bodies don't link islands
+    for (i = 0; i < _contacts.size(); i++)
+    {
+        const PhysicsContact& contact = _contacts[i];
+        if (!isAwake(contact.bodyA) || !isAwake(contact.bodyB) || contact.bodyA->isTrigger() || contact.bodyB->isTrigger())
+            continue;
+
+        int a = findIsland(contact.bodyA->_island);
+        int b = findIsland(contact.bodyB->_island);
+        if (a != b)
+            _islands[a] = b;
+    }
+
+    float linear2 = PHYSICS_SLEEP_LINEAR_VELOCITY * PHYSICS_SLEEP_LINEAR_VELOCITY;
+    float angular2 = PHYSICS_SLEEP_ANGULAR_VELOCITY * PHYSICS_SLEEP_ANGULAR_VELOCITY;
+    for (i = 0; i < count; i++)
+    {
+        RigidBody* body = _bodies[i];
+        if (!isAwake(body))
+            continue;
+
+        if (body->_linearVelocity.lengthSquared() < linear2 && body->_angularVelocity.lengthSquared() < angular2)
+            body->_sleepTime += dt;
+        else
+            body->_sleepTime = 0.0f;
+
+        int island = findIsland((int)i);
+        _islandSleepTime[island] = C3D_Min(_islandSleepTime[island], body->_sleepTime);
+    }
+
+    // the island sleeps once its most restless body stayed slow long enough
+    for (i = 0; i < count; i++)
+    {
+        RigidBody* body = _bodies[i];
+        if (isAwake(body) && _islandSleepTime[findIsland((int)i)] >= PHYSICS_TIME_TO_SLEEP)
+        {
+            body->_sleeping = true;
+            body->_linearVelocity.set(0.0f, 0.0f, 0.0f);
+            body->_angularVelocity.set(0.0f, 0.0f, 0.0f);
+        }
+    }
+}
+
+void PhysicsWorld::dispatchEvents()
+{
+    size_t i;
+    for (i = 0; i < _contacts.size(); i++)
+    {
+        PairRecord& record = _records[_contactRecords[i]];
+        if (record.touching)
+            continue;
+
+        record.touching = true;
+        for (size_t l = 0; l < _listeners.size(); l++)
+        {
+            _listeners[l]->contactBegan(_contacts[i]);
+        }
+    }
+
+    // the records are compacted, the pairs still touching are kept
+    size_t kept = 0;
+    for (i = 0; i < _records.size(); i++)
+    {
+        PairRecord record = _records[i];
+        if (record.contact < 0)
+        {
+            if (!record.touching)
+                continue;
+
+            // resting pairs are not tested while both sides sleep, they still touch
+            if (isActive(record.bodyA) || isActive(record.bodyB))
+            {
+                for (size_t l = 0; l < _listeners.size(); l++)
+                {
+                    _listeners[l]->contactEnded(record.bodyA, record.bodyB);
+                }
+                continue;
+            }
+            record.impulse.pointCount = 0;
+        }
+
+        record.contact = -1;
+        _records[kept++] = record;
+    }
+
+    if (kept != _records.size())
+    {
+        _records.resize(kept);
+        rebuildPairTable();
+    }
+}
+
+void PhysicsWorld::queryAABB(const C3DAABB& aabb, std::vector<RigidBody*>& result) const
+{
+    for (size_t i = 0; i < _bodies.size(); i++)
+    {
+        if (_bodies[i]->_aabb.intersects(aabb))
+            result.push_back(_bodies[i]);
+    }
+}
+}
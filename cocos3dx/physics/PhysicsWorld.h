@@ -0,0 +1,199 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef PHYSICSWORLD_H_
+#define PHYSICSWORLD_H_
+
+#include <vector>
+#include "C3DVector3.h"
+#include "C3DAABB.h"
+#include "PhysicsCollision.h"
+
+namespace cocos3d
+{
+class RigidBody;
+
+/**
+ * Defines a rigid body world stepped with a fixed time step.
+ *
+ * The broadphase sweeps the bodies sorted along x, the order is kept from one step to the next
+ * so the insertion sort runs in about linear time. Touching pairs go through the narrowphase
+ * then a sequential impulse solver. Dynamic bodies linked by contacts form islands, an island
+ * falls asleep once all its bodies stayed slow for a while and costs nothing until something
+ * touches it.
+ */
+class PhysicsWorld
+{
+public:
+    /**
+     * Listener interface for contact events.
+     */
+    class Listener
+    {
+    public:
+        virtual ~Listener() { }
+
+        /**
+         * Handles when two bodies start touching, the bodies must not be removed here.
+         */
+        virtual void contactBegan(const PhysicsContact& contact) = 0;
+
+        /**
+         * Handles when two bodies stop touching.
+         */
+        virtual void contactEnded(RigidBody* bodyA, RigidBody* bodyB) = 0;
+    };
+
+    PhysicsWorld();
+    ~PhysicsWorld();
+
+    /**
+     * add & remove body, the world retains its bodies
+     */
+    void addBody(RigidBody* body);
+    void removeBody(RigidBody* body);
+    void removeAllBodies();
+    const std::vector<RigidBody*>& getBodies() const { return _bodies; }
+
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+    /**
+     * get & set gravity
+     */
+    const C3DVector3& getGravity() const { return _gravity; }
+    void setGravity(const C3DVector3& gravity) { _gravity = gravity; }
+
+    /**
+     * fixed time step in seconds, and max steps run by a single step() call
+     */
+    void setFixedTimeStep(float timeStep, int maxSubSteps = 4);
+    float getFixedTimeStep() const { return _fixedTimeStep; }
+
+    /**
+     * solver iterations of each step
+     */
+    void setIterations(int iterations) { _iterations = iterations; }
+
+    /**
+     * advances the world by elapsedTime milliseconds, called by C3DScene::update
+     */
+    void step(long elapsedTime);
+
+    /**
+     * contacts of the last fixed step
+     */
+    const std::vector<PhysicsContact>& getContacts() const { return _contacts; }
+
+    /**
+     * collects the bodies whose bounds intersect aabb
+     */
+    void queryAABB(const C3DAABB& aabb, std::vector<RigidBody*>& result) const;
+
+    /**
+     * pairs found by the broadphase in the last fixed step
+     */
+    unsigned int getPairCount() const { return (unsigned int)_pairs.size(); }
+
+private:
+    struct ContactPoint
+    {
+        C3DVector3 rA;
+        C3DVector3 rB;
+        C3DVector3 tangent[2];
+        float normalMass;
+        float tangentMass[2];
+        float bias;
+        float normalImpulse;
+        float tangentImpulse[2];
+    };
+
+    // impulses of the last step, the solver starts from them
+    struct CachedImpulse
+    {
+        RigidBody* bodyA; // the points don't match once the pair is flipped
+        int pointCount;   // 0 without impulses
+        float normalImpulse[PHYSICS_MAX_CONTACT_POINTS];
+        float tangentImpulse[PHYSICS_MAX_CONTACT_POINTS][2];
+    };
+
+    // pair of bodies kept from one step to the next while they touch
+    struct PairRecord
+    {
+        RigidBody* bodyA; // the lower address first
+        RigidBody* bodyB;
+        int contact;      // index in _contacts during the step, -1 without contact
+        bool touching;    // contactBegan was sent
+        CachedImpulse impulse;
+    };
+
+    void simulate(float dt);
+    void integrateVelocities(float dt);
+    void integratePositions(float dt);
+    void broadphase();
+    void narrowphase();
+    void prepareContacts(float dt);
+    void solveContacts();
+    void storeImpulses();
+    void updateIslands(float dt);
+    void dispatchEvents();
+
+    int findIsland(int index);
+    int findPairRecord(RigidBody* a, RigidBody* b);
+    void rebuildPairTable();
+
+    C3DVector3 _gravity;
+    float _fixedTimeStep;
+    int _maxSubSteps;
+    int _iterations;
+    float _accumulator;
+
+    std::vector<RigidBody*> _bodies;
+
+    // broadphase, body indices sorted by min x and their bounds in the same order
+    std::vector<int> _order;
+    std::vector<float> _minX, _maxX, _minY, _maxY, _minZ, _maxZ;
+    std::vector<std::pair<int, int> > _pairs;
+
+    // narrowphase, the box pairs packed for C3DMathSIMD::collideBoxes and its results
+    std::vector<float> _boxPairs;
+    std::vector<float> _boxDepths;
+    std::vector<float> _boxNormals;
+
+    std::vector<PhysicsContact> _contacts;
+    std::vector<ContactPoint> _points; // PHYSICS_MAX_CONTACT_POINTS per contact
+    std::vector<int> _contactRecords; // pair record of each contact
+
+    // pair records and their open addressing table of record indices, -1 for the free slots
+    std::vector<PairRecord> _records;
+    std::vector<int> _pairTable;
+
+    std::vector<int> _islands; // union find parents
+    std::vector<float> _islandSleepTime;
+    std::vector<RigidBody*> _awakeBodies; // dynamic bodies awake at the beginning of step()
+
+    std::vector<Listener*> _listeners;
+};
+}
+
+#endif
@@ -1,6 +1,267 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
 
-#include "Physics.h"
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
 
-// physics header
- 
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
 
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "Base.h"
+#include "RigidBody.h"
+#include "PhysicsWorld.h"
+#include "C3DNode.h"
+
+namespace cocos3d
+{
+// rotates v by the unit quaternion q
+static C3DVector3 rotateVector(const C3DQuaternion& q, const C3DVector3& v)
+{
+    C3DVector3 u(q.x, q.y, q.z);
+    C3DVector3 t;
+    C3DVector3::cross(u, v, &t);
+    t.scale(2.0f);
+
+    C3DVector3 c;
+    C3DVector3::cross(u, t, &c);
+    return v + t * q.w + c;
+}
+
+RigidBodyParameter::RigidBodyParameter()
+    : shape(Shape_Sphere)
+    , halfExtents(0.5f, 0.5f, 0.5f)
+    , radius(0.5f)
+    , halfHeight(0.5f)
+    , mass(1.0f)
+    , restitution(0.2f)
+    , friction(0.5f)
+    , linearDamping(0.05f)
+    , angularDamping(0.05f)
+    , group(1)
+    , mask(0xffffffff)
+    , trigger(false)
+{
+}
+
+RigidBody* RigidBody::create(const RigidBodyParameter& param, C3DNode* node)
+{
+    RigidBody* body = new RigidBody(param, node);
+    body->autorelease();
+    return body;
+}
+
+RigidBody::RigidBody(const RigidBodyParameter& param, C3DNode* node)
+    : _param(param)
+    , _node(node)
+    , _world(NULL)
+    , _rotation(C3DQuaternion::identity())
+    , _invMass(0.0f)
+    , _sleeping(false)
+    , _sleepTime(0.0f)
+    , _island(-1)
+    , _userData(NULL)
+{
+    if (_node)
+        _node->retain();
+
+    if (_param.mass > 0.0f && !_param.trigger)
+    {
+        _invMass = 1.0f / _param.mass;
+
+        // inertia of the bounding box of the shape, good enough for game objects
+        C3DVector3 h;
+        switch (_param.shape)
+        {
+        case RigidBodyParameter::Shape_Sphere:
+            h.set(_param.radius, _param.radius, _param.radius);
+            break;
+        case RigidBodyParameter::Shape_Capsule:
+            h.set(_param.radius, _param.halfHeight + _param.radius, _param.radius);
+            break;
+        default:
+            h = _param.halfExtents;
+            break;
+        }
+
+        // aabb shapes never rotate
+        if (_param.shape != RigidBodyParameter::Shape_AABB)
+        {
+            _invInertia.set(3.0f * _invMass / (h.y * h.y + h.z * h.z),
+                            3.0f * _invMass / (h.x * h.x + h.z * h.z),
+                            3.0f * _invMass / (h.x * h.x + h.y * h.y));
+        }
+    }
+
+    pullNode();
+}
+
+RigidBody::~RigidBody()
+{
+    SAFE_RELEASE(_node);
+}
+
+void RigidBody::setPosition(const C3DVector3& position)
+{
+    _position = position;
+    updateAABB();
+    wakeUp();
+}
+
+void RigidBody::setRotation(const C3DQuaternion& rotation)
+{
+    if (_param.shape == RigidBodyParameter::Shape_AABB)
+        return;
+
+    _rotation = rotation;
+    _rotation.normalize();
+    updateAABB();
+    wakeUp();
+}
+
+void RigidBody::setLinearVelocity(const C3DVector3& velocity)
+{
+    _linearVelocity = velocity;
+    wakeUp();
+}
+
+void RigidBody::setAngularVelocity(const C3DVector3& velocity)
+{
+    if (_param.shape == RigidBodyParameter::Shape_AABB)
+        return;
+
+    _angularVelocity = velocity;
+    wakeUp();
+}
+
+void RigidBody::applyForce(const C3DVector3& force)
+{
+    _force += force;
+    wakeUp();
+}
+
+void RigidBody::applyTorque(const C3DVector3& torque)
+{
+    _torque += torque;
+    wakeUp();
+}
+
+void RigidBody::applyImpulse(const C3DVector3& impulse, const C3DVector3& point)
+{
+    if (!isDynamic())
+        return;
+
+    _linearVelocity += impulse * _invMass;
+
+    C3DVector3 torque;
+    C3DVector3::cross(point - _position, impulse, &torque);
+    _angularVelocity += applyInvInertia(torque);
+    wakeUp();
+}
+
+void RigidBody::wakeUp()
+{
+    _sleeping = false;
+    _sleepTime = 0.0f;
+}
+
+void RigidBody::getOBB(C3DOBB* obb) const
+{
+    obb->center = _position;
+    obb->xAxis = rotateVector(_rotation, C3DVector3::unitX());
+    obb->yAxis = rotateVector(_rotation, C3DVector3::unitY());
+    obb->zAxis = rotateVector(_rotation, C3DVector3::unitZ());
+    obb->extents = _param.halfExtents;
+    obb->completeExtAxis();
+}
+
+void RigidBody::getSegment(C3DVector3* p0, C3DVector3* p1) const
+{
+    if (_param.shape == RigidBodyParameter::Shape_Capsule)
+    {
+        C3DVector3 axis = rotateVector(_rotation, C3DVector3(0.0f, _param.halfHeight, 0.0f));
+        *p0 = _position - axis;
+        *p1 = _position + axis;
+    }
+    else
+    {
+        *p0 = _position;
+        *p1 = _position;
+    }
+}
+
+void RigidBody::pullNode()
+{
+    if (_node)
+    {
+        _position = _node->getTranslationWorld();
+        if (_param.shape != RigidBodyParameter::Shape_AABB)
+        {
+            _rotation = _node->getRotationWorld();
+            _rotation.normalize();
+        }
+    }
+    updateAABB();
+}
+
+void RigidBody::pushNode()
+{
+    if (_node == NULL)
+        return;
+
+    _node->setPosition(_position);
+    if (_param.shape != RigidBodyParameter::Shape_AABB)
+        _node->setRotation(_rotation);
+}
+
+void RigidBody::updateAABB()
+{
+    C3DVector3 extent;
+    switch (_param.shape)
+    {
+    case RigidBodyParameter::Shape_Sphere:
+        extent.set(_param.radius, _param.radius, _param.radius);
+        break;
+    case RigidBodyParameter::Shape_Capsule:
+        {
+            C3DVector3 axis = rotateVector(_rotation, C3DVector3(0.0f, _param.halfHeight, 0.0f));
+            extent.set(fabsf(axis.x) + _param.radius, fabsf(axis.y) + _param.radius, fabsf(axis.z) + _param.radius);
+        }
+        break;
+    case RigidBodyParameter::Shape_OBB:
+        {
+            C3DOBB obb;
+            getOBB(&obb);
+            extent.set(fabsf(obb.extX.x) + fabsf(obb.extY.x) + fabsf(obb.extZ.x),
+                       fabsf(obb.extX.y) + fabsf(obb.extY.y) + fabsf(obb.extZ.y),
+                       fabsf(obb.extX.z) + fabsf(obb.extY.z) + fabsf(obb.extZ.z));
+        }
+        break;
+    case RigidBodyParameter::Shape_AABB:
+        extent = _param.halfExtents;
+        break;
+    }
+    _aabb.set(_position - extent, _position + extent);
+}
+
+C3DVector3 RigidBody::applyInvInertia(const C3DVector3& v) const
+{
+    C3DQuaternion inv(-_rotation.x, -_rotation.y, -_rotation.z, _rotation.w);
+    C3DVector3 local = rotateVector(inv, v);
+    local.set(local.x * _invInertia.x, local.y * _invInertia.y, local.z * _invInertia.z);
+    return rotateVector(_rotation, local);
+}
+}
@@ -1,17 +1,177 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
 #ifndef RRIGIDBODY_H_
 #define RRIGIDBODY_H_
 
+#include "cocos2d.h"
+#include "C3DVector3.h"
+#include "C3DQuaternion.h"
+#include "C3DAABB.h"
+#include "C3DOBB.h"
+
 //physics rigid body object
 
 namespace cocos3d
 {
-	struct RigidBodyParameter
-	{
+class C3DNode;
+class PhysicsWorld;
+
+/**
+ * Defines the collision shape & material of a rigid body.
+ */
+struct RigidBodyParameter
+{
+    enum ShapeType
+    {
+        Shape_Sphere,
+        Shape_Capsule,      // segment along the local y axis, swept by radius
+        Shape_OBB,
+        Shape_AABB,         // box which never rotates
+    };
+
+    ShapeType shape;
+    C3DVector3 halfExtents; // box half size
+    float radius;           // sphere & capsule radius
+    float halfHeight;       // capsule half segment length, without the caps
+
+    float mass;             // 0 for static or node driven (kinematic) bodies
+    float restitution;
+    float friction;
+    float linearDamping;    // velocity lost per second, 0..1
+    float angularDamping;
+
+    unsigned int group;     // the bodies collide when (a.group & b.mask) && (b.group & a.mask)
+    unsigned int mask;
+    bool trigger;           // reports contacts but is never pushed
+
+    RigidBodyParameter();
+};
+
+/**
+ * Defines a rigid body of a PhysicsWorld.
+ *
+ * The body may be bound to a node. Dynamic bodies write their transform to the node after every
+ * step, so the node should be a child of the scene. Static & kinematic bodies follow the world
+ * transform of their node.
+ */
+class RigidBody : public cocos2d::CCObject
+{
+    friend class PhysicsWorld;
+
+public:
+    static RigidBody* create(const RigidBodyParameter& param, C3DNode* node = NULL);
+
+    virtual ~RigidBody();
+
+    const RigidBodyParameter& getParameter() const { return _param; }
+
+    /**
+     * bound node
+     */
+    C3DNode* getNode() const { return _node; }
+
+    PhysicsWorld* getWorld() const { return _world; }
+
+    bool isDynamic() const { return _invMass > 0.0f; }
+    bool isTrigger() const { return _param.trigger; }
+
+    /**
+     * world transform of the body, setting it wakes the body up
+     */
+    const C3DVector3& getPosition() const { return _position; }
+    void setPosition(const C3DVector3& position);
+    const C3DQuaternion& getRotation() const { return _rotation; }
+    void setRotation(const C3DQuaternion& rotation);
+
+    const C3DVector3& getLinearVelocity() const { return _linearVelocity; }
+    void setLinearVelocity(const C3DVector3& velocity);
+    const C3DVector3& getAngularVelocity() const { return _angularVelocity; }
+    void setAngularVelocity(const C3DVector3& velocity);
+
+    /**
+     * force & torque are applied during the next step then cleared
+     */
+    void applyForce(const C3DVector3& force);
+    void applyTorque(const C3DVector3& torque);
+    void applyImpulse(const C3DVector3& impulse, const C3DVector3& point);
+
+    bool isSleeping() const { return _sleeping; }
+    void wakeUp();
+
+    /**
+     * world bounds of the shape
+     */
+    const C3DAABB& getAABB() const { return _aabb; }
+
+    /**
+     * box of the shape in world space, only valid for box shapes
+     */
+    void getOBB(C3DOBB* obb) const;
+
+    /**
+     * capsule segment in world space
+     */
+    void getSegment(C3DVector3* p0, C3DVector3* p1) const;
+
+    void setUserData(void* data) { _userData = data; }
+    void* getUserData() const { return _userData; }
+
+protected:
+    RigidBody(const RigidBodyParameter& param, C3DNode* node);
+
+    // read the transform of the bound node
+    void pullNode();
+
+    // write the transform to the bound node
+    void pushNode();
+
+    void updateAABB();
+
+    // world space inverse inertia applied to v
+    C3DVector3 applyInvInertia(const C3DVector3& v) const;
+
+    RigidBodyParameter _param;
+    C3DNode* _node;
+    PhysicsWorld* _world;
+
+    C3DVector3 _position;
+    C3DQuaternion _rotation;
+    C3DVector3 _linearVelocity;
+    C3DVector3 _angularVelocity;
+    C3DVector3 _force;
+    C3DVector3 _torque;
+
+    float _invMass;
+    C3DVector3 _invInertia; // local diagonal inverse inertia
+
+    C3DAABB _aabb;
 
-	};
-	class RigidBody
-	{
+    bool _sleeping;
+    float _sleepTime;       // seconds spent under the sleep velocity
+    int _island;
 
-	};
+    void* _userData;
+};
 }
 #endif
@@ -0,0 +1,140 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+// Draws a scene with the null GL backend and checks the GL calls counted by the shim.
+// usage: C3DGLShimTest [resource directory]
+
+#include "Base.h"
+#include "cocos2d.h"
+#include "C3DScene.h"
+#include "C3DCamera.h"
+#include "C3DRenderSystem.h"
+#include "C3DRenderNodeManager.h"
+#include "C3DSprite.h"
+#include "C3DTest.h"
+
+#ifndef C3D_GL_NULL
+#error "the test runs with the null GL backend, build it with C3D_GL_NULL"
+#endif
+
+using namespace cocos3d;
+
+struct FrameCounts
+{
+    unsigned int draws;
+    unsigned int states;
+    unsigned int objects;
+    unsigned int textureUploads;
+};
+
+static FrameCounts drawFrame(C3DScene* scene)
+{
+    C3DGLShim::resetCounters();
+
+    scene->update(16);
+    scene->preDraw();
+    scene->draw();
+    scene->postDraw();
+
+    FrameCounts counts;
+    counts.draws = C3DGLShim::getCount(C3DGLShim::COUNT_DRAW);
+    counts.states = C3DGLShim::getCount(C3DGLShim::COUNT_STATE);
+    counts.objects = C3DGLShim::getCount(C3DGLShim::COUNT_OBJECT);
+    counts.textureUploads = C3DGLShim::getCount(C3DGLShim::COUNT_TEXTURE_UPLOAD);
+    return counts;
+}
+
+static void addSprites(C3DScene* scene, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        C3DSprite* sprite = static_cast<C3DSprite*>(C3DRenderNodeManager::getInstance()->getResource("demores/haigui/haigui.ckb"));
+        C3D_CHECK(sprite != NULL);
+        if (sprite == NULL)
+            return;
+
+        sprite->setPosition((i % 3 - 1) * 10.0f, (i / 3 % 3 - 1) * 10.0f, -(i / 9) * 10.0f);
+        scene->addChild(sprite);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string resources = argc > 1 ? argv[1] : "../../template/multi-platform-cpp/Resources";
+    cocos2d::CCFileUtils::getInstance()->addSearchPath(resources);
+    cocos2d::CCFileUtils::getInstance()->addSearchPath(resources + "/3d");
+
+    // there is no window, the render system gets the viewport from the test
+    C3DRenderSystem::getInstance()->setViewport(0, 0, 480, 320);
+
+    C3DScene* scene = C3DScene::createScene(NULL);
+
+    C3DCamera* camera = C3DCamera::createPerspective(45, 1.5f, 1, 1000);
+    camera->lookAt(C3DVector3(0, 0, 100), C3DVector3(0, 1, 0), C3DVector3(0, 0, 0));
+    scene->addChild(camera);
+
+    C3DCamera* awayCamera = C3DCamera::createPerspective(45, 1.5f, 1, 1000);
+    awayCamera->lookAt(C3DVector3(0, 0, 100), C3DVector3(0, 1, 0), C3DVector3(0, 0, 200));
+    scene->addChild(awayCamera);
+
+    scene->setActiveCamera(0);
+    addSprites(scene, 1);
+
+    // the first frame compiles the effects and uploads the meshes
+    FrameCounts first = drawFrame(scene);
+    C3D_CHECK(first.draws > 0);
+    C3D_CHECK(first.objects > 0);
+
+    // then nothing is created nor uploaded, and the frames are the same
+    FrameCounts one = drawFrame(scene);
+    C3D_CHECK(one.draws == first.draws);
+    C3D_CHECK(one.objects == 0);
+    C3D_CHECK(one.textureUploads == 0);
+
+    FrameCounts again = drawFrame(scene);
+    C3D_CHECK(again.draws == one.draws);
+    C3D_CHECK(again.states == one.states);
+
+    // nothing is drawn when the camera looks away
+    scene->setActiveCamera(1);
+    FrameCounts none = drawFrame(scene);
+    C3D_CHECK(none.draws == 0);
+    C3D_CHECK(none.states < one.states);
+    scene->setActiveCamera(0);
+
+    // the same sprite 9 times: 9 times the draws, and the state cache keeps
+    // the state changes of the next sprites below the ones of the first
+    addSprites(scene, 8);
+    drawFrame(scene);
+    FrameCounts nine = drawFrame(scene);
+    C3D_CHECK_MSG(nine.draws == 9 * one.draws, "%u draws for 9 sprites, %u for 1", nine.draws, one.draws);
+    C3D_CHECK_MSG(nine.states - none.states <= 9 * (one.states - none.states),
+        "%u state changes for 9 sprites, %u for 1, %u for none", nine.states, one.states, none.states);
+    C3D_CHECK(nine.objects == 0);
+
+    printf("1 sprite: %u draws, %u state changes\n", one.draws, one.states);
+    printf("9 sprites: %u draws, %u state changes\n", nine.draws, nine.states);
+
+    SAFE_DELETE(scene);
+
+    return C3D_TEST_RESULT();
+}
@@ -0,0 +1,296 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+// Parity of the C3DMathSIMD backends with the scalar reference.
+
+#include "Base.h"
+#include "C3DMathSIMD.h"
+#include "C3DMatrix.h"
+#include "C3DQuaternion.h"
+#include "C3DTest.h"
+
+using namespace cocos3d;
+
+static const float TOLERANCE = 1e-4f;
+
+#define CHECK_PARITY(backend, function, condition) C3D_CHECK_MSG(condition, "%s %s", backend, function)
+
+// deterministic, the failures must be reproducible
+static unsigned int __seed = 12345;
+
+static float randomFloat(float min, float max)
+{
+    __seed = __seed * 1664525 + 1013904223;
+    return min + (max - min) * ((__seed >> 8) / 16777216.0f);
+}
+
+static void randomTransform(float* m)
+{
+    C3DQuaternion rotation(randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(-1, 1));
+    rotation.normalize();
+
+    C3DMatrix matrix;
+    C3DMatrix::createRotation(rotation, &matrix);
+    matrix.scale(randomFloat(0.5f, 2.0f), randomFloat(0.5f, 2.0f), randomFloat(0.5f, 2.0f));
+    matrix.m[12] = randomFloat(-100, 100);
+    matrix.m[13] = randomFloat(-100, 100);
+    matrix.m[14] = randomFloat(-100, 100);
+
+    memcpy(m, matrix.m, sizeof(matrix.m));
+}
+
+static void randomProjection(float* m)
+{
+    C3DMatrix matrix;
+    C3DMatrix::createPerspective(randomFloat(30, 90), randomFloat(0.5f, 2.0f), randomFloat(0.1f, 1.0f), randomFloat(100, 1000), &matrix);
+    memcpy(m, matrix.m, sizeof(matrix.m));
+}
+
+static void randomQuaternion(float* q)
+{
+    C3DQuaternion quaternion(randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(-1, 1), randomFloat(-1, 1));
+    quaternion.normalize();
+    q[0] = quaternion.x;
+    q[1] = quaternion.y;
+    q[2] = quaternion.z;
+    q[3] = quaternion.w;
+}
+
+static bool equals(const float* a, const float* b, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (fabsf(a[i] - b[i]) > TOLERANCE * (1.0f + fabsf(b[i])))
+            return false;
+    }
+    return true;
+}
+
+static void testMultiply(C3DMathSIMD::Backend backend, const C3DMathSIMD& reference, const C3DMathSIMD& simd)
+{
+    const char* name = C3DMathSIMD::getBackendName(backend);
+    for (int i = 0; i < 100; i++)
+    {
+        float m1[16], m2[16], expected[16], result[16];
+        randomTransform(m1);
+        if (i % 2)
+            randomProjection(m2);
+        else
+            randomTransform(m2);
+
+        reference.multiplyMatrix(m1, m2, expected);
+        simd.multiplyMatrix(m1, m2, result);
+        CHECK_PARITY(name, "multiplyMatrix", equals(result, expected, 16));
+
+        // dst aliasing an operand
+        memcpy(result, m1, sizeof(result));
+        simd.multiplyMatrix(result, m2, result);
+        CHECK_PARITY(name, "multiplyMatrix in place", equals(result, expected, 16));
+    }
+}
+
+static void testInvert(C3DMathSIMD::Backend backend, const C3DMathSIMD& reference, const C3DMathSIMD& simd)
+{
+    const char* name = C3DMathSIMD::getBackendName(backend);
+    for (int i = 0; i < 100; i++)
+    {
+        float m[16], expected[16], result[16];
+        if (i % 2)
+            randomProjection(m);
+        else
+            randomTransform(m);
+
+        bool expectedOk = reference.invertMatrix(m, expected);
+        bool resultOk = simd.invertMatrix(m, result);
+        CHECK_PARITY(name, "invertMatrix", expectedOk && resultOk && equals(result, expected, 16));
+
+        memcpy(result, m, sizeof(result));
+        resultOk = simd.invertMatrix(result, result);
+        CHECK_PARITY(name, "invertMatrix in place", resultOk && equals(result, expected, 16));
+    }
+
+    // a singular matrix is left untouched
+    float singular[16] = { 1, 2, 3, 0,  2, 4, 6, 0,  0, 0, 1, 0,  0, 0, 0, 1 };
+    float result[16];
+    for (int i = 0; i < 16; i++)
+        result[i] = -1.0f;
+    CHECK_PARITY(name, "invertMatrix singular", !simd.invertMatrix(singular, result) && result[0] == -1.0f && result[15] == -1.0f);
+}
+
+static void testTransform(C3DMathSIMD::Backend backend, const C3DMathSIMD& reference, const C3DMathSIMD& simd)
+{
+    const char* name = C3DMathSIMD::getBackendName(backend);
+
+    // every remainder of the vector loops
+    for (unsigned int count = 0; count <= 37; count++)
+    {
+        float m[16];
+        randomTransform(m);
+
+        std::vector<float> src(count * 3 + 1);
+        for (unsigned int i = 0; i < count * 3; i++)
+            src[i] = randomFloat(-50, 50);
+
+        std::vector<float> expected(count * 3 + 1), result(count * 3 + 1);
+
+        // the float after the last vector must not be written
+        expected[count * 3] = result[count * 3] = 12345.0f;
+        reference.transformPoints(m, &src[0], &expected[0], count);
+        simd.transformPoints(m, &src[0], &result[0], count);
+        CHECK_PARITY(name, "transformPoints", equals(&result[0], &expected[0], count * 3 + 1));
+
+        result = src;
+        simd.transformPoints(m, &result[0], &result[0], count);
+        CHECK_PARITY(name, "transformPoints in place", equals(&result[0], &expected[0], count * 3));
+
+        expected[count * 3] = result[count * 3] = 12345.0f;
+        reference.transformVectors(m, &src[0], &expected[0], count);
+        simd.transformVectors(m, &src[0], &result[0], count);
+        CHECK_PARITY(name, "transformVectors", equals(&result[0], &expected[0], count * 3 + 1));
+
+        result = src;
+        simd.transformVectors(m, &result[0], &result[0], count);
+        CHECK_PARITY(name, "transformVectors in place", equals(&result[0], &expected[0], count * 3));
+    }
+}
+
+static void testSlerp(C3DMathSIMD::Backend backend, const C3DMathSIMD& reference, const C3DMathSIMD& simd)
+{
+    const char* name = C3DMathSIMD::getBackendName(backend);
+    for (int i = 0; i < 200; i++)
+    {
+        float q1[4], q2[4], expected[4], result[4];
+        randomQuaternion(q1);
+        switch (i % 5)
+        {
+        case 0:
+            // the same rotation
+            memcpy(q2, q1, sizeof(q2));
+            break;
+        case 1:
+            // the same rotation on the other side of the sphere
+            for (int j = 0; j < 4; j++)
+                q2[j] = -q1[j];
+            break;
+        case 2:
+            // nearly the same rotation
+            for (int j = 0; j < 4; j++)
+                q2[j] = q1[j] + randomFloat(-1e-4f, 1e-4f);
+            break;
+        default:
+            randomQuaternion(q2);
+            break;
+        }
+
+        float t = i < 10 ? (float)(i % 2) : randomFloat(0, 1);
+        reference.slerpQuaternion(q1, q2, t, expected);
+        simd.slerpQuaternion(q1, q2, t, result);
+        CHECK_PARITY(name, "slerpQuaternion", equals(result, expected, 4));
+    }
+}
+
+static void randomBox(float* box, const float* rotation)
+{
+    C3DQuaternion q(rotation[0], rotation[1], rotation[2], rotation[3]);
+    C3DMatrix matrix;
+    C3DMatrix::createRotation(q, &matrix);
+    for (int i = 0; i < 3; i++)
+    {
+        box[i] = randomFloat(-2, 2);
+        box[12 + i] = randomFloat(0.2f, 1.5f);
+        memcpy(box + 3 + i * 3, matrix.m + i * 4, 3 * sizeof(float));
+    }
+}
+
+static void testCollideBoxes(C3DMathSIMD::Backend backend, const C3DMathSIMD& reference, const C3DMathSIMD& simd)
+{
+    const char* name = C3DMathSIMD::getBackendName(backend);
+
+    // every remainder of the vector loops
+    for (unsigned int count = 0; count <= 37; count++)
+    {
+        std::vector<float> pairs(count * C3DMathSIMD::BOX_PAIR_FLOATS + 1);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            float* pair = &pairs[i * C3DMathSIMD::BOX_PAIR_FLOATS];
+            float qa[4], qb[4];
+            randomQuaternion(qa);
+            randomQuaternion(qb);
+
+            // the same rotation, all the edge axes are skipped
+            randomBox(pair, qa);
+            randomBox(pair + C3DMathSIMD::BOX_FLOATS, i % 4 ? qb : qa);
+        }
+
+        std::vector<float> expectedDepth(count + 1), resultDepth(count + 1);
+        std::vector<float> expectedNormal(count * 3 + 1), resultNormal(count * 3 + 1);
+
+        // the float after the last result must not be written
+        expectedDepth[count] = resultDepth[count] = 12345.0f;
+        expectedNormal[count * 3] = resultNormal[count * 3] = 12345.0f;
+        reference.collideBoxes(&pairs[0], count, &expectedDepth[0], &expectedNormal[0]);
+        simd.collideBoxes(&pairs[0], count, &resultDepth[0], &resultNormal[0]);
+        CHECK_PARITY(name, "collideBoxes", resultDepth[count] == 12345.0f && resultNormal[count * 3] == 12345.0f);
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            bool separated = expectedDepth[i] < 0.0f;
+            CHECK_PARITY(name, "collideBoxes separated", (resultDepth[i] < 0.0f) == separated);
+            if (!separated)
+            {
+                CHECK_PARITY(name, "collideBoxes depth", equals(&resultDepth[i], &expectedDepth[i], 1));
+                CHECK_PARITY(name, "collideBoxes normal", equals(&resultNormal[i * 3], &expectedNormal[i * 3], 3));
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    C3DMathSIMD& simd = C3DMathSIMD::getInstance();
+
+    // the scalar table is kept as the reference
+    simd.setBackend(C3DMathSIMD::Backend_Scalar);
+    const C3DMathSIMD reference = simd;
+
+    for (int i = 0; i < C3DMathSIMD::Backend_Count; i++)
+    {
+        C3DMathSIMD::Backend backend = (C3DMathSIMD::Backend)i;
+        if (backend == C3DMathSIMD::Backend_Scalar)
+            continue;
+
+        if (!simd.setBackend(backend))
+        {
+            printf("%s: not supported, skipped\n", C3DMathSIMD::getBackendName(backend));
+            continue;
+        }
+
+        testMultiply(backend, reference, simd);
+        testInvert(backend, reference, simd);
+        testTransform(backend, reference, simd);
+        testSlerp(backend, reference, simd);
+        testCollideBoxes(backend, reference, simd);
+        printf("%s: tested\n", C3DMathSIMD::getBackendName(backend));
+    }
+
+    return C3D_TEST_RESULT();
+}
@@ -0,0 +1,103 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+// C3DOcclusionBuffer with a wall in front of the camera, with every SIMD backend.
+
+#include "Base.h"
+#include "C3DOcclusionBuffer.h"
+#include "C3DMathSIMD.h"
+#include "C3DAABB.h"
+#include "C3DTest.h"
+
+using namespace cocos3d;
+
+#define CHECK_BACKEND(backend, condition) C3D_CHECK_MSG(condition, "%s", backend)
+
+static void testWall(const char* backend)
+{
+    // the camera at z = 10 looks down -z, the wall is a 10 x 10 quad at z = -10
+    C3DMatrix view, projection, viewProjection;
+    C3DMatrix::createLookAt(C3DVector3(0, 0, 10), C3DVector3(0, 0, 0), C3DVector3(0, 1, 0), &view);
+    C3DMatrix::createPerspective(60, 2.0f, 1.0f, 100.0f, &projection);
+    C3DMatrix::multiply(projection, view, &viewProjection);
+
+    C3DOcclusionBuffer buffer;
+
+    C3DAABB behind(C3DVector3(-1, -1, -30), C3DVector3(1, 1, -28));
+
+    // nothing is hidden until an occluder is drawn
+    buffer.begin(viewProjection);
+    buffer.end();
+    CHECK_BACKEND(backend, !buffer.isOccluded(behind));
+
+    C3DVector3 wall[4] =
+    {
+        C3DVector3(-5, -5, -10), C3DVector3(5, -5, -10), C3DVector3(5, 5, -10), C3DVector3(-5, 5, -10)
+    };
+    unsigned short indices[6] = { 0, 1, 2, 0, 2, 3 };
+
+    buffer.begin(viewProjection);
+    buffer.addOccluder(C3DMatrix::identity(), wall, 4, indices, 6);
+    buffer.end();
+    CHECK_BACKEND(backend, buffer.getTriangleCount() == 2);
+
+    // the diagonal shared by the two triangles leaves no hole
+    CHECK_BACKEND(backend, buffer.isOccluded(behind));
+
+    C3DAABB front(C3DVector3(-1, -1, -8), C3DVector3(1, 1, -6));
+    CHECK_BACKEND(backend, !buffer.isOccluded(front));
+
+    C3DAABB beside(C3DVector3(20, -1, -30), C3DVector3(22, 1, -28));
+    CHECK_BACKEND(backend, !buffer.isOccluded(beside));
+
+    C3DAABB straddling(C3DVector3(3, -1, -30), C3DVector3(12, 1, -28));
+    CHECK_BACKEND(backend, !buffer.isOccluded(straddling));
+
+    C3DAABB crossingNear(C3DVector3(-1, -1, -20), C3DVector3(1, 1, 20));
+    CHECK_BACKEND(backend, !buffer.isOccluded(crossingNear));
+
+    // the wall seen from behind is back facing and hides nothing
+    C3DMatrix::createLookAt(C3DVector3(0, 0, -40), C3DVector3(0, 0, -50), C3DVector3(0, 1, 0), &view);
+    C3DMatrix::multiply(projection, view, &viewProjection);
+    C3DAABB past(C3DVector3(-1, -1, -5), C3DVector3(1, 1, -3));
+
+    buffer.begin(viewProjection);
+    buffer.addOccluder(C3DMatrix::identity(), wall, 4, indices, 6);
+    buffer.end();
+    CHECK_BACKEND(backend, !buffer.isOccluded(past));
+}
+
+int main(int argc, char** argv)
+{
+    C3DMathSIMD& simd = C3DMathSIMD::getInstance();
+    for (int i = 0; i < C3DMathSIMD::Backend_Count; i++)
+    {
+        C3DMathSIMD::Backend backend = (C3DMathSIMD::Backend)i;
+        if (!simd.setBackend(backend))
+            continue;
+
+        testWall(C3DMathSIMD::getBackendName(backend));
+        printf("%s: tested\n", C3DMathSIMD::getBackendName(backend));
+    }
+
+    return C3D_TEST_RESULT();
+}
@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include <string>
 
 #include "MainLayer.h"
+#include "PerformanceTest/PerformanceBenchmark.h"
 #include "AppMacros.h"
 #include "cocos3d.h"
 #include "C3DRenderSystem.h"
@@ -111,7 +112,7 @@ bool AppDelegate::applicationDidFinishLaunching() {
     pDirector->setAnimationInterval(1.0 / 60);
 
     // create a scene. it's an autorelease object
-    CCScene *pScene = MainLayer::scene();
+    CCScene *pScene = PerformanceBenchmark::isRequested() ? PerformanceBenchmark::scene() : MainLayer::scene();
 
     // run
     pDirector->runWithScene(pScene);
@@ -0,0 +1,356 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "PerformanceBenchmark.h"
+
+#include <stdlib.h>
+#include <algorithm>
+
+#include "PerformanceTestLayer.h"
+#include "C3DProfile.h"
+#include "C3DRenderSystem.h"
+
+using namespace cocos3d;
+
+// milliseconds elapsed since begin, a C3DProfile::getTime() value
+static float elapsedTime(unsigned long long begin)
+{
+    return (float)((C3DProfile::getTime() - begin) * 1e-6);
+}
+
+static void writeTimes(FILE* file, const char* name, const std::vector<float>& times)
+{
+    if (times.empty())
+    {
+        fprintf(file, "\"%s\":null", name);
+        return;
+    }
+
+    std::vector<float> sorted(times);
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0;
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        total += sorted[i];
+    }
+
+    size_t last = sorted.size() - 1;
+    fprintf(file, "\"%s\":{\"mean\":%.4f,\"min\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"max\":%.4f}", name,
+        total / sorted.size(), sorted[0], sorted[(size_t)(last * 0.5f + 0.5f)], sorted[(size_t)(last * 0.95f + 0.5f)], sorted[last]);
+}
+
+PerformanceBenchmark::Options::Options()
+    : frames(600)
+    , warmup(60)
+    , step(16)
+    , render(true)
+{
+}
+
+PerformanceBenchmark::PerformanceBenchmark(C3DScene* scene, const Options& options)
+    : _scene(scene)
+    , _options(options)
+    , _frame(0)
+{
+    unsigned long long begin = C3DProfile::getTime();
+    PerformanceTestLayer::preloadSprites();
+    _preloadTime = elapsedTime(begin);
+}
+
+bool PerformanceBenchmark::isRequested()
+{
+    return getenv("C3D_BENCHMARK") != NULL;
+}
+
+CCScene* PerformanceBenchmark::scene()
+{
+    const char* env = getenv("C3D_BENCHMARK");
+
+    CCScene* scene = CCScene::create();
+    scene->addChild(PerformanceBenchmarkLayer::create(parseOptions(env ? env : "")));
+
+    return scene;
+}
+
+PerformanceBenchmark::Options PerformanceBenchmark::parseOptions(const std::string& str)
+{
+    Options options;
+
+    size_t pos = 0;
+    while (pos < str.size())
+    {
+        size_t end = str.find_first_of("; ", pos);
+        if (end == std::string::npos)
+            end = str.size();
+
+        std::string option = str.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t equal = option.find('=');
+        if (equal == std::string::npos)
+            continue;
+
+        std::string key = option.substr(0, equal);
+        std::string value = option.substr(equal + 1);
+        if (key == "sprites")
+        {
+            const char* s = value.c_str();
+            while (*s)
+            {
+                char* next;
+                long count = strtol(s, &next, 10);
+                if (next == s)
+                    break;
+                if (count > 0)
+                    options.spriteCounts.push_back((int)count);
+                s = *next == ',' ? next + 1 : next;
+            }
+        }
+        else if (key == "frames")
+            options.frames = atoi(value.c_str());
+        else if (key == "warmup")
+            options.warmup = atoi(value.c_str());
+        else if (key == "step")
+            options.step = atol(value.c_str());
+        else if (key == "render")
+            options.render = atoi(value.c_str()) != 0;
+        else if (key == "output")
+            options.output = value;
+        else if (key == "trace")
+            options.trace = value;
+        else
+            CCLOG("unknown benchmark option: %s", key.c_str());
+    }
+
+    if (options.spriteCounts.empty())
+    {
+        options.spriteCounts.push_back(100);
+        options.spriteCounts.push_back(500);
+        options.spriteCounts.push_back(2000);
+    }
+    options.frames = std::max(options.frames, 1);
+    options.warmup = std::max(options.warmup, 0);
+    options.step = std::max(options.step, 1L);
+
+    return options;
+}
+
+bool PerformanceBenchmark::step()
+{
+    if (_scenarios.empty() || _frame >= _options.warmup + _options.frames)
+    {
+        if (_scenarios.size() == _options.spriteCounts.size())
+            return false;
+
+        _scenarios.push_back(Scenario());
+        _scenarios.back().spriteCount = _options.spriteCounts[_scenarios.size() - 1];
+        beginScenario(_scenarios.back());
+        _frame = 0;
+    }
+
+    stepFrame(_scenarios.back(), _frame >= _options.warmup);
+    _frame++;
+
+    return true;
+}
+
+void PerformanceBenchmark::beginScenario(Scenario& scenario)
+{
+    _scene->removeAllNode();
+    PerformanceTestLayer::setUpCamera(_scene);
+
+    // the resource pools may have released the sprite file since the last scenario,
+    // load only clones it so the scenarios are comparable
+    PerformanceTestLayer::preloadSprites();
+
+    unsigned long long begin = C3DProfile::getTime();
+    PerformanceTestLayer::spawnSprites(_scene, scenario.spriteCount);
+    scenario.loadTime = elapsedTime(begin);
+    scenario.visibleCount = 0;
+}
+
+void PerformanceBenchmark::stepFrame(Scenario& scenario, bool measure)
+{
+    PROFILE_UPDATE();
+
+    unsigned long long begin = C3DProfile::getTime();
+    _scene->update(_options.step);
+    C3DRenderSystem::getInstance()->update(_options.step);
+    float updateTime = elapsedTime(begin);
+
+#ifdef ENABLE_C3D_PROFILE
+    // the profiled frame is closed when the step begins, the stats are the ones of the previous frame
+    int cull = C3DProfile::getInstance()->findMarker("3dscene cull");
+    if (cull >= 0 && _frame > _options.warmup)
+        scenario.cullTimes.push_back(C3DProfile::getInstance()->getMarkerStat(cull).frameTime);
+#endif
+
+    float submitTime = 0;
+    float flushTime = 0;
+    if (_options.render)
+    {
+        begin = C3DProfile::getTime();
+        _scene->preDraw();
+        _scene->draw();
+        submitTime = elapsedTime(begin);
+
+        begin = C3DProfile::getTime();
+        _scene->drawDebug();
+        _scene->postDraw();
+        flushTime = elapsedTime(begin);
+    }
+
+    if (measure)
+    {
+        scenario.updateTimes.push_back(updateTime);
+        if (_options.render)
+        {
+            scenario.submitTimes.push_back(submitTime);
+            scenario.flushTimes.push_back(flushTime);
+        }
+        scenario.visibleCount = (unsigned int)_scene->getVisibleNodes().size();
+    }
+}
+
+void PerformanceBenchmark::finish()
+{
+    if (_options.output.empty())
+    {
+        writeJson(stdout);
+        fflush(stdout);
+    }
+    else
+    {
+        FILE* file = fopen(_options.output.c_str(), "w");
+        if (file)
+        {
+            writeJson(file);
+            fclose(file);
+            CCLOG("benchmark results written to %s", _options.output.c_str());
+        }
+        else
+        {
+            CCLOG("failed to open benchmark output %s", _options.output.c_str());
+        }
+    }
+
+    if (!_options.trace.empty())
+    {
+#ifdef ENABLE_C3D_PROFILE
+        PROFILE_EXPORT(_options.trace);
+#else
+        CCLOG("benchmark trace needs ENABLE_C3D_PROFILE");
+#endif
+    }
+}
+
+void PerformanceBenchmark::writeJson(FILE* file) const
+{
+    fprintf(file, "{\"benchmark\":\"PerformanceTest\",\"step\":%ld,\"warmup\":%d,\"frames\":%d,\"render\":%s,\"preload\":%.4f,\"scenarios\":[\n",
+        _options.step, _options.warmup, _options.frames, _options.render ? "true" : "false", _preloadTime);
+
+    for (size_t i = 0; i < _scenarios.size(); i++)
+    {
+        const Scenario& scenario = _scenarios[i];
+        fprintf(file, "{\"sprites\":%d,\"visible\":%u,\"load\":%.4f,\"loadPerSprite\":%.4f,",
+            scenario.spriteCount, scenario.visibleCount, scenario.loadTime, scenario.loadTime / scenario.spriteCount);
+        writeTimes(file, "update", scenario.updateTimes);
+        fprintf(file, ",");
+        writeTimes(file, "cull", scenario.cullTimes);
+        fprintf(file, ",");
+        writeTimes(file, "submit", scenario.submitTimes);
+        fprintf(file, ",");
+        writeTimes(file, "flush", scenario.flushTimes);
+        fprintf(file, "}%s\n", i + 1 < _scenarios.size() ? "," : "");
+    }
+
+    fprintf(file, "]}\n");
+}
+
+PerformanceBenchmarkLayer::PerformanceBenchmarkLayer()
+    : _layer(NULL)
+    , _benchmark(NULL)
+{
+}
+
+PerformanceBenchmarkLayer::~PerformanceBenchmarkLayer()
+{
+    CC_SAFE_DELETE(_benchmark);
+    CC_SAFE_RELEASE(_layer);
+}
+
+PerformanceBenchmarkLayer* PerformanceBenchmarkLayer::create(const PerformanceBenchmark::Options& options)
+{
+    PerformanceBenchmarkLayer* layer = new PerformanceBenchmarkLayer();
+    if (layer->init(options))
+    {
+        layer->autorelease();
+        return layer;
+    }
+
+    delete layer;
+    return NULL;
+}
+
+bool PerformanceBenchmarkLayer::init(const PerformanceBenchmark::Options& options)
+{
+    if (!CCLayer::init())
+        return false;
+
+    // the 3d layer is never added to the scene graph, it only owns the scene and the render states
+    _layer = C3DLayer::create();
+    if (_layer == NULL)
+        return false;
+    _layer->retain();
+    _layer->setAsMainLayer();
+
+    _benchmark = new PerformanceBenchmark(_layer->get3DScene(), options);
+
+    return true;
+}
+
+void PerformanceBenchmarkLayer::onEnter()
+{
+    CCLayer::onEnter();
+
+    scheduleUpdate();
+}
+
+void PerformanceBenchmarkLayer::update(float dt)
+{
+    // one benchmark frame per tick, the real dt is ignored
+    _layer->beginRender();
+    bool running = _benchmark->step();
+    _layer->endRender();
+
+    // don't let the queued gpu work of this frame leak in the next one
+    glFinish();
+
+    if (!running)
+    {
+        unscheduleUpdate();
+        _benchmark->finish();
+        CCDirector::getInstance()->end();
+    }
+}
@@ -0,0 +1,143 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __PERFORMANCE_BENCHMARK_H__
+#define __PERFORMANCE_BENCHMARK_H__
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "cocos2d.h"
+#include "cocos3d.h"
+
+USING_NS_CC;
+
+/**
+ * Runs the scene of PerformanceTestLayer without user interaction and writes the timings as json.
+ *
+ * Every scenario spawns a number of sprites and steps the scene with a fixed time step, so the
+ * results only depend on the engine and the device. The benchmark only needs a C3DScene: the
+ * application runs it one frame per tick with PerformanceBenchmarkLayer, proj.headless runs it
+ * in a loop with the null GL backend. The options are a list of key=value separated by ';' or
+ * spaces, the application reads them from the C3D_BENCHMARK environment variable:
+ *   sprites=100,500,2000   sprite count of each scenario
+ *   frames=600             measured frames of each scenario
+ *   warmup=60              frames run before measuring
+ *   step=16                fixed time step in milliseconds
+ *   render=1               0 only runs update & cull, nothing is drawn
+ *   output=file            json results, stdout when empty
+ *   trace=file             chrome trace of the last frames, needs ENABLE_C3D_PROFILE
+ * Times are in milliseconds, update includes cull which is only reported with ENABLE_C3D_PROFILE.
+ * preload is the first load of the sprite file, load the time to spawn the sprites of a scenario
+ * once the file is cached, so it is comparable across scenarios.
+ */
+class PerformanceBenchmark
+{
+public:
+    struct Options
+    {
+        std::vector<int> spriteCounts;
+        int frames;
+        int warmup;
+        long step;
+        bool render;
+        std::string output;
+        std::string trace;
+
+        Options();
+    };
+
+    /**
+     * the benchmark replaces every node of scene
+     */
+    PerformanceBenchmark(cocos3d::C3DScene* scene, const Options& options);
+
+    /**
+     * true when the benchmark is asked by the environment
+     */
+    static bool isRequested();
+
+    /**
+     * scene running the benchmark with the options of the environment
+     */
+    static CCScene* scene();
+
+    static Options parseOptions(const std::string& str);
+
+    /**
+     * updates and draws one frame, false once every scenario is done
+     */
+    bool step();
+
+    /**
+     * writes the results and the trace
+     */
+    void finish();
+
+private:
+    struct Scenario
+    {
+        int spriteCount;
+        float loadTime;
+        unsigned int visibleCount;
+        std::vector<float> updateTimes;
+        std::vector<float> cullTimes;
+        std::vector<float> submitTimes;
+        std::vector<float> flushTimes;
+    };
+
+    void beginScenario(Scenario& scenario);
+    void stepFrame(Scenario& scenario, bool measure);
+
+    void writeJson(FILE* file) const;
+
+    cocos3d::C3DScene* _scene;
+    Options _options;
+    float _preloadTime;
+
+    std::vector<Scenario> _scenarios;
+    int _frame;
+};
+
+/**
+ * Runs a PerformanceBenchmark one frame per application tick and exits the application once done.
+ */
+class PerformanceBenchmarkLayer : public CCLayer
+{
+public:
+    PerformanceBenchmarkLayer();
+    virtual ~PerformanceBenchmarkLayer();
+
+    static PerformanceBenchmarkLayer* create(const PerformanceBenchmark::Options& options);
+
+    bool init(const PerformanceBenchmark::Options& options);
+
+    virtual void onEnter();
+    virtual void update(float dt);
+
+private:
+    cocos3d::C3DLayer* _layer;
+    PerformanceBenchmark* _benchmark;
+};
+
+#endif
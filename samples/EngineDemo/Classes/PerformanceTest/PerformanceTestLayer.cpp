@@ -53,6 +53,8 @@ enum ColorType
     COLOR_NUM
 };
 
+static const char* SPRITE_FILE = "demores/haigui/haigui.ckb";
+
 static const char* colorTypes[COLOR_NUM] =
 {
     "Orininal",
@@ -101,28 +103,44 @@ void PerformanceTestLayer::draw3D()
 
 void PerformanceTestLayer::setUpScene()
 {
-    C3DSprite* sm = static_cast<cocos3d::C3DSprite*>(C3DRenderNodeManager::getInstance()->getResource("demores/haigui/haigui.ckb"));
+    spawnSprites(_scene, 100);
+}
+
+void PerformanceTestLayer::preloadSprites()
+{
+    C3DSprite* sm = static_cast<cocos3d::C3DSprite*>(C3DRenderNodeManager::getInstance()->getResource(SPRITE_FILE));
     sm->addAnimationClip("all", 0 , 240, 0, 1.0f);
     sm->playAnimationClip("all");
+}
 
-    for (int i = 0; i < 10; i++)
+void PerformanceTestLayer::spawnSprites(C3DScene* scene, int count)
+{
+    preloadSprites();
+
+    int side = (int)ceilf(sqrtf((float)count));
+    for (int i = 0; i < side; i++)
     {
-		for (int j = 0; j < 10; j++)
+		for (int j = 0; j < side && i * side + j < count; j++)
 		{
-			C3DSprite* sm = static_cast<cocos3d::C3DSprite*>(C3DRenderNodeManager::getInstance()->getResource("demores/haigui/haigui.ckb"));
-			sm->setPosition(-50 +i * 10, -50 + j * 10, 0);
-			_scene->addChild(sm);
+			C3DSprite* sm = static_cast<cocos3d::C3DSprite*>(C3DRenderNodeManager::getInstance()->getResource(SPRITE_FILE));
+			sm->setPosition(-side * 5 + i * 10, -side * 5 + j * 10, 0);
+			scene->addChild(sm);
 		}
     }
 }
 
 void PerformanceTestLayer::setUpCamera()
+{
+    setUpCamera(_scene);
+}
+
+void PerformanceTestLayer::setUpCamera(C3DScene* scene)
 {
     C3DCamera* camera = C3DCamera::createPerspective(45, 0.75f, 1, 1000);
     camera->lookAt(C3DVector3(0,0,100), C3DVector3(0, 0, 0), C3DVector3(0, 0, 0));
 
-    _scene->addChild(camera);
-    _scene->setActiveCamera(0);
+    scene->addChild(camera);
+    scene->setActiveCamera(0);
 }
 
 void PerformanceTestLayer::setUpLight()
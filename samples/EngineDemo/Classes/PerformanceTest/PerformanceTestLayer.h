@@ -45,8 +45,15 @@ public:
 
 	void setUpScene();
 
+    // load the sprite file in the cache, spawnSprites then only clones it
+    static void preloadSprites();
+
+    // add count animated sprites on a grid centered at the origin, 10 units apart
+    static void spawnSprites(cocos3d::C3DScene* scene, int count);
+
     // setup initialize camera
     void setUpCamera();
+    static void setUpCamera(cocos3d::C3DScene* scene);
 
     //setup initialize light
     void setUpLight();
@@ -34,6 +34,7 @@ LOCAL_SRC_FILES := main.cpp \
                    ../../Classes/PostEffect/PEPointWarp.cpp \
                    ../../Classes/PostEffect/PESceneChange.cpp \
                    ../../Classes/PerformanceTest/PerformanceTestLayer.cpp \
+                   ../../Classes/PerformanceTest/PerformanceBenchmark.cpp \
                    ../../Classes/PostEffect/PESpaceWarp.cpp \
                    ../../Classes/PostEffect/PEVortex.cpp \
                    ../../Classes/PostEffect/PostEffectTestLayer.cpp \
@@ -0,0 +1,75 @@
+/****************************************************************************
+Copyright (c) Chukong Technologies Inc.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+// Runs PerformanceBenchmark with the null GL backend: no window, no GL context, only the cpu
+// side of the engine is measured.
+// usage: EngineDemoBenchmark [option=value ...], the options of PerformanceBenchmark,
+// C3D_BENCHMARK is used when there is none.
+
+#include <stdlib.h>
+#include <string>
+
+#include "cocos2d.h"
+#include "cocos3d.h"
+#include "C3DRenderSystem.h"
+#include "PerformanceBenchmark.h"
+
+#ifndef C3D_GL_NULL
+#error "the headless benchmark runs with the null GL backend, build it with C3D_GL_NULL"
+#endif
+
+using namespace cocos3d;
+
+int main(int argc, char** argv)
+{
+    std::string options;
+    for (int i = 1; i < argc; i++)
+    {
+        options += argv[i];
+        options += ' ';
+    }
+    const char* env = getenv("C3D_BENCHMARK");
+    if (options.empty() && env != NULL)
+        options = env;
+
+    cocos2d::CCFileUtils::getInstance()->addSearchPath("../Resources");
+    cocos2d::CCFileUtils::getInstance()->addSearchPath("../Resources/3d");
+
+    // there is no window, the viewport is the one of the application
+    C3DRenderSystem::getInstance()->setViewport(0, 0, 960, 640);
+
+    C3DScene* scene = C3DScene::createScene(NULL);
+
+    PerformanceBenchmark* benchmark = new PerformanceBenchmark(scene, PerformanceBenchmark::parseOptions(options));
+    while (benchmark->step())
+    {
+        // the director isn't running, release the objects autoreleased by the frame
+        cocos2d::PoolManager::getInstance()->getCurrentPool()->clear();
+    }
+    benchmark->finish();
+
+    SAFE_DELETE(benchmark);
+    SAFE_RELEASE(scene);
+
+    return 0;
+}
@@ -0,0 +1,343 @@
+#!/usr/bin/python
+
+"""
+Precompiles the C3DElementNode text files (.material, .particle, .config, ...)
+into the binary format read by C3DElementNode::create, which picks up
+"<file>.bin" when it is present and was converted from the current text file.
+
+usage: element_convert.py [file or directory]...
+       without arguments, converts the resources directory of config.py
+
+binary layout, little endian:
+    'C3EN', version major, version minor (bytes)
+    uint32 length, uint32 FNV-1a hash of the text file
+    uint32 string count, then per string: uint32 FNV-1a hash, uint16 length, bytes
+    root node, a node being:
+        uint32 type, uint32 name, uint32 flag count      (string indices)
+        flag count * (uint32 key, uint32 value)
+        uint32 element count, element count * (uint32 key, uint32 value, uint32 ElementType)
+        uint32 child count, child nodes
+"""
+
+import os, sys, struct
+
+VERSION_MAJOR = 2
+VERSION_MINOR = 0
+
+EXTENSIONS = (".material", ".particle", ".config", ".cbx")
+
+# C3DElementNode::ElementType
+NONE, STRING, NUMBER, VECTOR2, VECTOR3, VECTOR4, MATRIX = range(7)
+
+SPACES = " \t\n\v\f\r"
+
+
+class Node:
+    def __init__(self, node_type = "", name = ""):
+        self.type = node_type
+        self.name = name
+        self.flags = []
+        self.elements = []
+        self.children = []
+
+
+def trim(s):
+    if s is None:
+        return None
+    return s.strip(SPACES)
+
+
+class Tokenizer:
+    """ strtok """
+    def __init__(self, line):
+        self.line = line
+        self.pos = 0
+
+    def next(self, delimiters):
+        line = self.line
+        while self.pos < len(line) and line[self.pos] in delimiters:
+            self.pos += 1
+        if self.pos >= len(line):
+            return None
+        start = self.pos
+        while self.pos < len(line) and line[self.pos] not in delimiters:
+            self.pos += 1
+        token = line[start:self.pos]
+        self.pos += 1
+        return token
+
+
+class Reader:
+    """ the subset of C3DMemoryStream the text parser uses """
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def skip_white_space(self):
+        while self.pos < len(self.data) and self.data[self.pos] in SPACES:
+            self.pos += 1
+
+    def read_line(self):
+        end = self.data.find("\n", self.pos)
+        if end < 0:
+            end = len(self.data)
+        line = self.data[self.pos:end]
+        self.pos = end
+        return line
+
+    def read_char(self):
+        if self.eof():
+            return ""
+        c = self.data[self.pos]
+        self.pos += 1
+        return c
+
+
+# the parsers follow C3DElementNode::read, readContents and readFlag
+
+def read_node(reader, node):
+    while True:
+        reader.skip_white_space()
+        if reader.eof():
+            break
+
+        line = reader.read_line()
+        if line.startswith("//"):
+            continue
+
+        if "=" in line:
+            end = "}" in line
+            tokens = Tokenizer(line)
+            name = tokens.next(" =\t")
+            if name is None:
+                raise ValueError("value without name")
+            value = tokens.next("=")
+            if value is None:
+                raise ValueError("name without value")
+            node.elements.append((name, trim(value)))
+            if end:
+                return
+            continue
+
+        brace = "{" in line
+        tokens = Tokenizer(line)
+        name = trim(tokens.next(" \t\n{"))
+        if name is None:
+            raise ValueError("unknown error")
+        if name.startswith("}"):
+            return
+
+        value = trim(tokens.next("{"))
+        if brace:
+            child = Node(name, value or "")
+            read_node(reader, child)
+            node.children.append(child)
+            continue
+
+        reader.skip_white_space()
+        c = reader.read_char()
+        if c == "<":
+            child = Node()
+            read_flags(reader, child)
+            reader.skip_white_space()
+            reader.read_char()
+            read_contents(reader, child, name, value)
+            node.children.append(child)
+        elif c == "{":
+            child = Node(name, value or "")
+            read_node(reader, child)
+            node.children.append(child)
+        else:
+            if c:
+                reader.pos -= 1
+            node.elements.append((name, value or ""))
+
+
+def read_contents(reader, node, name, node_id):
+    node.type = name
+    if node_id:
+        node.name = node_id
+
+    while True:
+        reader.skip_white_space()
+        if reader.eof():
+            break
+
+        line = reader.read_line()
+        if line.startswith("//"):
+            continue
+
+        if "=" in line:
+            end = "}" in line
+            tokens = Tokenizer(line)
+            name = tokens.next(" =\t")
+            if name is None:
+                raise ValueError("value without name")
+            node.elements.append((name, trim(tokens.next("=")) or ""))
+            if end:
+                return
+            continue
+
+        brace = "{" in line
+        tokens = Tokenizer(line)
+        name = trim(tokens.next(" \t\n{"))
+        if name is None:
+            raise ValueError("unknown error")
+        if name.startswith("}"):
+            return
+
+        value = trim(tokens.next("{"))
+        if brace:
+            child = Node(name, value or "")
+            read_node(reader, child)
+            node.children.append(child)
+            continue
+
+        reader.skip_white_space()
+        c = reader.read_char()
+        if c == "{":
+            child = Node(name, value or "")
+            read_node(reader, child)
+            node.children.append(child)
+        else:
+            if c:
+                reader.pos -= 1
+            node.elements.append((name, value or ""))
+
+
+def read_flags(reader, node):
+    while True:
+        reader.skip_white_space()
+        if reader.eof():
+            break
+
+        line = reader.read_line()
+        if line.startswith("//"):
+            continue
+
+        if "=" in line:
+            end = ">" in line
+            tokens = Tokenizer(line)
+            name = tokens.next(" =\t")
+            value = tokens.next("=")
+            if name is None or value is None:
+                raise ValueError("invalid flag")
+            node.flags.append((name, trim(value)))
+            if end:
+                return
+        else:
+            name = trim(Tokenizer(line).next(" \t\n<"))
+            if name is None or name.startswith(">"):
+                return
+
+
+def is_numeric(s):
+    """ isStringNumeric of C3DElementNode.cpp """
+    if s.startswith("-"):
+        s = s[1:]
+    if not s or not s[0].isdigit():
+        return False
+    decimals = 0
+    for c in s[1:]:
+        if c.isdigit():
+            continue
+        if c == "." and decimals == 0:
+            decimals += 1
+        else:
+            return False
+    return True
+
+
+def element_type(value):
+    if not value:
+        return NONE
+    commas = value.count(",") + 1
+    if commas == 1:
+        return NUMBER if is_numeric(value) else STRING
+    return { 2 : VECTOR2, 3 : VECTOR3, 4 : VECTOR4, 16 : MATRIX }.get(commas, STRING)
+
+
+def hash_key(s):
+    """ FNV-1a, C3DElementNode::hashKey """
+    return hash_bytes(s.encode("latin-1"))
+
+
+def hash_bytes(data):
+    h = 2166136261
+    for c in bytearray(data):
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+
+class StringTable:
+    def __init__(self):
+        self.strings = []
+        self.indices = {}
+
+    def index(self, s):
+        if s not in self.indices:
+            self.indices[s] = len(self.strings)
+            self.strings.append(s)
+        return self.indices[s]
+
+
+def write_node(node, table, out):
+    out.append(struct.pack("<3I", table.index(node.type), table.index(node.name), len(node.flags)))
+    for key, value in node.flags:
+        out.append(struct.pack("<2I", table.index(key), table.index(value)))
+    out.append(struct.pack("<I", len(node.elements)))
+    for key, value in node.elements:
+        out.append(struct.pack("<3I", table.index(key), table.index(value), element_type(value)))
+    out.append(struct.pack("<I", len(node.children)))
+    for child in node.children:
+        write_node(child, table, out)
+
+
+def convert_file(src_file):
+    f = open(src_file, "rb")
+    raw_data = f.read()
+    f.close()
+    data = raw_data.decode("latin-1")
+
+    root = Node()
+    read_node(Reader(data), root)
+
+    table = StringTable()
+    nodes = []
+    write_node(root, table, nodes)
+
+    out = [struct.pack("<4sBBIII", b"C3EN", VERSION_MAJOR, VERSION_MINOR,
+                       len(raw_data), hash_bytes(raw_data), len(table.strings))]
+    for s in table.strings:
+        raw = s.encode("latin-1")
+        out.append(struct.pack("<IH", hash_key(s), len(raw)))
+        out.append(raw)
+    out.extend(nodes)
+
+    f = open(src_file + ".bin", "wb")
+    f.write(b"".join(out))
+    f.close()
+    print("%s ok" % src_file)
+
+
+def convert(paths):
+    for path in paths:
+        if os.path.isfile(path):
+            convert_file(path)
+            continue
+        for dirname, dirs, names in os.walk(path):
+            for name in names:
+                if name.lower().endswith(EXTENSIONS):
+                    convert_file(os.path.join(dirname, name))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) > 1:
+        convert(sys.argv[1:])
+    else:
+        import config
+        convert([config.g_resources_dir])